@@ -43,7 +43,7 @@ bool count_blocks(cxxopts::ParseResult parseResult, std::string& err) {
     }
 
     ColorAtlas * const colorAtlas = color_atlas_new();
-    Stream * const stream = stream_new_file_read(fd); // Stream is responsible for fclose-ing the file descriptor
+    Stream * const stream = stream_new_file_map(fd); // Stream is responsible for fclose-ing the file descriptor
 
     const ShapeSettings shapeSettings = {
         .lighting = false,
@@ -58,6 +58,7 @@ bool count_blocks(cxxopts::ParseResult parseResult, std::string& err) {
                                   colorAtlas,
                                   &shapeSettings,
                                   allowLegacy,
+                                  0,
                                   &assets) == false) {
         color_atlas_free(colorAtlas);
         err.assign("can't load assets");
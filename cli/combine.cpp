@@ -8,6 +8,7 @@
 #include "combine.hpp"
 
 // C++
+#include <chrono>
 #include <iostream>
 #include <vector>
 
@@ -58,16 +59,27 @@ bool command_combine(cxxopts::ParseResult parseResult, std::string& err) {
             break;
         }
         
-        Stream *s = stream_new_file_read(fd);
+        Stream *s = stream_new_file_map(fd);
+        if (s == nullptr) {
+            err = std::string("can't read ") + input_path;
+            break;
+        }
         
         Shape *shape = nullptr;
         
+        const auto start = std::chrono::steady_clock::now();
         enum serialization_vox_error error = serialization_vox_load(s,
                                                                     &shape,
                                                                     true,
                                                                     colorAtlas);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
         
         if (shape != nullptr) {
+            const size_t nbBlocks = shape_get_nb_blocks(shape);
+            std::cout << "  imported " << input_path << ": " << nbBlocks << " voxels in "
+                      << elapsed.count() * 1000.0 << " ms ("
+                      << (elapsed.count() > 0.0 ? nbBlocks / elapsed.count() / 1000000.0 : 0.0)
+                      << " M voxels/s)" << std::endl;
             shapes[index] = shape;
             ++index;
         }
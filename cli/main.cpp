@@ -14,6 +14,7 @@
 // cli
 #include "blocks.hpp"
 #include "combine.hpp"
+#include "pack.hpp"
 #include "shape_point.hpp"
 
 int main(int argc, const char * argv[]) {
@@ -21,10 +22,11 @@ int main(int argc, const char * argv[]) {
     cxxopts::Options options("Cubzh", "Tools for voxels.");
 
     options.add_options()
-    ("command", "command to use: blocks,combine,setpoint", cxxopts::value<std::string>())
+    ("command", "command to use: blocks,combine,pack,setpoint", cxxopts::value<std::string>())
     ("i,input", "input files", cxxopts::value<std::vector<std::string>>())
     // ("n,name", "input file name", cxxopts::value<std::vector<std::string>>())
     ("o,output", "output file", cxxopts::value<std::string>())
+    ("z,compress", "compress archive entries (pack)", cxxopts::value<bool>()->default_value("false"))
     ;
 
     options.parse_positional({"command"});
@@ -45,6 +47,8 @@ int main(int argc, const char * argv[]) {
         success = count_blocks(result, err);
     } else if (command == "combine") {
         success = command_combine(result, err);
+    } else if (command == "pack") {
+        success = command_pack(result, err);
     } else if (command == "setpoint") {
         success = commandSetPoint(result, err);
     } else {
@@ -0,0 +1,130 @@
+//
+//  pack.cpp
+//  cli
+//
+
+#include "pack.hpp"
+
+// C++
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Cubzh Core
+#include "asset_archive.h"
+
+namespace fs = std::filesystem;
+
+static bool read_file(const fs::path& path, std::vector<char>& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (file.is_open() == false) {
+        return false;
+    }
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return file.bad() == false;
+}
+
+bool command_pack(cxxopts::ParseResult parseResult, std::string& err) {
+
+    // validation
+
+    if (parseResult.count("input") <= 0) {
+        err.assign("no input files");
+        return false;
+    }
+
+    if (parseResult.count("output") == 0) {
+        err.assign("no output file path");
+        return false;
+    } else if (parseResult.count("output") != 1) {
+        err.assign("only 1 output file is allowed");
+        return false;
+    }
+
+    const bool compress = parseResult["compress"].as<bool>();
+
+    // processing
+
+    std::vector<std::string> input_paths = parseResult["input"].as<std::vector<std::string>>();
+    std::string output_path = parseResult["output"].as<std::string>();
+
+    // (absolute path, path within archive)
+    std::vector<std::pair<fs::path, std::string>> files;
+
+    std::error_code ec;
+    for (const std::string& input_path : input_paths) {
+        const fs::path input(input_path);
+        if (fs::is_directory(input, ec)) {
+            for (const fs::directory_entry& entry : fs::recursive_directory_iterator(input, ec)) {
+                if (entry.is_regular_file(ec)) {
+                    const std::string archivePath = entry.path().lexically_relative(input).generic_string();
+                    files.push_back(std::make_pair(entry.path(), archivePath));
+                }
+            }
+        } else if (fs::is_regular_file(input, ec)) {
+            files.push_back(std::make_pair(input, input.filename().generic_string()));
+        } else {
+            err = std::string("can't open ") + input_path;
+            return false;
+        }
+        if (ec) {
+            err = std::string("can't list ") + input_path + ": " + ec.message();
+            return false;
+        }
+    }
+
+    // deterministic output
+    std::sort(files.begin(), files.end(), [](const std::pair<fs::path, std::string>& a,
+                                             const std::pair<fs::path, std::string>& b){
+        return a.second < b.second;
+    });
+
+    std::cout << "* Packing " << files.size() << " files..." << std::endl;
+    std::cout << "  output: " << output_path << std::endl;
+
+    AssetArchiveWriter *writer = asset_archive_writer_new();
+    size_t totalSize = 0;
+    std::vector<char> content;
+
+    for (const std::pair<fs::path, std::string>& file : files) {
+        if (read_file(file.first, content) == false) {
+            err = std::string("can't read ") + file.first.string();
+            break;
+        }
+        if (asset_archive_writer_add(writer,
+                                     file.second.c_str(),
+                                     content.data(),
+                                     content.size(),
+                                     compress) == false) {
+            err = std::string("can't add ") + file.second;
+            break;
+        }
+        totalSize += content.size();
+    }
+
+    if (err.empty()) {
+        FILE *dst = fopen(output_path.c_str(), "wb");
+        if (dst == nullptr) {
+            err = std::string("can't create ") + output_path;
+        } else {
+            if (asset_archive_writer_write(writer, dst) == false) {
+                err = std::string("can't write ") + output_path + " (duplicate paths?)";
+            }
+            fclose(dst);
+        }
+    }
+
+    asset_archive_writer_free(writer);
+
+    if (err.empty() == false) {
+        return false;
+    }
+
+    std::cout << "  " << totalSize << " bytes packed in " << fs::file_size(output_path, ec) << " bytes" << std::endl;
+
+    return true;
+}
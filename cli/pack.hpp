@@ -0,0 +1,18 @@
+//
+//  pack.hpp
+//  cli
+//
+
+#pragma once
+
+// C++
+#include <string>
+
+// cxxopts
+#include <cxxopts.hpp>
+
+/// Packs input files and directories (recursively) in a single asset archive.
+/// Files within an input directory are indexed by their path relative to it.
+/// Returns true on success, false otherwise.
+/// When an error occured, the `err` argument is filled with an error message.
+bool command_pack(cxxopts::ParseResult parseResult, std::string& err);
@@ -60,7 +60,7 @@ bool commandSetPoint(cxxopts::ParseResult parseResult, std::string& err) {
     }
 
     // The file descriptor is owned by the stream, which will fclose it in the future.
-    Stream *stream = stream_new_file_read(fd);
+    Stream *stream = stream_new_file_map(fd);
     ColorAtlas *colorAtlas = color_atlas_new();
 
     ShapeSettings settings = {
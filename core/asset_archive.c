@@ -0,0 +1,244 @@
+// -------------------------------------------------------------
+//  Cubzh Core
+//  asset_archive.c
+// -------------------------------------------------------------
+
+#include "asset_archive.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "zlib.h"
+
+#define ASSET_ARCHIVE_MAGIC "CZHA"
+#define ASSET_ARCHIVE_MAGIC_SIZE 4
+
+#define ASSET_ARCHIVE_COMPRESSION_NONE 0
+#define ASSET_ARCHIVE_COMPRESSION_ZLIB 1
+
+// compressed data is kept only if at least this ratio smaller
+#define ASSET_ARCHIVE_MIN_COMPRESSION_RATIO 0.9
+
+typedef struct {
+    char magic[ASSET_ARCHIVE_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t pathsSize;
+    uint64_t pathsOffset;
+    uint64_t totalSize;
+} ArchiveHeader; // 32 bytes
+
+typedef struct {
+    uint64_t pathHash;
+    uint64_t dataOffset;
+    uint32_t pathOffset; // within paths
+    uint32_t pathLength;
+    uint32_t storedSize;
+    uint32_t size;
+    uint32_t compression;
+    uint32_t pad;
+} ArchiveEntry; // 40 bytes
+
+typedef struct {
+    char *path;
+    void *data;
+    uint64_t pathHash;
+    uint32_t storedSize;
+    uint32_t size;
+    uint32_t compression;
+    char pad[4];
+} WriterEntry;
+
+struct _AssetArchiveWriter {
+    WriterEntry *entries;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+static uint64_t _asset_archive_hash(const char *path, size_t *len) {
+    uint64_t h = 14695981039346656037ULL; // FNV-1a 64
+    const char *c = path;
+    while (*c != '\0') {
+        h ^= (uint8_t)*c;
+        h *= 1099511628211ULL;
+        ++c;
+    }
+    if (len != NULL) {
+        *len = (size_t)(c - path);
+    }
+    return h;
+}
+
+static uint64_t _asset_archive_align(const uint64_t offset) {
+    const uint64_t mask = ASSET_ARCHIVE_DATA_ALIGNMENT - 1;
+    return (offset + mask) & ~mask;
+}
+
+// MARK: - Writing -
+
+AssetArchiveWriter *asset_archive_writer_new(void) {
+    AssetArchiveWriter *w = (AssetArchiveWriter *)malloc(sizeof(AssetArchiveWriter));
+    if (w == NULL) {
+        return NULL;
+    }
+    w->entries = NULL;
+    w->count = 0;
+    w->capacity = 0;
+    return w;
+}
+
+void asset_archive_writer_free(AssetArchiveWriter *w) {
+    for (uint32_t i = 0; i < w->count; ++i) {
+        free(w->entries[i].path);
+        free(w->entries[i].data);
+    }
+    free(w->entries);
+    free(w);
+}
+
+bool asset_archive_writer_add(AssetArchiveWriter *w,
+                              const char *path,
+                              const void *data,
+                              const size_t size,
+                              const bool compress) {
+    if (path == NULL || (data == NULL && size > 0) || size > UINT32_MAX) {
+        return false;
+    }
+
+    if (w->count == w->capacity) {
+        const uint32_t capacity = w->capacity == 0 ? 64 : w->capacity * 2;
+        WriterEntry *entries = (WriterEntry *)realloc(w->entries, capacity * sizeof(WriterEntry));
+        if (entries == NULL) {
+            return false;
+        }
+        w->entries = entries;
+        w->capacity = capacity;
+    }
+
+    WriterEntry *e = &w->entries[w->count];
+    size_t len;
+    e->pathHash = _asset_archive_hash(path, &len);
+    e->path = (char *)malloc(len + 1);
+    if (e->path == NULL) {
+        return false;
+    }
+    memcpy(e->path, path, len + 1);
+    e->size = (uint32_t)size;
+    e->data = NULL;
+
+    if (compress && size > 0) {
+        uLong compressedSize = compressBound((uLong)size);
+        void *compressedData = malloc(compressedSize);
+        if (compressedData != NULL &&
+            compress2(compressedData, &compressedSize, data, (uLong)size, Z_BEST_COMPRESSION) ==
+                Z_OK &&
+            (double)compressedSize < (double)size * ASSET_ARCHIVE_MIN_COMPRESSION_RATIO) {
+            e->data = compressedData;
+            e->storedSize = (uint32_t)compressedSize;
+            e->compression = ASSET_ARCHIVE_COMPRESSION_ZLIB;
+        } else {
+            free(compressedData);
+        }
+    }
+
+    if (e->data == NULL) {
+        e->data = malloc(size > 0 ? size : 1);
+        if (e->data == NULL) {
+            free(e->path);
+            return false;
+        }
+        if (size > 0) {
+            memcpy(e->data, data, size);
+        }
+        e->storedSize = (uint32_t)size;
+        e->compression = ASSET_ARCHIVE_COMPRESSION_NONE;
+    }
+
+    ++w->count;
+    return true;
+}
+
+uint32_t asset_archive_writer_get_entry_count(const AssetArchiveWriter *w) {
+    return w->count;
+}
+
+static int _asset_archive_writer_entry_cmp(const void *a, const void *b) {
+    const WriterEntry *e1 = (const WriterEntry *)a;
+    const WriterEntry *e2 = (const WriterEntry *)b;
+    if (e1->pathHash != e2->pathHash) {
+        return e1->pathHash < e2->pathHash ? -1 : 1;
+    }
+    return strcmp(e1->path, e2->path);
+}
+
+static bool _asset_archive_write_padding(FILE *fd, uint64_t from, const uint64_t to) {
+    static const uint8_t zeros[ASSET_ARCHIVE_DATA_ALIGNMENT] = {0};
+    if (to > from) {
+        return fwrite(zeros, 1, (size_t)(to - from), fd) == to - from;
+    }
+    return true;
+}
+
+bool asset_archive_writer_write(AssetArchiveWriter *w, FILE *fd) {
+    qsort(w->entries, w->count, sizeof(WriterEntry), _asset_archive_writer_entry_cmp);
+
+    uint64_t pathsSize = 0;
+    for (uint32_t i = 0; i < w->count; ++i) {
+        if (i > 0 && w->entries[i - 1].pathHash == w->entries[i].pathHash &&
+            strcmp(w->entries[i - 1].path, w->entries[i].path) == 0) {
+            return false; // duplicate path
+        }
+        pathsSize += strlen(w->entries[i].path) + 1;
+    }
+    if (pathsSize > UINT32_MAX) {
+        return false;
+    }
+
+    ArchiveHeader header;
+    memcpy(header.magic, ASSET_ARCHIVE_MAGIC, ASSET_ARCHIVE_MAGIC_SIZE);
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.entryCount = w->count;
+    header.pathsSize = (uint32_t)pathsSize;
+    header.pathsOffset = sizeof(ArchiveHeader) + (uint64_t)w->count * sizeof(ArchiveEntry);
+
+    // entries, with data offsets
+    ArchiveEntry *entries = (ArchiveEntry *)malloc(w->count * sizeof(ArchiveEntry) + 1);
+    if (entries == NULL) {
+        return false;
+    }
+    uint32_t pathOffset = 0;
+    uint64_t dataOffset = _asset_archive_align(header.pathsOffset + pathsSize);
+    for (uint32_t i = 0; i < w->count; ++i) {
+        const WriterEntry *we = &w->entries[i];
+        ArchiveEntry *e = &entries[i];
+        e->pathHash = we->pathHash;
+        e->dataOffset = dataOffset;
+        e->pathOffset = pathOffset;
+        e->pathLength = (uint32_t)strlen(we->path);
+        e->storedSize = we->storedSize;
+        e->size = we->size;
+        e->compression = we->compression;
+        e->pad = 0;
+        pathOffset += e->pathLength + 1;
+        dataOffset = _asset_archive_align(dataOffset + we->storedSize);
+    }
+    header.totalSize = w->count > 0 ? entries[w->count - 1].dataOffset +
+                                          entries[w->count - 1].storedSize
+                                    : header.pathsOffset + pathsSize;
+
+    bool ok = fwrite(&header, sizeof(ArchiveHeader), 1, fd) == 1 &&
+              (w->count == 0 || fwrite(entries, sizeof(ArchiveEntry), w->count, fd) == w->count);
+    for (uint32_t i = 0; ok && i < w->count; ++i) {
+        const char *path = w->entries[i].path;
+        ok = fwrite(path, 1, entries[i].pathLength + 1, fd) == entries[i].pathLength + 1;
+    }
+    uint64_t offset = header.pathsOffset + pathsSize;
+    for (uint32_t i = 0; ok && i < w->count; ++i) {
+        ok = _asset_archive_write_padding(fd, offset, entries[i].dataOffset) &&
+             fwrite(w->entries[i].data, 1, entries[i].storedSize, fd) == entries[i].storedSize;
+        offset = entries[i].dataOffset + entries[i].storedSize;
+    }
+
+    free(entries);
+    return ok;
+}
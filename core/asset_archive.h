@@ -0,0 +1,55 @@
+// -------------------------------------------------------------
+//  Cubzh Core
+//  asset_archive.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Asset archive: many small files packed in a single indexed file, meant to be
+// memory-mapped once and read in place.
+//
+// Layout (little-endian):
+// - header: magic "CZHA", version, entry count, paths offset, total size
+// - entries: sorted by path hash (FNV-1a 64), each with path & data locations
+// - paths: '\0'-terminated entry paths
+// - data: entry blobs, each aligned on ASSET_ARCHIVE_DATA_ALIGNMENT bytes,
+//   stored as is or compressed with zlib (per entry)
+//
+// Only the writer lives in core (used by `cubzh_cli pack`), archives are mounted & read
+// at runtime by xptools (vx::fs::Archive, filesystem.hpp), tested against this writer.
+
+#define ASSET_ARCHIVE_VERSION 1
+#define ASSET_ARCHIVE_DATA_ALIGNMENT 16
+
+typedef struct _AssetArchiveWriter AssetArchiveWriter;
+
+// MARK: - Writing -
+
+AssetArchiveWriter *asset_archive_writer_new(void);
+void asset_archive_writer_free(AssetArchiveWriter *w);
+
+// Copies `data`, compressing it if `compress` is true and it makes the entry smaller.
+bool asset_archive_writer_add(AssetArchiveWriter *w,
+                              const char *path,
+                              const void *data,
+                              const size_t size,
+                              const bool compress);
+
+uint32_t asset_archive_writer_get_entry_count(const AssetArchiveWriter *w);
+
+// Writes archive in file opened with "wb" flag.
+// Returns false on failure or if the same path was added twice.
+bool asset_archive_writer_write(AssetArchiveWriter *w, FILE *fd);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
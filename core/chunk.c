@@ -14,6 +14,12 @@
 #include "zlib.h"
 
 #define CHUNK_NEIGHBORS_COUNT 26
+// chunk_write_vertices works on chunk blocks padded w/ a 1-block border from its neighbors,
+// stored x, z, y from -1 to CHUNK_SIZE
+#define CHUNK_PADDED_SIZE (CHUNK_SIZE + 2)
+#define CHUNK_PADDED_SIZE_CUBE (CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE)
+#define CHUNK_PADDED_INDEX(x, y, z)                                                                \
+    ((((x) + 1) * CHUNK_PADDED_SIZE + (z) + 1) * CHUNK_PADDED_SIZE + (y) + 1)
 
 static VERTEX_LIGHT_STRUCT_T *defaultLight = NULL;
 
@@ -43,6 +49,13 @@ struct _Chunk {
     char pad[7];
 };
 
+// block properties used by chunk_write_vertices, null blocks are non-solid light casters
+typedef struct {
+    VERTEX_LIGHT_STRUCT_T vlight; /* 2 bytes */
+    SHAPE_COLOR_INDEX_INT_T colorIndex; /* 1 byte */
+    bool solid, opaque, transparent, aoCaster, lightCaster; /* 5 x 1 byte */
+} PaddedBlock;
+
 // MARK: private functions prototypes
 
 Octree *_chunk_new_octree(void);
@@ -53,14 +66,12 @@ void _chunk_hello_neighbor(Chunk *newcomer,
                            Neighbor neighborLocation);
 void _chunk_good_bye_neighbor(Chunk *chunk, Neighbor location);
 
-/// used to gather vertex lighting values & properties in chunk_write_vertices
-void _vertex_light_get(Chunk *chunk,
-                       Block *block,
-                       const ColorPalette *palette,
-                       CHUNK_COORDS_INT3_T coords,
-                       VERTEX_LIGHT_STRUCT_T *vlight,
-                       bool *aoCaster,
-                       bool *lightCaster);
+/// used to gather blocks, vertex lighting values & properties for chunk_write_vertices, from
+/// chunk and a 1-block border taken from its neighbors
+static void _chunk_fill_padded_blocks(Chunk *chunk,
+                                      const ColorPalette *palette,
+                                      const bool vLighting,
+                                      PaddedBlock *out);
 /// used for smooth lighting in chunk_write_vertices
 void _vertex_light_smoothing(VERTEX_LIGHT_STRUCT_T *base,
                              bool add1,
@@ -354,8 +365,7 @@ Block *chunk_get_block(const Chunk *chunk,
     if (z < 0 || z > CHUNK_SIZE_MINUS_ONE)
         return NULL;
 
-    return (
-        Block *)octree_get_element_without_checking(chunk->octree, (size_t)x, (size_t)y, (size_t)z);
+    return (Block *)octree_get_element_fast(chunk->octree, (size_t)x, (size_t)y, (size_t)z);
 }
 
 Block *chunk_get_block_2(const Chunk *chunk, CHUNK_COORDS_INT3_T coords) {
@@ -492,10 +502,10 @@ Block *chunk_get_block_including_neighbors(Chunk *chunk,
     if (_chunk == NULL) {
         return NULL;
     } else {
-        return (Block *)octree_get_element_without_checking(_chunk->octree,
-                                                            (size_t)_coords.x,
-                                                            (size_t)_coords.y,
-                                                            (size_t)_coords.z);
+        return (Block *)octree_get_element_fast(_chunk->octree,
+                                                (size_t)_coords.x,
+                                                (size_t)_coords.y,
+                                                (size_t)_coords.z);
     }
 }
 
@@ -567,38 +577,18 @@ Chunk *chunk_get_neighbor(const Chunk *chunk, Neighbor location) {
 }
 
 void chunk_move_in_neighborhood(Index3D *chunks, Chunk *chunk, SHAPE_COORDS_INT3_T coords) {
-    void **batchedNode_X = NULL, **batchedNode_Y = NULL;
-
-    // Batch Index3D search for all neighbors on the right (x+1)
-    Chunk *x = NULL, *x_y = NULL, *x_y_z = NULL, *x_y_nz = NULL, *x_ny = NULL, *x_ny_z = NULL,
-          *x_ny_nz = NULL, *x_z = NULL, *x_nz = NULL;
-
-    index3d_batch_get_reset(chunks, &batchedNode_X);
-    if (index3d_batch_get_advance(coords.x + 1, &batchedNode_X)) {
-        // y batch
-        batchedNode_Y = batchedNode_X;
-        if (index3d_batch_get_advance(coords.y, &batchedNode_Y)) {
-            x = index3d_batch_get(coords.z, batchedNode_Y);
-            x_z = index3d_batch_get(coords.z + 1, batchedNode_Y);
-            x_nz = index3d_batch_get(coords.z - 1, batchedNode_Y);
-        }
-
-        // y+1 batch
-        batchedNode_Y = batchedNode_X;
-        if (index3d_batch_get_advance(coords.y + 1, &batchedNode_Y)) {
-            x_y = index3d_batch_get(coords.z, batchedNode_Y);
-            x_y_z = index3d_batch_get(coords.z + 1, batchedNode_Y);
-            x_y_nz = index3d_batch_get(coords.z - 1, batchedNode_Y);
-        }
-
-        // y-1 batch
-        batchedNode_Y = batchedNode_X;
-        if (index3d_batch_get_advance(coords.y - 1, &batchedNode_Y)) {
-            x_ny = index3d_batch_get(coords.z, batchedNode_Y);
-            x_ny_z = index3d_batch_get(coords.z + 1, batchedNode_Y);
-            x_ny_nz = index3d_batch_get(coords.z - 1, batchedNode_Y);
-        }
-    }
+    const int32_t cx = coords.x, cy = coords.y, cz = coords.z;
+
+    // neighbors on the right (x+1)
+    Chunk *x = index3d_get(chunks, cx + 1, cy, cz);
+    Chunk *x_z = index3d_get(chunks, cx + 1, cy, cz + 1);
+    Chunk *x_nz = index3d_get(chunks, cx + 1, cy, cz - 1);
+    Chunk *x_y = index3d_get(chunks, cx + 1, cy + 1, cz);
+    Chunk *x_y_z = index3d_get(chunks, cx + 1, cy + 1, cz + 1);
+    Chunk *x_y_nz = index3d_get(chunks, cx + 1, cy + 1, cz - 1);
+    Chunk *x_ny = index3d_get(chunks, cx + 1, cy - 1, cz);
+    Chunk *x_ny_z = index3d_get(chunks, cx + 1, cy - 1, cz + 1);
+    Chunk *x_ny_nz = index3d_get(chunks, cx + 1, cy - 1, cz - 1);
 
     _chunk_hello_neighbor(chunk, NX, x, X);
     _chunk_hello_neighbor(chunk, NX_NZ, x_z, X_Z);
@@ -612,36 +602,16 @@ void chunk_move_in_neighborhood(Index3D *chunks, Chunk *chunk, SHAPE_COORDS_INT3
     _chunk_hello_neighbor(chunk, NX_Y_NZ, x_ny_z, X_NY_Z);
     _chunk_hello_neighbor(chunk, NX_Y_Z, x_ny_nz, X_NY_NZ);
 
-    // Batch Index3D search for all neighbors on the left (x-1)
-    Chunk *nx = NULL, *nx_y = NULL, *nx_y_z = NULL, *nx_y_nz = NULL, *nx_ny = NULL, *nx_ny_z = NULL,
-          *nx_ny_nz = NULL, *nx_z = NULL, *nx_nz = NULL;
-
-    index3d_batch_get_reset(chunks, &batchedNode_X);
-    if (index3d_batch_get_advance(coords.x - 1, &batchedNode_X)) {
-        // y batch
-        batchedNode_Y = batchedNode_X;
-        if (index3d_batch_get_advance(coords.y, &batchedNode_Y)) {
-            nx = index3d_batch_get(coords.z, batchedNode_Y);
-            nx_z = index3d_batch_get(coords.z + 1, batchedNode_Y);
-            nx_nz = index3d_batch_get(coords.z - 1, batchedNode_Y);
-        }
-
-        // y+1 batch
-        batchedNode_Y = batchedNode_X;
-        if (index3d_batch_get_advance(coords.y + 1, &batchedNode_Y)) {
-            nx_y = index3d_batch_get(coords.z, batchedNode_Y);
-            nx_y_z = index3d_batch_get(coords.z + 1, batchedNode_Y);
-            nx_y_nz = index3d_batch_get(coords.z - 1, batchedNode_Y);
-        }
-
-        // y-1 batch
-        batchedNode_Y = batchedNode_X;
-        if (index3d_batch_get_advance(coords.y - 1, &batchedNode_Y)) {
-            nx_ny = index3d_batch_get(coords.z, batchedNode_Y);
-            nx_ny_z = index3d_batch_get(coords.z + 1, batchedNode_Y);
-            nx_ny_nz = index3d_batch_get(coords.z - 1, batchedNode_Y);
-        }
-    }
+    // neighbors on the left (x-1)
+    Chunk *nx = index3d_get(chunks, cx - 1, cy, cz);
+    Chunk *nx_z = index3d_get(chunks, cx - 1, cy, cz + 1);
+    Chunk *nx_nz = index3d_get(chunks, cx - 1, cy, cz - 1);
+    Chunk *nx_y = index3d_get(chunks, cx - 1, cy + 1, cz);
+    Chunk *nx_y_z = index3d_get(chunks, cx - 1, cy + 1, cz + 1);
+    Chunk *nx_y_nz = index3d_get(chunks, cx - 1, cy + 1, cz - 1);
+    Chunk *nx_ny = index3d_get(chunks, cx - 1, cy - 1, cz);
+    Chunk *nx_ny_z = index3d_get(chunks, cx - 1, cy - 1, cz + 1);
+    Chunk *nx_ny_nz = index3d_get(chunks, cx - 1, cy - 1, cz - 1);
 
     _chunk_hello_neighbor(chunk, X, nx, NX);
     _chunk_hello_neighbor(chunk, X_NZ, nx_z, NX_Z);
@@ -655,35 +625,15 @@ void chunk_move_in_neighborhood(Index3D *chunks, Chunk *chunk, SHAPE_COORDS_INT3
     _chunk_hello_neighbor(chunk, X_Y_NZ, nx_ny_z, NX_NY_Z);
     _chunk_hello_neighbor(chunk, X_Y_Z, nx_ny_nz, NX_NY_NZ);
 
-    // Batch Index3D search for remaining neighbors (same x)
-    Chunk *y = NULL, *y_z = NULL, *y_nz = NULL, *ny = NULL, *ny_z = NULL, *ny_nz = NULL, *z = NULL,
-          *nz = NULL;
-
-    index3d_batch_get_reset(chunks, &batchedNode_X);
-    if (index3d_batch_get_advance(coords.x, &batchedNode_X)) {
-        // y batch
-        batchedNode_Y = batchedNode_X;
-        if (index3d_batch_get_advance(coords.y, &batchedNode_Y)) {
-            z = index3d_batch_get(coords.z + 1, batchedNode_Y);
-            nz = index3d_batch_get(coords.z - 1, batchedNode_Y);
-        }
-
-        // y+1 batch
-        batchedNode_Y = batchedNode_X;
-        if (index3d_batch_get_advance(coords.y + 1, &batchedNode_Y)) {
-            y = index3d_batch_get(coords.z, batchedNode_Y);
-            y_z = index3d_batch_get(coords.z + 1, batchedNode_Y);
-            y_nz = index3d_batch_get(coords.z - 1, batchedNode_Y);
-        }
-
-        // y-1 batch
-        batchedNode_Y = batchedNode_X;
-        if (index3d_batch_get_advance(coords.y - 1, &batchedNode_Y)) {
-            ny = index3d_batch_get(coords.z, batchedNode_Y);
-            ny_z = index3d_batch_get(coords.z + 1, batchedNode_Y);
-            ny_nz = index3d_batch_get(coords.z - 1, batchedNode_Y);
-        }
-    }
+    // remaining neighbors (same x)
+    Chunk *z = index3d_get(chunks, cx, cy, cz + 1);
+    Chunk *nz = index3d_get(chunks, cx, cy, cz - 1);
+    Chunk *y = index3d_get(chunks, cx, cy + 1, cz);
+    Chunk *y_z = index3d_get(chunks, cx, cy + 1, cz + 1);
+    Chunk *y_nz = index3d_get(chunks, cx, cy + 1, cz - 1);
+    Chunk *ny = index3d_get(chunks, cx, cy - 1, cz);
+    Chunk *ny_z = index3d_get(chunks, cx, cy - 1, cz + 1);
+    Chunk *ny_nz = index3d_get(chunks, cx, cy - 1, cz - 1);
 
     _chunk_hello_neighbor(chunk, NZ, z, Z);
     _chunk_hello_neighbor(chunk, Z, nz, NZ);
@@ -754,6 +704,17 @@ void chunk_set_vbma(Chunk *chunk, void *vbma, bool transparent) {
 void chunk_write_vertices(Shape *shape, Chunk *chunk) {
     ColorPalette *palette = shape_get_palette(shape);
 
+    // vertex lighting (baked)
+    const bool vLighting = shape_uses_baked_lighting(shape);
+
+    // chunk blocks & 1-block border from neighbors, read by all faces/AO/lighting lookups below
+    PaddedBlock *cache = (PaddedBlock *)malloc(CHUNK_PADDED_SIZE_CUBE * sizeof(PaddedBlock));
+    if (cache == NULL) {
+        cclog_error("chunk_write_vertices: failed to allocate block cache");
+        return;
+    }
+    _chunk_fill_padded_blocks(chunk, palette, vLighting, cache);
+
     VertexBufferMemAreaWriter *opaqueWriter = vertex_buffer_mem_area_writer_new(shape,
                                                                                 chunk,
                                                                                 chunk->vbma_opaque,
@@ -768,25 +729,17 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
     VertexBufferMemAreaWriter *transparentWriter = opaqueWriter;
 #endif
 
-    Block *b;
+    const PaddedBlock *self;
     SHAPE_COORDS_INT3_T coords_in_shape;
     SHAPE_COLOR_INDEX_INT_T shapeColorIdx;
     ATLAS_COLOR_INDEX_INT_T atlasColorIdx;
 
-    // vertex lighting (baked)
-    const bool vLighting = shape_uses_baked_lighting(shape);
     VERTEX_LIGHT_STRUCT_T vlight1, vlight2, vlight3, vlight4;
 
     FACE_AMBIENT_OCCLUSION_STRUCT_T ao;
 
     // neighbors block information
-    typedef struct {
-        Block *block;
-        Chunk *chunk;
-        CHUNK_COORDS_INT3_T coords;
-        VERTEX_LIGHT_STRUCT_T vlight;
-    } NeighborBlock;
-    NeighborBlock neighbors[26];
+    PaddedBlock neighbors[26];
 
     // faces are only rendered
     // - if self opaque, when neighbor is not opaque
@@ -798,70 +751,41 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
     // - only non-solid blocks (null or air) are light casters
     // this property is what allow us to let light go through & be absorbed by transparent blocks,
     // without dimming the light values sampled for vertices adjacent to the transparent block
-    bool ao_topLeftBack, ao_topBack, ao_topRightBack, ao_topLeft, ao_topRight, ao_topLeftFront,
-        ao_topFront, ao_topRightFront, ao_leftBack, ao_rightBack, ao_leftFront, ao_rightFront,
-        ao_bottomLeftBack, ao_bottomBack, ao_bottomRightBack, ao_bottomLeft, ao_bottomRight,
-        ao_bottomLeftFront, ao_bottomFront, ao_bottomRightFront;
-    bool light_topLeftBack, light_topBack, light_topRightBack, light_topLeft, light_topRight,
-        light_topLeftFront, light_topFront, light_topRightFront, light_leftBack, light_rightBack,
-        light_leftFront, light_rightFront, light_bottomLeftBack, light_bottomBack,
-        light_bottomRightBack, light_bottomLeft, light_bottomRight, light_bottomLeftFront,
-        light_bottomFront, light_bottomRightFront;
+    bool ao_topLeftBack = false, ao_topBack = false, ao_topRightBack = false, ao_topLeft = false,
+        ao_topRight = false, ao_topLeftFront = false, ao_topFront = false, ao_topRightFront = false,
+        ao_leftBack = false, ao_rightBack = false, ao_leftFront = false, ao_rightFront = false,
+        ao_bottomLeftBack = false, ao_bottomBack = false, ao_bottomRightBack = false,
+        ao_bottomLeft = false, ao_bottomRight = false, ao_bottomLeftFront = false,
+        ao_bottomFront = false, ao_bottomRightFront = false;
+    bool light_topLeftBack = false, light_topBack = false, light_topRightBack = false,
+        light_topLeft = false, light_topRight = false, light_topLeftFront = false,
+        light_topFront = false, light_topRightFront = false, light_leftBack = false,
+        light_rightBack = false, light_leftFront = false, light_rightFront = false,
+        light_bottomLeftBack = false, light_bottomBack = false, light_bottomRightBack = false,
+        light_bottomLeft = false, light_bottomRight = false, light_bottomLeftFront = false,
+        light_bottomFront = false, light_bottomRightFront = false;
     // should self be rendered with transparency
     bool selfTransparent;
 
     for (CHUNK_COORDS_INT_T x = 0; x < CHUNK_SIZE; ++x) {
         for (CHUNK_COORDS_INT_T z = 0; z < CHUNK_SIZE; ++z) {
             for (CHUNK_COORDS_INT_T y = 0; y < CHUNK_SIZE; ++y) {
-                b = chunk_get_block(chunk, x, y, z);
-                if (block_is_solid(b)) {
+                self = &cache[CHUNK_PADDED_INDEX(x, y, z)];
+                if (self->solid) {
 
-                    shapeColorIdx = block_get_color_index(b);
+                    shapeColorIdx = self->colorIndex;
                     atlasColorIdx = color_palette_get_atlas_index(palette, shapeColorIdx);
-                    selfTransparent = color_palette_is_transparent(palette, shapeColorIdx);
+                    selfTransparent = self->transparent;
 
                     coords_in_shape = chunk_get_block_coords_in_shape(chunk, x, y, z);
 
                     // get axis-aligned neighbouring blocks
-                    neighbors[NX].block = chunk_get_block_including_neighbors(
-                        chunk,
-                        x - 1,
-                        y,
-                        z,
-                        &neighbors[NX].chunk,
-                        &neighbors[NX].coords);
-                    neighbors[X].block = chunk_get_block_including_neighbors(chunk,
-                                                                             x + 1,
-                                                                             y,
-                                                                             z,
-                                                                             &neighbors[X].chunk,
-                                                                             &neighbors[X].coords);
-                    neighbors[NZ].block = chunk_get_block_including_neighbors(
-                        chunk,
-                        x,
-                        y,
-                        z - 1,
-                        &neighbors[NZ].chunk,
-                        &neighbors[NZ].coords);
-                    neighbors[Z].block = chunk_get_block_including_neighbors(chunk,
-                                                                             x,
-                                                                             y,
-                                                                             z + 1,
-                                                                             &neighbors[Z].chunk,
-                                                                             &neighbors[Z].coords);
-                    neighbors[Y].block = chunk_get_block_including_neighbors(chunk,
-                                                                             x,
-                                                                             y + 1,
-                                                                             z,
-                                                                             &neighbors[Y].chunk,
-                                                                             &neighbors[Y].coords);
-                    neighbors[NY].block = chunk_get_block_including_neighbors(
-                        chunk,
-                        x,
-                        y - 1,
-                        z,
-                        &neighbors[NY].chunk,
-                        &neighbors[NY].coords);
+                    neighbors[NX] = cache[CHUNK_PADDED_INDEX(x - 1, y, z)];
+                    neighbors[X] = cache[CHUNK_PADDED_INDEX(x + 1, y, z)];
+                    neighbors[NZ] = cache[CHUNK_PADDED_INDEX(x, y, z - 1)];
+                    neighbors[Z] = cache[CHUNK_PADDED_INDEX(x, y, z + 1)];
+                    neighbors[Y] = cache[CHUNK_PADDED_INDEX(x, y + 1, z)];
+                    neighbors[NY] = cache[CHUNK_PADDED_INDEX(x, y - 1, z)];
 
                     // get their opacity properties
                     bool solid_left, opaque_left, transparent_left, solid_right, opaque_right,
@@ -869,76 +793,24 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
                         opaque_back, transparent_back, solid_top, opaque_top, transparent_top,
                         solid_bottom, opaque_bottom, transparent_bottom;
 
-                    block_is_any(neighbors[NX].block,
-                                 palette,
-                                 &solid_left,
-                                 &opaque_left,
-                                 &transparent_left,
-                                 NULL,
-                                 NULL);
-                    block_is_any(neighbors[X].block,
-                                 palette,
-                                 &solid_right,
-                                 &opaque_right,
-                                 &transparent_right,
-                                 NULL,
-                                 NULL);
-                    block_is_any(neighbors[NZ].block,
-                                 palette,
-                                 &solid_front,
-                                 &opaque_front,
-                                 &transparent_front,
-                                 NULL,
-                                 NULL);
-                    block_is_any(neighbors[Z].block,
-                                 palette,
-                                 &solid_back,
-                                 &opaque_back,
-                                 &transparent_back,
-                                 NULL,
-                                 NULL);
-                    block_is_any(neighbors[Y].block,
-                                 palette,
-                                 &solid_top,
-                                 &opaque_top,
-                                 &transparent_top,
-                                 NULL,
-                                 NULL);
-                    block_is_any(neighbors[NY].block,
-                                 palette,
-                                 &solid_bottom,
-                                 &opaque_bottom,
-                                 &transparent_bottom,
-                                 NULL,
-                                 NULL);
-
-                    // get their vertex light values
-                    if (vLighting) {
-                        neighbors[NX].vlight = chunk_get_light_or_default(
-                            neighbors[NX].chunk,
-                            neighbors[NX].coords,
-                            neighbors[NX].block == NULL || opaque_left);
-                        neighbors[X].vlight = chunk_get_light_or_default(
-                            neighbors[X].chunk,
-                            neighbors[X].coords,
-                            neighbors[X].block == NULL || opaque_right);
-                        neighbors[NZ].vlight = chunk_get_light_or_default(
-                            neighbors[NZ].chunk,
-                            neighbors[NZ].coords,
-                            neighbors[NZ].block == NULL || opaque_front);
-                        neighbors[Z].vlight = chunk_get_light_or_default(
-                            neighbors[Z].chunk,
-                            neighbors[Z].coords,
-                            neighbors[Z].block == NULL || opaque_back);
-                        neighbors[Y].vlight = chunk_get_light_or_default(
-                            neighbors[Y].chunk,
-                            neighbors[Y].coords,
-                            neighbors[Y].block == NULL || opaque_top);
-                        neighbors[NY].vlight = chunk_get_light_or_default(
-                            neighbors[NY].chunk,
-                            neighbors[NY].coords,
-                            neighbors[NY].block == NULL || opaque_bottom);
-                    }
+                    solid_left = neighbors[NX].solid;
+                    opaque_left = neighbors[NX].opaque;
+                    transparent_left = neighbors[NX].transparent;
+                    solid_right = neighbors[X].solid;
+                    opaque_right = neighbors[X].opaque;
+                    transparent_right = neighbors[X].transparent;
+                    solid_front = neighbors[NZ].solid;
+                    opaque_front = neighbors[NZ].opaque;
+                    transparent_front = neighbors[NZ].transparent;
+                    solid_back = neighbors[Z].solid;
+                    opaque_back = neighbors[Z].opaque;
+                    transparent_back = neighbors[Z].transparent;
+                    solid_top = neighbors[Y].solid;
+                    opaque_top = neighbors[Y].opaque;
+                    transparent_top = neighbors[Y].transparent;
+                    solid_bottom = neighbors[NY].solid;
+                    opaque_bottom = neighbors[NY].opaque;
+                    transparent_bottom = neighbors[NY].transparent;
 
                     // check which faces should be rendered
                     // transparent: if neighbor is non-solid or, if enabled, transparent with a
@@ -947,22 +819,22 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
                         if (shape_draw_inner_transparent_faces(shape)) {
                             renderLeft = (solid_left == false) ||
                                          (transparent_left &&
-                                          b->colorIndex != neighbors[NX].block->colorIndex);
+                                          shapeColorIdx != neighbors[NX].colorIndex);
                             renderRight = (solid_right == false) ||
                                           (transparent_right &&
-                                           b->colorIndex != neighbors[X].block->colorIndex);
+                                           shapeColorIdx != neighbors[X].colorIndex);
                             renderFront = (solid_front == false) ||
                                           (transparent_front &&
-                                           b->colorIndex != neighbors[NZ].block->colorIndex);
+                                           shapeColorIdx != neighbors[NZ].colorIndex);
                             renderBack = (solid_back == false) ||
                                          (transparent_back &&
-                                          b->colorIndex != neighbors[Z].block->colorIndex);
+                                          shapeColorIdx != neighbors[Z].colorIndex);
                             renderTop = (solid_top == false) ||
                                         (transparent_top &&
-                                         b->colorIndex != neighbors[Y].block->colorIndex);
+                                         shapeColorIdx != neighbors[Y].colorIndex);
                             renderBottom = (solid_bottom == false) ||
                                            (transparent_bottom &&
-                                            b->colorIndex != neighbors[NY].block->colorIndex);
+                                            shapeColorIdx != neighbors[NY].colorIndex);
                         } else {
                             renderLeft = (solid_left == false);
                             renderRight = (solid_right == false);
@@ -989,124 +861,36 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
                         ao.ao4 = 0;
 
                         // get 8 neighbors that can impact ambient occlusion and vertex lighting
-                        neighbors[NX_Y_Z].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x - 1,
-                            y + 1,
-                            z + 1,
-                            &neighbors[NX_Y_Z].chunk,
-                            &neighbors[NX_Y_Z].coords);
-                        neighbors[NX_Y].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x - 1,
-                            y + 1,
-                            z,
-                            &neighbors[NX_Y].chunk,
-                            &neighbors[NX_Y].coords);
-                        neighbors[NX_Y_NZ].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x - 1,
-                            y + 1,
-                            z - 1,
-                            &neighbors[NX_Y_NZ].chunk,
-                            &neighbors[NX_Y_NZ].coords);
-
-                        neighbors[NX_Z].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x - 1,
-                            y,
-                            z + 1,
-                            &neighbors[NX_Z].chunk,
-                            &neighbors[NX_Z].coords);
-                        neighbors[NX_NZ].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x - 1,
-                            y,
-                            z - 1,
-                            &neighbors[NX_NZ].chunk,
-                            &neighbors[NX_NZ].coords);
-
-                        neighbors[NX_NY_Z].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x - 1,
-                            y - 1,
-                            z + 1,
-                            &neighbors[NX_NY_Z].chunk,
-                            &neighbors[NX_NY_Z].coords);
-                        neighbors[NX_NY].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x - 1,
-                            y - 1,
-                            z,
-                            &neighbors[NX_NY].chunk,
-                            &neighbors[NX_NY].coords);
-                        neighbors[NX_NY_NZ].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x - 1,
-                            y - 1,
-                            z - 1,
-                            &neighbors[NX_NY_NZ].chunk,
-                            &neighbors[NX_NY_NZ].coords);
+                        neighbors[NX_Y_Z] = cache[CHUNK_PADDED_INDEX(x - 1, y + 1, z + 1)];
+                        neighbors[NX_Y] = cache[CHUNK_PADDED_INDEX(x - 1, y + 1, z)];
+                        neighbors[NX_Y_NZ] = cache[CHUNK_PADDED_INDEX(x - 1, y + 1, z - 1)];
+
+                        neighbors[NX_Z] = cache[CHUNK_PADDED_INDEX(x - 1, y, z + 1)];
+                        neighbors[NX_NZ] = cache[CHUNK_PADDED_INDEX(x - 1, y, z - 1)];
+
+                        neighbors[NX_NY_Z] = cache[CHUNK_PADDED_INDEX(x - 1, y - 1, z + 1)];
+                        neighbors[NX_NY] = cache[CHUNK_PADDED_INDEX(x - 1, y - 1, z)];
+                        neighbors[NX_NY_NZ] = cache[CHUNK_PADDED_INDEX(x - 1, y - 1, z - 1)];
 
                         // get their light values & properties
-                        _vertex_light_get(neighbors[NX_Y_Z].chunk,
-                                          neighbors[NX_Y_Z].block,
-                                          palette,
-                                          neighbors[NX_Y_Z].coords,
-                                          &neighbors[NX_Y_Z].vlight,
-                                          &ao_topLeftBack,
-                                          &light_topLeftBack);
-                        _vertex_light_get(neighbors[NX_Y].chunk,
-                                          neighbors[NX_Y].block,
-                                          palette,
-                                          neighbors[NX_Y].coords,
-                                          &neighbors[NX_Y].vlight,
-                                          &ao_topLeft,
-                                          &light_topLeft);
-                        _vertex_light_get(neighbors[NX_Y_NZ].chunk,
-                                          neighbors[NX_Y_NZ].block,
-                                          palette,
-                                          neighbors[NX_Y_NZ].coords,
-                                          &neighbors[NX_Y_NZ].vlight,
-                                          &ao_topLeftFront,
-                                          &light_topLeftFront);
-
-                        _vertex_light_get(neighbors[NX_Z].chunk,
-                                          neighbors[NX_Z].block,
-                                          palette,
-                                          neighbors[NX_Z].coords,
-                                          &neighbors[NX_Z].vlight,
-                                          &ao_leftBack,
-                                          &light_leftBack);
-                        _vertex_light_get(neighbors[NX_NZ].chunk,
-                                          neighbors[NX_NZ].block,
-                                          palette,
-                                          neighbors[NX_NZ].coords,
-                                          &neighbors[NX_NZ].vlight,
-                                          &ao_leftFront,
-                                          &light_leftFront);
-
-                        _vertex_light_get(neighbors[NX_NY_Z].chunk,
-                                          neighbors[NX_NY_Z].block,
-                                          palette,
-                                          neighbors[NX_NY_Z].coords,
-                                          &neighbors[NX_NY_Z].vlight,
-                                          &ao_bottomLeftBack,
-                                          &light_bottomLeftBack);
-                        _vertex_light_get(neighbors[NX_NY].chunk,
-                                          neighbors[NX_NY].block,
-                                          palette,
-                                          neighbors[NX_NY].coords,
-                                          &neighbors[NX_NY].vlight,
-                                          &ao_bottomLeft,
-                                          &light_bottomLeft);
-                        _vertex_light_get(neighbors[NX_NY_NZ].chunk,
-                                          neighbors[NX_NY_NZ].block,
-                                          palette,
-                                          neighbors[NX_NY_NZ].coords,
-                                          &neighbors[NX_NY_NZ].vlight,
-                                          &ao_bottomLeftFront,
-                                          &light_bottomLeftFront);
+                        ao_topLeftBack = neighbors[NX_Y_Z].aoCaster;
+                        light_topLeftBack = neighbors[NX_Y_Z].lightCaster;
+                        ao_topLeft = neighbors[NX_Y].aoCaster;
+                        light_topLeft = neighbors[NX_Y].lightCaster;
+                        ao_topLeftFront = neighbors[NX_Y_NZ].aoCaster;
+                        light_topLeftFront = neighbors[NX_Y_NZ].lightCaster;
+
+                        ao_leftBack = neighbors[NX_Z].aoCaster;
+                        light_leftBack = neighbors[NX_Z].lightCaster;
+                        ao_leftFront = neighbors[NX_NZ].aoCaster;
+                        light_leftFront = neighbors[NX_NZ].lightCaster;
+
+                        ao_bottomLeftBack = neighbors[NX_NY_Z].aoCaster;
+                        light_bottomLeftBack = neighbors[NX_NY_Z].lightCaster;
+                        ao_bottomLeft = neighbors[NX_NY].aoCaster;
+                        light_bottomLeft = neighbors[NX_NY].lightCaster;
+                        ao_bottomLeftFront = neighbors[NX_NY_NZ].aoCaster;
+                        light_bottomLeftFront = neighbors[NX_NY_NZ].lightCaster;
 
                         // first corner
                         if (ao_bottomLeft && ao_leftFront) {
@@ -1206,124 +990,36 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
                         ao.ao4 = 0;
 
                         // get 8 neighbors that can impact ambient occlusion and vertex lighting
-                        neighbors[X_Y_Z].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x + 1,
-                            y + 1,
-                            z + 1,
-                            &neighbors[X_Y_Z].chunk,
-                            &neighbors[X_Y_Z].coords);
-                        neighbors[X_Y].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x + 1,
-                            y + 1,
-                            z,
-                            &neighbors[X_Y].chunk,
-                            &neighbors[X_Y].coords);
-                        neighbors[X_Y_NZ].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x + 1,
-                            y + 1,
-                            z - 1,
-                            &neighbors[X_Y_NZ].chunk,
-                            &neighbors[X_Y_NZ].coords);
-
-                        neighbors[X_Z].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x + 1,
-                            y,
-                            z + 1,
-                            &neighbors[X_Z].chunk,
-                            &neighbors[X_Z].coords);
-                        neighbors[X_NZ].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x + 1,
-                            y,
-                            z - 1,
-                            &neighbors[X_NZ].chunk,
-                            &neighbors[X_NZ].coords);
-
-                        neighbors[X_NY_Z].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x + 1,
-                            y - 1,
-                            z + 1,
-                            &neighbors[X_NY_Z].chunk,
-                            &neighbors[X_NY_Z].coords);
-                        neighbors[X_NY].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x + 1,
-                            y - 1,
-                            z,
-                            &neighbors[X_NY].chunk,
-                            &neighbors[X_NY].coords);
-                        neighbors[X_NY_NZ].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x + 1,
-                            y - 1,
-                            z - 1,
-                            &neighbors[X_NY_NZ].chunk,
-                            &neighbors[X_NY_NZ].coords);
+                        neighbors[X_Y_Z] = cache[CHUNK_PADDED_INDEX(x + 1, y + 1, z + 1)];
+                        neighbors[X_Y] = cache[CHUNK_PADDED_INDEX(x + 1, y + 1, z)];
+                        neighbors[X_Y_NZ] = cache[CHUNK_PADDED_INDEX(x + 1, y + 1, z - 1)];
+
+                        neighbors[X_Z] = cache[CHUNK_PADDED_INDEX(x + 1, y, z + 1)];
+                        neighbors[X_NZ] = cache[CHUNK_PADDED_INDEX(x + 1, y, z - 1)];
+
+                        neighbors[X_NY_Z] = cache[CHUNK_PADDED_INDEX(x + 1, y - 1, z + 1)];
+                        neighbors[X_NY] = cache[CHUNK_PADDED_INDEX(x + 1, y - 1, z)];
+                        neighbors[X_NY_NZ] = cache[CHUNK_PADDED_INDEX(x + 1, y - 1, z - 1)];
 
                         // get their light values & properties
-                        _vertex_light_get(neighbors[X_Y_Z].chunk,
-                                          neighbors[X_Y_Z].block,
-                                          palette,
-                                          neighbors[X_Y_Z].coords,
-                                          &neighbors[X_Y_Z].vlight,
-                                          &ao_topRightBack,
-                                          &light_topRightBack);
-                        _vertex_light_get(neighbors[X_Y].chunk,
-                                          neighbors[X_Y].block,
-                                          palette,
-                                          neighbors[X_Y].coords,
-                                          &neighbors[X_Y].vlight,
-                                          &ao_topRight,
-                                          &light_topRight);
-                        _vertex_light_get(neighbors[X_Y_NZ].chunk,
-                                          neighbors[X_Y_NZ].block,
-                                          palette,
-                                          neighbors[X_Y_NZ].coords,
-                                          &neighbors[X_Y_NZ].vlight,
-                                          &ao_topRightFront,
-                                          &light_topRightFront);
-
-                        _vertex_light_get(neighbors[X_Z].chunk,
-                                          neighbors[X_Z].block,
-                                          palette,
-                                          neighbors[X_Z].coords,
-                                          &neighbors[X_Z].vlight,
-                                          &ao_rightBack,
-                                          &light_rightBack);
-                        _vertex_light_get(neighbors[X_NZ].chunk,
-                                          neighbors[X_NZ].block,
-                                          palette,
-                                          neighbors[X_NZ].coords,
-                                          &neighbors[X_NZ].vlight,
-                                          &ao_rightFront,
-                                          &light_rightFront);
-
-                        _vertex_light_get(neighbors[X_NY_Z].chunk,
-                                          neighbors[X_NY_Z].block,
-                                          palette,
-                                          neighbors[X_NY_Z].coords,
-                                          &neighbors[X_NY_Z].vlight,
-                                          &ao_bottomRightBack,
-                                          &light_bottomRightBack);
-                        _vertex_light_get(neighbors[X_NY].chunk,
-                                          neighbors[X_NY].block,
-                                          palette,
-                                          neighbors[X_NY].coords,
-                                          &neighbors[X_NY].vlight,
-                                          &ao_bottomRight,
-                                          &light_bottomRight);
-                        _vertex_light_get(neighbors[X_NY_NZ].chunk,
-                                          neighbors[X_NY_NZ].block,
-                                          palette,
-                                          neighbors[X_NY_NZ].coords,
-                                          &neighbors[X_NY_NZ].vlight,
-                                          &ao_bottomRightFront,
-                                          &light_bottomRightFront);
+                        ao_topRightBack = neighbors[X_Y_Z].aoCaster;
+                        light_topRightBack = neighbors[X_Y_Z].lightCaster;
+                        ao_topRight = neighbors[X_Y].aoCaster;
+                        light_topRight = neighbors[X_Y].lightCaster;
+                        ao_topRightFront = neighbors[X_Y_NZ].aoCaster;
+                        light_topRightFront = neighbors[X_Y_NZ].lightCaster;
+
+                        ao_rightBack = neighbors[X_Z].aoCaster;
+                        light_rightBack = neighbors[X_Z].lightCaster;
+                        ao_rightFront = neighbors[X_NZ].aoCaster;
+                        light_rightFront = neighbors[X_NZ].lightCaster;
+
+                        ao_bottomRightBack = neighbors[X_NY_Z].aoCaster;
+                        light_bottomRightBack = neighbors[X_NY_Z].lightCaster;
+                        ao_bottomRight = neighbors[X_NY].aoCaster;
+                        light_bottomRight = neighbors[X_NY].lightCaster;
+                        ao_bottomRightFront = neighbors[X_NY_NZ].aoCaster;
+                        light_bottomRightFront = neighbors[X_NY_NZ].lightCaster;
 
                         // first corner (topRightFront)
                         if (ao_topRight && ao_rightFront) {
@@ -1425,129 +1121,41 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
                         // get 8 neighbors that can impact ambient occlusion and vertex lighting
                         // left/right blocks may have been retrieved already
                         if (renderRight == false) {
-                            neighbors[X_Y_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y + 1,
-                                z - 1,
-                                &neighbors[X_Y_NZ].chunk,
-                                &neighbors[X_Y_NZ].coords);
-                            neighbors[X_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y,
-                                z - 1,
-                                &neighbors[X_NZ].chunk,
-                                &neighbors[X_NZ].coords);
-                            neighbors[X_NY_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y - 1,
-                                z - 1,
-                                &neighbors[X_NY_NZ].chunk,
-                                &neighbors[X_NY_NZ].coords);
+                            neighbors[X_Y_NZ] = cache[CHUNK_PADDED_INDEX(x + 1, y + 1, z - 1)];
+                            neighbors[X_NZ] = cache[CHUNK_PADDED_INDEX(x + 1, y, z - 1)];
+                            neighbors[X_NY_NZ] = cache[CHUNK_PADDED_INDEX(x + 1, y - 1, z - 1)];
                         }
 
                         if (renderLeft == false) {
-                            neighbors[NX_Y_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y + 1,
-                                z - 1,
-                                &neighbors[NX_Y_NZ].chunk,
-                                &neighbors[NX_Y_NZ].coords);
-                            neighbors[NX_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y,
-                                z - 1,
-                                &neighbors[NX_NZ].chunk,
-                                &neighbors[NX_NZ].coords);
-                            neighbors[NX_NY_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y - 1,
-                                z - 1,
-                                &neighbors[NX_NY_NZ].chunk,
-                                &neighbors[NX_NY_NZ].coords);
-                        }
-
-                        neighbors[Y_NZ].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x,
-                            y + 1,
-                            z - 1,
-                            &neighbors[Y_NZ].chunk,
-                            &neighbors[Y_NZ].coords);
-                        neighbors[NY_NZ].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x,
-                            y - 1,
-                            z - 1,
-                            &neighbors[NY_NZ].chunk,
-                            &neighbors[NY_NZ].coords);
+                            neighbors[NX_Y_NZ] = cache[CHUNK_PADDED_INDEX(x - 1, y + 1, z - 1)];
+                            neighbors[NX_NZ] = cache[CHUNK_PADDED_INDEX(x - 1, y, z - 1)];
+                            neighbors[NX_NY_NZ] = cache[CHUNK_PADDED_INDEX(x - 1, y - 1, z - 1)];
+                        }
+
+                        neighbors[Y_NZ] = cache[CHUNK_PADDED_INDEX(x, y + 1, z - 1)];
+                        neighbors[NY_NZ] = cache[CHUNK_PADDED_INDEX(x, y - 1, z - 1)];
 
                         // get their light values & properties
                         if (renderRight == false) {
-                            _vertex_light_get(neighbors[X_Y_NZ].chunk,
-                                              neighbors[X_Y_NZ].block,
-                                              palette,
-                                              neighbors[X_Y_NZ].coords,
-                                              &neighbors[X_Y_NZ].vlight,
-                                              &ao_topRightFront,
-                                              &light_topRightFront);
-                            _vertex_light_get(neighbors[X_NZ].chunk,
-                                              neighbors[X_NZ].block,
-                                              palette,
-                                              neighbors[X_NZ].coords,
-                                              &neighbors[X_NZ].vlight,
-                                              &ao_rightFront,
-                                              &light_rightFront);
-                            _vertex_light_get(neighbors[X_NY_NZ].chunk,
-                                              neighbors[X_NY_NZ].block,
-                                              palette,
-                                              neighbors[X_NY_NZ].coords,
-                                              &neighbors[X_NY_NZ].vlight,
-                                              &ao_bottomRightFront,
-                                              &light_bottomRightFront);
+                            ao_topRightFront = neighbors[X_Y_NZ].aoCaster;
+                            light_topRightFront = neighbors[X_Y_NZ].lightCaster;
+                            ao_rightFront = neighbors[X_NZ].aoCaster;
+                            light_rightFront = neighbors[X_NZ].lightCaster;
+                            ao_bottomRightFront = neighbors[X_NY_NZ].aoCaster;
+                            light_bottomRightFront = neighbors[X_NY_NZ].lightCaster;
                         }
                         if (renderLeft == false) {
-                            _vertex_light_get(neighbors[NX_Y_NZ].chunk,
-                                              neighbors[NX_Y_NZ].block,
-                                              palette,
-                                              neighbors[NX_Y_NZ].coords,
-                                              &neighbors[NX_Y_NZ].vlight,
-                                              &ao_topLeftFront,
-                                              &light_topLeftFront);
-                            _vertex_light_get(neighbors[NX_NZ].chunk,
-                                              neighbors[NX_NZ].block,
-                                              palette,
-                                              neighbors[NX_NZ].coords,
-                                              &neighbors[NX_NZ].vlight,
-                                              &ao_leftFront,
-                                              &light_leftFront);
-                            _vertex_light_get(neighbors[NX_NY_NZ].chunk,
-                                              neighbors[NX_NY_NZ].block,
-                                              palette,
-                                              neighbors[NX_NY_NZ].coords,
-                                              &neighbors[NX_NY_NZ].vlight,
-                                              &ao_bottomLeftFront,
-                                              &light_bottomLeftFront);
-                        }
-                        _vertex_light_get(neighbors[Y_NZ].chunk,
-                                          neighbors[Y_NZ].block,
-                                          palette,
-                                          neighbors[Y_NZ].coords,
-                                          &neighbors[Y_NZ].vlight,
-                                          &ao_topFront,
-                                          &light_topFront);
-                        _vertex_light_get(neighbors[NY_NZ].chunk,
-                                          neighbors[NY_NZ].block,
-                                          palette,
-                                          neighbors[NY_NZ].coords,
-                                          &neighbors[NY_NZ].vlight,
-                                          &ao_bottomFront,
-                                          &light_bottomFront);
+                            ao_topLeftFront = neighbors[NX_Y_NZ].aoCaster;
+                            light_topLeftFront = neighbors[NX_Y_NZ].lightCaster;
+                            ao_leftFront = neighbors[NX_NZ].aoCaster;
+                            light_leftFront = neighbors[NX_NZ].lightCaster;
+                            ao_bottomLeftFront = neighbors[NX_NY_NZ].aoCaster;
+                            light_bottomLeftFront = neighbors[NX_NY_NZ].lightCaster;
+                        }
+                        ao_topFront = neighbors[Y_NZ].aoCaster;
+                        light_topFront = neighbors[Y_NZ].lightCaster;
+                        ao_bottomFront = neighbors[NY_NZ].aoCaster;
+                        light_bottomFront = neighbors[NY_NZ].lightCaster;
 
                         // first corner (topLeftFront)
                         if (ao_topFront && ao_leftFront) {
@@ -1649,129 +1257,41 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
                         // get 8 neighbors that can impact ambient occlusion and vertex lighting
                         // left/right blocks may have been retrieved already
                         if (renderRight == false) {
-                            neighbors[X_Y_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y + 1,
-                                z + 1,
-                                &neighbors[X_Y_Z].chunk,
-                                &neighbors[X_Y_Z].coords);
-                            neighbors[X_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y,
-                                z + 1,
-                                &neighbors[X_Z].chunk,
-                                &neighbors[X_Z].coords);
-                            neighbors[X_NY_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y - 1,
-                                z + 1,
-                                &neighbors[X_NY_Z].chunk,
-                                &neighbors[X_NY_Z].coords);
+                            neighbors[X_Y_Z] = cache[CHUNK_PADDED_INDEX(x + 1, y + 1, z + 1)];
+                            neighbors[X_Z] = cache[CHUNK_PADDED_INDEX(x + 1, y, z + 1)];
+                            neighbors[X_NY_Z] = cache[CHUNK_PADDED_INDEX(x + 1, y - 1, z + 1)];
                         }
 
                         if (renderLeft == false) {
-                            neighbors[NX_Y_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y + 1,
-                                z + 1,
-                                &neighbors[NX_Y_Z].chunk,
-                                &neighbors[NX_Y_Z].coords);
-                            neighbors[NX_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y,
-                                z + 1,
-                                &neighbors[NX_Z].chunk,
-                                &neighbors[NX_Z].coords);
-                            neighbors[NX_NY_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y - 1,
-                                z + 1,
-                                &neighbors[NX_NY_Z].chunk,
-                                &neighbors[NX_NY_Z].coords);
-                        }
-
-                        neighbors[Y_Z].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x,
-                            y + 1,
-                            z + 1,
-                            &neighbors[Y_Z].chunk,
-                            &neighbors[Y_Z].coords);
-                        neighbors[NY_Z].block = chunk_get_block_including_neighbors(
-                            chunk,
-                            x,
-                            y - 1,
-                            z + 1,
-                            &neighbors[NY_Z].chunk,
-                            &neighbors[NY_Z].coords);
+                            neighbors[NX_Y_Z] = cache[CHUNK_PADDED_INDEX(x - 1, y + 1, z + 1)];
+                            neighbors[NX_Z] = cache[CHUNK_PADDED_INDEX(x - 1, y, z + 1)];
+                            neighbors[NX_NY_Z] = cache[CHUNK_PADDED_INDEX(x - 1, y - 1, z + 1)];
+                        }
+
+                        neighbors[Y_Z] = cache[CHUNK_PADDED_INDEX(x, y + 1, z + 1)];
+                        neighbors[NY_Z] = cache[CHUNK_PADDED_INDEX(x, y - 1, z + 1)];
 
                         // get their light values & properties
                         if (renderRight == false) {
-                            _vertex_light_get(neighbors[X_Y_Z].chunk,
-                                              neighbors[X_Y_Z].block,
-                                              palette,
-                                              neighbors[X_Y_Z].coords,
-                                              &neighbors[X_Y_Z].vlight,
-                                              &ao_topRightBack,
-                                              &light_topRightBack);
-                            _vertex_light_get(neighbors[X_Z].chunk,
-                                              neighbors[X_Z].block,
-                                              palette,
-                                              neighbors[X_Z].coords,
-                                              &neighbors[X_Z].vlight,
-                                              &ao_rightBack,
-                                              &light_rightBack);
-                            _vertex_light_get(neighbors[X_NY_Z].chunk,
-                                              neighbors[X_NY_Z].block,
-                                              palette,
-                                              neighbors[X_NY_Z].coords,
-                                              &neighbors[X_NY_Z].vlight,
-                                              &ao_bottomRightBack,
-                                              &light_bottomRightBack);
+                            ao_topRightBack = neighbors[X_Y_Z].aoCaster;
+                            light_topRightBack = neighbors[X_Y_Z].lightCaster;
+                            ao_rightBack = neighbors[X_Z].aoCaster;
+                            light_rightBack = neighbors[X_Z].lightCaster;
+                            ao_bottomRightBack = neighbors[X_NY_Z].aoCaster;
+                            light_bottomRightBack = neighbors[X_NY_Z].lightCaster;
                         }
                         if (renderLeft == false) {
-                            _vertex_light_get(neighbors[NX_Y_Z].chunk,
-                                              neighbors[NX_Y_Z].block,
-                                              palette,
-                                              neighbors[NX_Y_Z].coords,
-                                              &neighbors[NX_Y_Z].vlight,
-                                              &ao_topLeftBack,
-                                              &light_topLeftBack);
-                            _vertex_light_get(neighbors[NX_Z].chunk,
-                                              neighbors[NX_Z].block,
-                                              palette,
-                                              neighbors[NX_Z].coords,
-                                              &neighbors[NX_Z].vlight,
-                                              &ao_leftBack,
-                                              &light_leftBack);
-                            _vertex_light_get(neighbors[NX_NY_Z].chunk,
-                                              neighbors[NX_NY_Z].block,
-                                              palette,
-                                              neighbors[NX_NY_Z].coords,
-                                              &neighbors[NX_NY_Z].vlight,
-                                              &ao_bottomLeftBack,
-                                              &light_bottomLeftBack);
-                        }
-                        _vertex_light_get(neighbors[Y_Z].chunk,
-                                          neighbors[Y_Z].block,
-                                          palette,
-                                          neighbors[Y_Z].coords,
-                                          &neighbors[Y_Z].vlight,
-                                          &ao_topBack,
-                                          &light_topBack);
-                        _vertex_light_get(neighbors[NY_Z].chunk,
-                                          neighbors[NY_Z].block,
-                                          palette,
-                                          neighbors[NY_Z].coords,
-                                          &neighbors[NY_Z].vlight,
-                                          &ao_bottomBack,
-                                          &light_bottomBack);
+                            ao_topLeftBack = neighbors[NX_Y_Z].aoCaster;
+                            light_topLeftBack = neighbors[NX_Y_Z].lightCaster;
+                            ao_leftBack = neighbors[NX_Z].aoCaster;
+                            light_leftBack = neighbors[NX_Z].lightCaster;
+                            ao_bottomLeftBack = neighbors[NX_NY_Z].aoCaster;
+                            light_bottomLeftBack = neighbors[NX_NY_Z].lightCaster;
+                        }
+                        ao_topBack = neighbors[Y_Z].aoCaster;
+                        light_topBack = neighbors[Y_Z].lightCaster;
+                        ao_bottomBack = neighbors[NY_Z].aoCaster;
+                        light_bottomBack = neighbors[NY_Z].lightCaster;
 
                         // first corner (bottomLeftBack)
                         if (ao_bottomBack && ao_leftBack) {
@@ -1873,137 +1393,49 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
                         // get 8 neighbors that can impact ambient occlusion and vertex lighting
                         // left/right/back/front blocks may have been retrieved already
                         if (renderLeft == false) {
-                            neighbors[NX_Y_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y + 1,
-                                z + 1,
-                                &neighbors[NX_Y_Z].chunk,
-                                &neighbors[NX_Y_Z].coords);
-                            neighbors[NX_Y].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y + 1,
-                                z,
-                                &neighbors[NX_Y].chunk,
-                                &neighbors[NX_Y].coords);
-                            neighbors[NX_Y_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y + 1,
-                                z - 1,
-                                &neighbors[NX_Y_NZ].chunk,
-                                &neighbors[NX_Y_NZ].coords);
+                            neighbors[NX_Y_Z] = cache[CHUNK_PADDED_INDEX(x - 1, y + 1, z + 1)];
+                            neighbors[NX_Y] = cache[CHUNK_PADDED_INDEX(x - 1, y + 1, z)];
+                            neighbors[NX_Y_NZ] = cache[CHUNK_PADDED_INDEX(x - 1, y + 1, z - 1)];
                         }
 
                         if (renderRight == false) {
-                            neighbors[X_Y_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y + 1,
-                                z + 1,
-                                &neighbors[X_Y_Z].chunk,
-                                &neighbors[X_Y_Z].coords);
-                            neighbors[X_Y].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y + 1,
-                                z,
-                                &neighbors[X_Y].chunk,
-                                &neighbors[X_Y].coords);
-                            neighbors[X_Y_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y + 1,
-                                z - 1,
-                                &neighbors[X_Y_NZ].chunk,
-                                &neighbors[X_Y_NZ].coords);
+                            neighbors[X_Y_Z] = cache[CHUNK_PADDED_INDEX(x + 1, y + 1, z + 1)];
+                            neighbors[X_Y] = cache[CHUNK_PADDED_INDEX(x + 1, y + 1, z)];
+                            neighbors[X_Y_NZ] = cache[CHUNK_PADDED_INDEX(x + 1, y + 1, z - 1)];
                         }
 
                         if (renderBack == false) {
-                            neighbors[Y_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x,
-                                y + 1,
-                                z + 1,
-                                &neighbors[Y_Z].chunk,
-                                &neighbors[Y_Z].coords);
+                            neighbors[Y_Z] = cache[CHUNK_PADDED_INDEX(x, y + 1, z + 1)];
                         }
 
                         if (renderFront == false) {
-                            neighbors[Y_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x,
-                                y + 1,
-                                z - 1,
-                                &neighbors[Y_NZ].chunk,
-                                &neighbors[Y_NZ].coords);
+                            neighbors[Y_NZ] = cache[CHUNK_PADDED_INDEX(x, y + 1, z - 1)];
                         }
 
                         // get their light values & properties
                         if (renderLeft == false) {
-                            _vertex_light_get(neighbors[NX_Y_Z].chunk,
-                                              neighbors[NX_Y_Z].block,
-                                              palette,
-                                              neighbors[NX_Y_Z].coords,
-                                              &neighbors[NX_Y_Z].vlight,
-                                              &ao_topLeftBack,
-                                              &light_topLeftBack);
-                            _vertex_light_get(neighbors[NX_Y].chunk,
-                                              neighbors[NX_Y].block,
-                                              palette,
-                                              neighbors[NX_Y].coords,
-                                              &neighbors[NX_Y].vlight,
-                                              &ao_topLeft,
-                                              &light_topLeft);
-                            _vertex_light_get(neighbors[NX_Y_NZ].chunk,
-                                              neighbors[NX_Y_NZ].block,
-                                              palette,
-                                              neighbors[NX_Y_NZ].coords,
-                                              &neighbors[NX_Y_NZ].vlight,
-                                              &ao_topLeftFront,
-                                              &light_topLeftFront);
+                            ao_topLeftBack = neighbors[NX_Y_Z].aoCaster;
+                            light_topLeftBack = neighbors[NX_Y_Z].lightCaster;
+                            ao_topLeft = neighbors[NX_Y].aoCaster;
+                            light_topLeft = neighbors[NX_Y].lightCaster;
+                            ao_topLeftFront = neighbors[NX_Y_NZ].aoCaster;
+                            light_topLeftFront = neighbors[NX_Y_NZ].lightCaster;
                         }
                         if (renderRight == false) {
-                            _vertex_light_get(neighbors[X_Y_Z].chunk,
-                                              neighbors[X_Y_Z].block,
-                                              palette,
-                                              neighbors[X_Y_Z].coords,
-                                              &neighbors[X_Y_Z].vlight,
-                                              &ao_topRightBack,
-                                              &light_topRightBack);
-                            _vertex_light_get(neighbors[X_Y].chunk,
-                                              neighbors[X_Y].block,
-                                              palette,
-                                              neighbors[X_Y].coords,
-                                              &neighbors[X_Y].vlight,
-                                              &ao_topRight,
-                                              &light_topRight);
-                            _vertex_light_get(neighbors[X_Y_NZ].chunk,
-                                              neighbors[X_Y_NZ].block,
-                                              palette,
-                                              neighbors[X_Y_NZ].coords,
-                                              &neighbors[X_Y_NZ].vlight,
-                                              &ao_topRightFront,
-                                              &light_topRightFront);
+                            ao_topRightBack = neighbors[X_Y_Z].aoCaster;
+                            light_topRightBack = neighbors[X_Y_Z].lightCaster;
+                            ao_topRight = neighbors[X_Y].aoCaster;
+                            light_topRight = neighbors[X_Y].lightCaster;
+                            ao_topRightFront = neighbors[X_Y_NZ].aoCaster;
+                            light_topRightFront = neighbors[X_Y_NZ].lightCaster;
                         }
                         if (renderBack == false) {
-                            _vertex_light_get(neighbors[Y_Z].chunk,
-                                              neighbors[Y_Z].block,
-                                              palette,
-                                              neighbors[Y_Z].coords,
-                                              &neighbors[Y_Z].vlight,
-                                              &ao_topBack,
-                                              &light_topBack);
+                            ao_topBack = neighbors[Y_Z].aoCaster;
+                            light_topBack = neighbors[Y_Z].lightCaster;
                         }
                         if (renderFront == false) {
-                            _vertex_light_get(neighbors[Y_NZ].chunk,
-                                              neighbors[Y_NZ].block,
-                                              palette,
-                                              neighbors[Y_NZ].coords,
-                                              &neighbors[Y_NZ].vlight,
-                                              &ao_topFront,
-                                              &light_topFront);
+                            ao_topFront = neighbors[Y_NZ].aoCaster;
+                            light_topFront = neighbors[Y_NZ].lightCaster;
                         }
 
                         // first corner (topRightFront)
@@ -2106,137 +1538,49 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
                         // get 8 neighbors that can impact ambient occlusion and vertex lighting
                         // left/right/back/front blocks may have been retrieved already
                         if (renderLeft == false) {
-                            neighbors[NX_NY_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y - 1,
-                                z + 1,
-                                &neighbors[NX_NY_Z].chunk,
-                                &neighbors[NX_NY_Z].coords);
-                            neighbors[NX_NY].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y - 1,
-                                z,
-                                &neighbors[NX_NY].chunk,
-                                &neighbors[NX_NY].coords);
-                            neighbors[NX_NY_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x - 1,
-                                y - 1,
-                                z - 1,
-                                &neighbors[NX_NY_NZ].chunk,
-                                &neighbors[NX_NY_NZ].coords);
+                            neighbors[NX_NY_Z] = cache[CHUNK_PADDED_INDEX(x - 1, y - 1, z + 1)];
+                            neighbors[NX_NY] = cache[CHUNK_PADDED_INDEX(x - 1, y - 1, z)];
+                            neighbors[NX_NY_NZ] = cache[CHUNK_PADDED_INDEX(x - 1, y - 1, z - 1)];
                         }
 
                         if (renderRight == false) {
-                            neighbors[X_NY_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y - 1,
-                                z + 1,
-                                &neighbors[X_NY_Z].chunk,
-                                &neighbors[X_NY_Z].coords);
-                            neighbors[X_NY].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y - 1,
-                                z,
-                                &neighbors[X_NY].chunk,
-                                &neighbors[X_NY].coords);
-                            neighbors[X_NY_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x + 1,
-                                y - 1,
-                                z - 1,
-                                &neighbors[X_NY_NZ].chunk,
-                                &neighbors[X_NY_NZ].coords);
+                            neighbors[X_NY_Z] = cache[CHUNK_PADDED_INDEX(x + 1, y - 1, z + 1)];
+                            neighbors[X_NY] = cache[CHUNK_PADDED_INDEX(x + 1, y - 1, z)];
+                            neighbors[X_NY_NZ] = cache[CHUNK_PADDED_INDEX(x + 1, y - 1, z - 1)];
                         }
 
                         if (renderBack == false) {
-                            neighbors[NY_Z].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x,
-                                y - 1,
-                                z + 1,
-                                &neighbors[NY_Z].chunk,
-                                &neighbors[NY_Z].coords);
+                            neighbors[NY_Z] = cache[CHUNK_PADDED_INDEX(x, y - 1, z + 1)];
                         }
 
                         if (renderFront == false) {
-                            neighbors[NY_NZ].block = chunk_get_block_including_neighbors(
-                                chunk,
-                                x,
-                                y - 1,
-                                z - 1,
-                                &neighbors[NY_NZ].chunk,
-                                &neighbors[NY_NZ].coords);
+                            neighbors[NY_NZ] = cache[CHUNK_PADDED_INDEX(x, y - 1, z - 1)];
                         }
 
                         // get their light values & properties
                         if (renderLeft == false) {
-                            _vertex_light_get(neighbors[NX_NY_Z].chunk,
-                                              neighbors[NX_NY_Z].block,
-                                              palette,
-                                              neighbors[NX_NY_Z].coords,
-                                              &neighbors[NX_NY_Z].vlight,
-                                              &ao_bottomLeftBack,
-                                              &light_bottomLeftBack);
-                            _vertex_light_get(neighbors[NX_NY].chunk,
-                                              neighbors[NX_NY].block,
-                                              palette,
-                                              neighbors[NX_NY].coords,
-                                              &neighbors[NX_NY].vlight,
-                                              &ao_bottomLeft,
-                                              &light_bottomLeft);
-                            _vertex_light_get(neighbors[NX_NY_NZ].chunk,
-                                              neighbors[NX_NY_NZ].block,
-                                              palette,
-                                              neighbors[NX_NY_NZ].coords,
-                                              &neighbors[NX_NY_NZ].vlight,
-                                              &ao_bottomLeftFront,
-                                              &light_bottomLeftFront);
+                            ao_bottomLeftBack = neighbors[NX_NY_Z].aoCaster;
+                            light_bottomLeftBack = neighbors[NX_NY_Z].lightCaster;
+                            ao_bottomLeft = neighbors[NX_NY].aoCaster;
+                            light_bottomLeft = neighbors[NX_NY].lightCaster;
+                            ao_bottomLeftFront = neighbors[NX_NY_NZ].aoCaster;
+                            light_bottomLeftFront = neighbors[NX_NY_NZ].lightCaster;
                         }
                         if (renderRight == false) {
-                            _vertex_light_get(neighbors[X_NY_Z].chunk,
-                                              neighbors[X_NY_Z].block,
-                                              palette,
-                                              neighbors[X_NY_Z].coords,
-                                              &neighbors[X_NY_Z].vlight,
-                                              &ao_bottomRightBack,
-                                              &light_bottomRightBack);
-                            _vertex_light_get(neighbors[X_NY].chunk,
-                                              neighbors[X_NY].block,
-                                              palette,
-                                              neighbors[X_NY].coords,
-                                              &neighbors[X_NY].vlight,
-                                              &ao_bottomRight,
-                                              &light_bottomRight);
-                            _vertex_light_get(neighbors[X_NY_NZ].chunk,
-                                              neighbors[X_NY_NZ].block,
-                                              palette,
-                                              neighbors[X_NY_NZ].coords,
-                                              &neighbors[X_NY_NZ].vlight,
-                                              &ao_bottomRightFront,
-                                              &light_bottomRightFront);
+                            ao_bottomRightBack = neighbors[X_NY_Z].aoCaster;
+                            light_bottomRightBack = neighbors[X_NY_Z].lightCaster;
+                            ao_bottomRight = neighbors[X_NY].aoCaster;
+                            light_bottomRight = neighbors[X_NY].lightCaster;
+                            ao_bottomRightFront = neighbors[X_NY_NZ].aoCaster;
+                            light_bottomRightFront = neighbors[X_NY_NZ].lightCaster;
                         }
                         if (renderBack == false) {
-                            _vertex_light_get(neighbors[NY_Z].chunk,
-                                              neighbors[NY_Z].block,
-                                              palette,
-                                              neighbors[NY_Z].coords,
-                                              &neighbors[NY_Z].vlight,
-                                              &ao_bottomBack,
-                                              &light_bottomBack);
+                            ao_bottomBack = neighbors[NY_Z].aoCaster;
+                            light_bottomBack = neighbors[NY_Z].lightCaster;
                         }
                         if (renderFront == false) {
-                            _vertex_light_get(neighbors[NY_NZ].chunk,
-                                              neighbors[NY_NZ].block,
-                                              palette,
-                                              neighbors[NY_NZ].coords,
-                                              &neighbors[NY_NZ].vlight,
-                                              &ao_bottomFront,
-                                              &light_bottomFront);
+                            ao_bottomFront = neighbors[NY_NZ].aoCaster;
+                            light_bottomFront = neighbors[NY_NZ].lightCaster;
                         }
 
                         // first corner (bottomLeftFront)
@@ -2340,6 +1684,8 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
     vertex_buffer_mem_area_writer_done(transparentWriter);
     vertex_buffer_mem_area_writer_free(transparentWriter);
 #endif
+
+    free(cache);
 }
 
 // MARK: private functions
@@ -2410,17 +1756,84 @@ void _chunk_good_bye_neighbor(Chunk *chunk, Neighbor location) {
     chunk->neighbors[location] = NULL;
 }
 
-void _vertex_light_get(Chunk *chunk,
-                       Block *block,
-                       const ColorPalette *palette,
-                       CHUNK_COORDS_INT3_T coords,
-                       VERTEX_LIGHT_STRUCT_T *vlight,
-                       bool *aoCaster,
-                       bool *lightCaster) {
-
-    bool opaque;
-    block_is_any(block, palette, NULL, &opaque, NULL, aoCaster, lightCaster);
-    *vlight = chunk_get_light_or_default(chunk, coords, block == NULL || opaque);
+static void _chunk_fill_padded_blocks(Chunk *chunk,
+                                      const ColorPalette *palette,
+                                      const bool vLighting,
+                                      PaddedBlock *out) {
+    // neighbor at offset (x, y, z) in {-1, 0, 1}, indexed (x + 1) * 9 + (y + 1) * 3 + z + 1
+    // (center entry is the chunk itself and is never read)
+    static const Neighbor neighborForOffset[27] = {
+        NX_NY_NZ, NX_NY, NX_NY_Z, NX_NZ, NX, NX_Z, NX_Y_NZ, NX_Y, NX_Y_Z,
+        NY_NZ,    NY,    NY_Z,    NZ,    X,  Z,    Y_NZ,    Y,    Y_Z,
+        X_NY_NZ,  X_NY,  X_NY_Z,  X_NZ,  X,  X_Z,  X_Y_NZ,  X_Y,  X_Y_Z};
+
+    // blocks read from the chunk itself, or from a face/edge/corner of one of its neighbors
+    Block blocks[CHUNK_SIZE_CUBE];
+    // for offset -1, 0 & 1 along an axis: first coordinate read, number of blocks read
+    const CHUNK_COORDS_INT_T start[3] = {CHUNK_SIZE_MINUS_ONE, 0, 0};
+    const CHUNK_COORDS_INT_T length[3] = {1, CHUNK_SIZE, 1};
+    const CHUNK_COORDS_INT_T dstStart[3] = {-1, 0, CHUNK_SIZE};
+
+    Chunk *c;
+    Block *block;
+    PaddedBlock *pb;
+    CHUNK_COORDS_INT3_T coords;
+    CHUNK_COORDS_INT_T lx, ly, lz;
+
+    for (int ox = 0; ox < 3; ++ox) {
+        for (int oy = 0; oy < 3; ++oy) {
+            for (int oz = 0; oz < 3; ++oz) {
+                c = ox == 1 && oy == 1 && oz == 1
+                        ? chunk
+                        : chunk->neighbors[neighborForOffset[ox * 9 + oy * 3 + oz]];
+                lx = length[ox];
+                ly = length[oy];
+                lz = length[oz];
+                if (c != NULL) {
+                    octree_get_elements_slab(c->octree,
+                                             (size_t)start[ox],
+                                             (size_t)start[oy],
+                                             (size_t)start[oz],
+                                             (size_t)lx,
+                                             (size_t)ly,
+                                             (size_t)lz,
+                                             blocks);
+                }
+
+                for (CHUNK_COORDS_INT_T i = 0; i < lx; ++i) {
+                    for (CHUNK_COORDS_INT_T k = 0; k < lz; ++k) {
+                        for (CHUNK_COORDS_INT_T j = 0; j < ly; ++j) {
+                            pb = &out[CHUNK_PADDED_INDEX(dstStart[ox] + i,
+                                                         dstStart[oy] + j,
+                                                         dstStart[oz] + k)];
+                            block = c != NULL ? &blocks[(k * ly + j) * lx + i] : NULL;
+
+                            pb->colorIndex = block != NULL ? block->colorIndex
+                                                           : SHAPE_COLOR_INDEX_AIR_BLOCK;
+                            block_is_any(block,
+                                         palette,
+                                         &pb->solid,
+                                         &pb->opaque,
+                                         &pb->transparent,
+                                         &pb->aoCaster,
+                                         &pb->lightCaster);
+                            if (vLighting) {
+                                coords = (CHUNK_COORDS_INT3_T){start[ox] + i,
+                                                               start[oy] + j,
+                                                               start[oz] + k};
+                                pb->vlight = chunk_get_light_or_default(c,
+                                                                        coords,
+                                                                        block == NULL ||
+                                                                            pb->opaque);
+                            } else {
+                                DEFAULT_LIGHT(pb->vlight)
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
 }
 
 void _vertex_light_smoothing(VERTEX_LIGHT_STRUCT_T *base,
@@ -2525,10 +1938,10 @@ void _chunk_update_bounding_box(Chunk *chunk,
             for (CHUNK_COORDS_INT_T x = chunk->bbMax.x - 1; isEmpty && x >= chunk->bbMin.x; --x) {
                 for (CHUNK_COORDS_INT_T z = chunk->bbMin.z; z < chunk->bbMax.z; ++z) {
                     for (CHUNK_COORDS_INT_T y = chunk->bbMin.y; y < chunk->bbMax.y; ++y) {
-                        b = (Block *)octree_get_element_without_checking(chunk->octree,
-                                                                         (size_t)x,
-                                                                         (size_t)y,
-                                                                         (size_t)z);
+                        b = (Block *)octree_get_element_fast(chunk->octree,
+                                                             (size_t)x,
+                                                             (size_t)y,
+                                                             (size_t)z);
                         if (block_is_solid(b)) {
                             isEmpty = false;
                             break;
@@ -2548,10 +1961,10 @@ void _chunk_update_bounding_box(Chunk *chunk,
             for (CHUNK_COORDS_INT_T x = chunk->bbMin.x; isEmpty && x < chunk->bbMax.x; ++x) {
                 for (CHUNK_COORDS_INT_T z = chunk->bbMin.z; z < chunk->bbMax.z; ++z) {
                     for (CHUNK_COORDS_INT_T y = chunk->bbMin.y; y < chunk->bbMax.y; ++y) {
-                        b = (Block *)octree_get_element_without_checking(chunk->octree,
-                                                                         (size_t)x,
-                                                                         (size_t)y,
-                                                                         (size_t)z);
+                        b = (Block *)octree_get_element_fast(chunk->octree,
+                                                             (size_t)x,
+                                                             (size_t)y,
+                                                             (size_t)z);
                         if (block_is_solid(b)) {
                             isEmpty = false;
                             break;
@@ -2572,10 +1985,10 @@ void _chunk_update_bounding_box(Chunk *chunk,
             for (CHUNK_COORDS_INT_T y = chunk->bbMax.y - 1; isEmpty && y >= chunk->bbMin.y; --y) {
                 for (CHUNK_COORDS_INT_T z = chunk->bbMin.z; z < chunk->bbMax.z; ++z) {
                     for (CHUNK_COORDS_INT_T x = chunk->bbMin.x; x < chunk->bbMax.x; ++x) {
-                        b = (Block *)octree_get_element_without_checking(chunk->octree,
-                                                                         (size_t)x,
-                                                                         (size_t)y,
-                                                                         (size_t)z);
+                        b = (Block *)octree_get_element_fast(chunk->octree,
+                                                             (size_t)x,
+                                                             (size_t)y,
+                                                             (size_t)z);
                         if (block_is_solid(b)) {
                             isEmpty = false;
                             break;
@@ -2595,10 +2008,10 @@ void _chunk_update_bounding_box(Chunk *chunk,
             for (CHUNK_COORDS_INT_T y = chunk->bbMin.y; isEmpty && y < chunk->bbMax.y; ++y) {
                 for (CHUNK_COORDS_INT_T z = chunk->bbMin.z; z < chunk->bbMax.z; ++z) {
                     for (CHUNK_COORDS_INT_T x = chunk->bbMin.x; x < chunk->bbMax.x; ++x) {
-                        b = (Block *)octree_get_element_without_checking(chunk->octree,
-                                                                         (size_t)x,
-                                                                         (size_t)y,
-                                                                         (size_t)z);
+                        b = (Block *)octree_get_element_fast(chunk->octree,
+                                                             (size_t)x,
+                                                             (size_t)y,
+                                                             (size_t)z);
                         if (block_is_solid(b)) {
                             isEmpty = false;
                             break;
@@ -2619,10 +2032,10 @@ void _chunk_update_bounding_box(Chunk *chunk,
             for (CHUNK_COORDS_INT_T z = chunk->bbMax.z - 1; isEmpty && z >= chunk->bbMin.z; --z) {
                 for (CHUNK_COORDS_INT_T x = chunk->bbMin.x; x < chunk->bbMax.x; ++x) {
                     for (CHUNK_COORDS_INT_T y = chunk->bbMin.y; y < chunk->bbMax.y; ++y) {
-                        b = (Block *)octree_get_element_without_checking(chunk->octree,
-                                                                         (size_t)x,
-                                                                         (size_t)y,
-                                                                         (size_t)z);
+                        b = (Block *)octree_get_element_fast(chunk->octree,
+                                                             (size_t)x,
+                                                             (size_t)y,
+                                                             (size_t)z);
                         if (block_is_solid(b)) {
                             isEmpty = false;
                             break;
@@ -2642,10 +2055,10 @@ void _chunk_update_bounding_box(Chunk *chunk,
             for (CHUNK_COORDS_INT_T z = chunk->bbMin.z; isEmpty && z < chunk->bbMax.z; ++z) {
                 for (CHUNK_COORDS_INT_T x = chunk->bbMin.x; x < chunk->bbMax.x; ++x) {
                     for (CHUNK_COORDS_INT_T y = chunk->bbMin.y; y < chunk->bbMax.y; ++y) {
-                        b = (Block *)octree_get_element_without_checking(chunk->octree,
-                                                                         (size_t)x,
-                                                                         (size_t)y,
-                                                                         (size_t)z);
+                        b = (Block *)octree_get_element_fast(chunk->octree,
+                                                             (size_t)x,
+                                                             (size_t)y,
+                                                             (size_t)z);
                         if (block_is_solid(b)) {
                             isEmpty = false;
                             break;
@@ -109,6 +109,7 @@ Block *chunk_get_block(const Chunk *chunk,
 
 Block *chunk_get_block_2(const Chunk *chunk, CHUNK_COORDS_INT3_T coords);
 
+/// x, y & z have to be within [-1, CHUNK_SIZE], i.e. in the chunk or one of its direct neighbors
 Block *chunk_get_block_including_neighbors(Chunk *chunk,
                                            const CHUNK_COORDS_INT_T x,
                                            const CHUNK_COORDS_INT_T y,
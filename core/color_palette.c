@@ -168,6 +168,25 @@ void color_palette_set_atlas(ColorPalette *p, ColorAtlas *atlas) {
     }
 }
 
+void color_palette_link_atlas(ColorPalette *p,
+                              ColorAtlas *atlas,
+                              const SHAPE_COLOR_INDEX_INT_T *entries,
+                              const uint16_t count) {
+    if (p->refAtlas != NULL || atlas == NULL) {
+        return;
+    }
+    p->refAtlas = color_atlas_get_and_retain_weakptr(atlas);
+
+    for (uint16_t i = 0; i < count; ++i) {
+        const SHAPE_COLOR_INDEX_INT_T entry = entries[i];
+        if (entry < p->count && p->entries[entry].blocksCount > 0 &&
+            p->entries[entry].atlasIndex == ATLAS_COLOR_INDEX_ERROR) {
+            p->entries[entry].atlasIndex = color_atlas_check_and_add_color(atlas,
+                                                                           p->entries[entry].color);
+        }
+    }
+}
+
 ColorAtlas *color_palette_get_atlas(const ColorPalette *p) {
     return weakptr_get(p->refAtlas);
 }
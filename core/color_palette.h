@@ -75,6 +75,12 @@ bool color_palette_retain(ColorPalette *p);
 bool color_palette_release(ColorPalette *p);
 
 void color_palette_set_atlas(ColorPalette *p, ColorAtlas *atlas);
+/// Links a palette that was used without atlas, registering used entries in given order as if
+/// they were used for the first time; other entries are registered when first used
+void color_palette_link_atlas(ColorPalette *p,
+                              ColorAtlas *atlas,
+                              const SHAPE_COLOR_INDEX_INT_T *entries,
+                              const uint16_t count);
 
 uint8_t color_palette_get_count(const ColorPalette *p);
 ColorAtlas *color_palette_get_atlas(const ColorPalette *p);
@@ -144,6 +144,8 @@ extern unsigned long upper_power_of_two(unsigned long v);
 /// Queries over large distances may be split in steps
 #define RTREE_CAST_STEP_DISTANCE                                                                   \
     64.0f // 1/4 of a large-sized map, or "10 frames" of max velocity (PHYSICS_MAX_VELOCITY * .016)
+/// Initial capacity of cast queries results buffers, grown x2 when full
+#define RTREE_CAST_RESULTS_DEFAULT_CAPACITY 16
 /// When updating a leaf, stick to current node if volume expansion is below threshold
 #define RTREE_LEAF_UPDATE_THRESHOLD 25.0f
 /// Maximum velocity magnitude in unit/sec for all objects
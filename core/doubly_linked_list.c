@@ -245,21 +245,69 @@ DoublyLinkedListNode *doubly_linked_list_insert_node_next(DoublyLinkedList *list
 
 void doubly_linked_list_sort_ascending(DoublyLinkedList *list,
                                        pointer_doubly_linked_list_sort_func func) {
-    DoublyLinkedListNode *last = list->last;
-    DoublyLinkedListNode *current = NULL;
-    void *ptr = NULL;
-    while (last != NULL) {
-        current = list->first;
-        while (current != last) {
-            if (func(current, last)) {
-                ptr = current->ptr;
-                current->ptr = last->ptr;
-                last->ptr = ptr;
+    if (list->first == NULL || list->first == list->last) {
+        return;
+    }
+
+    // bottom-up merge sort, O(n log n) without recursion nor allocation ; nodes are re-linked
+    // and merging is stable, equal nodes keep their relative order
+    DoublyLinkedListNode *head = list->first, *tail, *p, *q, *e;
+    size_t insize = 1, nmerges, psize, qsize;
+    while (true) {
+        p = head;
+        head = NULL;
+        tail = NULL;
+        nmerges = 0;
+
+        while (p != NULL) {
+            ++nmerges;
+
+            // step 'insize' nodes along from p
+            q = p;
+            psize = 0;
+            while (psize < insize && q != NULL) {
+                ++psize;
+                q = q->next;
             }
-            current = current->next;
+            qsize = insize;
+
+            // merge the two runs starting at p and q
+            while (psize > 0 || (qsize > 0 && q != NULL)) {
+                if (psize == 0) {
+                    e = q;
+                    q = q->next;
+                    --qsize;
+                } else if (qsize == 0 || q == NULL || func(p, q) == false) {
+                    e = p;
+                    p = p->next;
+                    --psize;
+                } else {
+                    e = q;
+                    q = q->next;
+                    --qsize;
+                }
+
+                if (tail != NULL) {
+                    tail->next = e;
+                } else {
+                    head = e;
+                }
+                e->previous = tail;
+                tail = e;
+            }
+
+            p = q;
         }
-        last = last->previous;
+        tail->next = NULL;
+
+        if (nmerges <= 1) {
+            break;
+        }
+        insize *= 2;
     }
+
+    list->first = head;
+    list->last = tail;
 }
 
 size_t doubly_linked_list_node_count(const DoublyLinkedList *list) {
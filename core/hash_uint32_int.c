@@ -9,210 +9,183 @@
 #include "cclog.h"
 #include <stdio.h>
 
-#define HASH_UINT32_BIT_SHIFT 2
-// 32 / 2 = 16 levels
-#define HASH_TREE_LEVELS 16
-#define HASH_TREE_LEVELS_MINUS_ONE 15
-#define HASH_UINT32_CHILDREN_PER_NODE 16
-// % 16 (modulo) == & 15 (binary operation)
-#define HASH_UINT32_BIN_MODULO 15 // 1111
-
-typedef struct _HashUInt32IntNode HashUInt32IntNode;
-
-struct _HashUInt32IntNode {
-    void **slots;
-    HashUInt32IntNode *parent;
-    uint8_t level;
-    uint8_t index;
-};
+// capacity is always a power of 2, so that % capacity == & (capacity - 1)
+#define HASH_UINT32_INT_DEFAULT_CAPACITY 16
+// grow when count reaches 7/8 of capacity, Robin Hood keeps probe sequences short at high load
+#define HASH_UINT32_INT_MAX_LOAD_NUM 7
+#define HASH_UINT32_INT_MAX_LOAD_DEN 8
+
+typedef struct {
+    uint32_t key;
+    int value;
+    // distance from the slot the key hashes to, + 1 ; 0 means empty slot
+    uint32_t dist;
+} HashUInt32IntSlot;
 
 struct _HashUInt32Int {
-    HashUInt32IntNode *rootNode;
+    HashUInt32IntSlot *slots;
+    uint32_t capacity;
+    uint32_t count;
 };
 
-// when leaf == true, each branch slot contains a value, not another branch
-HashUInt32IntNode *hash_uint32_node_new(HashUInt32IntNode *parent, uint8_t index, uint8_t level) {
-    vx_assert(level <= HASH_TREE_LEVELS);
-    HashUInt32IntNode *const n = (HashUInt32IntNode *)malloc(sizeof(HashUInt32IntNode));
-    void **slots = (void **)malloc(sizeof(void *) * HASH_UINT32_CHILDREN_PER_NODE);
-    for (int i = 0; i < HASH_UINT32_CHILDREN_PER_NODE; ++i) {
-        slots[i] = NULL;
+// MARK: - Private functions -
+
+// murmur3 finalizer, colors used as keys tend to only differ in a few bits
+static uint32_t _hash_uint32_int_hash(uint32_t key) {
+    key ^= key >> 16;
+    key *= 0x85ebca6bu;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35u;
+    key ^= key >> 16;
+    return key;
+}
+
+static HashUInt32IntSlot *_hash_uint32_int_slots_new(uint32_t capacity) {
+    return (HashUInt32IntSlot *)calloc(capacity, sizeof(HashUInt32IntSlot));
+}
+
+// inserts a key known to be absent from the table, table must have at least one empty slot
+static void _hash_uint32_int_insert_new(HashUInt32Int *h, uint32_t key, int value) {
+    const uint32_t mask = h->capacity - 1;
+    HashUInt32IntSlot entry = {key, value, 1};
+    HashUInt32IntSlot tmp;
+    uint32_t i = _hash_uint32_int_hash(key) & mask;
+
+    while (true) {
+        HashUInt32IntSlot *slot = &h->slots[i];
+        if (slot->dist == 0) {
+            *slot = entry;
+            ++h->count;
+            return;
+        }
+        // Robin Hood: take the slot from entries closer to their home slot
+        if (slot->dist < entry.dist) {
+            tmp = *slot;
+            *slot = entry;
+            entry = tmp;
+        }
+        ++entry.dist;
+        i = (i + 1) & mask;
     }
-    n->slots = slots;
-    n->parent = parent;
-    n->level = level;
-    n->index = index;
-    return n;
 }
 
-// frees node and all children
-// + sets parent slot to NULL
-void hash_uint32_node_free(HashUInt32IntNode *n) {
-    HashUInt32IntNode *cursor = n;
-    HashUInt32IntNode *tmp = NULL;
-    uint8_t slotCursor = 0;
-    HashUInt32IntNode **slots;
-
-    while (cursor != NULL) {
-        if (slotCursor == HASH_UINT32_CHILDREN_PER_NODE ||
-            cursor->level == HASH_TREE_LEVELS_MINUS_ONE) {
-            // done freeing all children, or reached last level
-            tmp = cursor->parent;
-            slotCursor = cursor->index + 1;
-            for (int i = 0; i < HASH_UINT32_CHILDREN_PER_NODE; ++i) {
-                if (cursor->slots[i] != NULL) {
-                    free(cursor->slots[i]);
-                    cursor->slots[i] = NULL;
-                }
-            }
-            if (tmp != NULL) {
-                // set parent slot to NULL
-                tmp->slots[cursor->index] = NULL;
-            }
-            if (cursor == n) {
-                // don't free nodes above n
-                tmp = NULL;
-            }
-            free(cursor->slots);
-            free(cursor);
-            cursor = tmp;
-            continue;
+static bool _hash_uint32_int_grow(HashUInt32Int *h) {
+    HashUInt32IntSlot *oldSlots = h->slots;
+    const uint32_t oldCapacity = h->capacity;
+
+    HashUInt32IntSlot *slots = _hash_uint32_int_slots_new(oldCapacity * 2);
+    if (slots == NULL) {
+        return false;
+    }
+    h->slots = slots;
+    h->capacity = oldCapacity * 2;
+    h->count = 0;
+
+    for (uint32_t i = 0; i < oldCapacity; ++i) {
+        if (oldSlots[i].dist != 0) {
+            _hash_uint32_int_insert_new(h, oldSlots[i].key, oldSlots[i].value);
         }
+    }
+    free(oldSlots);
+
+    return true;
+}
+
+// returns slot index or -1 if not found
+static int64_t _hash_uint32_int_find(const HashUInt32Int *h, uint32_t key) {
+    const uint32_t mask = h->capacity - 1;
+    uint32_t i = _hash_uint32_int_hash(key) & mask;
+    uint32_t dist = 1;
 
-        slots = (HashUInt32IntNode **)(cursor->slots);
-        if (slots[slotCursor] != NULL) {
-            cursor = slots[slotCursor];
-            slotCursor = 0;
-            continue;
+    while (true) {
+        const HashUInt32IntSlot *slot = &h->slots[i];
+        // an empty slot, or an entry closer to its home slot than we are, means key is absent
+        if (slot->dist < dist) {
+            return -1;
+        }
+        if (slot->key == key) {
+            return (int64_t)i;
         }
-        ++slotCursor; // child is NULL, go see next
+        ++dist;
+        i = (i + 1) & mask;
     }
 }
 
+// MARK: - Public functions -
+
 HashUInt32Int *hash_uint32_int_new(void) {
     HashUInt32Int *h = (HashUInt32Int *)malloc(sizeof(HashUInt32Int));
-    h->rootNode = hash_uint32_node_new(NULL, 0, 1);
+    if (h == NULL) {
+        return NULL;
+    }
+    h->slots = _hash_uint32_int_slots_new(HASH_UINT32_INT_DEFAULT_CAPACITY);
+    if (h->slots == NULL) {
+        free(h);
+        return NULL;
+    }
+    h->capacity = HASH_UINT32_INT_DEFAULT_CAPACITY;
+    h->count = 0;
     return h;
 }
 
 void hash_uint32_int_free(HashUInt32Int *h) {
-    hash_uint32_node_free(h->rootNode);
+    if (h == NULL) {
+        return;
+    }
+    free(h->slots);
     free(h);
 }
 
 void hash_uint32_int_set(HashUInt32Int *const h, uint32_t key, const int value) {
-    uint8_t level = 1;
-    HashUInt32IntNode *n = h->rootNode;
-    vx_assert(n != NULL);
-    uint8_t modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-    HashUInt32IntNode **slots;
+    vx_assert(h != NULL);
 
-    while (true) {
-        slots = (HashUInt32IntNode **)(n->slots);
-        // cclog_debug("LEVEL: %d - modulo: %d", level, modulo);
-        ++level;
-        if (slots[modulo] == NULL) {
-            slots[modulo] = hash_uint32_node_new(n, modulo, level);
-        }
-        n = slots[modulo];
-        key = key >> HASH_UINT32_BIT_SHIFT;
-        modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-
-        if (level == HASH_TREE_LEVELS_MINUS_ONE) {
-            slots = (HashUInt32IntNode **)(n->slots);
-            int *i = (int *)slots[modulo];
-
-            if (i == NULL) {
-                slots[modulo] = (void *)malloc(sizeof(int *));
-                i = (int *)slots[modulo];
-            }
+    const int64_t i = _hash_uint32_int_find(h, key);
+    if (i >= 0) {
+        h->slots[i].value = value;
+        return;
+    }
 
-            *i = value;
+    if ((h->count + 1) * HASH_UINT32_INT_MAX_LOAD_DEN >
+        h->capacity * HASH_UINT32_INT_MAX_LOAD_NUM) {
+        if (_hash_uint32_int_grow(h) == false) {
+            cclog_error("hash_uint32_int: failed to grow table");
             return;
         }
     }
+    _hash_uint32_int_insert_new(h, key, value);
 }
 
 bool hash_uint32_int_get(HashUInt32Int *h, uint32_t key, int *outValue) {
-    int level = 1;
-    HashUInt32IntNode *n = h->rootNode;
-    vx_assert(n != NULL);
-    uint8_t modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-    HashUInt32IntNode **slots;
-
-    while (true) {
-        slots = (HashUInt32IntNode **)(n->slots);
-
-        if (slots[modulo] == NULL) {
-            return false;
-        }
-        n = slots[modulo];
-        ++level;
-        key = key >> HASH_UINT32_BIT_SHIFT;
-        modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-
-        if (level == HASH_TREE_LEVELS_MINUS_ONE) {
-
-            slots = (HashUInt32IntNode **)(n->slots);
-            int *i = (int *)slots[modulo];
-
-            if (i == NULL) {
-                return false;
-            }
+    vx_assert(h != NULL);
 
-            *outValue = *i;
-            return true;
-        }
+    const int64_t i = _hash_uint32_int_find(h, key);
+    if (i < 0) {
+        return false;
     }
-
-    vx_assert(false); // should never reach this point
-    return false;
+    *outValue = h->slots[i].value;
+    return true;
 }
 
 void hash_uint32_int_delete(HashUInt32Int *h, uint32_t key) {
-    int level = 1;
-    HashUInt32IntNode *n = h->rootNode;
-    HashUInt32IntNode *tmp = NULL;
-    vx_assert(n != NULL);
-    uint8_t modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-    HashUInt32IntNode **slots;
-
-    while (true) {
-        slots = (HashUInt32IntNode **)(n->slots);
-
-        if (slots[modulo] == NULL) {
-            // not found, nothing to delete
-            return;
-        }
-        n = slots[modulo];
-        ++level;
-        key = key >> HASH_UINT32_BIT_SHIFT;
-        modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-
-        if (level == HASH_TREE_LEVELS_MINUS_ONE) {
-
-            slots = (HashUInt32IntNode **)(n->slots);
+    vx_assert(h != NULL);
 
-            if (slots[modulo] == NULL) {
-                // not found, nothing to delete
-                return;
-            }
-
-            free(slots[modulo]); // free int* (value)
-            slots[modulo] = NULL;
-            break;
-        }
+    const int64_t found = _hash_uint32_int_find(h, key);
+    if (found < 0) {
+        // not found, nothing to delete
+        return;
     }
 
-    // cleanup empty parents (except root node)
-    while (n != NULL && n->level > 1) {
-        for (int i = 0; i < HASH_UINT32_CHILDREN_PER_NODE; ++i) {
-            if (n->slots[i] != NULL) {
-                return; // at least one slot not empty, stop
-            }
-        }
-        tmp = n->parent;
-        hash_uint32_node_free(n);
-        n = tmp;
+    // backward shift deletion: pull following entries one slot closer to their home slot,
+    // until reaching an empty slot or an entry already in its home slot
+    const uint32_t mask = h->capacity - 1;
+    uint32_t i = (uint32_t)found;
+    uint32_t next = (i + 1) & mask;
+    while (h->slots[next].dist > 1) {
+        h->slots[i] = h->slots[next];
+        --h->slots[i].dist;
+        i = next;
+        next = (next + 1) & mask;
     }
+    h->slots[i].dist = 0;
+    --h->count;
 }
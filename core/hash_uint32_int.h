@@ -4,8 +4,9 @@
 //  Created by Adrien Duermael on August 15, 2022.
 // -------------------------------------------------------------
 
-// Allows to register uint32 values and quickly find out if some value is registered.
-// In that kind of hash, the key stored and the value are the same.
+// Maps uint32 keys to int values.
+// Flat open-addressing table (Robin Hood hashing w/ backward shift deletion), all entries are
+// stored in a single array that grows x2 when reaching max load factor.
 
 #pragma once
 
@@ -8,329 +8,281 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "cclog.h"
+#include "config.h"
 
-// has to be a power of two
-// #define INDEX_NODE_SIZE 64
-#define INDEX_NODE_BITWISE_MODULO 63 // INDEX_NODE_SIZE - 1
-// the extra slot is used to go from x > y and y > z or store the actual pointer
-#define INDEX_NODE_ARRAY_SIZE 65           // INDEX_NODE_SIZE + 1
-#define INDEX_NODE_ARRAY_SIZE_MINUS_ONE 64 // INDEX_NODE_ARRAY_SIZE_MINUS_ONE
-#define INDEX_DIVIDE_BYTES 6
+// both have to be powers of two
+#define INDEX3D_DEFAULT_ENTRIES_CAPACITY 8
+#define INDEX3D_DEFAULT_SLOTS_CAPACITY 16
+// slots table grows when reaching 3/4 load
+#define INDEX3D_SLOTS_MAX_LOAD_NUM 3
+#define INDEX3D_SLOTS_MAX_LOAD_DEN 4
+#define INDEX3D_EMPTY_SLOT UINT32_MAX
+
+typedef struct {
+    void *ptr; // NULL for removed entries
+    int32_t x, y, z;
+
+    char pad[4];
+} Index3DEntry;
+
+// coordinates are duplicated in slots so that probing doesn't touch entries
+typedef struct {
+    int32_t x, y, z;
+    uint32_t entry; // INDEX3D_EMPTY_SLOT if empty
+} Index3DSlot;
 
 struct _Index3D {
-    void **topLevelNode;
-    DoublyLinkedList *list;
+    // entries in insertion order, contiguous for iteration ; removed entries leave a hole
+    // until entries are compacted, next time the array is full (trailing holes are trimmed)
+    Index3DEntry *entries;
+    // open-addressing table (linear probing), each slot holds an index in entries
+    Index3DSlot *slots;
+    // iterators created on this index, moved along w/ entries
+    Index3DIterator *iterators;
+    // number of entries in use, including holes ; last one is never a hole
+    uint32_t entriesCount;
+    uint32_t entriesCapacity;
+    // number of stored pointers
+    uint32_t count;
+    // slots capacity - 1
+    uint32_t slotsMask;
 };
 
 struct _Index3DIterator {
-    DoublyLinkedListNode *current;
+    Index3D *index; // NULL if index was freed
+    Index3DIterator *prev;
+    Index3DIterator *next;
+    uint32_t current;
+
+    char pad[4];
 };
 
 //-------------------
-// Index3D
+// Private
 //-------------------
 
-static void **_new_node(void) {
-    void **arr = (void **)malloc(INDEX_NODE_ARRAY_SIZE * sizeof(void *));
-    for (int i = 0; i < INDEX_NODE_ARRAY_SIZE; ++i) {
-        arr[i] = NULL;
-    }
-    return arr;
+static uint32_t _index3d_hash(const int32_t x, const int32_t y, const int32_t z) {
+    const uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u;
+    // fold high bits, so that neighbor coordinates don't collide in small tables
+    return h ^ (h >> 15);
 }
 
-void *index3d_get(const Index3D *index, const int32_t x, const int32_t y, const int32_t z) {
-
-    // only use unsigned integers for bitwise operations:
-    uint32_t ux = (uint32_t)x;
-    uint32_t uy = (uint32_t)y;
-    uint32_t uz = (uint32_t)z;
-
-    void **currentNode = index->topLevelNode;
-
-    uint32_t modulo = ux & INDEX_NODE_BITWISE_MODULO;
-    uint32_t quotient = ux >> INDEX_DIVIDE_BYTES;
-
-    // look for x
-
-    while (1) {
-        // found, go to y
-        if (quotient == 0 && modulo == 0) {
-            currentNode = (void **)currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE];
-            if (currentNode == NULL) {
-                // not found
-                return NULL;
-            }
-            break;
-        }
-
-        currentNode = (void **)currentNode[modulo];
-
-        if (currentNode == NULL) {
-            // not found
-            return NULL;
-        }
-
-        if (quotient == 0) {
-            // making sure we're going to y in next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
-        }
+// returns slot holding given coordinates, or INDEX3D_EMPTY_SLOT if not found
+static uint32_t _index3d_find_slot(const Index3D *index,
+                                   const int32_t x,
+                                   const int32_t y,
+                                   const int32_t z) {
+    if (index->slots == NULL) {
+        return INDEX3D_EMPTY_SLOT;
     }
-
-    // look for y
-
-    modulo = uy & INDEX_NODE_BITWISE_MODULO;
-    quotient = uy >> INDEX_DIVIDE_BYTES;
-
-    while (1) {
-        // found, go to z
-        if (quotient == 0 && modulo == 0) {
-            currentNode = (void **)currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE];
-            if (currentNode == NULL) {
-                // not found
-                return NULL;
-            }
-            break;
-        }
-
-        currentNode = (void **)currentNode[modulo];
-
-        if (currentNode == NULL) {
-            // not found
-            return NULL;
+    uint32_t s = _index3d_hash(x, y, z) & index->slotsMask;
+    const Index3DSlot *slot;
+    while (true) {
+        slot = &index->slots[s];
+        if (slot->entry == INDEX3D_EMPTY_SLOT) {
+            return INDEX3D_EMPTY_SLOT;
         }
-
-        if (quotient == 0) {
-            // making sure we're going to z in next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
+        if (slot->x == x && slot->y == y && slot->z == z) {
+            return s;
         }
+        s = (s + 1) & index->slotsMask;
     }
+}
 
-    // look for z
-
-    modulo = uz & INDEX_NODE_BITWISE_MODULO;
-    quotient = uz >> INDEX_DIVIDE_BYTES;
-
-    while (1) {
-        // found!!!!
-        if (quotient == 0 && modulo == 0) {
-            return doubly_linked_list_node_pointer(
-                (const DoublyLinkedListNode *)currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE]);
-        }
-
-        currentNode = (void **)currentNode[modulo];
-
-        if (currentNode == NULL) {
-            // not found
-            return NULL;
-        }
-
-        if (quotient == 0) {
-            // making sure we're going to z in next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
-        }
+static void _index3d_slots_insert(Index3D *index, const uint32_t e) {
+    const Index3DEntry *entry = &index->entries[e];
+    uint32_t s = _index3d_hash(entry->x, entry->y, entry->z) & index->slotsMask;
+    while (index->slots[s].entry != INDEX3D_EMPTY_SLOT) {
+        s = (s + 1) & index->slotsMask;
     }
-
-    return NULL;
+    Index3DSlot *slot = &index->slots[s];
+    slot->x = entry->x;
+    slot->y = entry->y;
+    slot->z = entry->z;
+    slot->entry = e;
 }
 
-void index3d_batch_get_reset(const Index3D *index, void ***batchedNode) {
-    *batchedNode = index->topLevelNode;
+// empties a slot, moving back following entries so that no lookup is interrupted by a gap
+static void _index3d_slots_delete(Index3D *index, uint32_t s) {
+    uint32_t next = (s + 1) & index->slotsMask, home;
+    const Index3DSlot *slot;
+    while (index->slots[next].entry != INDEX3D_EMPTY_SLOT) {
+        slot = &index->slots[next];
+        home = _index3d_hash(slot->x, slot->y, slot->z) & index->slotsMask;
+        // move entry back if its home slot isn't cyclically in ]s, next]
+        if (((next - home) & index->slotsMask) >= ((next - s) & index->slotsMask)) {
+            index->slots[s] = *slot;
+            s = next;
+        }
+        next = (next + 1) & index->slotsMask;
+    }
+    index->slots[s].entry = INDEX3D_EMPTY_SLOT;
 }
 
-bool index3d_batch_get_advance(const int32_t value, void ***batchedNode) {
-    uint32_t modulo = (uint32_t)value & INDEX_NODE_BITWISE_MODULO;
-    uint32_t quotient = (uint32_t)value >> INDEX_DIVIDE_BYTES;
-
-    while (1) {
-        if (quotient == 0 && modulo == 0) {
-            *batchedNode = (void **)(*batchedNode)[INDEX_NODE_ARRAY_SIZE_MINUS_ONE];
-            if (*batchedNode == NULL) {
-                return false; // not found
-            }
-            break;
-        }
-
-        *batchedNode = (void **)(*batchedNode)[modulo];
-
-        if (*batchedNode == NULL) {
-            return false; // not found
-        }
-
-        if (quotient == 0) {
-            // making sure we're going to stop next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
+// empties all slots & inserts entries again, does not allocate
+static void _index3d_slots_reset(Index3D *index) {
+    for (uint32_t s = 0; s <= index->slotsMask; ++s) {
+        index->slots[s].entry = INDEX3D_EMPTY_SLOT;
+    }
+    for (uint32_t e = 0; e < index->entriesCount; ++e) {
+        if (index->entries[e].ptr != NULL) {
+            _index3d_slots_insert(index, e);
         }
     }
+}
 
+static bool _index3d_slots_rebuild(Index3D *index, const uint32_t capacity) {
+    Index3DSlot *slots = (Index3DSlot *)realloc(index->slots, capacity * sizeof(Index3DSlot));
+    if (slots == NULL) {
+        return false;
+    }
+    index->slots = slots;
+    index->slotsMask = capacity - 1;
+    _index3d_slots_reset(index);
     return true;
 }
 
-void *index3d_batch_get(const int32_t z, void **batchedNode) {
-    uint32_t modulo = (uint32_t)z & INDEX_NODE_BITWISE_MODULO;
-    uint32_t quotient = (uint32_t)z >> INDEX_DIVIDE_BYTES;
-
-    while (1) {
-        // found!!!!
-        if (quotient == 0 && modulo == 0) {
-            return doubly_linked_list_node_pointer(
-                (const DoublyLinkedListNode *)batchedNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE]);
-        }
-
-        batchedNode = (void **)batchedNode[modulo];
-
-        if (batchedNode == NULL) {
-            return NULL; // not found
-        }
-
-        if (quotient == 0) {
-            // making sure we're going to stop next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
+// moves iterators that went past the last entry back to end position
+static void _index3d_clamp_iterators(Index3D *index) {
+    for (Index3DIterator *it = index->iterators; it != NULL; it = it->next) {
+        if (it->current > index->entriesCount) {
+            it->current = index->entriesCount;
         }
     }
 }
 
-void *index3d_remove(Index3D *index,
-                     const int32_t x,
-                     const int32_t y,
-                     const int32_t z,
-                     Index3DIterator *it) {
-
-    // only use unsigned integers for bitwise operations:
-    uint32_t ux = (uint32_t)x;
-    uint32_t uy = (uint32_t)y;
-    uint32_t uz = (uint32_t)z;
-
-    void **currentNode = index->topLevelNode;
-
-    uint32_t modulo = ux & INDEX_NODE_BITWISE_MODULO;
-    uint32_t quotient = ux >> INDEX_DIVIDE_BYTES;
-
-    // look for x
-
-    while (1) {
-        // found, go to y
-        if (quotient == 0 && modulo == 0) {
-            currentNode = (void **)currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE];
-            if (currentNode == NULL) {
-                // not found
-                return NULL;
+// removes holes from entries, preserving order, iterators keep pointing to the same entries
+// (or the next one if they were on a hole), slots table is reused as is
+static void _index3d_compact(Index3D *index) {
+    uint32_t dst = 0;
+    for (uint32_t e = 0; e < index->entriesCount; ++e) {
+        // dst <= e, an iterator moved back can't match a following entry
+        for (Index3DIterator *it = index->iterators; it != NULL; it = it->next) {
+            if (it->current == e) {
+                it->current = dst;
             }
-            break;
         }
-
-        currentNode = (void **)currentNode[modulo];
-
-        if (currentNode == NULL) {
-            // not found
-            return NULL;
-        }
-
-        if (quotient == 0) {
-            // making sure we're going to y in next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
+        if (index->entries[e].ptr != NULL) {
+            index->entries[dst++] = index->entries[e];
         }
     }
+    index->entriesCount = dst;
+    _index3d_clamp_iterators(index);
 
-    // look for y
-
-    modulo = uy & INDEX_NODE_BITWISE_MODULO;
-    quotient = uy >> INDEX_DIVIDE_BYTES;
+    _index3d_slots_reset(index);
+}
 
-    while (1) {
-        // found, go to z
-        if (quotient == 0 && modulo == 0) {
-            currentNode = (void **)currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE];
-            if (currentNode == NULL) {
-                // not found
-                return NULL;
-            }
-            break;
+static bool _index3d_reserve(Index3D *index) {
+    if (index->entries == NULL) {
+        index->entries = (Index3DEntry *)malloc(INDEX3D_DEFAULT_ENTRIES_CAPACITY *
+                                                sizeof(Index3DEntry));
+        if (index->entries == NULL) {
+            return false;
         }
-
-        currentNode = (void **)currentNode[modulo];
-
-        if (currentNode == NULL) {
-            // not found
-            return NULL;
+        index->entriesCapacity = INDEX3D_DEFAULT_ENTRIES_CAPACITY;
+        if (_index3d_slots_rebuild(index, INDEX3D_DEFAULT_SLOTS_CAPACITY) == false) {
+            return false;
         }
+    }
 
-        if (quotient == 0) {
-            // making sure we're going to z in next loop
-            modulo = 0;
+    if (index->entriesCount == index->entriesCapacity) {
+        // reclaim holes if they account for at least 1/4 of the entries, grow otherwise
+        if (index->entriesCount - index->count >= index->entriesCapacity / 4) {
+            _index3d_compact(index);
         } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
+            const uint32_t capacity = index->entriesCapacity * 2;
+            Index3DEntry *entries = (Index3DEntry *)realloc(index->entries,
+                                                            capacity * sizeof(Index3DEntry));
+            if (entries == NULL) {
+                return false;
+            }
+            index->entries = entries;
+            index->entriesCapacity = capacity;
         }
     }
 
-    // look for z
+    const uint32_t slotsCapacity = index->slotsMask + 1;
+    if ((index->count + 1) * INDEX3D_SLOTS_MAX_LOAD_DEN >
+        slotsCapacity * INDEX3D_SLOTS_MAX_LOAD_NUM) {
+        return _index3d_slots_rebuild(index, slotsCapacity * 2);
+    }
 
-    modulo = uz & INDEX_NODE_BITWISE_MODULO;
-    quotient = uz >> INDEX_DIVIDE_BYTES;
+    return true;
+}
 
-    while (1) {
-        // found!!!!
-        if (quotient == 0 && modulo == 0) {
-            // Note: maybe the node itself can be destroyed if contains nothing
-            // else, but it's good enough for now.
-            void *node = currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE];
-            currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE] = NULL;
+// removes holes at the end of entries, so that the last entry is always in use
+static void _index3d_trim(Index3D *index) {
+    while (index->entriesCount > 0 && index->entries[index->entriesCount - 1].ptr == NULL) {
+        --index->entriesCount;
+    }
+    _index3d_clamp_iterators(index);
+}
 
-            // optionally maintain ongoing iterator, if at node being removed
-            if (it != NULL && it->current == node) {
-                it->current = doubly_linked_list_node_previous(it->current);
-            }
+static void _index3d_iterator_skip_holes(Index3DIterator *it) {
+    const Index3D *index = it->index;
+    while (it->current < index->entriesCount && index->entries[it->current].ptr == NULL) {
+        ++it->current;
+    }
+}
 
-            void *ptr = doubly_linked_list_node_pointer((const DoublyLinkedListNode *)node);
-            doubly_linked_list_delete_node(index->list, (DoublyLinkedListNode *)node);
-            return ptr;
-        }
+//-------------------
+// Index3D
+//-------------------
 
-        currentNode = (void **)currentNode[modulo];
+Index3D *index3d_new(void) {
+    Index3D *index = (Index3D *)malloc(sizeof(Index3D));
+    if (index == NULL) {
+        return NULL;
+    }
+    // storage is allocated on first insertion
+    index->entries = NULL;
+    index->slots = NULL;
+    index->iterators = NULL;
+    index->entriesCount = 0;
+    index->entriesCapacity = 0;
+    index->count = 0;
+    index->slotsMask = 0;
+    return index;
+}
 
-        if (currentNode == NULL) {
-            // not found
-            return NULL;
-        }
+void index3d_free(Index3D *index) {
+    if (index == NULL) {
+        return;
+    }
+    if (index3d_is_empty(index) == false) {
+        cclog_error("⚠️ index3d_free error: index is not empty (possible memory leak)");
+    }
+    // iterators can still be freed after their index
+    for (Index3DIterator *it = index->iterators; it != NULL; it = it->next) {
+        it->index = NULL;
+    }
+    free(index->entries);
+    free(index->slots);
+    free(index);
+}
 
-        if (quotient == 0) {
-            // making sure we're going to z in next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
+bool index3d_is_empty(const Index3D *const index) {
+    return index->count == 0;
+}
+
+void index3d_flush(Index3D *index, pointer_free_function ptr) {
+    if (index3d_is_empty(index) == true) {
+        return;
+    }
+    for (uint32_t e = 0; e < index->entriesCount; ++e) {
+        if (index->entries[e].ptr != NULL && ptr != NULL) {
+            ptr(index->entries[e].ptr);
         }
     }
-
-    return NULL;
+    index->entriesCount = 0;
+    index->count = 0;
+    for (uint32_t s = 0; s <= index->slotsMask; ++s) {
+        index->slots[s].entry = INDEX3D_EMPTY_SLOT;
+    }
+    _index3d_clamp_iterators(index);
 }
 
 void index3d_insert(Index3D *index,
@@ -339,184 +291,60 @@ void index3d_insert(Index3D *index,
                     const int32_t y,
                     const int32_t z,
                     Index3DIterator *it) {
+    vx_assert(ptr != NULL);
 
-    // only use unsigned integers for bitwise operations:
-    uint32_t ux = (uint32_t)x;
-    uint32_t uy = (uint32_t)y;
-    uint32_t uz = (uint32_t)z;
-
-    void **currentNode = index->topLevelNode;
-
-    uint32_t modulo = ux & INDEX_NODE_BITWISE_MODULO;
-    uint32_t quotient = ux >> INDEX_DIVIDE_BYTES;
-
-    // set x
-
-    while (1) {
-        // printf("x -- q: %u - m: %u\n", quotient, modulo);
-        // found, go to y
-        if (quotient == 0 && modulo == 0) {
-            if (currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE] == NULL) {
-                currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE] = _new_node();
-            }
-            currentNode = (void **)currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE];
-            break;
-        }
-
-        if (currentNode[modulo] == NULL) {
-            currentNode[modulo] = _new_node();
-        }
-        currentNode = (void **)currentNode[modulo];
-
-        if (quotient == 0) {
-            // making sure we're going to y in next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
-        }
+    // an entry already exists at given position, it is replaced and pushed last
+    if (_index3d_find_slot(index, x, y, z) != INDEX3D_EMPTY_SLOT) {
+        index3d_remove(index, x, y, z, NULL);
     }
 
-    // set y
-
-    modulo = uy & INDEX_NODE_BITWISE_MODULO;
-    quotient = uy >> INDEX_DIVIDE_BYTES;
-
-    while (1) {
-        // printf("y -- q: %u - m: %u\n", quotient, modulo);
-        // found, go to z
-        if (quotient == 0 && modulo == 0) {
-            if (currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE] == NULL) {
-                currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE] = _new_node();
-            }
-            currentNode = (void **)currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE];
-            break;
-        }
-
-        if (currentNode[modulo] == NULL) {
-            currentNode[modulo] = _new_node();
-        }
-        currentNode = (void **)currentNode[modulo];
-
-        if (quotient == 0) {
-            // making sure we're going to y in next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
-        }
+    if (_index3d_reserve(index) == false) {
+        cclog_error("index3d_insert: failed to allocate storage");
+        return;
     }
 
-    // set z
-
-    modulo = uz & INDEX_NODE_BITWISE_MODULO;
-    quotient = uz >> INDEX_DIVIDE_BYTES;
-
-    while (1) {
-        // printf("z -- q: %u - m: %u\n", quotient, modulo);
-        // found, go to z
-        if (quotient == 0 && modulo == 0) {
-            DoublyLinkedListNode *node = doubly_linked_list_push_last(index->list, ptr);
-            currentNode[INDEX_NODE_ARRAY_SIZE_MINUS_ONE] = node;
-
-            // optionally maintain ongoing iterator, if at the end
-            if (it != NULL && it->current == NULL) {
-                it->current = node;
-            }
-            break;
-        }
-
-        if (currentNode[modulo] == NULL) {
-            currentNode[modulo] = _new_node();
-        }
-        currentNode = (void **)currentNode[modulo];
+    // inserted last, an iterator at end position will now point to this entry
+    const uint32_t e = index->entriesCount++;
+    Index3DEntry *entry = &index->entries[e];
+    entry->ptr = ptr;
+    entry->x = x;
+    entry->y = y;
+    entry->z = z;
+    ++index->count;
 
-        if (quotient == 0) {
-            // making sure we're going to y in next loop
-            modulo = 0;
-        } else {
-            // go deeper
-            modulo = quotient & INDEX_NODE_BITWISE_MODULO;
-            quotient = quotient >> INDEX_DIVIDE_BYTES;
-        }
-    }
+    _index3d_slots_insert(index, e);
 }
 
-/// returns whether index is empty
-bool index3d_is_empty(const Index3D *const index) {
-    for (int i = 0; i < INDEX_NODE_ARRAY_SIZE; i++) {
-        if (index->topLevelNode[i] != NULL) {
-            return false;
-        }
+void *index3d_get(const Index3D *index, const int32_t x, const int32_t y, const int32_t z) {
+    const uint32_t s = _index3d_find_slot(index, x, y, z);
+    if (s == INDEX3D_EMPTY_SLOT) {
+        return NULL;
     }
-    return true;
+    return index->entries[index->slots[s].entry].ptr;
 }
 
-void index3d_flush_node(Index3D *index,
-                        void **node,
-                        uint8_t dimension,
-                        pointer_free_function freePtr) {
-    if (node == NULL)
-        return;
-
-    int lastIndex = INDEX_NODE_ARRAY_SIZE_MINUS_ONE;
-
-    for (int i = 0; i < lastIndex; ++i) {
-        if (node[i] != NULL) {
-            index3d_flush_node(index, (void **)(node[i]), dimension, freePtr);
-            free(node[i]);
-            node[i] = NULL;
-        }
+void *index3d_remove(Index3D *index,
+                     const int32_t x,
+                     const int32_t y,
+                     const int32_t z,
+                     Index3DIterator *it) {
+    const uint32_t s = _index3d_find_slot(index, x, y, z);
+    if (s == INDEX3D_EMPTY_SLOT) {
+        return NULL;
     }
 
-    // go to next dimension or free content if looking in 3rd one
-    if (node[lastIndex] != NULL) {
-        if (dimension < 3) {
-            index3d_flush_node(index, (void **)(node[lastIndex]), dimension + 1, freePtr);
-            free(node[lastIndex]);
-            node[lastIndex] = NULL;
-        } else {
-            void *ptr = doubly_linked_list_node_pointer(
-                (const DoublyLinkedListNode *)(node[lastIndex]));
-            if (freePtr != NULL) {
-                freePtr(ptr);
-            }
-            doubly_linked_list_delete_node(index->list, (DoublyLinkedListNode *)(node[lastIndex]));
-            node[lastIndex] = NULL;
-        }
-    }
-}
+    const uint32_t e = index->slots[s].entry;
+    void *ptr = index->entries[e].ptr;
+    index->entries[e].ptr = NULL;
+    --index->count;
+    _index3d_slots_delete(index, s);
 
-Index3D *index3d_new(void) {
-    Index3D *index = (Index3D *)malloc(sizeof(Index3D));
-    index->topLevelNode = _new_node();
-    index->list = doubly_linked_list_new();
-    return index;
-}
-
-void index3d_free(Index3D *index) {
-    if (index == NULL) {
-        return;
-    }
-    if (index3d_is_empty(index) == false) {
-        cclog_error("⚠️ index3d_free error: index is not empty (possible memory leak)");
+    // entries are reused from the last one in use (from the start if index is now empty)
+    if (e == index->entriesCount - 1) {
+        _index3d_trim(index);
     }
-    doubly_linked_list_free(index->list);
-    free(index->topLevelNode);
-    free(index);
-}
 
-void index3d_flush(Index3D *index, pointer_free_function ptr) {
-    if (index3d_is_empty(index) == true) {
-        return;
-    }
-    // list nodes are freed correctly within index3d_flush_node
-    index3d_flush_node(index, index->topLevelNode, 1, ptr);
-    // so it's now safe to free the list and create a new one
-    doubly_linked_list_free(index->list);
-    index->list = doubly_linked_list_new();
+    return ptr;
 }
 
 //-------------------
@@ -525,23 +353,53 @@ void index3d_flush(Index3D *index, pointer_free_function ptr) {
 
 Index3DIterator *index3d_iterator_new(Index3D *index) {
     Index3DIterator *it = (Index3DIterator *)malloc(sizeof(Index3DIterator));
-    it->current = doubly_linked_list_first(index->list);
+    if (it == NULL) {
+        return NULL;
+    }
+    it->index = index;
+    it->prev = NULL;
+    it->next = index->iterators;
+    if (index->iterators != NULL) {
+        index->iterators->prev = it;
+    }
+    index->iterators = it;
+    it->current = 0;
+    _index3d_iterator_skip_holes(it);
     return it;
 }
 
 void index3d_iterator_free(Index3DIterator *it) {
-    // the list nodes are the Index3D's responsibility
+    if (it == NULL) {
+        return;
+    }
+    if (it->index != NULL) {
+        if (it->prev != NULL) {
+            it->prev->next = it->next;
+        } else {
+            it->index->iterators = it->next;
+        }
+        if (it->next != NULL) {
+            it->next->prev = it->prev;
+        }
+    }
     free(it);
 }
 
 void *index3d_iterator_pointer(const Index3DIterator *it) {
-    return doubly_linked_list_node_pointer(it->current);
+    if (it->current >= it->index->entriesCount) {
+        return NULL;
+    }
+    return it->index->entries[it->current].ptr;
 }
 
 void index3d_iterator_next(Index3DIterator *it) {
-    it->current = doubly_linked_list_node_next(it->current);
+    if (it->current < it->index->entriesCount) {
+        ++it->current;
+        _index3d_iterator_skip_holes(it);
+    }
 }
 
 bool index3d_iterator_is_at_end(const Index3DIterator *it) {
-    return doubly_linked_list_node_next(it->current) == NULL;
+    // last entry is never a hole
+    return it->current + 1 >= it->index->entriesCount;
 }
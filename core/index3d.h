@@ -4,12 +4,10 @@
 //  Created by Adrien Duermael on December 3, 2016.
 // -------------------------------------------------------------
 
-// index3d can be used to store pointers in 3d space
-// storing and retrieving pointers is a little slower compared
-// to 3d arrays. But it takes a lot less space in memory and
-// request time is constant and reliable.
-// index3d also automatically stores pointers in a doubly_linked_list, in no
-// specific order. It's useful when we want to iterate over all entries quickly.
+// index3d can be used to store pointers in 3d space.
+// Pointers are stored contiguously in insertion order, for fast iteration over all entries,
+// and looked up through an open-addressing hash table of their coordinates: lookups cost
+// a hash & a few probes, whatever the coordinates.
 
 #pragma once
 
@@ -21,13 +19,13 @@ extern "C" {
 #include <stdint.h>
 #include <stdio.h>
 
-#include "doubly_linked_list.h"
 #include "function_pointers.h"
 
 typedef struct _Index3D Index3D;
 
-// Index3DIterator can be used to quickly iterate over all stored pointers
-// (uses the doubly_linked_list)
+// Index3DIterator can be used to quickly iterate over all stored pointers, in insertion order.
+// All iterators created on an index remain valid through insertions & removals, including when
+// storage is compacted. They must not be used after index3d_free, but can still be freed.
 typedef struct _Index3DIterator Index3DIterator;
 
 // constructor
@@ -47,7 +45,10 @@ bool index3d_is_empty(const Index3D *const index);
 // see world.c/entity_list_with_distance_free to help for implementation
 void index3d_flush(Index3D *index, pointer_free_function ptr);
 
-// index3d_insert inserts ptr at given position, optionally maintaining given iterator
+// index3d_insert inserts ptr at given position
+// ptr is inserted last, iterators at end position will point to it
+// if a pointer was already stored at that position, it is replaced
+// `it` can be NULL, all iterators of the index are maintained anyway
 void index3d_insert(Index3D *index,
                     void *ptr,
                     const int32_t x,
@@ -57,12 +58,12 @@ void index3d_insert(Index3D *index,
 
 // index3d_get returns pointer at given position. NULL can be returned
 void *index3d_get(const Index3D *index, const int32_t x, const int32_t y, const int32_t z);
-void index3d_batch_get_reset(const Index3D *index, void ***batchedNode);
-bool index3d_batch_get_advance(const int32_t value, void ***batchedNode);
-void *index3d_batch_get(const int32_t z, void **batchedNode);
 
-// index3d_remove removes ptr from index at given position, optionally maintaining given iterator
+// index3d_remove removes ptr from index at given position
 // @returns removed pointer or NULL if not found. Its caller's responsibility to free memory.
+// If an iterator was pointing to removed ptr, index3d_iterator_pointer returns NULL until
+// index3d_iterator_next is called, moving it to the following entry.
+// `it` can be NULL, all iterators of the index are maintained anyway
 void *index3d_remove(Index3D *index,
                      const int32_t x,
                      const int32_t y,
@@ -81,7 +82,7 @@ void *index3d_iterator_pointer(const Index3DIterator *it);
 // moves iterator to next position
 void index3d_iterator_next(Index3DIterator *it);
 
-// returns 1 if iterator is at end position, 0 otherwise
+// returns true if there is no entry after iterator's current position
 bool index3d_iterator_is_at_end(const Index3DIterator *it);
 
 #ifdef __cplusplus
@@ -604,6 +604,40 @@ void *octree_get_element_without_checking(const Octree *octree,
             octree->element_size * octree_element_index_1d(octree, x, y, z));
 }
 
+void *octree_get_element_fast(const Octree *octree,
+                              const size_t x,
+                              const size_t y,
+                              const size_t z) {
+    // octree dimension is 2^levels
+    return ((char *)octree->elements +
+            octree->element_size * ((((z << octree->levels) | y) << octree->levels) | x));
+}
+
+bool octree_get_elements_slab(const Octree *octree,
+                              const size_t x,
+                              const size_t y,
+                              const size_t z,
+                              const size_t w,
+                              const size_t h,
+                              const size_t d,
+                              void *out) {
+    if (x + w > octree->width_height_depth || y + h > octree->width_height_depth ||
+        z + d > octree->width_height_depth) {
+        return false;
+    }
+
+    // rows along x are contiguous
+    const size_t rowSize = w * octree->element_size;
+    char *cursor = (char *)out;
+    for (size_t k = z; k < z + d; ++k) {
+        for (size_t j = y; j < y + h; ++j) {
+            memcpy(cursor, octree_get_element_fast(octree, x, j, k), rowSize);
+            cursor += rowSize;
+        }
+    }
+    return true;
+}
+
 void octree_log(const Octree *octree) {
     cclog_trace("----- OCTREE -----");
     cclog_info("- levels: %hhu", octree->levels);
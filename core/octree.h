@@ -52,6 +52,22 @@ void *octree_get_element_without_checking(const Octree *octree,
                                           const size_t y,
                                           const size_t z);
 
+/// Always return the data at given coordinates (could be default value), in O(1) & without
+/// bounds checking: x, y & z have to be lower than octree_get_dimension.
+void *octree_get_element_fast(const Octree *octree, const size_t x, const size_t y, const size_t z);
+
+/// Copies elements in box [x, x + w[ * [y, y + h[ * [z, z + d[ into out (w * h * d elements),
+/// ordered like octree elements: x first, then y, then z. Empty cells give the default value.
+/// Returns false if the box isn't fully within the octree.
+bool octree_get_elements_slab(const Octree *octree,
+                              const size_t x,
+                              const size_t y,
+                              const size_t z,
+                              const size_t w,
+                              const size_t h,
+                              const size_t d,
+                              void *out);
+
 /// Useful if using octree to store arbitrary values in empty nodes ;
 /// if node is empty, *element will be set to NULL and *empty will point
 /// to what's currently stored at (x, y, z).
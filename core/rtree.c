@@ -14,11 +14,24 @@
 #include "transform.h"
 
 #if DEBUG_RTREE
-static int debug_rtree_insert_calls = 0;
-static int debug_rtree_split_calls = 0;
-static int debug_rtree_remove_calls = 0;
-static int debug_rtree_condense_calls = 0;
-static int debug_rtree_update_calls = 0;
+// atomic, shapes can be built on worker threads (see serialization_load_assets nbThreads)
+#if defined(__VX_PLATFORM_WINDOWS)
+#include <intrin.h>
+typedef volatile long DebugRtreeCounter;
+#define DEBUG_RTREE_COUNTER_INCREMENT(c) _InterlockedIncrement(&(c))
+#define DEBUG_RTREE_COUNTER_GET(c) (int)_InterlockedOr(&(c), 0)
+#define DEBUG_RTREE_COUNTER_RESET(c) _InterlockedExchange(&(c), 0)
+#else
+typedef int DebugRtreeCounter;
+#define DEBUG_RTREE_COUNTER_INCREMENT(c) __atomic_fetch_add(&(c), 1, __ATOMIC_RELAXED)
+#define DEBUG_RTREE_COUNTER_GET(c) __atomic_load_n(&(c), __ATOMIC_RELAXED)
+#define DEBUG_RTREE_COUNTER_RESET(c) __atomic_store_n(&(c), 0, __ATOMIC_RELAXED)
+#endif
+static DebugRtreeCounter debug_rtree_insert_calls = 0;
+static DebugRtreeCounter debug_rtree_split_calls = 0;
+static DebugRtreeCounter debug_rtree_remove_calls = 0;
+static DebugRtreeCounter debug_rtree_condense_calls = 0;
+static DebugRtreeCounter debug_rtree_update_calls = 0;
 #endif
 
 /// Ref: https://books.google.fr/books?id=1mu099DN9UwC&pg=PR5&redir_esc=y#v=onepage&q&f=false
@@ -369,7 +382,7 @@ RtreeNode *_rtree_split_node_quadratic(Rtree *r, RtreeNode *toSplit) {
     vx_assert(rnSplit2->count >= r->m && rnSplit2->count <= r->M);
 
 #if DEBUG_RTREE_CALLS
-    debug_rtree_split_calls++;
+    DEBUG_RTREE_COUNTER_INCREMENT(debug_rtree_split_calls);
 #endif
 #if DEBUG_RTREE_EXTRA_LOGS
     if (heightIncreased) {
@@ -481,7 +494,7 @@ void _rtree_condense(Rtree *r, RtreeNode *start) {
     fifo_list_free(toRemove, NULL);
 
 #if DEBUG_RTREE_CALLS
-    debug_rtree_condense_calls++;
+    DEBUG_RTREE_COUNTER_INCREMENT(debug_rtree_condense_calls);
 #endif
 #if DEBUG_RTREE_EXTRA_LOGS
     if (removalCount > 0 || reinsertCount > 0) {
@@ -492,6 +505,35 @@ void _rtree_condense(Rtree *r, RtreeNode *start) {
 #endif
 }
 
+void _rtree_cast_results_sift_down(RtreeCastResult *hits, size_t count, size_t i) {
+    RtreeCastResult tmp;
+    size_t smallest, l, r;
+    while (true) {
+        smallest = i;
+        l = 2 * i + 1;
+        r = l + 1;
+        if (l < count && hits[l].distance < hits[smallest].distance) {
+            smallest = l;
+        }
+        if (r < count && hits[r].distance < hits[smallest].distance) {
+            smallest = r;
+        }
+        if (smallest == i) {
+            return;
+        }
+        tmp = hits[i];
+        hits[i] = hits[smallest];
+        hits[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+int _rtree_cast_results_compare_func(const void *a, const void *b) {
+    const float d1 = ((const RtreeCastResult *)a)->distance;
+    const float d2 = ((const RtreeCastResult *)b)->distance;
+    return d1 < d2 ? -1 : (d1 > d2 ? 1 : 0);
+}
+
 // MARK: - Public functions -
 
 Rtree *rtree_new(uint8_t m, uint8_t M) {
@@ -657,7 +699,7 @@ void rtree_insert(Rtree *r, RtreeNode *leaf) {
     }
 
 #if DEBUG_RTREE_CALLS
-    debug_rtree_insert_calls++;
+    DEBUG_RTREE_COUNTER_INCREMENT(debug_rtree_insert_calls);
 #endif
 #if DEBUG_RTREE_EXTRA_LOGS
     cclog_debug("🏞 r-tree node inserted w/ %d box merge, %d box reset & %d split",
@@ -707,7 +749,7 @@ void rtree_remove(Rtree *r, RtreeNode *leaf, bool freeLeaf) {
     }
 
 #if DEBUG_RTREE_CALLS
-    debug_rtree_remove_calls++;
+    DEBUG_RTREE_COUNTER_INCREMENT(debug_rtree_remove_calls);
 #endif
 #if DEBUG_RTREE_EXTRA_LOGS
     if (heightDecreased) {
@@ -760,7 +802,7 @@ void rtree_update(Rtree *r, RtreeNode *leaf, Box *aabb) {
             rn = rn->parent;
         }
 #if DEBUG_RTREE_CALLS
-        debug_rtree_update_calls++;
+        DEBUG_RTREE_COUNTER_INCREMENT(debug_rtree_update_calls);
 #endif
     } else {
         rtree_remove(r, leaf, false);
@@ -851,7 +893,7 @@ size_t rtree_query_cast_all_func(Rtree *r,
                                  pointer_rtree_query_cast_all_func func,
                                  void *ptr,
                                  const DoublyLinkedList *excludeLeafPtrs,
-                                 DoublyLinkedList *results) {
+                                 RtreeCastResults *results) {
     vx_assert(results != NULL);
 
     FifoList *toExamine = fifo_list_new();
@@ -859,7 +901,6 @@ size_t rtree_query_cast_all_func(Rtree *r,
     RtreeNode *rn, *child;
     size_t hits = 0;
     float dist;
-    RtreeCastResult *result;
 
     rn = r->root;
     while (rn != NULL) {
@@ -878,11 +919,7 @@ size_t rtree_query_cast_all_func(Rtree *r,
                 } else if (excludeLeafPtrs == NULL ||
                            doubly_linked_list_contains(excludeLeafPtrs, child->leaf) == false) {
 
-                    result = malloc(sizeof(RtreeCastResult));
-                    if (result != NULL) {
-                        result->rtreeLeaf = child;
-                        result->distance = dist;
-                        doubly_linked_list_push_last(results, result);
+                    if (rtree_cast_results_push(results, child, dist)) {
                         hits++;
                     }
                 }
@@ -907,7 +944,7 @@ size_t rtree_query_cast_all_ray(Rtree *r,
                                 uint16_t groups,
                                 uint16_t collidesWith,
                                 const DoublyLinkedList *excludeLeafPtrs,
-                                DoublyLinkedList *results) {
+                                RtreeCastResults *results) {
 
     return rtree_query_cast_all_func(r,
                                      groups,
@@ -927,14 +964,14 @@ size_t rtree_query_cast_all_box_step_func(Rtree *r,
                                           uint16_t collidesWith,
                                           void *optionalPtr,
                                           const DoublyLinkedList *excludeLeafPtrs,
-                                          DoublyLinkedList *results,
+                                          RtreeCastResults *results,
                                           const float3 *epsilon) {
 
     float swept;
     RtreeNode *hit;
     FifoList *query = fifo_list_new();
-    RtreeCastResult *result;
     size_t hits = 0;
+    const float stepLength = float3_length(step3);
 
     if (rtree_query_overlap_box(r,
                                 broadPhaseBox,
@@ -950,11 +987,9 @@ size_t rtree_query_cast_all_box_step_func(Rtree *r,
             if ((excludeLeafPtrs == NULL ||
                  doubly_linked_list_contains(excludeLeafPtrs, hit->leaf) == false)) {
 
-                result = malloc(sizeof(RtreeCastResult));
-                if (result != NULL) {
-                    result->rtreeLeaf = hit;
-                    result->distance = stepStartDistance + swept * float3_length(step3);
-                    doubly_linked_list_push_last(results, result);
+                if (rtree_cast_results_push(results,
+                                            hit,
+                                            stepStartDistance + swept * stepLength)) {
                     hits++;
                 }
             }
@@ -975,7 +1010,7 @@ size_t rtree_query_cast_all_box(Rtree *r,
                                 uint16_t groups,
                                 uint16_t collidesWith,
                                 const DoublyLinkedList *excludeLeafPtrs,
-                                DoublyLinkedList *results,
+                                RtreeCastResults *results,
                                 const float3 *epsilon) {
 
     return rtree_utils_broadphase_steps(r,
@@ -1002,7 +1037,7 @@ size_t rtree_utils_broadphase_steps(Rtree *r,
                                     pointer_rtree_broadphase_step_func func,
                                     void *optionalPtr,
                                     const DoublyLinkedList *excludeLeafPtrs,
-                                    DoublyLinkedList *results,
+                                    RtreeCastResults *results,
                                     const float3 *epsilon) {
     vx_assert(results != NULL);
 
@@ -1038,40 +1073,106 @@ size_t rtree_utils_broadphase_steps(Rtree *r,
     return hits;
 }
 
-bool rtree_utils_result_sort_func(DoublyLinkedListNode *n1, DoublyLinkedListNode *n2) {
-    return ((RtreeCastResult *)doubly_linked_list_node_pointer(n1))->distance >
-           ((RtreeCastResult *)doubly_linked_list_node_pointer(n2))->distance;
+// MARK: Cast results
+
+void rtree_cast_results_init(RtreeCastResults *results) {
+    results->hits = NULL;
+    results->count = 0;
+    results->capacity = 0;
+    results->isHeap = false;
+}
+
+void rtree_cast_results_release(RtreeCastResults *results) {
+    free(results->hits);
+    rtree_cast_results_init(results);
+}
+
+bool rtree_cast_results_push(RtreeCastResults *results, RtreeNode *leaf, float distance) {
+    if (results->count == results->capacity) {
+        const size_t capacity = results->capacity == 0 ? RTREE_CAST_RESULTS_DEFAULT_CAPACITY
+                                                       : results->capacity * 2;
+        RtreeCastResult *hits = (RtreeCastResult *)realloc(results->hits,
+                                                           capacity * sizeof(RtreeCastResult));
+        if (hits == NULL) {
+            return false;
+        }
+        results->hits = hits;
+        results->capacity = capacity;
+    }
+    RtreeCastResult *hit = &results->hits[results->count++];
+    hit->rtreeLeaf = leaf;
+    hit->distance = distance;
+    results->isHeap = false;
+    return true;
+}
+
+size_t rtree_cast_results_count(const RtreeCastResults *results) {
+    return results->count;
+}
+
+const RtreeCastResult *rtree_cast_results_get(const RtreeCastResults *results, size_t i) {
+    return i < results->count ? &results->hits[i] : NULL;
+}
+
+bool rtree_cast_results_pop_nearest(RtreeCastResults *results, RtreeCastResult *out) {
+    if (results->count == 0) {
+        return false;
+    }
+
+    if (results->isHeap == false) {
+        for (size_t i = results->count / 2; i > 0; --i) {
+            _rtree_cast_results_sift_down(results->hits, results->count, i - 1);
+        }
+        results->isHeap = true;
+    }
+
+    *out = results->hits[0];
+    results->hits[0] = results->hits[--results->count];
+    _rtree_cast_results_sift_down(results->hits, results->count, 0);
+
+    return true;
+}
+
+void rtree_cast_results_sort(RtreeCastResults *results) {
+    if (results->count > 1) {
+        qsort(results->hits,
+              results->count,
+              sizeof(RtreeCastResult),
+              _rtree_cast_results_compare_func);
+    }
+    // a sorted array is a valid min-heap
+    results->isHeap = true;
 }
 
 // MARK: - Debug functions -
 #if DEBUG_RTREE
 
 int debug_rtree_get_insert_calls(void) {
-    return debug_rtree_insert_calls;
+    return DEBUG_RTREE_COUNTER_GET(debug_rtree_insert_calls);
 }
 
 int debug_rtree_get_split_calls(void) {
-    return debug_rtree_split_calls;
+    return DEBUG_RTREE_COUNTER_GET(debug_rtree_split_calls);
 }
 
 int debug_rtree_get_remove_calls(void) {
-    return debug_rtree_remove_calls;
+    return DEBUG_RTREE_COUNTER_GET(debug_rtree_remove_calls);
 }
 
 int debug_rtree_get_condense_calls(void) {
-    return debug_rtree_condense_calls;
+    return DEBUG_RTREE_COUNTER_GET(debug_rtree_condense_calls);
 }
 
 int debug_rtree_get_update_calls(void) {
-    return debug_rtree_update_calls;
+    return DEBUG_RTREE_COUNTER_GET(debug_rtree_update_calls);
 }
 
 void debug_rtree_reset_calls(void) {
-    debug_rtree_insert_calls = 0;
-    debug_rtree_split_calls = 0;
-    debug_rtree_remove_calls = 0;
-    debug_rtree_condense_calls = 0;
-    debug_rtree_update_calls = 0;
+    DEBUG_RTREE_COUNTER_RESET(debug_rtree_insert_calls);
+    DEBUG_RTREE_COUNTER_RESET(debug_rtree_split_calls);
+    DEBUG_RTREE_COUNTER_RESET(debug_rtree_remove_calls);
+    DEBUG_RTREE_COUNTER_RESET(debug_rtree_condense_calls);
+    DEBUG_RTREE_COUNTER_RESET(debug_rtree_update_calls);
 }
 
 bool debug_rtree_integrity_check(Rtree *r) {
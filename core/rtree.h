@@ -37,6 +37,7 @@ extern "C" {
 
 typedef struct _Rtree Rtree;
 typedef struct _RtreeNode RtreeNode;
+typedef struct RtreeCastResults RtreeCastResults;
 typedef void (*pointer_rtree_recurse_func)(RtreeNode *rn);
 typedef bool (*pointer_rtree_query_overlap_func)(RtreeNode *rn, void *ptr, const float3 *epsilon);
 typedef bool (*pointer_rtree_query_cast_all_func)(RtreeNode *rn, void *ptr, float *distance);
@@ -49,7 +50,7 @@ typedef size_t (*pointer_rtree_broadphase_step_func)(Rtree *r,
                                                      uint16_t collidesWith,
                                                      void *optionalPtr,
                                                      const DoublyLinkedList *excludeLeafPtrs,
-                                                     DoublyLinkedList *results,
+                                                     RtreeCastResults *results,
                                                      const float3 *epsilon);
 
 typedef struct RtreeCastResult {
@@ -59,6 +60,19 @@ typedef struct RtreeCastResult {
     char pad[4];
 } RtreeCastResult;
 
+/// Array buffer for CAST ALL queries, hits are stored by value (no allocation per hit).
+/// Hits can be consumed by ascending distance w/ rtree_cast_results_pop_nearest, which lazily
+/// arranges the buffer as a binary min-heap: finding the nearest hits doesn't require sorting
+/// all of them.
+struct RtreeCastResults {
+    RtreeCastResult *hits;
+    size_t count;
+    size_t capacity;
+    bool isHeap;
+
+    char pad[7];
+};
+
 Rtree *rtree_new(uint8_t m, uint8_t M);
 void rtree_free(Rtree *r);
 
@@ -99,7 +113,7 @@ void rtree_refresh_collision_masks(Rtree *r);
 ///
 /// Each query returns,
 /// - OVERLAP: directly fills the 'results' parameter w/ leaf ptr
-/// - CAST ALL: populates the 'results' parameter w/ RtreeCastResult structs, to be freed by caller
+/// - CAST ALL: populates the 'results' buffer w/ RtreeCastResult structs, in no particular order
 /// - CAST: returns only 1 hit, but parameter 'excludeLeafPtrs' can be used to add a few exceptions
 ///
 /// Two usages for collision masks in queries,
@@ -126,13 +140,13 @@ size_t rtree_query_cast_all_func(Rtree *r,
                                  pointer_rtree_query_cast_all_func func,
                                  void *ptr,
                                  const DoublyLinkedList *excludeLeafPtrs,
-                                 DoublyLinkedList *results);
+                                 RtreeCastResults *results);
 size_t rtree_query_cast_all_ray(Rtree *r,
                                 const Ray *worldRay,
                                 uint16_t groups,
                                 uint16_t collidesWith,
                                 const DoublyLinkedList *excludeLeafPtrs,
-                                DoublyLinkedList *results);
+                                RtreeCastResults *results);
 size_t rtree_query_cast_all_box_step_func(Rtree *r,
                                           const Box *stepOriginBox,
                                           float stepStartDistance,
@@ -142,7 +156,7 @@ size_t rtree_query_cast_all_box_step_func(Rtree *r,
                                           uint16_t collidesWith,
                                           void *optionalPtr,
                                           const DoublyLinkedList *excludeLeafPtrs,
-                                          DoublyLinkedList *results,
+                                          RtreeCastResults *results,
                                           const float3 *epsilon);
 size_t rtree_query_cast_all_box(Rtree *r,
                                 const Box *aabb,
@@ -151,9 +165,24 @@ size_t rtree_query_cast_all_box(Rtree *r,
                                 uint16_t groups,
                                 uint16_t collidesWith,
                                 const DoublyLinkedList *excludeLeafPtrs,
-                                DoublyLinkedList *results,
+                                RtreeCastResults *results,
                                 const float3 *epsilon);
 
+/// MARK: - Cast results -
+void rtree_cast_results_init(RtreeCastResults *results);
+/// Frees hits storage, the RtreeCastResults struct itself is not freed
+void rtree_cast_results_release(RtreeCastResults *results);
+/// Returns false if the hit couldn't be stored (allocation failure)
+bool rtree_cast_results_push(RtreeCastResults *results, RtreeNode *leaf, float distance);
+size_t rtree_cast_results_count(const RtreeCastResults *results);
+/// Access by index, in no particular order unless rtree_cast_results_sort was called
+const RtreeCastResult *rtree_cast_results_get(const RtreeCastResults *results, size_t i);
+/// Removes nearest remaining hit and copies it in 'out', O(log n) after a O(n) heapify on first
+/// call ; returns false if there are no more hits
+bool rtree_cast_results_pop_nearest(RtreeCastResults *results, RtreeCastResult *out);
+/// Sorts all hits by ascending distance, O(n log n)
+void rtree_cast_results_sort(RtreeCastResults *results);
+
 /// MARK: - Utils -
 size_t rtree_utils_broadphase_steps(Rtree *r,
                                     const Box *originBox,
@@ -164,9 +193,8 @@ size_t rtree_utils_broadphase_steps(Rtree *r,
                                     pointer_rtree_broadphase_step_func func,
                                     void *optionalPtr,
                                     const DoublyLinkedList *excludeLeafPtrs,
-                                    DoublyLinkedList *results,
+                                    RtreeCastResults *results,
                                     const float3 *epsilon);
-bool rtree_utils_result_sort_func(DoublyLinkedListNode *n1, DoublyLinkedListNode *n2);
 
 /// MARK: - Debug -
 #if DEBUG_RTREE
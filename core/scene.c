@@ -543,6 +543,11 @@ void scene_register_awake_block_box(Scene *sc,
     scene_register_awake_box(sc, worldBox);
 }
 
+bool _scene_cast_result_sort_func(DoublyLinkedListNode *n1, DoublyLinkedListNode *n2) {
+    return ((CastResult *)doubly_linked_list_node_pointer(n1))->distance >
+           ((CastResult *)doubly_linked_list_node_pointer(n2))->distance;
+}
+
 CastResult scene_cast_result_default(void) {
     CastResult hit;
     hit.hitTr = NULL;
@@ -570,29 +575,25 @@ HitType scene_cast_ray(Scene *sc,
         return Hit_None;
     }
 
-    DoublyLinkedList *sceneQuery = doubly_linked_list_new();
+    RtreeCastResults sceneQuery;
+    rtree_cast_results_init(&sceneQuery);
     if (rtree_query_cast_all_ray(sc->rtree,
                                  worldRay,
                                  PHYSICS_GROUP_NONE,
                                  groups,
                                  filterOutTransforms,
-                                 sceneQuery) > 0) {
-
-        // sort query results by distance
-        doubly_linked_list_sort_ascending(sceneQuery, rtree_utils_result_sort_func);
+                                 &sceneQuery) > 0) {
 
-        // process query results in order, to return first hit block or collision box
-        DoublyLinkedListNode *n = doubly_linked_list_first(sceneQuery);
-        RtreeCastResult *rtreeHit;
+        // process query results by ascending distance, to return first hit block or collision box
+        RtreeCastResult rtreeHit;
         Transform *hitTr;
         RigidBody *hitRb;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
-            hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
+        while (rtree_cast_results_pop_nearest(&sceneQuery, &rtreeHit)) {
+            hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit.rtreeLeaf);
             hitRb = transform_get_rigidbody(hitTr);
 
             // re-examine closer hits after updating hit.distance vs. per-block or rotated collider
-            if (rtreeHit->distance >= hit.distance) {
+            if (rtreeHit.distance >= hit.distance) {
                 break;
             }
 
@@ -600,7 +601,7 @@ HitType scene_cast_ray(Scene *sc,
 
             if (mode == RigidbodyMode_Dynamic) {
                 hit.hitTr = hitTr;
-                hit.distance = rtreeHit->distance;
+                hit.distance = rtreeHit.distance;
                 hit.type = Hit_CollisionBox;
             } else if (transform_get_type(hitTr) == ShapeTransform &&
                        rigidbody_uses_per_block_collisions(transform_get_rigidbody(hitTr))) {
@@ -644,12 +645,9 @@ HitType scene_cast_ray(Scene *sc,
 
                 ray_free(modelRay);
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(sceneQuery, free);
-    doubly_linked_list_free(sceneQuery);
+    rtree_cast_results_release(&sceneQuery);
 
     if (result != NULL) {
         *result = hit;
@@ -668,23 +666,23 @@ size_t scene_cast_all_ray(Scene *sc,
         return 0;
     }
 
-    DoublyLinkedList *sceneQuery = doubly_linked_list_new();
+    RtreeCastResults sceneQuery;
+    rtree_cast_results_init(&sceneQuery);
     size_t count = 0;
     if (rtree_query_cast_all_ray(sc->rtree,
                                  worldRay,
                                  PHYSICS_GROUP_NONE,
                                  groups,
                                  filterOutTransforms,
-                                 sceneQuery) > 0) {
+                                 &sceneQuery) > 0) {
 
         // process query results to confirm intersections w/ per-block and rotated colliders
-        DoublyLinkedListNode *n = doubly_linked_list_first(sceneQuery);
-        RtreeCastResult *rtreeHit;
+        const RtreeCastResult *rtreeHit;
         Transform *hitTr;
         RigidBody *hitRb;
         CastResult *hit;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
+        for (size_t i = 0; i < rtree_cast_results_count(&sceneQuery); ++i) {
+            rtreeHit = rtree_cast_results_get(&sceneQuery, i);
             hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
             hitRb = transform_get_rigidbody(hitTr);
             hit = NULL;
@@ -741,15 +739,12 @@ size_t scene_cast_all_ray(Scene *sc,
                 doubly_linked_list_push_last(results, hit);
                 ++count;
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(sceneQuery, free);
-    doubly_linked_list_free(sceneQuery);
+    rtree_cast_results_release(&sceneQuery);
 
     // sort query results by distance
-    doubly_linked_list_sort_ascending(results, rtree_utils_result_sort_func);
+    doubly_linked_list_sort_ascending(results, _scene_cast_result_sort_func);
 
     return count;
 }
@@ -806,7 +801,8 @@ HitType scene_cast_box(Scene *sc,
         return Hit_None;
     }
 
-    DoublyLinkedList *sceneQuery = doubly_linked_list_new();
+    RtreeCastResults sceneQuery;
+    rtree_cast_results_init(&sceneQuery);
     if (rtree_query_cast_all_box(sc->rtree,
                                  aabb,
                                  unit,
@@ -814,24 +810,19 @@ HitType scene_cast_box(Scene *sc,
                                  PHYSICS_GROUP_NONE,
                                  groups,
                                  filterOutTransforms,
-                                 sceneQuery,
+                                 &sceneQuery,
                                  &float3_epsilon_collision)) {
 
-        // sort query results by distance
-        doubly_linked_list_sort_ascending(sceneQuery, rtree_utils_result_sort_func);
-
-        // process query results in order, to return first hit block or collision box
-        DoublyLinkedListNode *n = doubly_linked_list_first(sceneQuery);
-        RtreeCastResult *rtreeHit;
+        // process query results by ascending distance, to return first hit block or collision box
+        RtreeCastResult rtreeHit;
         Transform *hitTr;
         RigidBody *hitRb;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
-            hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
+        while (rtree_cast_results_pop_nearest(&sceneQuery, &rtreeHit)) {
+            hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit.rtreeLeaf);
             hitRb = transform_get_rigidbody(hitTr);
 
             // re-examine closer hits after updating hit.distance vs. per-block or rotated collider
-            if (rtreeHit->distance >= hit.distance) {
+            if (rtreeHit.distance >= hit.distance) {
                 break;
             }
 
@@ -839,7 +830,7 @@ HitType scene_cast_box(Scene *sc,
 
             if (mode == RigidbodyMode_Dynamic) {
                 hit.hitTr = hitTr;
-                hit.distance = rtreeHit->distance;
+                hit.distance = rtreeHit.distance;
                 hit.type = Hit_CollisionBox;
             } else {
                 Box modelBox, modelBroadphase;
@@ -925,12 +916,9 @@ HitType scene_cast_box(Scene *sc,
                     }
                 }
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(sceneQuery, free);
-    doubly_linked_list_free(sceneQuery);
+    rtree_cast_results_release(&sceneQuery);
 
     if (result != NULL) {
         *result = hit;
@@ -951,7 +939,8 @@ size_t scene_cast_all_box(Scene *sc,
         return 0;
     }
 
-    DoublyLinkedList *sceneQuery = doubly_linked_list_new();
+    RtreeCastResults sceneQuery;
+    rtree_cast_results_init(&sceneQuery);
     size_t count = 0;
     if (rtree_query_cast_all_box(sc->rtree,
                                  aabb,
@@ -960,17 +949,16 @@ size_t scene_cast_all_box(Scene *sc,
                                  PHYSICS_GROUP_NONE,
                                  groups,
                                  filterOutTransforms,
-                                 sceneQuery,
+                                 &sceneQuery,
                                  &float3_epsilon_collision)) {
 
         // process query results to confirm intersections w/ per-block and rotated colliders
-        DoublyLinkedListNode *n = doubly_linked_list_first(sceneQuery);
-        RtreeCastResult *rtreeHit;
+        const RtreeCastResult *rtreeHit;
         Transform *hitTr;
         RigidBody *hitRb;
         CastResult *hit;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
+        for (size_t i = 0; i < rtree_cast_results_count(&sceneQuery); ++i) {
+            rtreeHit = rtree_cast_results_get(&sceneQuery, i);
             hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
             hitRb = transform_get_rigidbody(hitTr);
             hit = NULL;
@@ -1065,15 +1053,12 @@ size_t scene_cast_all_box(Scene *sc,
                 doubly_linked_list_push_last(results, hit);
                 ++count;
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(sceneQuery, free);
-    doubly_linked_list_free(sceneQuery);
+    rtree_cast_results_release(&sceneQuery);
 
     // sort query results by distance
-    doubly_linked_list_sort_ascending(results, rtree_utils_result_sort_func);
+    doubly_linked_list_sort_ascending(results, _scene_cast_result_sort_func);
 
     return count;
 }
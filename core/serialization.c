@@ -55,7 +55,7 @@ DataFormat serialization_load_data(const void *buffer, const size_t size, const
 
     // 3ZH and PCUBES
     if (readMagicBytes(stream, true)) {
-        if (serialization_load_assets(stream, NULL, filter, NULL, shapeSettings, true, (DoublyLinkedList **)out)) { // frees stream
+        if (serialization_load_assets(stream, NULL, filter, NULL, shapeSettings, true, 0, (DoublyLinkedList **)out)) { // frees stream
             return DataFormat_3ZH;
         } else {
             return DataFormat_Error;
@@ -125,6 +125,7 @@ Shape *serialization_load_shape(Stream *s,
                                   colorAtlas,
                                   shapeSettings,
                                   allowLegacy,
+                                  0,
                                   &assets)) {
         Shape *shape = assets_get_root_shape(assets, true);
 
@@ -144,6 +145,7 @@ bool serialization_load_assets(Stream *stream,
                                ColorAtlas *colorAtlas,
                                const ShapeSettings *const shapeSettings,
                                const bool allowLegacy,
+                               const uint8_t nbThreads,
                                DoublyLinkedList **out) {
     vx_assert_d(*out == NULL);
 
@@ -180,7 +182,11 @@ bool serialization_load_assets(Stream *stream,
             break;
         }
         case 6: {
-            *out = serialization_load_assets_v6(stream, colorAtlas, filter, shapeSettings);
+            *out = serialization_load_assets_v6(stream,
+                                                colorAtlas,
+                                                filter,
+                                                shapeSettings,
+                                                nbThreads);
             break;
         }
         default: {
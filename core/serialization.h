@@ -125,6 +125,8 @@ Shape *assets_get_root_shape(DoublyLinkedList *list, bool remove);
 /// @param colorAtlas optional, linked w/ shapes if present (NOT thread-safe)
 /// @param shapeSettings optional
 /// @param allowLegacy if true, .pcubes files will be supported as well
+/// @param nbThreads threads used to read & build the shapes of a 3ZH file (calling thread
+/// included), 0 reads them serially on calling thread
 /// @param out must be a NULL pointer
 bool serialization_load_assets(Stream *stream,
                                const char *fullname,
@@ -132,6 +134,7 @@ bool serialization_load_assets(Stream *stream,
                                ColorAtlas *colorAtlas,
                                const ShapeSettings *shapeSettings,
                                const bool allowLegacy,
+                               const uint8_t nbThreads,
                                DoublyLinkedList **out);
 void serialization_assets_free_func(void *ptr);
 
@@ -11,6 +11,7 @@
 
 #include "cclog.h"
 #include "map_string_float3.h"
+#include "mutex.h"
 #include "serialization.h"
 #include "stream.h"
 #include "transform.h"
@@ -160,6 +161,71 @@ uint32_t chunk_v6_read_shape(Stream *s,
 
 uint32_t chunk_v6_read_preview_image(Stream *s, void **imageData, uint32_t *size);
 
+// Size of compressed data read at once when inflating a chunk from a file stream
+#define CHUNK_V6_READER_WINDOW_SIZE 16384
+// Number of shape blocks inflated at once
+#define CHUNK_V6_READER_BLOCKS_WINDOW_SIZE 4096
+
+// Reads chunk data sequentially, inflating it on the fly if compressed. Large chunks (shapes) are
+// processed while being inflated instead of being fully loaded in memory first.
+typedef struct {
+    z_stream z;
+    Stream *s;
+    // compressed data window, NULL if inflating directly from stream memory
+    uint8_t *window;
+    // chunk bytes left in stream
+    uint32_t streamLeft;
+    // (uncompressed) chunk bytes left to read
+    uint32_t left;
+    bool isCompressed;
+    char pad[7];
+} ChunkV6Reader;
+
+// Shape chunk content, read by chunk_v6_read_shape_data and applied to the shape (palette, blocks
+// that couldn't be processed while reading, hierarchy...) by chunk_v6_read_shape_apply
+typedef struct {
+    Shape *shape;
+    MapStringFloat3 *pois;
+    MapStringFloat3 *pois_rotation;
+    VERTEX_LIGHT_STRUCT_T *lightingData;
+    // individual shape palette, if any
+    ColorPalette *palette;
+    // blocks sub-chunk (size included), if it couldn't be processed while reading
+    void *blocks;
+    char *name;
+    LocalTransform localTransform;
+    float3 collisionBoxMin;
+    float3 collisionBoxMax;
+    float3 pivot;
+    uint32_t blocksSize;
+    uint32_t lightingDataSize;
+    uint16_t width;
+    uint16_t height;
+    uint16_t depth;
+    uint16_t shapeId;
+    uint16_t shapeParentId;
+    // palette entries in order of first use, to link a palette read without atlas
+    uint16_t usedEntriesCount;
+    SHAPE_COLOR_INDEX_INT_T usedEntries[SHAPE_COLOR_INDEX_MAX_COUNT];
+    uint8_t paletteID;
+    uint8_t isHiddenSelf;
+    bool paletteIsSet;
+    bool shrinkPalette;
+    bool hasCustomCollisionBox;
+    bool hasPivot;
+} ChunkV6ShapeData;
+
+// Reads chunk header, chunk ID should be read already at this point.
+// chunk_v6_reader_end must be called once done if init succeeds.
+static bool chunk_v6_reader_init(ChunkV6Reader *r,
+                                 Stream *s,
+                                 uint32_t *chunkSize,
+                                 uint32_t *uncompressedSize);
+static bool chunk_v6_reader_read(ChunkV6Reader *r, void *outValue, uint32_t size);
+static bool chunk_v6_reader_skip(ChunkV6Reader *r, uint32_t size);
+// Moves stream to the end of the chunk, skipping what hasn't been read
+static void chunk_v6_reader_end(ChunkV6Reader *r);
+
 //  MARK: Utils -
 
 static uint32_t getChunkHeaderSize(const uint8_t chunkID);
@@ -376,6 +442,7 @@ bool serialization_v6_save_shape_as_buffer(const Shape *const shape,
             return false;
         }
 
+        free(shapeBuffersCursor->shapeCompressedData);
         free(shapeBuffersCursor);
         n = doubly_linked_list_node_next(n);
     }
@@ -643,18 +710,23 @@ bool chunk_v6_read(void **chunkData, uint32_t *chunkSize, uint32_t *uncompressed
         return false;
     }
 
-    // read chunk data
-    void *_chunkData = malloc(_chunkSize);
-    if (stream_read(s, _chunkData, _chunkSize, 1) == false) {
-        free(_chunkData);
-        return false;
-    }
-
-    // uncompress if required by this chunk
+    // uncompress if required by this chunk,
+    // directly from stream memory when possible (buffer or mapped file)
     if (_isCompressed != 0) {
+        const void *compressedData = stream_view(s, _chunkSize);
+        void *_chunkData = NULL;
+        if (compressedData == NULL) {
+            _chunkData = malloc(_chunkSize);
+            if (stream_read(s, _chunkData, _chunkSize, 1) == false) {
+                free(_chunkData);
+                return false;
+            }
+            compressedData = _chunkData;
+        }
+
         uLong resultSize = _uncompressedSize;
         void *uncompressedData = malloc(_uncompressedSize);
-        if (uncompress(uncompressedData, &resultSize, _chunkData, _chunkSize) != Z_OK) {
+        if (uncompress(uncompressedData, &resultSize, compressedData, _chunkSize) != Z_OK) {
             free(uncompressedData);
             free(_chunkData);
             return false;
@@ -663,6 +735,11 @@ bool chunk_v6_read(void **chunkData, uint32_t *chunkSize, uint32_t *uncompressed
 
         *chunkData = uncompressedData;
     } else {
+        void *_chunkData = malloc(_chunkSize);
+        if (stream_read(s, _chunkData, _chunkSize, 1) == false) {
+            free(_chunkData);
+            return false;
+        }
         *chunkData = _chunkData;
     }
     *chunkSize = _chunkSize;
@@ -765,6 +842,162 @@ uint32_t chunk_v6_read_palette_id(Stream *s, uint8_t *paletteID) {
     return CHUNK_V6_HEADER_NO_ID_SIZE + chunkSize;
 }
 
+static bool chunk_v6_reader_init(ChunkV6Reader *r,
+                                 Stream *s,
+                                 uint32_t *chunkSize,
+                                 uint32_t *uncompressedSize) {
+    memset(r, 0, sizeof(ChunkV6Reader));
+
+    uint8_t isCompressed = 0;
+
+    // read chunk header, chunk ID should be read already at this point
+    if (stream_read_uint32(s, chunkSize) == false) {
+        return false;
+    }
+    if (stream_read_uint8(s, &isCompressed) == false) {
+        return false;
+    }
+    if (stream_read_uint32(s, uncompressedSize) == false) {
+        return false;
+    }
+
+    if (*chunkSize == 0 || *uncompressedSize == 0) {
+        return false;
+    }
+
+    r->s = s;
+    r->isCompressed = isCompressed != 0;
+    r->streamLeft = *chunkSize;
+    r->left = r->isCompressed ? *uncompressedSize : *chunkSize;
+
+    if (r->isCompressed) {
+        if (inflateInit(&r->z) != Z_OK) {
+            return false;
+        }
+        // inflate directly from stream memory when possible (buffer or mapped file),
+        // otherwise compressed data is read one window at a time
+        const void *compressedData = stream_view(s, *chunkSize);
+        if (compressedData != NULL) {
+            r->z.next_in = (Bytef *)compressedData;
+            r->z.avail_in = *chunkSize;
+            r->streamLeft = 0;
+        } else {
+            r->window = (uint8_t *)malloc(CHUNK_V6_READER_WINDOW_SIZE);
+            if (r->window == NULL) {
+                inflateEnd(&r->z);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool chunk_v6_reader_read(ChunkV6Reader *r, void *outValue, uint32_t size) {
+    if (size > r->left) {
+        return false;
+    }
+
+    if (r->isCompressed == false) {
+        if (stream_read(r->s, outValue, size, 1) == false) {
+            return false;
+        }
+        r->streamLeft -= size;
+        r->left -= size;
+        return true;
+    }
+
+    r->z.next_out = (Bytef *)outValue;
+    r->z.avail_out = size;
+    while (r->z.avail_out > 0) {
+        if (r->z.avail_in == 0 && r->window != NULL && r->streamLeft > 0) {
+            const uint32_t n = r->streamLeft < CHUNK_V6_READER_WINDOW_SIZE
+                                   ? r->streamLeft
+                                   : CHUNK_V6_READER_WINDOW_SIZE;
+            if (stream_read(r->s, r->window, n, 1) == false) {
+                return false;
+            }
+            r->streamLeft -= n;
+            r->z.next_in = r->window;
+            r->z.avail_in = n;
+        }
+        const int ret = inflate(&r->z, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            if (r->z.avail_out > 0) {
+                return false;
+            }
+        } else if (ret != Z_OK) {
+            return false;
+        }
+    }
+    r->left -= size;
+    return true;
+}
+
+static bool chunk_v6_reader_skip(ChunkV6Reader *r, uint32_t size) {
+    if (r->isCompressed == false) {
+        if (size > r->left || stream_skip(r->s, size) == false) {
+            return false;
+        }
+        r->streamLeft -= size;
+        r->left -= size;
+        return true;
+    }
+
+    uint8_t skipped[1024];
+    while (size > 0) {
+        const uint32_t n = size < sizeof(skipped) ? size : (uint32_t)sizeof(skipped);
+        if (chunk_v6_reader_read(r, skipped, n) == false) {
+            return false;
+        }
+        size -= n;
+    }
+    return true;
+}
+
+static void chunk_v6_reader_end(ChunkV6Reader *r) {
+    if (r->streamLeft > 0) {
+        stream_skip(r->s, r->streamLeft);
+        r->streamLeft = 0;
+    }
+    if (r->isCompressed) {
+        inflateEnd(&r->z);
+    }
+    free(r->window);
+    r->window = NULL;
+}
+
+static void chunk_v6_shape_add_block(Shape *shape,
+                                     ColorPalette *palette,
+                                     SHAPE_COLOR_INDEX_INT_T colorIndex,
+                                     SHAPE_COORDS_INT_T x,
+                                     SHAPE_COORDS_INT_T y,
+                                     SHAPE_COORDS_INT_T z,
+                                     uint8_t paletteID,
+                                     ColorPalette *shrinkPalette) {
+    bool success = true;
+    // translate & shrink to a shape palette w/ only used colors if,
+    // 1) octree was serialized w/ a palette ID using any of the default palettes
+    if (paletteID == PALETTE_ID_IOS_ITEM_EDITOR_LEGACY) {
+        success = color_palette_check_and_add_default_color_pico8p(palette,
+                                                                   colorIndex,
+                                                                   &colorIndex);
+    } else if (paletteID == PALETTE_ID_2021) {
+        success = color_palette_check_and_add_default_color_2021(palette,
+                                                                 colorIndex,
+                                                                 &colorIndex);
+    }
+    // 2) octree was serialized w/ a palette that exceeds max size
+    else if (shrinkPalette != NULL) {
+        RGBAColor color = color_palette_get_color(shrinkPalette, colorIndex);
+        success = color_palette_check_and_add_color(palette, color, &colorIndex, false);
+    }
+    if (success == false) {
+        colorIndex = 0;
+    }
+
+    shape_add_block(shape, colorIndex, x, y, z, false);
+}
+
 uint32_t chunk_v6_read_shape_process_blocks(void *cursor,
                                             Shape *shape,
                                             uint16_t w,
@@ -787,28 +1020,14 @@ uint32_t chunk_v6_read_shape_process_blocks(void *cursor,
                     continue;
                 }
 
-                bool success = true;
-                // translate & shrink to a shape palette w/ only used colors if,
-                // 1) octree was serialized w/ a palette ID using any of the default palettes
-                if (paletteID == PALETTE_ID_IOS_ITEM_EDITOR_LEGACY) {
-                    success = color_palette_check_and_add_default_color_pico8p(palette,
-                                                                               colorIndex,
-                                                                               &colorIndex);
-                } else if (paletteID == PALETTE_ID_2021) {
-                    success = color_palette_check_and_add_default_color_2021(palette,
-                                                                             colorIndex,
-                                                                             &colorIndex);
-                }
-                // 2) octree was serialized w/ a palette that exceeds max size
-                else if (shrinkPalette != NULL) {
-                    RGBAColor color = color_palette_get_color(shrinkPalette, colorIndex);
-                    success = color_palette_check_and_add_color(palette, color, &colorIndex, false);
-                }
-                if (success == false) {
-                    colorIndex = 0;
-                }
-
-                shape_add_block(shape, colorIndex, x, y, z, false);
+                chunk_v6_shape_add_block(shape,
+                                         palette,
+                                         colorIndex,
+                                         x,
+                                         y,
+                                         z,
+                                         paletteID,
+                                         shrinkPalette);
             }
         }
     }
@@ -817,291 +1036,361 @@ uint32_t chunk_v6_read_shape_process_blocks(void *cursor,
     return size + sizeof(uint32_t);
 }
 
-uint32_t chunk_v6_read_shape(Stream *s,
-                             Shape **shape,
-                             DoublyLinkedList *shapes,
-                             const ShapeSettings *const shapeSettings,
-                             ColorAtlas *colorAtlas,
-                             ColorPalette *filePalette,
-                             uint8_t paletteID,
-                             ColorPalette **rootShapePalette) {
-    if (shapeSettings == NULL) {
-        cclog_error("tried to load shape without shape settings");
-        return 0;
+static bool chunk_v6_read_shape_stream_blocks(ChunkV6Reader *r,
+                                              uint32_t size,
+                                              ChunkV6ShapeData *d,
+                                              ColorPalette *shrinkPalette) {
+    const uint32_t count = (uint32_t)d->width * (uint32_t)d->height * (uint32_t)d->depth;
+    if (size < count) {
+        cclog_error("shape blocks chunk is too small for shape size");
+        return false;
     }
 
-    /// read file
-    void *chunkData = NULL;
-    uint32_t chunkSize = 0;
-    uint32_t uncompressedSize = 0;
-    if (chunk_v6_read(&chunkData, &chunkSize, &uncompressedSize, s) == false) {
-        cclog_error("failed to read shape");
-        return 0;
+    SHAPE_COLOR_INDEX_INT_T window[CHUNK_V6_READER_BLOCKS_WINDOW_SIZE];
+    bool used[SHAPE_COLOR_INDEX_MAX_COUNT + 1] = {false};
+    ColorPalette *palette = shape_get_palette(d->shape);
+    uint16_t x = 0, y = 0, z = 0;
+    uint32_t left = count;
+    while (left > 0) {
+        const uint32_t n = left < CHUNK_V6_READER_BLOCKS_WINDOW_SIZE
+                               ? left
+                               : CHUNK_V6_READER_BLOCKS_WINDOW_SIZE;
+        if (chunk_v6_reader_read(r, window, n * (uint32_t)sizeof(SHAPE_COLOR_INDEX_INT_T)) ==
+            false) {
+            return false;
+        }
+        for (uint32_t i = 0; i < n; ++i) {
+            if (window[i] != SHAPE_COLOR_INDEX_AIR_BLOCK) {
+                if (used[window[i]] == false) {
+                    used[window[i]] = true;
+                    d->usedEntries[d->usedEntriesCount++] = window[i];
+                }
+                chunk_v6_shape_add_block(d->shape,
+                                         palette,
+                                         window[i],
+                                         (SHAPE_COORDS_INT_T)x,
+                                         (SHAPE_COORDS_INT_T)y,
+                                         (SHAPE_COORDS_INT_T)z,
+                                         d->paletteID,
+                                         shrinkPalette);
+            }
+            if (++z == d->depth) {
+                z = 0;
+                if (++y == d->height) {
+                    y = 0;
+                    ++x;
+                }
+            }
+        }
+        left -= n;
     }
+    color_palette_clear_lighting_dirty(palette);
 
-    // no need to read if shape return parameter is NULL
-    if (shape == NULL) {
-        cclog_error("shape pointer is null");
-        free(chunkData);
-        return CHUNK_V6_HEADER_NO_ID_SIZE + chunkSize;
+    return chunk_v6_reader_skip(r, size - count);
+}
+
+static bool chunk_v6_read_shape_set_palette(ChunkV6ShapeData *d,
+                                            ColorPalette *rootShapePalette,
+                                            ColorPalette *filePalette,
+                                            ColorAtlas *colorAtlas) {
+    // Compatibility modes (see comment in serialization_load_assets_v6):
+    // [MULTI] Use sub-chunk palette if it exists, else use shared palette, ignore file palette
+    // [SINGLE] If file palette exists, use it as shape palette (optionally shrinked)
+    // [LEGACY] No file palette, legacy palette ID will be used (shrinked)
+    bool shrinkPalette = false;
+    if (rootShapePalette != NULL || d->palette != NULL) { // [MULTI]
+        if (d->palette != NULL) {                         // individual palette
+            shape_set_palette(d->shape, d->palette, false);
+        } else { // shared palette
+            shape_set_palette(d->shape, rootShapePalette, true);
+        }
+        d->paletteID = PALETTE_ID_CUSTOM;
+    } else if (filePalette != NULL) { // [SINGLE]
+        shrinkPalette = color_palette_get_count(filePalette) >= SHAPE_COLOR_INDEX_MAX_COUNT;
+        shape_set_palette(d->shape,
+                          shrinkPalette ? color_palette_new(colorAtlas)
+                                        : color_palette_new_copy(filePalette),
+                          false);
+        d->paletteID = PALETTE_ID_CUSTOM;
+    } else { // [LEGACY]
+        shape_set_palette(d->shape, color_palette_new(colorAtlas), false);
+        vx_assert(d->paletteID !=
+                  PALETTE_ID_CUSTOM); // from caller, reading legacy chunks at the root
     }
+    d->paletteIsSet = true;
+    d->shrinkPalette = shrinkPalette;
+    return shrinkPalette;
+}
 
-    if (*shape != NULL) {
-        shape_release(*shape);
-        *shape = NULL;
+static bool chunk_v6_read_shape_point(ChunkV6Reader *r, MapStringFloat3 *points) {
+    uint8_t nameLen = 0;
+    float3 f3;
+
+    if (chunk_v6_reader_read(r, &nameLen, sizeof(uint8_t)) == false) { // shape POI name length
+        return false;
     }
 
-    /// get shape data
-    void *cursor = chunkData;
-    void *shapeBlocksCursor = NULL;
+    char *nameStr = (char *)malloc(nameLen + 1); // +1 for null terminator
+    if (nameStr == NULL) {
+        cclog_error("malloc failed");
+        if (chunk_v6_reader_skip(r, nameLen) == false) {
+            return false;
+        }
+    } else {
+        if (chunk_v6_reader_read(r, nameStr, nameLen) == false) { // shape POI name
+            free(nameStr);
+            return false;
+        }
+        nameStr[nameLen] = 0; // add null terminator
+    }
 
-    uint32_t totalSizeRead = 0;
-    uint32_t sizeRead = 0;
-    uint32_t lightingDataSizeRead = 0;
+    // shape POI X, Y, Z
+    if (chunk_v6_reader_read(r, &f3.x, sizeof(float)) == false ||
+        chunk_v6_reader_read(r, &f3.y, sizeof(float)) == false ||
+        chunk_v6_reader_read(r, &f3.z, sizeof(float)) == false) {
+        free(nameStr);
+        return false;
+    }
 
-    uint8_t chunkID;
-    MapStringFloat3 *pois = map_string_float3_new();
-    MapStringFloat3 *pois_rotation = map_string_float3_new();
-    VERTEX_LIGHT_STRUCT_T *lightingData = NULL;
-    ColorPalette *palette = NULL;
+    if (nameStr != NULL) {
+        map_string_float3_set_key_value(points, nameStr, float3_new(f3.x, f3.y, f3.z));
+        free(nameStr);
+    }
+    return true;
+}
 
-    uint16_t width = 0;
-    uint16_t height = 0;
-    uint16_t depth = 0;
+static void chunk_v6_shape_data_init(ChunkV6ShapeData *d, uint8_t paletteID) {
+    memset(d, 0, sizeof(ChunkV6ShapeData));
+    d->pois = map_string_float3_new();
+    d->pois_rotation = map_string_float3_new();
+    d->localTransform.scale.x = 1;
+    d->localTransform.scale.y = 1;
+    d->localTransform.scale.z = 1;
+    d->shapeId = 1;
+    d->shapeParentId = 0;
+    d->paletteID = paletteID;
+}
 
-    uint16_t shapeId = 1;
-    uint16_t shapeParentId = 0;
+static void chunk_v6_shape_data_free(ChunkV6ShapeData *d) {
+    if (d->paletteIsSet == false) {
+        color_palette_release(d->palette);
+    }
+    if (d->shape != NULL) {
+        shape_release(d->shape);
+        d->shape = NULL;
+    }
+    free(d->lightingData);
+    free(d->name);
+    free(d->blocks);
+    map_string_float3_free(d->pois);
+    map_string_float3_free(d->pois_rotation);
+}
 
-    bool hasCustomCollisionBox = false;
-    float3 collisionBoxMin = float3_zero;
-    float3 collisionBoxMax = float3_zero;
-    uint8_t isHiddenSelf = false;
+static bool chunk_v6_read_shape_data(ChunkV6Reader *r,
+                                     uint32_t uncompressedSize,
+                                     const ShapeSettings *const shapeSettings,
+                                     ColorAtlas *colorAtlas,
+                                     ColorPalette *filePalette,
+                                     ColorPalette *const *rootShapePalette,
+                                     Shape *shape,
+                                     ChunkV6ShapeData *d) {
+    bool ok = true;
 
-    LocalTransform localTransform;
-    memset(&localTransform, 0, sizeof(LocalTransform));
-    localTransform.scale.x = 1;
-    localTransform.scale.y = 1;
-    localTransform.scale.z = 1;
-    char *name = NULL;
-    float3 pivot = {0.0f, 0.0f, 0.0f};
-    bool hasPivot = false;
-
-    while (totalSizeRead < uncompressedSize) {
-        chunkID = *((uint8_t *)cursor);
-        cursor = (void *)((uint8_t *)cursor + 1);
+    uint32_t totalSizeRead = 0;
+    uint32_t sizeRead = 0;
+    uint8_t chunkID;
+
+    while (ok && totalSizeRead < uncompressedSize) {
+        if (chunk_v6_reader_read(r, &chunkID, sizeof(uint8_t)) == false) {
+            ok = false;
+            break;
+        }
         totalSizeRead += 1; // size of chunk id
         switch (chunkID) {
             case P3S_CHUNK_ID_SHAPE_ID: {
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // shape id chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-                memcpy(&shapeId, cursor, sizeof(uint16_t));
-                cursor = (void *)((uint16_t *)cursor + 1);
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t)) &&
+                     chunk_v6_reader_read(r, &d->shapeId, sizeof(uint16_t));
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
                 break;
             }
             case P3S_CHUNK_ID_SHAPE_PARENT_ID: {
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // shape id chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-                memcpy(&shapeParentId, cursor, sizeof(uint16_t));
-                cursor = (void *)((uint16_t *)cursor + 1);
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t)) &&
+                     chunk_v6_reader_read(r, &d->shapeParentId, sizeof(uint16_t));
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
                 break;
             }
             case P3S_CHUNK_ID_SHAPE_TRANSFORM: {
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // shape id chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-                memcpy(&localTransform, cursor, sizeof(LocalTransform));
-                cursor = (void *)((LocalTransform *)cursor + 1);
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t)) &&
+                     chunk_v6_reader_read(r, &d->localTransform, sizeof(LocalTransform));
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
                 break;
             }
             case P3S_CHUNK_ID_SHAPE_PIVOT: {
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // shape id chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-                memcpy(&pivot, cursor, sizeof(float3));
-                cursor = (void *)((float3 *)cursor + 1);
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t)) &&
+                     chunk_v6_reader_read(r, &d->pivot, sizeof(float3));
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
-                hasPivot = true;
+                d->hasPivot = true;
                 break;
             }
             case P3S_CHUNK_ID_SHAPE_PALETTE: {
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // shape palette chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-
-                palette = chunk_v6_read_palette_data(cursor, colorAtlas, false);
-                cursor = (void *)((uint8_t *)cursor + sizeRead);
-
-                paletteID = PALETTE_ID_CUSTOM;
+                // shape palette chunk size
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t));
+                totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
+                if (ok == false) {
+                    break;
+                }
 
-                if (*rootShapePalette == NULL) {
-                    *rootShapePalette = palette; // for [MULTI] file, root shape palette may be
-                                                 // shared
+                // writers put the palette before blocks, which may already be processed otherwise
+                if (d->paletteIsSet) {
+                    cclog_warning("shape palette found after shape blocks, ignored");
+                    ok = chunk_v6_reader_skip(r, sizeRead);
+                    break;
                 }
 
-                totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
+                void *paletteData = malloc(sizeRead);
+                if (paletteData == NULL) {
+                    ok = false;
+                    break;
+                }
+                ok = chunk_v6_reader_read(r, paletteData, sizeRead);
+                if (ok) {
+                    if (d->palette != NULL) { // shouldn't happen
+                        color_palette_release(d->palette);
+                    }
+                    d->palette = chunk_v6_read_palette_data(paletteData, colorAtlas, false);
+                    d->paletteID = PALETTE_ID_CUSTOM;
+                }
+                free(paletteData);
                 break;
             }
             case P3S_CHUNK_ID_OBJECT_COLLISION_BOX: {
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // shape id chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-                memcpy(&collisionBoxMin, cursor, sizeof(float3));
-                cursor = (void *)((float3 *)cursor + 1);
-                memcpy(&collisionBoxMax, cursor, sizeof(float3));
-                cursor = (void *)((float3 *)cursor + 1);
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t)) &&
+                     chunk_v6_reader_read(r, &d->collisionBoxMin, sizeof(float3)) &&
+                     chunk_v6_reader_read(r, &d->collisionBoxMax, sizeof(float3));
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
-                hasCustomCollisionBox = true;
+                d->hasCustomCollisionBox = true;
                 break;
             }
             case P3S_CHUNK_ID_OBJECT_IS_HIDDEN: {
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // object is hidden chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-                memcpy(&isHiddenSelf, cursor, sizeof(uint8_t));
-                cursor = (void *)((uint8_t *)cursor + 1);
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t)) &&
+                     chunk_v6_reader_read(r, &d->isHiddenSelf, sizeof(uint8_t));
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
                 break;
             }
             case P3S_CHUNK_ID_SHAPE_NAME: {
                 uint8_t nameLen;
-                memcpy(&nameLen, cursor, sizeof(uint8_t));
-                cursor = (void *)((uint8_t *)cursor + 1);
-                if (name != NULL) { // shouldn't happen
-                    free(name);
+                ok = chunk_v6_reader_read(r, &nameLen, sizeof(uint8_t));
+                if (ok == false) {
+                    break;
+                }
+                if (d->name != NULL) { // shouldn't happen
+                    free(d->name);
                 }
-                name = malloc(nameLen + 1);
-                if (name == NULL) {
+                d->name = malloc(nameLen + 1);
+                if (d->name == NULL) {
                     cclog_error("malloc failed");
+                    ok = chunk_v6_reader_skip(r, nameLen);
                 } else {
-                    memcpy(name, cursor, sizeof(char) * nameLen);
-                    name[nameLen] = 0;
+                    ok = chunk_v6_reader_read(r, d->name, sizeof(char) * nameLen);
+                    d->name[nameLen] = 0;
                 }
-                cursor = (void *)((uint8_t *)cursor + nameLen);
                 totalSizeRead += (uint32_t)(sizeof(uint8_t) + sizeof(char) * nameLen);
+
+                // Name is written last, files written before its sub-chunk size was fixed end with
+                // 4 extra bytes, too short to be a sub-chunk (ID + size): ignored
+                if (ok && totalSizeRead < uncompressedSize &&
+                    uncompressedSize - totalSizeRead < sizeof(uint8_t) + sizeof(uint32_t)) {
+                    totalSizeRead = uncompressedSize;
+                }
                 break;
             }
             case P3S_CHUNK_ID_SHAPE_SIZE: {
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // shape size chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-                memcpy(&width, cursor, sizeof(uint16_t)); // shape size X
-                cursor = (void *)((uint16_t *)cursor + 1);
-                memcpy(&height, cursor, sizeof(uint16_t)); // shape size Y
-                cursor = (void *)((uint16_t *)cursor + 1);
-                memcpy(&depth, cursor, sizeof(uint16_t)); // shape size Y
-                cursor = (void *)((uint16_t *)cursor + 1);
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t)) &&
+                     chunk_v6_reader_read(r, &d->width, sizeof(uint16_t)) &&
+                     chunk_v6_reader_read(r, &d->height, sizeof(uint16_t)) &&
+                     chunk_v6_reader_read(r, &d->depth, sizeof(uint16_t));
 
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
 
                 // size is known, now is a good time to create the shape
-                *shape = shape_make_2(shapeSettings->isMutable);
+                if (ok && d->shape == NULL) {
+                    d->shape = shape != NULL ? shape : shape_make_2(shapeSettings->isMutable);
+                }
                 break;
             }
             case P3S_CHUNK_ID_SHAPE_BLOCKS: {
-                // Palette and size are required to read blocks, storing blocks position to process
-                // them later
-                shapeBlocksCursor = cursor;
-
                 // shape blocks chunk size
-                memcpy(&sizeRead, cursor, sizeof(uint32_t));
-                cursor = (void *)((uint32_t *)cursor + 1);
-
-                // skip chunk for now
-                cursor = (void *)((uint8_t *)cursor + sizeRead);
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t));
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
-                break;
-            }
-            case P3S_CHUNK_ID_SHAPE_POINT: {
-                uint8_t nameLen = 0;
-                char *nameStr = NULL;
-                float3 *poi = float3_new(0, 0, 0);
-
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // shape POI chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-
-                memcpy(&nameLen, cursor, sizeof(uint8_t)); // shape POI name length
-                cursor = (void *)((uint8_t *)cursor + 1);
-
-                nameStr = (char *)malloc(nameLen + 1); // +1 for null terminator
-                if (nameStr == NULL) {
-                    cclog_error("malloc failed");
-                } else {
-                    memcpy(nameStr, cursor, nameLen); // shape POI name
-                    nameStr[nameLen] = 0;             // add null terminator
+                if (ok == false) {
+                    break;
                 }
-                cursor = (void *)((char *)cursor + nameLen);
-
-                memcpy(&(poi->x), cursor, sizeof(float)); // shape POI X
-                cursor = (void *)((float *)cursor + 1);
-
-                memcpy(&(poi->y), cursor, sizeof(float)); // shape POI Y
-                cursor = (void *)((float *)cursor + 1);
 
-                memcpy(&(poi->z), cursor, sizeof(float)); // shape POI Z
-                cursor = (void *)((float *)cursor + 1);
-
-                if (nameStr != NULL) {
-                    map_string_float3_set_key_value(pois, nameStr, poi);
-                    free(nameStr);
+                // Palette and size are required to read blocks, both are written before them:
+                // blocks can be processed while being inflated. Unless shared palettes aren't known
+                // yet (NULL rootShapePalette) and shape doesn't have its own.
+                if (d->shape != NULL && (rootShapePalette != NULL || d->palette != NULL)) {
+                    if (d->paletteIsSet == false) {
+                        chunk_v6_read_shape_set_palette(d,
+                                                        rootShapePalette != NULL
+                                                            ? *rootShapePalette
+                                                            : NULL,
+                                                        filePalette,
+                                                        colorAtlas);
+                    }
+                    ok = chunk_v6_read_shape_stream_blocks(r,
+                                                           sizeRead,
+                                                           d,
+                                                           d->shrinkPalette ? filePalette : NULL);
+                } else {
+                    // storing blocks to process them later
+                    free(d->blocks);
+                    d->blocksSize = sizeRead;
+                    d->blocks = malloc(sizeof(uint32_t) + d->blocksSize);
+                    if (d->blocks == NULL) {
+                        ok = false;
+                        break;
+                    }
+                    memcpy(d->blocks, &d->blocksSize, sizeof(uint32_t));
+                    ok = chunk_v6_reader_read(r,
+                                              (uint8_t *)d->blocks + sizeof(uint32_t),
+                                              d->blocksSize);
                 }
-
+                break;
+            }
+            case P3S_CHUNK_ID_SHAPE_POINT: {
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t)) && // POI size
+                     chunk_v6_read_shape_point(r, d->pois);
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
                 break;
             }
             case P3S_CHUNK_ID_SHAPE_POINT_ROTATION: {
-                uint8_t nameLen = 0;
-                char *nameStr = NULL;
-                float3 *poi = float3_new(0, 0, 0);
-
-                memcpy(&sizeRead, cursor, sizeof(uint32_t)); // shape POI chunk size
-                cursor = (void *)((uint32_t *)cursor + 1);
-
-                memcpy(&nameLen, cursor, sizeof(uint8_t)); // shape POI name length
-                cursor = (void *)((uint8_t *)cursor + 1);
-
-                nameStr = (char *)malloc(nameLen + 1); // +1 for null terminator
-                if (nameStr == NULL) {
-                    cclog_error("malloc failed");
-                } else {
-                    memcpy(nameStr, cursor, nameLen); // shape POI name
-                    nameStr[nameLen] = 0;             // add null terminator
-                }
-                cursor = (void *)((char *)cursor + nameLen);
-
-                memcpy(&(poi->x), cursor, sizeof(float)); // shape POI X
-                cursor = (void *)((float *)cursor + 1);
-
-                memcpy(&(poi->y), cursor, sizeof(float)); // shape POI Y
-                cursor = (void *)((float *)cursor + 1);
-
-                memcpy(&(poi->z), cursor, sizeof(float)); // shape POI Z
-                cursor = (void *)((float *)cursor + 1);
-
-                if (nameStr != NULL) {
-                    map_string_float3_set_key_value(pois_rotation, nameStr, poi);
-                    free(nameStr);
-                }
-
+                ok = chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t)) && // POI size
+                     chunk_v6_read_shape_point(r, d->pois_rotation);
                 totalSizeRead += sizeRead + (uint32_t)sizeof(uint32_t);
                 break;
             }
 #if GLOBAL_LIGHTING_BAKE_READ_ENABLED
             case P3S_CHUNK_ID_SHAPE_BAKED_LIGHTING: {
                 // shape baked lighting chunk size
-                memcpy(&lightingDataSizeRead, cursor, sizeof(uint32_t));
-                cursor = (void *)((uint32_t *)cursor + 1);
-
-                totalSizeRead += lightingDataSizeRead + (uint32_t)sizeof(uint32_t);
+                ok = chunk_v6_reader_read(r, &d->lightingDataSize, sizeof(uint32_t));
+                totalSizeRead += d->lightingDataSize + (uint32_t)sizeof(uint32_t);
+                if (ok == false) {
+                    break;
+                }
 
                 if (shapeSettings->lighting) {
-                    if (lightingData != NULL) { // shouldn't happen
-                        free(lightingData);
+                    if (d->lightingData != NULL) { // shouldn't happen
+                        free(d->lightingData);
                     }
-                    lightingData = (VERTEX_LIGHT_STRUCT_T *)malloc(lightingDataSizeRead);
-                    if (lightingData == NULL) {
+                    d->lightingData = (VERTEX_LIGHT_STRUCT_T *)malloc(d->lightingDataSize);
+                    if (d->lightingData != NULL) {
+                        ok = chunk_v6_reader_read(r, d->lightingData, d->lightingDataSize);
                         break;
                     }
-
-                    memcpy(lightingData, cursor, lightingDataSizeRead);
-                    cursor = (void *)((char *)cursor + lightingDataSizeRead);
                 }
+                ok = chunk_v6_reader_skip(r, d->lightingDataSize);
+                break;
             }
 #endif
             default: // shape sub chunks we don't need to read
@@ -1116,12 +1405,14 @@ uint32_t chunk_v6_read_shape(Stream *s,
                  */
                 // sub chunk header size + sub chunk data size
                 if (uncompressedSize >= totalSizeRead &&
-                    uncompressedSize - totalSizeRead >= sizeof(uint32_t)) {
-                    sizeRead = CHUNK_V6_HEADER_NO_ID_SIZE + *((uint32_t *)cursor);
-                    // advance cursor
-                    cursor = (void *)((char *)cursor + sizeRead);
-
-                    totalSizeRead += sizeRead;
+                    uncompressedSize - totalSizeRead >= sizeof(uint32_t) &&
+                    chunk_v6_reader_read(r, &sizeRead, sizeof(uint32_t))) {
+                    const uint32_t left = uncompressedSize - totalSizeRead;
+                    if (left >= CHUNK_V6_HEADER_NO_ID_SIZE &&
+                        sizeRead <= left - CHUNK_V6_HEADER_NO_ID_SIZE) {
+                        ok = chunk_v6_reader_skip(r, CHUNK_V6_HEADER_NO_ID_SKIP_SIZE + sizeRead);
+                    }
+                    totalSizeRead += (uint32_t)CHUNK_V6_HEADER_NO_ID_SIZE + sizeRead;
                 } else {
                     totalSizeRead = uncompressedSize; // end it
                 }
@@ -1130,136 +1421,138 @@ uint32_t chunk_v6_read_shape(Stream *s,
         }
     }
 
-    if (*shape == NULL) {
-        free(lightingData);
-        free(name);
-        free(palette);
-        map_string_float3_free(pois);
-        map_string_float3_free(pois_rotation);
-        free(chunkData);
+    if (ok == false) {
+        cclog_error("error while reading shape : corrupted shape chunk");
+    } else if (d->shape == NULL) {
         cclog_error("error while reading shape : no shape were created");
-        return 0;
     }
+    return ok && d->shape != NULL;
+}
 
-    // Compatibility modes (see comment in serialization_load_assets_v6):
-    // [MULTI] Use sub-chunk palette if it exists, else use shared palette, ignore file palette
-    // [SINGLE] If file palette exists, use it as shape palette (optionally shrinked)
-    // [LEGACY] No file palette, legacy palette ID will be used (shrinked)
-    bool shrinkPalette = false;
-    if (*rootShapePalette != NULL || palette != NULL) { // [MULTI]
-        if (palette != NULL) {                          // individual palette
-            shape_set_palette(*shape, palette, false);
-        } else { // shared palette
-            shape_set_palette(*shape, *rootShapePalette, true);
-        }
-        paletteID = PALETTE_ID_CUSTOM;
-    } else if (filePalette != NULL) { // [SINGLE]
-        shrinkPalette = color_palette_get_count(filePalette) >= SHAPE_COLOR_INDEX_MAX_COUNT;
-        shape_set_palette(*shape,
-                          shrinkPalette ? color_palette_new(colorAtlas)
-                                        : color_palette_new_copy(filePalette),
-                          false);
-        paletteID = PALETTE_ID_CUSTOM;
-    } else { // [LEGACY]
-        shape_set_palette(*shape, color_palette_new(colorAtlas), false);
-        vx_assert(paletteID != PALETTE_ID_CUSTOM); // from caller, reading legacy chunks at the root
+static void chunk_v6_read_shape_apply(ChunkV6ShapeData *d,
+                                      DoublyLinkedList *shapes,
+                                      const ShapeSettings *const shapeSettings,
+                                      ColorAtlas *colorAtlas,
+                                      ColorPalette *filePalette,
+                                      ColorPalette **rootShapePalette) {
+    Shape *shape = d->shape;
+
+    if (d->palette != NULL && *rootShapePalette == NULL) {
+        *rootShapePalette = d->palette; // for [MULTI] file, root shape palette may be shared
     }
 
-    // process blocks now
-    if (shapeBlocksCursor != NULL) {
-        chunk_v6_read_shape_process_blocks(shapeBlocksCursor,
-                                           *shape,
-                                           width,
-                                           height,
-                                           depth,
-                                           paletteID,
-                                           shrinkPalette ? filePalette : NULL);
+    // palette read without atlas (see chunk_v6_run_shape_job), registering colors
+    // in the order they would have been while adding blocks
+    if (d->palette != NULL && colorAtlas != NULL && color_palette_get_atlas(d->palette) == NULL) {
+        color_palette_link_atlas(d->palette, colorAtlas, d->usedEntries, d->usedEntriesCount);
     }
 
-    free(chunkData);
+    if (d->paletteIsSet == false) {
+        chunk_v6_read_shape_set_palette(d, *rootShapePalette, filePalette, colorAtlas);
+    }
+
+    // process blocks that couldn't be processed while reading
+    if (d->blocks != NULL) {
+        if (d->blocksSize >= (uint32_t)d->width * (uint32_t)d->height * (uint32_t)d->depth) {
+            chunk_v6_read_shape_process_blocks(d->blocks,
+                                               shape,
+                                               d->width,
+                                               d->height,
+                                               d->depth,
+                                               d->paletteID,
+                                               d->shrinkPalette ? filePalette : NULL);
+        } else {
+            cclog_error("shape blocks chunk is too small for shape size");
+        }
+        free(d->blocks);
+        d->blocks = NULL;
+    }
 
     float3 f3;
 
     // set shape POIs
-    MapStringFloat3Iterator *it = map_string_float3_iterator_new(pois);
+    MapStringFloat3Iterator *it = map_string_float3_iterator_new(d->pois);
     while (map_string_float3_iterator_is_done(it) == false) {
         float3 *value = map_string_float3_iterator_current_value(it);
         float3_copy(&f3, value);
-        shape_set_point_of_interest(*shape, map_string_float3_iterator_current_key(it), &f3);
+        shape_set_point_of_interest(shape, map_string_float3_iterator_current_key(it), &f3);
         map_string_float3_iterator_next(it);
     }
     map_string_float3_iterator_free(it);
-    map_string_float3_free(pois);
+    map_string_float3_free(d->pois);
+    d->pois = NULL;
 
     // set shape points (rotation)
-    it = map_string_float3_iterator_new(pois_rotation);
+    it = map_string_float3_iterator_new(d->pois_rotation);
     while (map_string_float3_iterator_is_done(it) == false) {
         float3 *value = map_string_float3_iterator_current_value(it);
         float3_copy(&f3, value);
-        shape_set_point_rotation(*shape, map_string_float3_iterator_current_key(it), &f3);
+        shape_set_point_rotation(shape, map_string_float3_iterator_current_key(it), &f3);
         map_string_float3_iterator_next(it);
     }
     map_string_float3_iterator_free(it);
-    map_string_float3_free(pois_rotation);
+    map_string_float3_free(d->pois_rotation);
+    d->pois_rotation = NULL;
 
     // set shape lighting data
     if (shapeSettings->lighting) {
-        if (lightingData == NULL) {
+        if (d->lightingData == NULL) {
             cclog_warning("shape uses lighting but no baked lighting found");
-        } else if (lightingDataSizeRead !=
-                   (uint32_t)(width * height * depth * (uint16_t)sizeof(VERTEX_LIGHT_STRUCT_T))) {
+        } else if (d->lightingDataSize != (uint32_t)(d->width * d->height * d->depth *
+                                                     (uint16_t)sizeof(VERTEX_LIGHT_STRUCT_T))) {
             cclog_warning("shape uses lighting but does not match lighting data size");
-            free(lightingData);
+            free(d->lightingData);
         } else {
-            shape_set_lighting_data_from_blob(*shape,
-                                              lightingData,
+            shape_set_lighting_data_from_blob(shape,
+                                              d->lightingData,
                                               coords3_zero,
-                                              (SHAPE_COORDS_INT3_T){(SHAPE_COORDS_INT_T)width,
-                                                                    (SHAPE_COORDS_INT_T)height,
-                                                                    (SHAPE_COORDS_INT_T)depth});
+                                              (SHAPE_COORDS_INT3_T){(SHAPE_COORDS_INT_T)d->width,
+                                                                    (SHAPE_COORDS_INT_T)d->height,
+                                                                    (SHAPE_COORDS_INT_T)d->depth});
         }
-    } else if (lightingData != NULL) {
+    } else if (d->lightingData != NULL) {
         cclog_warning("shape baked lighting data discarded");
-        free(lightingData);
+        free(d->lightingData);
     }
+    d->lightingData = NULL;
 
-    doubly_linked_list_push_last(shapes, *shape);
+    doubly_linked_list_push_last(shapes, shape);
     if (shapes) {
-        int32_t parentIndex = shapeParentId - 1;
+        int32_t parentIndex = d->shapeParentId - 1;
         Shape *parent = (Shape *)doubly_linked_list_node_pointer(
             doubly_linked_list_node_at_index(shapes, (size_t)parentIndex));
         if (parentIndex >= 0 && parent) {
-            shape_set_parent(*shape, shape_get_root_transform(parent), false);
-            shape_set_local_position(*shape,
-                                     localTransform.position.x,
-                                     localTransform.position.y,
-                                     localTransform.position.z);
-            shape_set_local_rotation_euler(*shape,
-                                           localTransform.rotation.x,
-                                           localTransform.rotation.y,
-                                           localTransform.rotation.z);
-            shape_set_local_scale(*shape,
-                                  localTransform.scale.x,
-                                  localTransform.scale.y,
-                                  localTransform.scale.z);
+            shape_set_parent(shape, shape_get_root_transform(parent), false);
+            shape_set_local_position(shape,
+                                     d->localTransform.position.x,
+                                     d->localTransform.position.y,
+                                     d->localTransform.position.z);
+            shape_set_local_rotation_euler(shape,
+                                           d->localTransform.rotation.x,
+                                           d->localTransform.rotation.y,
+                                           d->localTransform.rotation.z);
+            shape_set_local_scale(shape,
+                                  d->localTransform.scale.x,
+                                  d->localTransform.scale.y,
+                                  d->localTransform.scale.z);
         }
     }
 
-    if (hasPivot) {
-        shape_set_pivot(*shape, pivot.x, pivot.y, pivot.z);
+    if (d->hasPivot) {
+        shape_set_pivot(shape, d->pivot.x, d->pivot.y, d->pivot.z);
     } else {
-        shape_reset_pivot_to_center(*shape);
+        shape_reset_pivot_to_center(shape);
     }
 
-    if (name != NULL) {
-        transform_set_name(shape_get_root_transform(*shape), name);
-        free(name);
-        name = NULL;
+    if (d->name != NULL) {
+        transform_set_name(shape_get_root_transform(shape), d->name);
+        free(d->name);
+        d->name = NULL;
     }
 
-    if (hasCustomCollisionBox) {
+    if (d->hasCustomCollisionBox) {
         RigidBody *rb;
-        transform_ensure_rigidbody(shape_get_root_transform(*shape),
+        transform_ensure_rigidbody(shape_get_root_transform(shape),
                                    RigidbodyMode_Static,
                                    PHYSICS_GROUP_DEFAULT_OBJECT,
                                    PHYSICS_COLLIDESWITH_DEFAULT_OBJECT,
@@ -1267,18 +1560,82 @@ uint32_t chunk_v6_read_shape(Stream *s,
 
         // construct new box value
         Box newCollider = *rigidbody_get_collider(rb);
-        newCollider.min = collisionBoxMin;
-        newCollider.max = collisionBoxMax;
+        newCollider.min = d->collisionBoxMin;
+        newCollider.max = d->collisionBoxMax;
 
         // set the new box using
         rigidbody_set_collider(rb, &newCollider, true);
     }
 
-    Transform *const root = shape_get_root_transform(*shape);
+    Transform *const root = shape_get_root_transform(shape);
     if (root) {
-        transform_set_hidden_self(root, isHiddenSelf == 1);
+        transform_set_hidden_self(root, d->isHiddenSelf == 1);
+    }
+}
+
+uint32_t chunk_v6_read_shape(Stream *s,
+                             Shape **shape,
+                             DoublyLinkedList *shapes,
+                             const ShapeSettings *const shapeSettings,
+                             ColorAtlas *colorAtlas,
+                             ColorPalette *filePalette,
+                             uint8_t paletteID,
+                             ColorPalette **rootShapePalette) {
+    if (shapeSettings == NULL) {
+        cclog_error("tried to load shape without shape settings");
+        return 0;
+    }
+
+    /// read file, shape data is inflated while being processed
+    ChunkV6Reader reader;
+    uint32_t chunkSize = 0;
+    uint32_t uncompressedSize = 0;
+    if (chunk_v6_reader_init(&reader, s, &chunkSize, &uncompressedSize) == false) {
+        cclog_error("failed to read shape");
+        return 0;
+    }
+
+    // no need to read if shape return parameter is NULL
+    if (shape == NULL) {
+        cclog_error("shape pointer is null");
+        chunk_v6_reader_end(&reader);
+        return CHUNK_V6_HEADER_NO_ID_SIZE + chunkSize;
+    }
+
+    if (*shape != NULL) {
+        shape_release(*shape);
+        *shape = NULL;
+    }
+
+    ChunkV6ShapeData data;
+    chunk_v6_shape_data_init(&data, paletteID);
+    const bool ok = chunk_v6_read_shape_data(&reader,
+                                             uncompressedSize,
+                                             shapeSettings,
+                                             colorAtlas,
+                                             filePalette,
+                                             rootShapePalette,
+                                             NULL,
+                                             &data);
+
+    // moves stream to the end of shape chunk
+    chunk_v6_reader_end(&reader);
+
+    if (ok == false) {
+        chunk_v6_shape_data_free(&data);
+        return 0;
     }
 
+    chunk_v6_read_shape_apply(&data,
+                              shapes,
+                              shapeSettings,
+                              colorAtlas,
+                              filePalette,
+                              rootShapePalette);
+    *shape = data.shape;
+    data.shape = NULL;
+    chunk_v6_shape_data_free(&data);
+
     return CHUNK_V6_HEADER_NO_ID_SIZE + chunkSize;
 }
 
@@ -1526,7 +1883,7 @@ bool chunk_v6_shape_create_and_write_uncompressed_buffer(const Shape *shape,
                         shapePointPositionsCount * subheaderSize + shapePointPositionsSize +
                         shapePointRotationsCount * subheaderSize + shapePointRotationsSize +
                         (hasLighting ? subheaderSize + shapeLightingSize : 0) +
-                        (nameLen > 0 ? subheaderSize + nameLenSize + nameLen : 0);
+                        (nameLen > 0 ? (uint32_t)(sizeof(uint8_t) + nameLenSize + nameLen) : 0);
 
     *uncompressedData = malloc(*uncompressedSize);
     if (*uncompressedData == NULL) {
@@ -2018,10 +2375,179 @@ bool create_shape_buffers(DoublyLinkedList *shapesBuffers,
     return true;
 }
 
+// MARK: - Threaded shapes loading -
+
+// Shape chunk indexed by serialization_load_assets_v6, to be read & built on a worker thread
+typedef struct {
+    ChunkV6ShapeData data;
+    // created on calling thread, for transform IDs to match the serial path
+    Shape *shape;
+    // chunk header & data, viewed from stream memory or copied
+    const void *bytes;
+    void *bytesCopy;
+    // file palette & palette ID at the time this chunk was found, to apply shape
+    ColorPalette *filePalette;
+    // node of the shape asset in loaded assets list, if any
+    DoublyLinkedListNode *assetNode;
+    uint32_t size;
+    uint8_t paletteID;
+    bool ok;
+    // shape is built w/ a placeholder palette, to be replaced by root shape palette (shared)
+    bool placeholderPalette;
+    char pad[1];
+} ShapeChunkJob;
+
+typedef struct {
+    ShapeChunkJob *jobs;
+    const ShapeSettings *shapeSettings;
+    Mutex *mutex;
+    uint32_t count;
+    uint32_t next;
+} ShapeChunkJobs;
+
+// Keeps shape chunk bytes (header included, chunk ID excluded) to read them later.
+// Returns the size of the chunk or 0 if it can't be read.
+static uint32_t chunk_v6_index_shape(Stream *s, ShapeChunkJob *job) {
+    uint32_t chunkSize = 0;
+    const void *header = stream_peek(s, sizeof(uint32_t));
+    if (header != NULL) {
+        memcpy(&chunkSize, header, sizeof(uint32_t));
+        job->bytes = stream_view(s, CHUNK_V6_HEADER_NO_ID_SIZE + chunkSize);
+        if (job->bytes == NULL) {
+            return 0;
+        }
+    } else {
+        uint8_t headerBytes[CHUNK_V6_HEADER_NO_ID_SIZE];
+        if (stream_read(s, headerBytes, sizeof(headerBytes), 1) == false) {
+            return 0;
+        }
+        memcpy(&chunkSize, headerBytes, sizeof(uint32_t));
+        job->bytesCopy = malloc(sizeof(headerBytes) + chunkSize);
+        if (job->bytesCopy == NULL) {
+            return 0;
+        }
+        memcpy(job->bytesCopy, headerBytes, sizeof(headerBytes));
+        if (stream_read(s, (uint8_t *)job->bytesCopy + sizeof(headerBytes), chunkSize, 1) ==
+            false) {
+            return 0;
+        }
+        job->bytes = job->bytesCopy;
+    }
+    job->size = CHUNK_V6_HEADER_NO_ID_SIZE + chunkSize;
+    return job->size;
+}
+
+// Reads shape chunk without touching shared state: shape palette is read without atlas, blocks are
+// processed if shape has its own palette or uses a placeholder one. See chunk_v6_read_shape_apply
+// for the rest.
+static void chunk_v6_run_shape_job(ShapeChunkJob *job, const ShapeSettings *const shapeSettings) {
+    ColorPalette *placeholder = job->placeholderPalette ? color_palette_new(NULL) : NULL;
+    Stream *s = stream_new_buffer_read((const char *)job->bytes, job->size);
+    ChunkV6Reader reader;
+    uint32_t chunkSize = 0;
+    uint32_t uncompressedSize = 0;
+    if (chunk_v6_reader_init(&reader, s, &chunkSize, &uncompressedSize)) {
+        job->ok = chunk_v6_read_shape_data(&reader,
+                                           uncompressedSize,
+                                           shapeSettings,
+                                           NULL,
+                                           NULL,
+                                           placeholder != NULL ? &placeholder : NULL,
+                                           job->shape,
+                                           &job->data);
+        chunk_v6_reader_end(&reader);
+    } else {
+        cclog_error("failed to read shape");
+        job->ok = false;
+    }
+    stream_free(s);
+    if (placeholder != NULL) {
+        // retained by shape if used
+        color_palette_release(placeholder);
+    }
+}
+
+static void chunk_v6_run_shape_jobs(ShapeChunkJobs *jobs) {
+    while (true) {
+        mutex_lock(jobs->mutex);
+        const uint32_t i = jobs->next;
+        if (i < jobs->count) {
+            ++jobs->next;
+        }
+        mutex_unlock(jobs->mutex);
+
+        if (i >= jobs->count) {
+            return;
+        }
+        chunk_v6_run_shape_job(&jobs->jobs[i], jobs->shapeSettings);
+    }
+}
+
+#if defined(__VX_PLATFORM_WINDOWS)
+static DWORD WINAPI chunk_v6_shape_jobs_thread(LPVOID arg) {
+    chunk_v6_run_shape_jobs((ShapeChunkJobs *)arg);
+    return 0;
+}
+#else
+static void *chunk_v6_shape_jobs_thread(void *arg) {
+    chunk_v6_run_shape_jobs((ShapeChunkJobs *)arg);
+    return NULL;
+}
+#endif
+
+// Runs jobs on nbThreads threads, calling thread included. Jobs that couldn't get a thread (e.g.
+// platform without threads) run on calling thread.
+static void chunk_v6_run_shape_jobs_threaded(ShapeChunkJob *jobs,
+                                             const uint32_t count,
+                                             const ShapeSettings *const shapeSettings,
+                                             uint8_t nbThreads) {
+    ShapeChunkJobs shared = {jobs, shapeSettings, mutex_new(), count, 0};
+    if (shared.mutex == NULL) {
+        nbThreads = 1;
+    }
+    if (nbThreads > count) {
+        nbThreads = (uint8_t)count;
+    }
+
+    uint8_t nbStarted = 0;
+#if defined(__VX_PLATFORM_WINDOWS)
+    HANDLE threads[UINT8_MAX];
+    for (uint8_t i = 1; i < nbThreads; ++i) {
+        threads[nbStarted] = CreateThread(NULL, 0, chunk_v6_shape_jobs_thread, &shared, 0, NULL);
+        if (threads[nbStarted] != NULL) {
+            ++nbStarted;
+        }
+    }
+#else
+    pthread_t threads[UINT8_MAX];
+    for (uint8_t i = 1; i < nbThreads; ++i) {
+        if (pthread_create(&threads[nbStarted], NULL, chunk_v6_shape_jobs_thread, &shared) == 0) {
+            ++nbStarted;
+        }
+    }
+#endif
+
+    chunk_v6_run_shape_jobs(&shared);
+
+    for (uint8_t i = 0; i < nbStarted; ++i) {
+#if defined(__VX_PLATFORM_WINDOWS)
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    if (shared.mutex != NULL) {
+        mutex_free(shared.mutex);
+    }
+}
+
 DoublyLinkedList *serialization_load_assets_v6(Stream *s,
                                                ColorAtlas *colorAtlas,
                                                const ASSET_MASK_T filter,
-                                               const ShapeSettings *const shapeSettings) {
+                                               const ShapeSettings *const shapeSettings,
+                                               const uint8_t nbThreads) {
 
     uint8_t i;
     if (stream_read_uint8(s, &i) == false) {
@@ -2074,6 +2600,14 @@ DoublyLinkedList *serialization_load_assets_v6(Stream *s,
     bool serializedPaletteAssigned = false;
     uint8_t paletteID = PALETTE_ID_IOS_ITEM_EDITOR_LEGACY; // by default, pico8+ legacy colors
 
+    // With worker threads, shape chunks are only indexed while reading the file, then read & built
+    // in parallel, and finally applied in file order (palette sharing, hierarchy...)
+    const bool threaded = nbThreads > 0 && shapeSettings != NULL &&
+                          (filter & AssetType_Shape) != 0;
+    ShapeChunkJob *jobs = NULL;
+    uint32_t jobsCount = 0;
+    uint32_t jobsCapacity = 0;
+
     DoublyLinkedList *shapes = doubly_linked_list_new();
     while (totalSizeRead < totalSize && error == false) {
         chunkID = chunk_v6_read_identifier(s);
@@ -2130,6 +2664,52 @@ DoublyLinkedList *serialization_load_assets_v6(Stream *s,
                 break;
             }
             case P3S_CHUNK_ID_SHAPE: {
+                if (threaded) {
+                    if (jobsCount == jobsCapacity) {
+                        jobsCapacity = jobsCapacity == 0 ? 8 : jobsCapacity * 2;
+                        ShapeChunkJob *grown = (ShapeChunkJob *)realloc(
+                            jobs,
+                            sizeof(ShapeChunkJob) * jobsCapacity);
+                        if (grown == NULL) {
+                            cclog_error("error while allocating shape jobs");
+                            error = true;
+                            break;
+                        }
+                        jobs = grown;
+                    }
+                    ShapeChunkJob *job = &jobs[jobsCount];
+                    memset(job, 0, sizeof(ShapeChunkJob));
+                    chunk_v6_shape_data_init(&job->data, paletteID);
+                    ++jobsCount;
+
+                    sizeRead = chunk_v6_index_shape(s, job);
+                    if (sizeRead == 0) {
+                        cclog_error("error while reading shape");
+                        error = true;
+                        break;
+                    }
+                    job->shape = shape_make_2(shapeSettings->isMutable);
+                    // a later palette chunk would release the current one
+                    job->filePalette = serializedPalette;
+                    if (job->filePalette != NULL) {
+                        color_palette_retain(job->filePalette);
+                    }
+                    job->paletteID = paletteID;
+
+                    Asset *asset = malloc(sizeof(Asset));
+                    if (asset == NULL) {
+                        cclog_error("error while allocating asset (shape)");
+                        error = true;
+                        break;
+                    }
+                    asset->ptr = job->shape;
+                    asset->type = AssetType_Shape;
+                    job->assetNode = doubly_linked_list_push_last(list, asset);
+
+                    totalSizeRead += sizeRead;
+                    break;
+                }
+
                 Shape *shape = NULL;
                 sizeRead = chunk_v6_read_shape(s,
                                                &shape,
@@ -2172,6 +2752,69 @@ DoublyLinkedList *serialization_load_assets_v6(Stream *s,
         }
     }
 
+    if (jobsCount > 0) {
+        // root shape is read first, its palette is shared w/ children that don't have their own
+        chunk_v6_run_shape_job(&jobs[0], shapeSettings);
+        if (jobs[0].ok && jobsCount > 1) {
+            for (uint32_t j = 1; j < jobsCount; ++j) {
+                jobs[j].placeholderPalette = jobs[0].data.palette != NULL;
+            }
+            chunk_v6_run_shape_jobs_threaded(jobs + 1, jobsCount - 1, shapeSettings, nbThreads);
+        }
+
+        // same outcome as the serial path: assets found after a shape that couldn't be read are
+        // dropped
+        bool failed = false;
+        for (uint32_t j = 0; j < jobsCount; ++j) {
+            ShapeChunkJob *job = &jobs[j];
+            if (job->ok && job->assetNode != NULL && failed == false) {
+                if (job->placeholderPalette && job->data.palette == NULL &&
+                    job->data.paletteIsSet) {
+                    shape_replace_palette(job->shape,
+                                          rootShapePalette,
+                                          job->data.usedEntries,
+                                          job->data.usedEntriesCount);
+                }
+                chunk_v6_read_shape_apply(&job->data,
+                                          shapes,
+                                          shapeSettings,
+                                          colorAtlas,
+                                          job->filePalette,
+                                          &rootShapePalette);
+                job->data.shape = NULL;
+
+                // shrink box once all blocks were added to update box origin
+                shape_reset_box(job->shape);
+            } else {
+                if (failed == false && job->assetNode != NULL) {
+                    cclog_error("error while reading shape");
+                    error = true;
+                }
+                failed = true;
+                if (job->assetNode != NULL) {
+                    while (doubly_linked_list_last(list) != job->assetNode) {
+                        Asset *asset = (Asset *)doubly_linked_list_pop_last(list);
+                        if (asset->ptr == serializedPalette) {
+                            serializedPaletteAssigned = false;
+                        }
+                        free(asset);
+                    }
+                    free(doubly_linked_list_pop_last(list));
+                    job->assetNode = NULL;
+                }
+                if (job->data.shape == NULL && job->shape != NULL) {
+                    shape_release(job->shape);
+                }
+            }
+            chunk_v6_shape_data_free(&job->data);
+            if (job->filePalette != NULL) {
+                color_palette_release(job->filePalette);
+            }
+            free(job->bytesCopy);
+        }
+    }
+    free(jobs);
+
     if (serializedPalette != NULL && serializedPaletteAssigned == false) {
         color_palette_release(serializedPalette);
     }
@@ -31,10 +31,13 @@ typedef struct _LocalTransform {
 #define SERIALIZATION_COMPRESSION_ALGO_SIZE sizeof(uint8_t)
 #define SERIALIZATION_TOTAL_SIZE_SIZE sizeof(uint32_t)
 
+/// Loads assets from stream. When nbThreads > 0, shape chunks are read & built on up to nbThreads
+/// threads (calling thread included), with the same result as the serial path (nbThreads == 0).
 DoublyLinkedList *serialization_load_assets_v6(Stream *s,
                                                ColorAtlas *colorAtlas,
                                                const ASSET_MASK_T filter,
-                                               const ShapeSettings *const settings);
+                                               const ShapeSettings *const settings,
+                                               const uint8_t nbThreads);
 
 /// Saves shape in file w/ optional palette
 bool serialization_v6_save_shape(Shape *shape,
@@ -11,7 +11,6 @@
 #include "cclog.h"
 #include "colors.h"
 #include "config.h"
-#include "hash_uint32_int.h"
 #include "serialization.h"
 #include "shape.h"
 #include "stream.h"
@@ -25,6 +24,14 @@
 
 #define VOX_MAX_NB_COLORS 256 // there are always 256 colors in a .vox
 
+// voxels are sorted by chunk when loading, .vox models being at most 256 voxels wide
+#define VOX_CHUNKS_PER_AXIS ((256 + CHUNK_SIZE - 1) / CHUNK_SIZE)
+#define VOX_NB_CHUNKS (VOX_CHUNKS_PER_AXIS * VOX_CHUNKS_PER_AXIS * VOX_CHUNKS_PER_AXIS)
+#define VOX_CHUNK_INDEX(x, y, z)                                                                   \
+    (((uint32_t)(x) / CHUNK_SIZE * VOX_CHUNKS_PER_AXIS + (uint32_t)(y) / CHUNK_SIZE) *             \
+         VOX_CHUNKS_PER_AXIS +                                                                     \
+     (uint32_t)(z) / CHUNK_SIZE)
+
 bool _readExpectedBytes(Stream *s, const char *bytes, size_t size) {
     char current = 0;
     for (size_t i = 0; i < size; ++i) {
@@ -146,15 +153,21 @@ bool serialization_vox_save_shapes(Shape **shapes, const size_t nbShapes, FILE *
     // combine palettes
 
     ColorPalette *combinedPalette = color_palette_new(NULL);
-    HashUInt32Int **paletteConversionMaps = (HashUInt32Int **)malloc(sizeof(HashUInt32Int *) *
-                                                                     nbShapes);
 
-    uint32_t colorAsUint32;
+    // shape palette entry -> combined palette index, for each shape (0 if not found)
+    SHAPE_COLOR_INDEX_INT_T *paletteConversionMaps = (SHAPE_COLOR_INDEX_INT_T *)calloc(
+        nbShapes * VOX_MAX_NB_COLORS,
+        sizeof(SHAPE_COLOR_INDEX_INT_T));
+    if (paletteConversionMaps == NULL) {
+        cclog_error("failed to allocate palette conversion maps");
+        color_palette_release(combinedPalette);
+        return false;
+    }
+
     ColorPalette *palette;
-    HashUInt32Int *paletteConversionMap;
+    const SHAPE_COLOR_INDEX_INT_T *paletteConversionMap;
 
     for (unsigned int i = 0; i < nbShapes; ++i) {
-        paletteConversionMaps[i] = hash_uint32_int_new();
         palette = shape_get_palette(shapes[i]);
         uint8_t count = color_palette_get_count(palette);
         for (SHAPE_COLOR_INDEX_INT_T c = 0; c < count; ++c) {
@@ -170,17 +183,13 @@ bool serialization_vox_save_shapes(Shape **shapes, const size_t nbShapes, FILE *
             // over 128.
             color_palette_check_and_add_color(combinedPalette, color, &index, false);
 
-            colorAsUint32 = color_to_uint32(&color);
-            hash_uint32_int_set(paletteConversionMaps[i], colorAsUint32, index);
+            paletteConversionMaps[i * VOX_MAX_NB_COLORS + c] = index;
         }
     }
 
 #define _shapes_to_vox_error(msg)                                                                  \
     cclog_error(msg);                                                                              \
     color_palette_release(combinedPalette);                                                        \
-    for (unsigned int zzz = 0; zzz < nbShapes; ++zzz) {                                            \
-        hash_uint32_int_free(paletteConversionMaps[zzz]);                                          \
-    }                                                                                              \
     free(paletteConversionMaps);                                                                   \
     return false;
 
@@ -230,8 +239,7 @@ bool serialization_vox_save_shapes(Shape **shapes, const size_t nbShapes, FILE *
     for (unsigned int l = 0; l < nbShapes; ++l) {
 
         const Shape *src = shapes[l];
-        palette = shape_get_palette(src);
-        paletteConversionMap = paletteConversionMaps[l];
+        paletteConversionMap = paletteConversionMaps + l * VOX_MAX_NB_COLORS;
 
         shape_size = shape_get_allocated_size(src);
 
@@ -272,8 +280,7 @@ bool serialization_vox_save_shapes(Shape **shapes, const size_t nbShapes, FILE *
         SHAPE_COORDS_INT3_T coords_in_shape;
         CHUNK_COORDS_INT3_T coords_in_chunk;
         Block *b = NULL;
-        int colorIndexInCombinedPalette;
-        RGBAColor color;
+        SHAPE_COLOR_INDEX_INT_T colorIndexInCombinedPalette;
 
         for (int k = 0; k < shape_size.z; k++) {
             for (int j = 0; j < shape_size.y; j++) {
@@ -293,13 +300,8 @@ bool serialization_vox_save_shapes(Shape **shapes, const size_t nbShapes, FILE *
                     }
 
                     if (block_is_solid(b)) {
-                        SHAPE_COLOR_INDEX_INT_T bci = block_get_color_index(b);
-                        color = color_palette_get_color(palette, bci);
-                        if (hash_uint32_int_get(paletteConversionMap,
-                                                color_to_uint32(&color),
-                                                &colorIndexInCombinedPalette) == false) {
-                            colorIndexInCombinedPalette = 0;
-                        }
+                        colorIndexInCombinedPalette = paletteConversionMap[block_get_color_index(
+                            b)];
 
                         // ⚠️ y -> z, z -> y
                         uint8_t cx = (uint8_t)coords_in_shape.x;
@@ -592,9 +594,6 @@ bool serialization_vox_save_shapes(Shape **shapes, const size_t nbShapes, FILE *
     }
 
     color_palette_release(combinedPalette);
-    for (unsigned int i = 0; i < nbShapes; ++i) {
-        hash_uint32_int_free(paletteConversionMaps[i]);
-    }
     free(paletteConversionMaps);
 
     return true;
@@ -663,9 +662,11 @@ enum serialization_vox_error serialization_vox_load(Stream *s,
     enum serialization_vox_error err = no_error;
 
     size_t blocksPosition = 0;
+    // bound from XYZI chunk size, nbVoxels can't be trusted before allocating
+    uint32_t maxNbVoxels = 0;
     RGBAColor *colors = malloc(sizeof(RGBAColor) * VOX_MAX_NB_COLORS);
     if (colors == NULL) {
-        return unknown_chunk;
+        return out_of_memory;
     }
     for (int i = 0; i < VOX_MAX_NB_COLORS; ++i) {
         colors[i].r = 0;
@@ -740,10 +741,19 @@ enum serialization_vox_error serialization_vox_load(Stream *s,
             uint32_t nbVoxels;
             if (stream_read_uint32(s, &nbVoxels) == false) {
                 cclog_error("could not read nbVoxels");
-                shape_release(*out);
-                return invalid_format;
+                err = invalid_format;
+                break;
             }
 
+            // nbVoxels, then x, z, y, color index for each voxel
+            if (current_chunk_content_bytes < sizeof(uint32_t) ||
+                nbVoxels > (current_chunk_content_bytes - sizeof(uint32_t)) / 4) {
+                cclog_error("nbVoxels doesn't fit in XYZI chunk");
+                err = invalid_format;
+                break;
+            }
+            maxNbVoxels = nbVoxels;
+
             stream_skip(s, 4 * nbVoxels);
         }
 
@@ -758,31 +768,11 @@ enum serialization_vox_error serialization_vox_load(Stream *s,
 
             int nbColors = minimum(current_chunk_content_bytes / 4, VOX_MAX_NB_COLORS);
 
-            for (int i = 0; i < nbColors; i++) {
-
-                if (stream_read_uint8(s, &(colors[i].r)) == false) {
-                    cclog_error("could not read r");
-                    err = invalid_format;
-                    break;
-                }
-
-                if (stream_read_uint8(s, &(colors[i].g)) == false) {
-                    cclog_error("could not read g");
-                    err = invalid_format;
-                    break;
-                }
-
-                if (stream_read_uint8(s, &(colors[i].b)) == false) {
-                    cclog_error("could not read b");
-                    err = invalid_format;
-                    break;
-                }
-
-                if (stream_read_uint8(s, &(colors[i].a)) == false) {
-                    cclog_error("could not read a");
-                    err = invalid_format;
-                    break;
-                }
+            // r, g, b, a for each color, like RGBAColor
+            if (stream_read(s, colors, sizeof(RGBAColor), (size_t)nbColors) == false) {
+                cclog_error("could not read colors");
+                err = invalid_format;
+                break;
             }
         }
         // UNSUPPORTED CHUNK
@@ -807,69 +797,100 @@ enum serialization_vox_error serialization_vox_load(Stream *s,
     stream_set_cursor_position(s, blocksPosition);
 
     uint32_t nbVoxels;
-    uint8_t x, y, z;
-    SHAPE_COLOR_INDEX_INT_T color_index;
-
-    if (stream_read_uint32(s, &nbVoxels) == false) {
+    if (stream_read_uint32(s, &nbVoxels) == false || nbVoxels > maxNbVoxels) {
         cclog_error("could not read nbVoxels");
         shape_release(*out);
+        *out = NULL;
         free(colors);
         return invalid_format;
     }
 
-    ColorPalette *palette = shape_get_palette(*out);
-    for (uint32_t i = 0; i < nbVoxels; i++) {
-
-        // ⚠️ y -> z, z -> y
-        if (stream_read_uint8(s, &x) == false) {
-            cclog_error("could not read x");
-            err = invalid_format;
-            break;
-        }
-
-        if (stream_read_uint8(s, &z) == false) {
-            cclog_error("could not read z");
-            err = invalid_format;
-            break;
-        }
-
-        if (stream_read_uint8(s, &y) == false) {
-            cclog_error("could not read y");
-            err = invalid_format;
-            break;
+    // x, z, y, color index for each voxel,
+    // read in place when stream is memory-backed (buffer or mapped file)
+    const uint8_t *voxels = (const uint8_t *)stream_view(s, 4 * (size_t)nbVoxels);
+    uint8_t *voxelsCopy = NULL;
+    if (voxels == NULL && nbVoxels > 0) {
+        voxelsCopy = (uint8_t *)malloc(4 * (size_t)nbVoxels);
+        if (voxelsCopy == NULL) {
+            cclog_error("could not allocate voxels");
+            shape_release(*out);
+            *out = NULL;
+            free(colors);
+            return out_of_memory;
+        }
+        if (stream_read(s, voxelsCopy, 4, nbVoxels) == false) {
+            cclog_error("could not read voxels");
+            free(voxelsCopy);
+            shape_release(*out);
+            *out = NULL;
+            free(colors);
+            return invalid_format;
         }
+        voxels = voxelsCopy;
+    }
 
-        if (stream_read_uint8(s, &color_index) == false) {
-            cclog_error("could not read color_index");
-            err = invalid_format;
-            break;
+    // 1st pass, in file order for palette entries to be ordered by first use: translate .vox color
+    // indices to a shape palette w/ only used colors, and count voxels per chunk
+    ColorPalette *palette = shape_get_palette(*out);
+    SHAPE_COLOR_INDEX_INT_T remap[VOX_MAX_NB_COLORS];
+    bool remapped[VOX_MAX_NB_COLORS] = {false};
+    uint32_t *chunkStarts = (uint32_t *)calloc(VOX_NB_CHUNKS + 1, sizeof(uint32_t));
+    uint32_t *sorted = (uint32_t *)malloc(sizeof(uint32_t) * (nbVoxels > 0 ? nbVoxels : 1));
+    if (chunkStarts == NULL || sorted == NULL) {
+        cclog_error("could not allocate voxels");
+        free(chunkStarts);
+        free(sorted);
+        free(voxelsCopy);
+        shape_release(*out);
+        *out = NULL;
+        free(colors);
+        return out_of_memory;
+    }
+
+    const uint8_t *v = voxels;
+    for (uint32_t i = 0; i < nbVoxels; ++i, v += 4) {
+        if (remapped[v[3]] == false) {
+            // MV block indexes start at 1, while palette indexes start at 0.
+            // We have to shift the color index.
+            // It's also done when exporting .vox (+1 instead of -1)
+            SHAPE_COLOR_INDEX_INT_T colorIdx = (SHAPE_COLOR_INDEX_INT_T)(v[3] - 1);
+            if (color_palette_check_and_add_color(palette, colors[colorIdx], &colorIdx, false) ==
+                false) {
+                colorIdx = 0;
+            }
+            remap[v[3]] = colorIdx;
+            remapped[v[3]] = true;
         }
+        // ⚠️ y -> z, z -> y
+        ++chunkStarts[VOX_CHUNK_INDEX(v[0], v[2], v[1]) + 1];
+    }
+    for (uint32_t c = 0; c < VOX_NB_CHUNKS; ++c) {
+        chunkStarts[c + 1] += chunkStarts[c];
+    }
 
-        // MV block indexes start at 1, while palette indexes start at 0.
-        // We have to shift the color index.
-        // It's also done when exporting .vox (+1 instead of -1)
-        SHAPE_COLOR_INDEX_INT_T colorIdx = color_index - 1;
-
-        // translate & shrink to a shape palette w/ only used colors
-        if (color_palette_check_and_add_color(palette, colors[colorIdx], &colorIdx, false) ==
-            false) {
-            colorIdx = 0;
-        }
+    // 2nd pass: sort voxels by chunk, keeping file order within each chunk
+    v = voxels;
+    for (uint32_t i = 0; i < nbVoxels; ++i, v += 4) {
+        // ⚠️ y -> z, z -> y
+        sorted[chunkStarts[VOX_CHUNK_INDEX(v[0], v[2], v[1])]++] =
+            (uint32_t)v[0] | (uint32_t)v[2] << 8 | (uint32_t)v[1] << 16 |
+            (uint32_t)remap[v[3]] << 24;
+    }
+    free(voxelsCopy);
+    free(chunkStarts);
 
+    // each chunk is now created once and filled before moving on to the next one
+    for (uint32_t i = 0; i < nbVoxels; ++i) {
         shape_add_block(*out,
-                        colorIdx,
-                        (SHAPE_COORDS_INT_T)x,
-                        (SHAPE_COORDS_INT_T)y,
-                        (SHAPE_COORDS_INT_T)z,
+                        (SHAPE_COLOR_INDEX_INT_T)(sorted[i] >> 24),
+                        (SHAPE_COORDS_INT_T)(sorted[i] & 0xFF),
+                        (SHAPE_COORDS_INT_T)(sorted[i] >> 8 & 0xFF),
+                        (SHAPE_COORDS_INT_T)(sorted[i] >> 16 & 0xFF),
                         false);
     }
+    free(sorted);
+    free(colors);
     color_palette_clear_lighting_dirty(palette);
 
-    if (err != no_error) {
-        shape_release(*out);
-        free(colors);
-        return err;
-    }
-
     return no_error;
 }
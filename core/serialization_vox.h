@@ -24,7 +24,8 @@ enum serialization_vox_error {
     cant_open_file = 1,
     invalid_format = 2,
     pack_chunk_found = 3,
-    unknown_chunk = 4
+    unknown_chunk = 4,
+    out_of_memory = 5
 };
 
 /// Saves Shape in .vox format (Magicavoxel)
@@ -837,6 +837,18 @@ void shape_set_palette(Shape *shape, ColorPalette *palette, const bool retain) {
     shape_refresh_all_vertices(shape);
 }
 
+void shape_replace_palette(Shape *shape,
+                           ColorPalette *palette,
+                           const SHAPE_COLOR_INDEX_INT_T *entries,
+                           const uint16_t count) {
+    for (uint16_t i = 0; i < count; ++i) {
+        color_palette_increment_color(palette, entries[i], shape->blocksCount[entries[i]]);
+    }
+    color_palette_retain(palette);
+    color_palette_release(shape->palette);
+    shape->palette = palette;
+}
+
 void shape_remap_colors(Shape *s, const SHAPE_COLOR_INDEX_INT_T *remap) {
     SHAPE_COORDS_INT3_T chunkFrom = chunk_utils_get_coords(
         (SHAPE_COORDS_INT3_T){s->bbMin.x, s->bbMin.y, s->bbMin.z});
@@ -1911,7 +1923,8 @@ float shape_box_cast(const Shape *s,
                          modelVector->z / maxDist};
 
     // select overlapped chunks
-    DoublyLinkedList *chunksQuery = doubly_linked_list_new();
+    RtreeCastResults chunksQuery;
+    rtree_cast_results_init(&chunksQuery);
     if (rtree_query_cast_all_box(s->rtree,
                                  modelBox,
                                  &unit,
@@ -1919,32 +1932,27 @@ float shape_box_cast(const Shape *s,
                                  0,
                                  1,
                                  NULL,
-                                 chunksQuery,
+                                 &chunksQuery,
                                  modelEpsilon) > 0) {
-        // sort query results by distance
-        doubly_linked_list_sort_ascending(chunksQuery, rtree_utils_result_sort_func);
-
         Box broadPhaseBox, tmpBox;
         box_set_broadphase_box(modelBox, modelVector, &broadPhaseBox);
 
-        // examine query results in order, return first hit block
-        DoublyLinkedListNode *n = doubly_linked_list_first(chunksQuery);
-        RtreeCastResult *rtreeHit;
+        // examine query results by ascending distance, return first hit block
+        RtreeCastResult rtreeHit;
         OctreeIterator *oi;
         Chunk *c;
         bool didHit = false, leaf;
         float3 tmpNormal, tmpReplacement;
         float swept = 1.0f, lastRtreeDist = FLT_MAX;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
-            c = (Chunk *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
+        while (rtree_cast_results_pop_nearest(&chunksQuery, &rtreeHit)) {
+            c = (Chunk *)rtree_node_get_leaf_ptr(rtreeHit.rtreeLeaf);
 
             // make sure to examine all hits w/ similar distances before stopping
             if (didHit &&
-                float_isEqual(rtreeHit->distance, lastRtreeDist, EPSILON_COLLISION) == false) {
+                float_isEqual(rtreeHit.distance, lastRtreeDist, EPSILON_COLLISION) == false) {
                 break;
             }
-            lastRtreeDist = rtreeHit->distance;
+            lastRtreeDist = rtreeHit.distance;
 
             const SHAPE_COORDS_INT3_T chunkOrigin = chunk_get_origin(c);
             leaf = false;
@@ -2052,12 +2060,9 @@ float shape_box_cast(const Shape *s,
                 blockCoords->y += chunkOrigin.y;
                 blockCoords->z += chunkOrigin.z;
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(chunksQuery, free);
-    doubly_linked_list_free(chunksQuery);
+    rtree_cast_results_release(&chunksQuery);
 
     return minSwept;
 }
@@ -2080,14 +2085,11 @@ bool shape_ray_cast(const Transform *t,
     Ray *modelRay = ray_transform(worldRay, &invModel);
 
     // select traversed chunks
-    DoublyLinkedList *chunksQuery = doubly_linked_list_new();
-    if (rtree_query_cast_all_ray(s->rtree, modelRay, 0, 1, NULL, chunksQuery) > 0) {
-        // sort query results by distance
-        doubly_linked_list_sort_ascending(chunksQuery, rtree_utils_result_sort_func);
-
-        // examine query results in order, return first hit block
-        DoublyLinkedListNode *n = doubly_linked_list_first(chunksQuery);
-        RtreeCastResult *rtreeHit;
+    RtreeCastResults chunksQuery;
+    rtree_cast_results_init(&chunksQuery);
+    if (rtree_query_cast_all_ray(s->rtree, modelRay, 0, 1, NULL, &chunksQuery) > 0) {
+        // examine query results by ascending distance, return first hit block
+        RtreeCastResult rtreeHit;
         OctreeIterator *oi;
         Chunk *c;
         bool didHit = false, leaf;
@@ -2096,16 +2098,15 @@ bool shape_ray_cast(const Transform *t,
         uint16_t x = 0, y = 0, z = 0;
         Box tmpBox;
         float d;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
-            c = (Chunk *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
+        while (rtree_cast_results_pop_nearest(&chunksQuery, &rtreeHit)) {
+            c = (Chunk *)rtree_node_get_leaf_ptr(rtreeHit.rtreeLeaf);
 
             // make sure to examine all hits w/ similar distances before stopping
             if (didHit &&
-                float_isEqual(rtreeHit->distance, lastRtreeDist, EPSILON_COLLISION) == false) {
+                float_isEqual(rtreeHit.distance, lastRtreeDist, EPSILON_COLLISION) == false) {
                 break;
             }
-            lastRtreeDist = rtreeHit->distance;
+            lastRtreeDist = rtreeHit.distance;
 
             const SHAPE_COORDS_INT3_T chunkOrigin = chunk_get_origin(c);
             leaf = false;
@@ -2144,14 +2145,11 @@ bool shape_ray_cast(const Transform *t,
                 y += chunkOrigin.y;
                 z += chunkOrigin.z;
             }
-
-            n = doubly_linked_list_node_next(n);
         }
 
         if (hitBlock == NULL) {
             ray_free(modelRay);
-            doubly_linked_list_flush(chunksQuery, free);
-            doubly_linked_list_free(chunksQuery);
+            rtree_cast_results_release(&chunksQuery);
             return false;
         }
 
@@ -2184,14 +2182,12 @@ bool shape_ray_cast(const Transform *t,
         }
 
         ray_free(modelRay);
-        doubly_linked_list_flush(chunksQuery, free);
-        doubly_linked_list_free(chunksQuery);
+        rtree_cast_results_release(&chunksQuery);
         return true;
     }
 
     ray_free(modelRay);
-    doubly_linked_list_flush(chunksQuery, free);
-    doubly_linked_list_free(chunksQuery);
+    rtree_cast_results_release(&chunksQuery);
 
     return false;
 }
@@ -2213,10 +2209,10 @@ bool shape_point_overlap(const Shape *s, const float3 *world) {
     shape_get_chunk_and_coordinates(s, coords_in_shape, &c, NULL, &coords_in_chunk);
 
     if (c != NULL) {
-        Block *b = (Block *)octree_get_element_without_checking(chunk_get_octree(c),
-                                                                (size_t)coords_in_chunk.x,
-                                                                (size_t)coords_in_chunk.y,
-                                                                (size_t)coords_in_chunk.z);
+        Block *b = (Block *)octree_get_element_fast(chunk_get_octree(c),
+                                                    (size_t)coords_in_chunk.x,
+                                                    (size_t)coords_in_chunk.y,
+                                                    (size_t)coords_in_chunk.z);
 
         return block_is_solid(b);
     }
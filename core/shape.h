@@ -88,6 +88,12 @@ void shape_flush(Shape *shape);
 // access palette reference to get or set the colors
 ColorPalette *shape_get_palette(const Shape *shape);
 void shape_set_palette(Shape *shape, ColorPalette *palette, const bool retain);
+/// Replaces the placeholder palette a shape was built with, w/o refreshing vertices. Blocks are
+/// counted in new palette following given entries order (e.g. order of first use)
+void shape_replace_palette(Shape *shape,
+                           ColorPalette *palette,
+                           const SHAPE_COLOR_INDEX_INT_T *entries,
+                           const uint16_t count);
 void shape_remap_colors(Shape *s, const SHAPE_COLOR_INDEX_INT_T *remap);
 
 /// Gets the block in model OR transactions
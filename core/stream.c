@@ -9,11 +9,20 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__VX_PLATFORM_WINDOWS)
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 enum STREAM_TYPE {
     STREAM_TYPE_FILE_READ = 1,
     STREAM_TYPE_FILE_WRITE = 2,
     STREAM_TYPE_BUFFER_READ = 3,
-    STREAM_TYPE_BUFFER_WRITE = 4
+    STREAM_TYPE_BUFFER_WRITE = 4,
+    STREAM_TYPE_MAPPED_READ = 5
 };
 
 typedef struct {
@@ -32,11 +41,38 @@ typedef struct {
     FILE *file;
 } StreamData_FILE;
 
+// read like a buffer, `buffer` has to remain first field
+typedef struct {
+    StreamData_BUFFER_READ buffer;
+    FILE *file;
+    // file mapping handle (Windows), NULL if content has been read in allocated buffer
+    void *mapping;
+    bool mapped;
+    char pad[7];
+} StreamData_MAPPED_READ;
+
 struct _Stream {
     enum STREAM_TYPE type;
     void *data;
 };
 
+// Unmaps or frees file content of a STREAM_TYPE_MAPPED_READ stream
+static void _stream_release_file_content(const char *bytes,
+                                         const size_t size,
+                                         void *mapping,
+                                         const bool mapped) {
+    if (mapped == false) {
+        free((void *)bytes);
+    } else {
+#if defined(__VX_PLATFORM_WINDOWS)
+        UnmapViewOfFile(bytes);
+        CloseHandle((HANDLE)mapping);
+#else
+        munmap((void *)bytes, size);
+#endif
+    }
+}
+
 void stream_free(Stream *s) {
     switch (s->type) {
         case STREAM_TYPE_BUFFER_READ: {
@@ -59,6 +95,16 @@ void stream_free(Stream *s) {
             data->file = NULL;
             break;
         }
+        case STREAM_TYPE_MAPPED_READ: {
+            StreamData_MAPPED_READ *data = (StreamData_MAPPED_READ *)(s->data);
+            _stream_release_file_content(data->buffer.buffer,
+                                         data->buffer.bufferSize,
+                                         data->mapping,
+                                         data->mapped);
+            fclose(data->file);
+            data->file = NULL;
+            break;
+        }
     }
 
     free(s->data);
@@ -127,6 +173,87 @@ Stream *stream_new_file_read(FILE *fd) {
     return s;
 }
 
+// Maps `size` bytes of `fd`, returns NULL on failure.
+static const char *_stream_map_file(FILE *fd, const size_t size, void **mapping) {
+#if defined(__VX_PLATFORM_WINDOWS)
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno(fd));
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    HANDLE m = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m == NULL) {
+        return NULL;
+    }
+    const char *bytes = (const char *)MapViewOfFile(m, FILE_MAP_READ, 0, 0, size);
+    if (bytes == NULL) {
+        CloseHandle(m);
+        return NULL;
+    }
+    *mapping = (void *)m;
+    return bytes;
+#else
+    void *bytes = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(fd), 0);
+    if (bytes == MAP_FAILED) {
+        return NULL;
+    }
+    *mapping = NULL;
+    return (const char *)bytes;
+#endif
+}
+
+Stream *stream_new_file_map(FILE *fd) {
+    // stream starts at current position
+    const long start = ftell(fd);
+    if (start < 0 || fseek(fd, 0, SEEK_END) != 0) {
+        return stream_new_file_read(fd);
+    }
+    const long end = ftell(fd);
+    if (end <= start || fseek(fd, start, SEEK_SET) != 0) {
+        return stream_new_file_read(fd);
+    }
+    const size_t fileSize = (size_t)end;
+
+    void *mapping = NULL;
+    const char *bytes = _stream_map_file(fd, fileSize, &mapping);
+    const bool mapped = bytes != NULL;
+
+    if (mapped == false) {
+        // mapping not available, reading whole content in one go
+        char *content = (char *)malloc(fileSize);
+        if (content == NULL) {
+            return stream_new_file_read(fd);
+        }
+        if (fseek(fd, 0, SEEK_SET) != 0 || fread(content, 1, fileSize, fd) != fileSize) {
+            free(content);
+            fseek(fd, start, SEEK_SET);
+            return stream_new_file_read(fd);
+        }
+        bytes = content;
+    }
+
+    Stream *s = (Stream *)malloc(sizeof(Stream));
+    // cursor positions are file positions, like with STREAM_TYPE_FILE_READ
+    StreamData_MAPPED_READ *data = malloc(sizeof(StreamData_MAPPED_READ));
+    if (s == NULL || data == NULL) {
+        free(s);
+        free(data);
+        _stream_release_file_content(bytes, fileSize, mapping, mapped);
+        fclose(fd);
+        return NULL;
+    }
+    s->type = STREAM_TYPE_MAPPED_READ;
+
+    data->buffer.buffer = bytes;
+    data->buffer.bufferSize = fileSize;
+    data->buffer.cursor = bytes + start;
+    data->file = fd;
+    data->mapping = mapping;
+    data->mapped = mapped;
+
+    s->data = (void *)data;
+    return s;
+}
+
 bool stream_buffer_unload(Stream *s, char **buf, size_t *written, size_t *bufSize) {
     if (s->type != STREAM_TYPE_BUFFER_WRITE)
         return false;
@@ -150,7 +277,8 @@ bool stream_buffer_unload(Stream *s, char **buf, size_t *written, size_t *bufSiz
 
 bool stream_read(Stream *s, void *outValue, size_t itemSize, size_t nbItems) {
     switch (s->type) {
-        case STREAM_TYPE_BUFFER_READ: {
+        case STREAM_TYPE_BUFFER_READ:
+        case STREAM_TYPE_MAPPED_READ: {
             size_t toRead = itemSize * nbItems;
             StreamData_BUFFER_READ *data = (StreamData_BUFFER_READ *)(s->data);
             if ((size_t)(data->cursor - data->buffer) + toRead > data->bufferSize) {
@@ -196,7 +324,8 @@ bool stream_read_string(Stream *s, size_t size, char *outValue) {
 
 bool stream_skip(Stream *s, size_t bytesToSkip) {
     switch (s->type) {
-        case STREAM_TYPE_BUFFER_READ: {
+        case STREAM_TYPE_BUFFER_READ:
+        case STREAM_TYPE_MAPPED_READ: {
             StreamData_BUFFER_READ *data = (StreamData_BUFFER_READ *)(s->data);
             if ((size_t)(data->cursor - data->buffer) + bytesToSkip > data->bufferSize) {
                 return false;
@@ -219,7 +348,8 @@ bool stream_skip(Stream *s, size_t bytesToSkip) {
 
 size_t stream_get_cursor_position(Stream *s) {
     switch (s->type) {
-        case STREAM_TYPE_BUFFER_READ: {
+        case STREAM_TYPE_BUFFER_READ:
+        case STREAM_TYPE_MAPPED_READ: {
             StreamData_BUFFER_READ *data = (StreamData_BUFFER_READ *)(s->data);
             return (size_t)(data->cursor - data->buffer);
         }
@@ -235,7 +365,8 @@ size_t stream_get_cursor_position(Stream *s) {
 
 void stream_set_cursor_position(Stream *s, size_t pos) {
     switch (s->type) {
-        case STREAM_TYPE_BUFFER_READ: {
+        case STREAM_TYPE_BUFFER_READ:
+        case STREAM_TYPE_MAPPED_READ: {
             StreamData_BUFFER_READ *data = (StreamData_BUFFER_READ *)(s->data);
             data->cursor = data->buffer + pos;
             break;
@@ -252,7 +383,8 @@ void stream_set_cursor_position(Stream *s, size_t pos) {
 
 bool stream_reached_the_end(Stream *s) {
     switch (s->type) {
-        case STREAM_TYPE_BUFFER_READ: {
+        case STREAM_TYPE_BUFFER_READ:
+        case STREAM_TYPE_MAPPED_READ: {
             StreamData_BUFFER_READ *data = (StreamData_BUFFER_READ *)(s->data);
             return (size_t)(data->cursor - data->buffer) == data->bufferSize;
         }
@@ -272,3 +404,28 @@ bool stream_reached_the_end(Stream *s) {
     }
     return false;
 }
+
+const void *stream_peek(Stream *s, size_t size) {
+    switch (s->type) {
+        case STREAM_TYPE_BUFFER_READ:
+        case STREAM_TYPE_MAPPED_READ: {
+            StreamData_BUFFER_READ *data = (StreamData_BUFFER_READ *)(s->data);
+            if (size > data->bufferSize - (size_t)(data->cursor - data->buffer)) {
+                return NULL;
+            }
+            return (const void *)data->cursor;
+        }
+        default:
+            break;
+    }
+    return NULL;
+}
+
+const void *stream_view(Stream *s, size_t size) {
+    const void *view = stream_peek(s, size);
+    if (view != NULL) {
+        StreamData_BUFFER_READ *data = (StreamData_BUFFER_READ *)(s->data);
+        data->cursor += size;
+    }
+    return view;
+}
@@ -40,6 +40,13 @@ Stream *stream_new_file_write(FILE *fd);
 // Expecting a file opened with "rb" flag
 Stream *stream_new_file_read(FILE *fd);
 
+// Expecting a file opened with "rb" flag
+// File content is memory-mapped (or read in one go where mapping isn't available),
+// reads are then bounds-checked memory accesses and stream_peek / stream_view can be used.
+// Falls back to stream_new_file_read behavior if content can't be mapped nor read.
+// Returns NULL (fd closed) if the stream can't be allocated.
+Stream *stream_new_file_map(FILE *fd);
+
 // READ
 
 bool stream_read(Stream *s, void *outValue, size_t itemSize, size_t nbItems);
@@ -50,6 +57,14 @@ bool stream_read_float32(Stream *s, float *outValue);
 bool stream_read_string(Stream *s, size_t size, char *outValue);
 bool stream_skip(Stream *s, size_t bytesToSkip);
 
+// Returns a pointer to the next `size` bytes, without copying them nor moving the cursor.
+// Returns NULL if there are not enough bytes left or if the stream isn't memory-backed
+// (buffer or mapped file), callers then have to use stream_read.
+const void *stream_peek(Stream *s, size_t size);
+
+// Same as stream_peek, moving the cursor after returned bytes.
+const void *stream_view(Stream *s, size_t size);
+
 size_t stream_get_cursor_position(Stream *s);
 void stream_set_cursor_position(Stream *s, size_t pos);
 
@@ -0,0 +1,160 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench.h
+// -------------------------------------------------------------
+
+// Minimal benchmark harness, provides main().
+//
+// Benchmarks are listed in bench_list.c w/ BENCH_LIST, similar to acutest's TEST_LIST.
+// Each benchmark function is called once per run, it must measure its hot section between
+// bench_start & bench_stop, and report how many items it processed w/ bench_set_items.
+// Setup & teardown done outside of bench_start/bench_stop are not measured.
+// An extra value that isn't a throughput (e.g. peak memory) can be reported w/ bench_set_metric.
+//
+// Results are printed to stdout as JSON, so they can be tracked between releases.
+//
+// Usage: core_bench [--runs N] [filter...]
+// Only benchmarks whose name contains one of the filters are run.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_RUNS 5
+#define BENCH_MAX_RUNS 100
+
+typedef struct {
+    uint64_t startNs;
+    uint64_t elapsedNs;
+    uint64_t items;
+    const char *metricName;
+    uint64_t metric;
+} Bench;
+
+typedef void (*pointer_bench_func)(Bench *b);
+
+typedef struct {
+    const char *name;
+    pointer_bench_func func;
+} BenchEntry;
+
+#define BENCH_LIST const BenchEntry bench_list_[]
+
+extern const BenchEntry bench_list_[];
+
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/// Starts (or resumes) measuring
+static inline void bench_start(Bench *b) {
+    b->startNs = bench_now_ns();
+}
+
+/// Stops measuring, can be called several times in a run to exclude setup between sections
+static inline void bench_stop(Bench *b) {
+    b->elapsedNs += bench_now_ns() - b->startNs;
+}
+
+/// Number of items processed per run (blocks, keys, casts...), used to report throughput
+static inline void bench_set_items(Bench *b, uint64_t items) {
+    b->items = items;
+}
+
+/// Extra value per run, reported as is (`<name>`)
+static inline void bench_set_metric(Bench *b, const char *name, uint64_t value) {
+    b->metricName = name;
+    b->metric = value;
+}
+
+/// Prevents the compiler from optimizing out a computed value
+static volatile uint64_t bench_sink_;
+static inline void bench_consume(uint64_t value) {
+    bench_sink_ += value;
+}
+
+#ifndef BENCH_NO_MAIN
+
+static int bench_compare_u64_(const void *a, const void *b) {
+    const uint64_t v1 = *(const uint64_t *)a;
+    const uint64_t v2 = *(const uint64_t *)b;
+    return v1 < v2 ? -1 : (v1 > v2 ? 1 : 0);
+}
+
+static int bench_is_selected_(const char *name, int argc, char **argv, int firstFilter) {
+    if (firstFilter >= argc) {
+        return 1;
+    }
+    for (int i = firstFilter; i < argc; ++i) {
+        if (strstr(name, argv[i]) != NULL) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int runs = BENCH_DEFAULT_RUNS;
+    int firstFilter = 1;
+    if (argc > 2 && strcmp(argv[1], "--runs") == 0) {
+        runs = atoi(argv[2]);
+        if (runs < 1) {
+            runs = 1;
+        } else if (runs > BENCH_MAX_RUNS) {
+            runs = BENCH_MAX_RUNS;
+        }
+        firstFilter = 3;
+    }
+
+    uint64_t samples[BENCH_MAX_RUNS];
+    int first = 1;
+
+    printf("{\n  \"suite\": \"core_bench\",\n  \"runs\": %d,\n  \"results\": [", runs);
+    for (const BenchEntry *e = bench_list_; e->name != NULL; ++e) {
+        if (bench_is_selected_(e->name, argc, argv, firstFilter) == 0) {
+            continue;
+        }
+
+        Bench b = {0, 0, 0, NULL, 0};
+        uint64_t total = 0;
+        for (int r = 0; r < runs; ++r) {
+            b.elapsedNs = 0;
+            e->func(&b);
+            samples[r] = b.elapsedNs;
+            total += b.elapsedNs;
+        }
+        qsort(samples, (size_t)runs, sizeof(uint64_t), bench_compare_u64_);
+
+        const uint64_t median = samples[runs / 2];
+        const double itemsPerSec = median > 0 ? (double)b.items * 1e9 / (double)median : 0.0;
+
+        printf("%s\n    {\"name\": \"%s\", \"items\": %llu, \"min_ns\": %llu, "
+               "\"median_ns\": %llu, \"mean_ns\": %llu, \"max_ns\": %llu, "
+               "\"items_per_sec\": %.1f",
+               first ? "" : ",",
+               e->name,
+               (unsigned long long)b.items,
+               (unsigned long long)samples[0],
+               (unsigned long long)median,
+               (unsigned long long)(total / (uint64_t)runs),
+               (unsigned long long)samples[runs - 1],
+               itemsPerSec);
+        if (b.metricName != NULL) {
+            printf(", \"%s\": %llu", b.metricName, (unsigned long long)b.metric);
+        }
+        printf("}");
+        fflush(stdout);
+        first = 0;
+    }
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
+
+#endif
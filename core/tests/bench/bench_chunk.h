@@ -0,0 +1,80 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench_chunk.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "chunk.h"
+#include "color_atlas.h"
+#include "shape.h"
+#include "vertextbuffer.h"
+
+#define BENCH_CHUNK_SHAPE_SIZE 64
+
+// terrain-like shape: solid ground, then sparse blocks w/ a mix of opaque & transparent colors
+static Shape *_bench_chunk_shape_new(ColorAtlas *atlas, bool lighting) {
+    Shape *s = shape_make_2(true);
+    ColorPalette *palette = color_palette_new(atlas);
+    shape_set_palette(s, palette, false);
+
+    const RGBAColor colors[4] = {{200, 10, 10, 255},
+                                 {10, 200, 10, 255},
+                                 {10, 10, 200, 100},
+                                 {250, 250, 0, 255}};
+    SHAPE_COLOR_INDEX_INT_T idx[4];
+    for (int i = 0; i < 4; ++i) {
+        color_palette_check_and_add_color(palette, colors[i], &idx[i], false);
+    }
+
+    uint32_t r = 42;
+    for (SHAPE_COORDS_INT_T x = 0; x < BENCH_CHUNK_SHAPE_SIZE; ++x) {
+        for (SHAPE_COORDS_INT_T y = 0; y < BENCH_CHUNK_SHAPE_SIZE / 2; ++y) {
+            for (SHAPE_COORDS_INT_T z = 0; z < BENCH_CHUNK_SHAPE_SIZE; ++z) {
+                r = r * 1664525u + 1013904223u;
+                if (y < 8 || (r >> 24) % 4 == 0) {
+                    shape_add_block(s, idx[(r >> 16) % 4], x, y, z, false);
+                }
+            }
+        }
+    }
+    shape_apply_current_transaction(s, true);
+    if (lighting) {
+        shape_compute_baked_lighting(s);
+    }
+    // first refresh allocates vertex buffers
+    shape_refresh_all_vertices(s);
+    return s;
+}
+
+static void _bench_chunk_write_vertices(Bench *b, bool lighting) {
+    vertex_buffer_set_lighting_enabled(lighting);
+    chunk_alloc_default_light();
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *s = _bench_chunk_shape_new(atlas, lighting);
+
+    uint64_t chunks = 0;
+    bench_start(b);
+    Index3DIterator *it = index3d_iterator_new(shape_get_chunks(s));
+    Chunk *c;
+    while (index3d_iterator_pointer(it) != NULL) {
+        c = (Chunk *)index3d_iterator_pointer(it);
+        chunk_write_vertices(s, c);
+        ++chunks;
+        index3d_iterator_next(it);
+    }
+    index3d_iterator_free(it);
+    bench_stop(b);
+    bench_set_items(b, chunks);
+
+    shape_release(s);
+    color_atlas_free(atlas);
+}
+
+void bench_chunk_write_vertices(Bench *b) {
+    _bench_chunk_write_vertices(b, false);
+}
+
+void bench_chunk_write_vertices_lighting(Bench *b) {
+    _bench_chunk_write_vertices(b, true);
+}
@@ -0,0 +1,86 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench_hash_uint32_int.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "hash_uint32_int.h"
+
+// keys spread like RGBA colors would, w/ a fixed sequence for reproducibility
+static uint32_t _bench_hash_uint32_int_key(uint32_t i) {
+    return (i * 2654435761u) ^ 0xFF000000u;
+}
+
+static void _bench_hash_uint32_int_insert(Bench *b, uint32_t n) {
+    HashUInt32Int *h = hash_uint32_int_new();
+
+    bench_start(b);
+    for (uint32_t i = 0; i < n; ++i) {
+        hash_uint32_int_set(h, _bench_hash_uint32_int_key(i), (int)i);
+    }
+    bench_stop(b);
+    bench_set_items(b, n);
+
+    hash_uint32_int_free(h);
+}
+
+static void _bench_hash_uint32_int_get(Bench *b, uint32_t n) {
+    HashUInt32Int *h = hash_uint32_int_new();
+    for (uint32_t i = 0; i < n; ++i) {
+        hash_uint32_int_set(h, _bench_hash_uint32_int_key(i), (int)i);
+    }
+
+    // half hits, half misses
+    int v;
+    uint64_t found = 0;
+    bench_start(b);
+    for (uint32_t i = 0; i < 2 * n; ++i) {
+        found += hash_uint32_int_get(h, _bench_hash_uint32_int_key(i), &v) ? 1 : 0;
+    }
+    bench_stop(b);
+    bench_set_items(b, 2 * (uint64_t)n);
+    bench_consume(found);
+
+    hash_uint32_int_free(h);
+}
+
+static void _bench_hash_uint32_int_delete(Bench *b, uint32_t n) {
+    HashUInt32Int *h = hash_uint32_int_new();
+    for (uint32_t i = 0; i < n; ++i) {
+        hash_uint32_int_set(h, _bench_hash_uint32_int_key(i), (int)i);
+    }
+
+    bench_start(b);
+    for (uint32_t i = 0; i < n; ++i) {
+        hash_uint32_int_delete(h, _bench_hash_uint32_int_key(i));
+    }
+    bench_stop(b);
+    bench_set_items(b, n);
+
+    hash_uint32_int_free(h);
+}
+
+void bench_hash_uint32_int_insert_1k(Bench *b) {
+    _bench_hash_uint32_int_insert(b, 1000);
+}
+
+void bench_hash_uint32_int_insert_1m(Bench *b) {
+    _bench_hash_uint32_int_insert(b, 1000000);
+}
+
+void bench_hash_uint32_int_get_1k(Bench *b) {
+    _bench_hash_uint32_int_get(b, 1000);
+}
+
+void bench_hash_uint32_int_get_1m(Bench *b) {
+    _bench_hash_uint32_int_get(b, 1000000);
+}
+
+void bench_hash_uint32_int_delete_1k(Bench *b) {
+    _bench_hash_uint32_int_delete(b, 1000);
+}
+
+void bench_hash_uint32_int_delete_1m(Bench *b) {
+    _bench_hash_uint32_int_delete(b, 1000000);
+}
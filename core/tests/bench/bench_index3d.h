@@ -0,0 +1,147 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench_index3d.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "color_atlas.h"
+#include "index3d.h"
+#include "shape.h"
+
+#define BENCH_INDEX3D_SIZE 32
+
+static void _bench_index3d_fill(Index3D *index, int32_t min, int32_t size) {
+    for (int32_t x = min; x < min + size; ++x) {
+        for (int32_t y = min; y < min + size; ++y) {
+            for (int32_t z = min; z < min + size; ++z) {
+                index3d_insert(index, index, x, y, z, NULL);
+            }
+        }
+    }
+}
+
+static void _bench_index3d_insert(Bench *b, int32_t min) {
+    Index3D *index = index3d_new();
+
+    bench_start(b);
+    _bench_index3d_fill(index, min, BENCH_INDEX3D_SIZE);
+    bench_stop(b);
+    bench_set_items(b, BENCH_INDEX3D_SIZE * BENCH_INDEX3D_SIZE * BENCH_INDEX3D_SIZE);
+
+    index3d_flush(index, NULL);
+    index3d_free(index);
+}
+
+static void _bench_index3d_get(Bench *b, int32_t min) {
+    Index3D *index = index3d_new();
+    _bench_index3d_fill(index, min, BENCH_INDEX3D_SIZE);
+
+    // the 26 neighbours of each coordinate, like chunks looking for their neighbors
+    uint64_t found = 0;
+    bench_start(b);
+    for (int32_t x = min; x < min + BENCH_INDEX3D_SIZE; ++x) {
+        for (int32_t y = min; y < min + BENCH_INDEX3D_SIZE; ++y) {
+            for (int32_t z = min; z < min + BENCH_INDEX3D_SIZE; ++z) {
+                for (int32_t i = 0; i < 27; ++i) {
+                    found += index3d_get(index, x + i % 3 - 1, y + i / 3 % 3 - 1, z + i / 9 - 1)
+                                 != NULL
+                                 ? 1
+                                 : 0;
+                }
+            }
+        }
+    }
+    bench_stop(b);
+    bench_set_items(b, 27 * BENCH_INDEX3D_SIZE * BENCH_INDEX3D_SIZE * BENCH_INDEX3D_SIZE);
+    bench_consume(found);
+
+    index3d_flush(index, NULL);
+    index3d_free(index);
+}
+
+void bench_index3d_insert_32k(Bench *b) {
+    _bench_index3d_insert(b, 0);
+}
+
+// centered on origin, like chunks of a map
+void bench_index3d_insert_32k_centered(Bench *b) {
+    _bench_index3d_insert(b, -BENCH_INDEX3D_SIZE / 2);
+}
+
+void bench_index3d_get_32k(Bench *b) {
+    _bench_index3d_get(b, 0);
+}
+
+void bench_index3d_get_32k_centered(Bench *b) {
+    _bench_index3d_get(b, -BENCH_INDEX3D_SIZE / 2);
+}
+
+static Shape *_bench_index3d_shape_new(ColorAtlas *atlas) {
+    Shape *s = shape_make_2(true);
+    shape_set_palette(s, color_palette_new(atlas), false);
+    return s;
+}
+
+// pending blocks are looked up in the transaction index first, then in chunks
+void bench_shape_get_block_32k(Bench *b) {
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *s = _bench_index3d_shape_new(atlas);
+    for (int32_t x = 0; x < BENCH_INDEX3D_SIZE; ++x) {
+        for (int32_t y = 0; y < BENCH_INDEX3D_SIZE; ++y) {
+            for (int32_t z = 0; z < BENCH_INDEX3D_SIZE; ++z) {
+                shape_add_block(s, 1, (SHAPE_COORDS_INT_T)x, (SHAPE_COORDS_INT_T)y,
+                                (SHAPE_COORDS_INT_T)z, true);
+            }
+        }
+    }
+    shape_apply_current_transaction(s, true);
+    for (int32_t x = 0; x < BENCH_INDEX3D_SIZE; x += 2) {
+        for (int32_t z = 0; z < BENCH_INDEX3D_SIZE; z += 2) {
+            shape_remove_block_as_transaction(s, NULL, (SHAPE_COORDS_INT_T)x, 0,
+                                              (SHAPE_COORDS_INT_T)z);
+        }
+    }
+
+    uint64_t solid = 0;
+    bench_start(b);
+    for (int32_t x = 0; x < BENCH_INDEX3D_SIZE; ++x) {
+        for (int32_t y = 0; y < BENCH_INDEX3D_SIZE; ++y) {
+            for (int32_t z = 0; z < BENCH_INDEX3D_SIZE; ++z) {
+                solid += block_is_solid(shape_get_block(s, (SHAPE_COORDS_INT_T)x,
+                                                        (SHAPE_COORDS_INT_T)y,
+                                                        (SHAPE_COORDS_INT_T)z))
+                             ? 1
+                             : 0;
+            }
+        }
+    }
+    bench_stop(b);
+    bench_set_items(b, BENCH_INDEX3D_SIZE * BENCH_INDEX3D_SIZE * BENCH_INDEX3D_SIZE);
+    bench_consume(solid);
+
+    shape_release(s);
+    color_atlas_free(atlas);
+}
+
+// records a 32k blocks transaction then applies it to the shape
+void bench_shape_transaction_32k(Bench *b) {
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *s = _bench_index3d_shape_new(atlas);
+
+    bench_start(b);
+    for (int32_t x = 0; x < BENCH_INDEX3D_SIZE; ++x) {
+        for (int32_t y = 0; y < BENCH_INDEX3D_SIZE; ++y) {
+            for (int32_t z = 0; z < BENCH_INDEX3D_SIZE; ++z) {
+                shape_add_block_as_transaction(s, NULL, 1, (SHAPE_COORDS_INT_T)x,
+                                               (SHAPE_COORDS_INT_T)y, (SHAPE_COORDS_INT_T)z);
+            }
+        }
+    }
+    shape_apply_current_transaction(s, true);
+    bench_stop(b);
+    bench_set_items(b, BENCH_INDEX3D_SIZE * BENCH_INDEX3D_SIZE * BENCH_INDEX3D_SIZE);
+
+    shape_release(s);
+    color_atlas_free(atlas);
+}
@@ -0,0 +1,70 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench_list.c
+// -------------------------------------------------------------
+
+#include "bench.h"
+
+#include "bench_chunk.h"
+#include "bench_hash_uint32_int.h"
+#include "bench_index3d.h"
+#include "bench_octree.h"
+#include "bench_rtree.h"
+#include "bench_scene.h"
+#include "bench_serialization.h"
+#include "bench_shape.h"
+
+BENCH_LIST = {
+
+    // chunk
+    {"chunk_write_vertices", bench_chunk_write_vertices},
+    {"chunk_write_vertices_lighting", bench_chunk_write_vertices_lighting},
+
+    // hash_uint32_int
+    {"hash_uint32_int_insert_1k", bench_hash_uint32_int_insert_1k},
+    {"hash_uint32_int_insert_1m", bench_hash_uint32_int_insert_1m},
+    {"hash_uint32_int_get_1k", bench_hash_uint32_int_get_1k},
+    {"hash_uint32_int_get_1m", bench_hash_uint32_int_get_1m},
+    {"hash_uint32_int_delete_1k", bench_hash_uint32_int_delete_1k},
+    {"hash_uint32_int_delete_1m", bench_hash_uint32_int_delete_1m},
+
+    // index3d
+    {"index3d_insert_32k", bench_index3d_insert_32k},
+    {"index3d_insert_32k_centered", bench_index3d_insert_32k_centered},
+    {"index3d_get_32k", bench_index3d_get_32k},
+    {"index3d_get_32k_centered", bench_index3d_get_32k_centered},
+    {"shape_get_block_32k", bench_shape_get_block_32k},
+    {"shape_transaction_32k", bench_shape_transaction_32k},
+
+
+    // octree
+    {"octree_get_element", bench_octree_get_element},
+    {"octree_get_element_without_checking", bench_octree_get_element_without_checking},
+    {"octree_get_element_fast", bench_octree_get_element_fast},
+    {"octree_get_elements_slab", bench_octree_get_elements_slab},
+
+    // rtree
+    {"rtree_insert", bench_rtree_insert},
+    {"rtree_query_overlap_box", bench_rtree_query_overlap_box},
+    {"rtree_query_cast_all_ray", bench_rtree_query_cast_all_ray},
+
+    // scene
+    {"scene_refresh_256", bench_scene_refresh_256},
+    {"scene_refresh_1024", bench_scene_refresh_1024},
+
+    // serialization
+    {"serialization_3zh_load", bench_serialization_3zh_load},
+    {"serialization_3zh_load_threaded", bench_serialization_3zh_load_threaded},
+    {"serialization_3zh_save", bench_serialization_3zh_save},
+    {"serialization_3zh_load_bundle", bench_serialization_3zh_load_bundle},
+    {"serialization_3zh_save_bundle", bench_serialization_3zh_save_bundle},
+    {"serialization_3zh_load_map_peak_rss", bench_serialization_3zh_load_map_peak_rss},
+    {"serialization_3zh_load_map_peak_rss_whole_chunks",
+     bench_serialization_3zh_load_map_peak_rss_whole_chunks},
+
+    // shape
+    {"shape_compute_baked_lighting", bench_shape_compute_baked_lighting},
+    {"shape_ray_cast", bench_shape_ray_cast},
+    {"shape_box_cast", bench_shape_box_cast},
+
+    {NULL, NULL}};
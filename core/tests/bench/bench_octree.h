@@ -0,0 +1,91 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench_octree.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "block.h"
+#include "octree.h"
+
+#define BENCH_OCTREE_SIZE 16
+
+// chunk-like octree, every other block set
+static Octree *_bench_octree_new(void) {
+    Block air = {SHAPE_COLOR_INDEX_AIR_BLOCK};
+    Block block = {1};
+    Octree *o = octree_new_with_default_element(octree_16x16x16, &air, sizeof(Block));
+    for (size_t x = 0; x < BENCH_OCTREE_SIZE; ++x) {
+        for (size_t y = 0; y < BENCH_OCTREE_SIZE; ++y) {
+            for (size_t z = (x + y) % 2; z < BENCH_OCTREE_SIZE; z += 2) {
+                octree_set_element(o, &block, x, y, z);
+            }
+        }
+    }
+    return o;
+}
+
+typedef void *(*_bench_octree_get_func)(const Octree *, const size_t, const size_t, const size_t);
+
+static void _bench_octree_get(Bench *b, _bench_octree_get_func get) {
+    Octree *o = _bench_octree_new();
+
+    const int passes = 64;
+    uint64_t solid = 0;
+    bench_start(b);
+    for (int p = 0; p < passes; ++p) {
+        for (size_t x = 0; x < BENCH_OCTREE_SIZE; ++x) {
+            for (size_t z = 0; z < BENCH_OCTREE_SIZE; ++z) {
+                for (size_t y = 0; y < BENCH_OCTREE_SIZE; ++y) {
+                    solid += block_is_solid((Block *)get(o, x, y, z)) ? 1 : 0;
+                }
+            }
+        }
+    }
+    bench_stop(b);
+    bench_set_items(b,
+                    (uint64_t)passes * BENCH_OCTREE_SIZE * BENCH_OCTREE_SIZE * BENCH_OCTREE_SIZE);
+    bench_consume(solid);
+
+    octree_free(o);
+}
+
+void bench_octree_get_element(Bench *b) {
+    _bench_octree_get(b, octree_get_element);
+}
+
+void bench_octree_get_element_without_checking(Bench *b) {
+    _bench_octree_get(b, octree_get_element_without_checking);
+}
+
+void bench_octree_get_element_fast(Bench *b) {
+    _bench_octree_get(b, octree_get_element_fast);
+}
+
+void bench_octree_get_elements_slab(Bench *b) {
+    Octree *o = _bench_octree_new();
+    Block blocks[BENCH_OCTREE_SIZE * BENCH_OCTREE_SIZE * BENCH_OCTREE_SIZE];
+
+    const int passes = 64;
+    uint64_t solid = 0;
+    bench_start(b);
+    for (int p = 0; p < passes; ++p) {
+        octree_get_elements_slab(o,
+                                 0,
+                                 0,
+                                 0,
+                                 BENCH_OCTREE_SIZE,
+                                 BENCH_OCTREE_SIZE,
+                                 BENCH_OCTREE_SIZE,
+                                 blocks);
+        for (size_t i = 0; i < BENCH_OCTREE_SIZE * BENCH_OCTREE_SIZE * BENCH_OCTREE_SIZE; ++i) {
+            solid += block_is_solid(&blocks[i]) ? 1 : 0;
+        }
+    }
+    bench_stop(b);
+    bench_set_items(b,
+                    (uint64_t)passes * BENCH_OCTREE_SIZE * BENCH_OCTREE_SIZE * BENCH_OCTREE_SIZE);
+    bench_consume(solid);
+
+    octree_free(o);
+}
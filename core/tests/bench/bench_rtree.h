@@ -0,0 +1,120 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench_rtree.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "box.h"
+#include "config.h"
+#include "fifo_list.h"
+#include "ray.h"
+#include "rtree.h"
+
+#define BENCH_RTREE_NB_LEAVES 10000
+#define BENCH_RTREE_NB_QUERIES 10000
+#define BENCH_RTREE_WORLD_SIZE 1000
+
+static uint32_t _bench_rtree_random(uint32_t *r) {
+    *r = *r * 1664525u + 1013904223u;
+    return *r >> 8;
+}
+
+// boxes of 1 to 4 units, scattered in a flat world like scene objects
+static Box _bench_rtree_box(uint32_t *r) {
+    const float x = (float)(_bench_rtree_random(r) % BENCH_RTREE_WORLD_SIZE);
+    const float y = (float)(_bench_rtree_random(r) % (BENCH_RTREE_WORLD_SIZE / 10));
+    const float z = (float)(_bench_rtree_random(r) % BENCH_RTREE_WORLD_SIZE);
+    const float size = (float)(1 + _bench_rtree_random(r) % 4);
+    return (Box){{x, y, z}, {x + size, y + size, z + size}};
+}
+
+static Rtree *_bench_rtree_new(uint8_t *leaves) {
+    Rtree *r = rtree_new(RTREE_NODE_MIN_CAPACITY, RTREE_NODE_MAX_CAPACITY);
+    uint32_t seed = 3;
+    for (int i = 0; i < BENCH_RTREE_NB_LEAVES; ++i) {
+        Box box = _bench_rtree_box(&seed);
+        rtree_create_and_insert(r,
+                                &box,
+                                PHYSICS_GROUP_DEFAULT_OBJECT,
+                                PHYSICS_COLLIDESWITH_DEFAULT_OBJECT,
+                                leaves + i);
+    }
+    return r;
+}
+
+void bench_rtree_insert(Bench *b) {
+    uint8_t *leaves = (uint8_t *)malloc(BENCH_RTREE_NB_LEAVES);
+
+    bench_start(b);
+    Rtree *r = _bench_rtree_new(leaves);
+    bench_stop(b);
+    bench_set_items(b, BENCH_RTREE_NB_LEAVES);
+    bench_consume(rtree_get_height(r));
+
+    rtree_free(r);
+    free(leaves);
+}
+
+void bench_rtree_query_overlap_box(Bench *b) {
+    uint8_t *leaves = (uint8_t *)malloc(BENCH_RTREE_NB_LEAVES);
+    Rtree *r = _bench_rtree_new(leaves);
+    FifoList *results = fifo_list_new();
+    const float3 epsilon = {EPSILON_COLLISION, EPSILON_COLLISION, EPSILON_COLLISION};
+
+    uint32_t seed = 5;
+    uint64_t hits = 0;
+    bench_start(b);
+    for (int i = 0; i < BENCH_RTREE_NB_QUERIES; ++i) {
+        const Box box = _bench_rtree_box(&seed);
+        hits += rtree_query_overlap_box(r,
+                                        &box,
+                                        PHYSICS_GROUP_DEFAULT_OBJECT,
+                                        PHYSICS_COLLIDESWITH_DEFAULT_OBJECT,
+                                        NULL,
+                                        results,
+                                        &epsilon);
+        while (fifo_list_pop(results) != NULL) {}
+    }
+    bench_stop(b);
+    bench_set_items(b, BENCH_RTREE_NB_QUERIES);
+    bench_consume(hits);
+
+    fifo_list_free(results, NULL);
+    rtree_free(r);
+    free(leaves);
+}
+
+// rays cast across the world, along X or Z, like scene_cast_ray
+void bench_rtree_query_cast_all_ray(Bench *b) {
+    uint8_t *leaves = (uint8_t *)malloc(BENCH_RTREE_NB_LEAVES);
+    Rtree *r = _bench_rtree_new(leaves);
+    RtreeCastResults results;
+
+    uint32_t seed = 5;
+    uint64_t hits = 0;
+    bench_start(b);
+    for (int i = 0; i < BENCH_RTREE_NB_QUERIES; ++i) {
+        const float a = (float)(_bench_rtree_random(&seed) % BENCH_RTREE_WORLD_SIZE);
+        const float y = (float)(_bench_rtree_random(&seed) % (BENCH_RTREE_WORLD_SIZE / 10));
+        const bool alongX = i % 2 == 0;
+        const float3 origin = {alongX ? 0.0f : a, y, alongX ? a : 0.0f};
+        const float3 dir = {alongX ? 1.0f : 0.0f, 0.0f, alongX ? 0.0f : 1.0f};
+        Ray *ray = ray_new(&origin, &dir);
+        rtree_cast_results_init(&results);
+        hits += rtree_query_cast_all_ray(r,
+                                         ray,
+                                         PHYSICS_GROUP_NONE,
+                                         PHYSICS_GROUP_DEFAULT_OBJECT,
+                                         NULL,
+                                         &results);
+        rtree_cast_results_release(&results);
+        ray_free(ray);
+    }
+    bench_stop(b);
+    bench_set_items(b, BENCH_RTREE_NB_QUERIES);
+    bench_consume(hits);
+
+    rtree_free(r);
+    free(leaves);
+}
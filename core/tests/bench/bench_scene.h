@@ -0,0 +1,92 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench_scene.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "color_atlas.h"
+#include "config.h"
+#include "rigidBody.h"
+#include "scene.h"
+#include "shape.h"
+#include "transform.h"
+
+#define BENCH_SCENE_GROUND_SIZE 64
+#define BENCH_SCENE_NB_FRAMES 60
+
+static Shape *_bench_scene_shape_new(ColorAtlas *atlas,
+                                     SHAPE_COORDS_INT_T width,
+                                     SHAPE_COORDS_INT_T height,
+                                     uint8_t mode,
+                                     uint16_t groups,
+                                     uint16_t collidesWith) {
+    Shape *s = shape_make_2(false);
+    ColorPalette *palette = color_palette_new(atlas);
+    shape_set_palette(s, palette, false);
+    SHAPE_COLOR_INDEX_INT_T idx;
+    color_palette_check_and_add_color(palette, (RGBAColor){120, 120, 120, 255}, &idx, false);
+    for (SHAPE_COORDS_INT_T x = 0; x < width; ++x) {
+        for (SHAPE_COORDS_INT_T y = 0; y < height; ++y) {
+            for (SHAPE_COORDS_INT_T z = 0; z < width; ++z) {
+                shape_add_block(s, idx, x, y, z, false);
+            }
+        }
+    }
+    RigidBody *rb = NULL;
+    shape_ensure_rigidbody(s, groups, collidesWith, &rb);
+    rigidbody_set_simulation_mode(rb, mode);
+    shape_fit_collider_to_bounding_box(s);
+    return s;
+}
+
+// dynamic 2x2x2 shapes falling in a grid & piling up on a static ground, for a number of frames
+static void _bench_scene_refresh(Bench *b, const int nbRigidbodies) {
+    ColorAtlas *atlas = color_atlas_new();
+    Scene *sc = scene_new(NULL);
+
+    Shape *ground = _bench_scene_shape_new(atlas,
+                                           BENCH_SCENE_GROUND_SIZE,
+                                           1,
+                                           RigidbodyMode_Static,
+                                           PHYSICS_GROUP_DEFAULT_MAP,
+                                           PHYSICS_COLLIDESWITH_DEFAULT_MAP);
+    shape_set_parent(ground, scene_get_root(sc), false);
+    shape_release(ground);
+
+    const int perRow = BENCH_SCENE_GROUND_SIZE / 4;
+    for (int i = 0; i < nbRigidbodies; ++i) {
+        Shape *s = _bench_scene_shape_new(atlas,
+                                          2,
+                                          2,
+                                          RigidbodyMode_Dynamic,
+                                          PHYSICS_GROUP_DEFAULT_OBJECT,
+                                          PHYSICS_COLLIDESWITH_DEFAULT_OBJECT);
+        shape_set_local_position(s,
+                                 (float)(i % perRow * 4 + 1),
+                                 (float)(2 + i / (perRow * perRow) * 3),
+                                 (float)(i / perRow % perRow * 4 + 1));
+        shape_set_parent(s, scene_get_root(sc), false);
+        shape_release(s);
+    }
+    // first refresh inserts all rigidbodies in the r-tree
+    scene_refresh(sc, 1.0 / 60.0, NULL);
+
+    bench_start(b);
+    for (int f = 0; f < BENCH_SCENE_NB_FRAMES; ++f) {
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+    bench_stop(b);
+    bench_set_items(b, (uint64_t)BENCH_SCENE_NB_FRAMES * (uint64_t)nbRigidbodies);
+
+    scene_free(sc);
+    color_atlas_free(atlas);
+}
+
+void bench_scene_refresh_256(Bench *b) {
+    _bench_scene_refresh(b, 256);
+}
+
+void bench_scene_refresh_1024(Bench *b) {
+    _bench_scene_refresh(b, 1024);
+}
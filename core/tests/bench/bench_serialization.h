@@ -0,0 +1,434 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench_serialization.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include <dirent.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "zlib.h"
+
+#include "color_atlas.h"
+#include "serialization.h"
+#include "shape.h"
+#include "stream.h"
+#include "transform.h"
+
+// directory of bundle shapes, files that aren't .3zh (e.g. git-lfs pointers) are skipped
+#ifndef BENCH_SERIALIZATION_BUNDLE_SHAPES_DIR
+#define BENCH_SERIALIZATION_BUNDLE_SHAPES_DIR "../../../bundle/shapes"
+#endif
+#define BENCH_SERIALIZATION_MAX_FILES 256
+#define BENCH_SERIALIZATION_NB_PARTS 16
+#define BENCH_SERIALIZATION_MAP_SIZE 256
+#define BENCH_SERIALIZATION_MAP_HEIGHT 64
+
+typedef struct {
+    void *buffers[BENCH_SERIALIZATION_MAX_FILES];
+    uint32_t sizes[BENCH_SERIALIZATION_MAX_FILES];
+    int count;
+} _BenchSerializationFiles;
+
+// avatar-like multi-shape: a body and parts, odd parts w/ their own palette, even ones sharing body
+// palette
+static Shape *_bench_serialization_shape_new(ColorAtlas *atlas) {
+    Shape *root = shape_make_2(true);
+    shape_set_palette(root, color_palette_new(atlas), false);
+    for (int i = 0; i <= BENCH_SERIALIZATION_NB_PARTS; ++i) {
+        Shape *s = root;
+        if (i > 0) {
+            s = shape_make_2(true);
+            if (i % 2 == 1) {
+                shape_set_palette(s, color_palette_new(atlas), false);
+            } else {
+                shape_set_palette(s, shape_get_palette(root), true);
+            }
+            shape_set_parent(s, shape_get_root_transform(root), false);
+            shape_release(s);
+        }
+        ColorPalette *palette = shape_get_palette(s);
+        SHAPE_COLOR_INDEX_INT_T idx[8];
+        for (int c = 0; c < 8; ++c) {
+            const RGBAColor color = {(uint8_t)(c * 30), (uint8_t)(i * 15), 128, 255};
+            color_palette_check_and_add_color(palette, color, &idx[c], false);
+        }
+        const SHAPE_COORDS_INT_T size = i == 0 ? 32 : 16;
+        for (SHAPE_COORDS_INT_T x = 0; x < size; ++x) {
+            for (SHAPE_COORDS_INT_T y = 0; y < size; ++y) {
+                for (SHAPE_COORDS_INT_T z = 0; z < size; ++z) {
+                    if ((x * 7 + y * 3 + z + i) % 5 != 0) {
+                        shape_add_block(s, idx[(x / 3 + y + z / 2) % 8], x, y, z, false);
+                    }
+                }
+            }
+        }
+    }
+    return root;
+}
+
+static void _bench_serialization_files_free(_BenchSerializationFiles *files) {
+    for (int i = 0; i < files->count; ++i) {
+        free(files->buffers[i]);
+    }
+    files->count = 0;
+}
+
+static void _bench_serialization_generated_file(ColorAtlas *atlas,
+                                                _BenchSerializationFiles *files) {
+    Shape *s = _bench_serialization_shape_new(atlas);
+    files->count = 0;
+    if (serialization_save_shape_as_buffer(s,
+                                           NULL,
+                                           NULL,
+                                           0,
+                                           &files->buffers[0],
+                                           &files->sizes[0])) {
+        files->count = 1;
+    }
+    shape_release(s);
+}
+
+// terrain-like map, large blocks chunk compressing well
+static void _bench_serialization_map_file(ColorAtlas *atlas, _BenchSerializationFiles *files) {
+    Shape *s = shape_make_2(true);
+    shape_set_palette(s, color_palette_new(atlas), false);
+    SHAPE_COLOR_INDEX_INT_T idx[8];
+    for (int c = 0; c < 8; ++c) {
+        const RGBAColor color = {(uint8_t)(c * 30), 160, (uint8_t)(255 - c * 30), 255};
+        color_palette_check_and_add_color(shape_get_palette(s), color, &idx[c], false);
+    }
+    for (SHAPE_COORDS_INT_T x = 0; x < BENCH_SERIALIZATION_MAP_SIZE; ++x) {
+        for (SHAPE_COORDS_INT_T z = 0; z < BENCH_SERIALIZATION_MAP_SIZE; ++z) {
+            const int h = 16 + (x / 8 * 7 + z / 8 * 13) % (BENCH_SERIALIZATION_MAP_HEIGHT - 16);
+            for (SHAPE_COORDS_INT_T y = 0; y < h; ++y) {
+                shape_add_block(s, idx[y / 4 % 8], x, y, z, false);
+            }
+        }
+    }
+    files->count = 0;
+    if (serialization_save_shape_as_buffer(s,
+                                           NULL,
+                                           NULL,
+                                           0,
+                                           &files->buffers[0],
+                                           &files->sizes[0])) {
+        files->count = 1;
+    }
+    shape_release(s);
+}
+
+// Copy of a .3zh (w/o preview) where chunks are stored inflated. Loading it holds whole inflated
+// chunks in memory while parsing them, like the loader did before inflating while parsing.
+static bool _bench_serialization_inflate_chunks(const uint8_t *file,
+                                                const uint32_t size,
+                                                void **out,
+                                                uint32_t *outSize) {
+    const uint32_t headerSize = MAGIC_BYTES_SIZE + 2 * sizeof(uint32_t) + sizeof(uint8_t);
+    const uint32_t chunkHeaderSize = 2 * sizeof(uint32_t) + 2 * sizeof(uint8_t);
+
+    // inflated size
+    uint32_t total = headerSize;
+    uint32_t cursor = headerSize;
+    while (cursor + chunkHeaderSize <= size) {
+        uint32_t chunkSize, uncompressedSize;
+        memcpy(&chunkSize, file + cursor + 1, sizeof(uint32_t));
+        memcpy(&uncompressedSize, file + cursor + 1 + sizeof(uint32_t) + 1, sizeof(uint32_t));
+        total += chunkHeaderSize + (file[cursor + 1 + sizeof(uint32_t)] ? uncompressedSize
+                                                                        : chunkSize);
+        cursor += chunkHeaderSize + chunkSize;
+    }
+
+    uint8_t *inflated = (uint8_t *)malloc(total);
+    if (inflated == NULL) {
+        return false;
+    }
+    memcpy(inflated, file, headerSize);
+    const uint32_t totalSize = total - headerSize;
+    memcpy(inflated + headerSize - sizeof(uint32_t), &totalSize, sizeof(uint32_t));
+
+    uint32_t written = headerSize;
+    cursor = headerSize;
+    while (cursor + chunkHeaderSize <= size) {
+        uint32_t chunkSize, uncompressedSize;
+        memcpy(&chunkSize, file + cursor + 1, sizeof(uint32_t));
+        memcpy(&uncompressedSize, file + cursor + 1 + sizeof(uint32_t) + 1, sizeof(uint32_t));
+        const bool compressed = file[cursor + 1 + sizeof(uint32_t)] != 0;
+        const uint8_t *data = file + cursor + chunkHeaderSize;
+        const uint32_t dataSize = compressed ? uncompressedSize : chunkSize;
+
+        inflated[written] = file[cursor]; // chunk ID
+        memcpy(inflated + written + 1, &dataSize, sizeof(uint32_t));
+        inflated[written + 1 + sizeof(uint32_t)] = 0;
+        memcpy(inflated + written + 1 + sizeof(uint32_t) + 1, &dataSize, sizeof(uint32_t));
+        written += chunkHeaderSize;
+        if (compressed) {
+            uLongf len = dataSize;
+            if (uncompress(inflated + written, &len, data, chunkSize) != Z_OK || len != dataSize) {
+                free(inflated);
+                return false;
+            }
+        } else {
+            memcpy(inflated + written, data, dataSize);
+        }
+        written += dataSize;
+        cursor += chunkHeaderSize + chunkSize;
+    }
+    *out = inflated;
+    *outSize = written;
+    return true;
+}
+
+// kB read from /proc/self/status for given field (e.g. "VmHWM:"), 0 if not available
+static uint64_t _bench_serialization_proc_status_kb(const char *field) {
+    FILE *f = fopen("/proc/self/status", "r");
+    if (f == NULL) {
+        return 0;
+    }
+    char line[256];
+    unsigned long long kb = 0;
+    const size_t len = strlen(field);
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strncmp(line, field, len) == 0) {
+            kb = strtoull(line + len, NULL, 10);
+            break;
+        }
+    }
+    fclose(f);
+    return (uint64_t)kb;
+}
+
+static void _bench_serialization_bundle_files(_BenchSerializationFiles *files) {
+    files->count = 0;
+    DIR *dir = opendir(BENCH_SERIALIZATION_BUNDLE_SHAPES_DIR);
+    if (dir == NULL) {
+        return;
+    }
+    char path[1024];
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && files->count < BENCH_SERIALIZATION_MAX_FILES) {
+        const size_t len = strlen(entry->d_name);
+        if (len < 4 || strcmp(entry->d_name + len - 4, ".3zh") != 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", BENCH_SERIALIZATION_BUNDLE_SHAPES_DIR, entry->d_name);
+        FILE *fd = fopen(path, "rb");
+        if (fd == NULL) {
+            continue;
+        }
+        char magic[MAGIC_BYTES_SIZE];
+        fseek(fd, 0, SEEK_END);
+        const long size = ftell(fd);
+        fseek(fd, 0, SEEK_SET);
+        void *buffer = size > MAGIC_BYTES_SIZE ? malloc((size_t)size) : NULL;
+        if (buffer != NULL && fread(buffer, (size_t)size, 1, fd) == 1) {
+            memcpy(magic, buffer, MAGIC_BYTES_SIZE);
+            if (memcmp(magic, MAGIC_BYTES, MAGIC_BYTES_SIZE) == 0) {
+                files->buffers[files->count] = buffer;
+                files->sizes[files->count] = (uint32_t)size;
+                ++files->count;
+                buffer = NULL;
+            }
+        }
+        free(buffer);
+        fclose(fd);
+    }
+    closedir(dir);
+}
+
+static uint64_t _bench_serialization_release_assets(DoublyLinkedList *assets) {
+    uint64_t blocks = 0;
+    DoublyLinkedListNode *n = doubly_linked_list_first(assets);
+    while (n != NULL) {
+        Asset *asset = (Asset *)doubly_linked_list_node_pointer(n);
+        if (asset->type == AssetType_Shape) {
+            blocks += shape_get_nb_blocks((Shape *)asset->ptr);
+        }
+        n = doubly_linked_list_node_next(n);
+    }
+    doubly_linked_list_flush(assets, serialization_assets_free_func);
+    doubly_linked_list_free(assets);
+    return blocks;
+}
+
+static void _bench_serialization_load(Bench *b, bool bundle, uint8_t nbThreads) {
+    ColorAtlas *atlas = color_atlas_new();
+    _BenchSerializationFiles files;
+    if (bundle) {
+        _bench_serialization_bundle_files(&files);
+    } else {
+        _bench_serialization_generated_file(atlas, &files);
+    }
+    const ShapeSettings settings = {.lighting = false, .isMutable = false};
+
+    uint64_t blocks = 0;
+    for (int i = 0; i < files.count; ++i) {
+        DoublyLinkedList *assets = NULL;
+        bench_start(b);
+        const bool ok = serialization_load_assets(stream_new_buffer_read(files.buffers[i],
+                                                                         files.sizes[i]),
+                                                  NULL,
+                                                  AssetType_Shape,
+                                                  atlas,
+                                                  &settings,
+                                                  false,
+                                                  nbThreads,
+                                                  &assets);
+        bench_stop(b);
+        if (ok) {
+            blocks += _bench_serialization_release_assets(assets);
+        }
+    }
+    bench_set_items(b, blocks);
+
+    _bench_serialization_files_free(&files);
+    color_atlas_free(atlas);
+}
+
+static void _bench_serialization_save(Bench *b, bool bundle) {
+    ColorAtlas *atlas = color_atlas_new();
+    _BenchSerializationFiles files;
+    if (bundle) {
+        _bench_serialization_bundle_files(&files);
+    } else {
+        _bench_serialization_generated_file(atlas, &files);
+    }
+    const ShapeSettings settings = {.lighting = false, .isMutable = false};
+
+    uint64_t blocks = 0;
+    for (int i = 0; i < files.count; ++i) {
+        DoublyLinkedList *assets = NULL;
+        if (serialization_load_assets(stream_new_buffer_read(files.buffers[i], files.sizes[i]),
+                                      NULL,
+                                      AssetType_Shape,
+                                      atlas,
+                                      &settings,
+                                      false,
+                                      0,
+                                      &assets) == false) {
+            continue;
+        }
+        // root keeps children alive, remaining assets only hold an extra reference
+        Shape *s = assets_get_root_shape(assets, true);
+        const uint64_t nbBlocks = _bench_serialization_release_assets(assets);
+        if (s == NULL) {
+            continue;
+        }
+        void *buffer = NULL;
+        uint32_t size = 0;
+        bench_start(b);
+        const bool ok = serialization_save_shape_as_buffer(s, NULL, NULL, 0, &buffer, &size);
+        bench_stop(b);
+        if (ok) {
+            blocks += nbBlocks + shape_get_nb_blocks(s);
+        }
+        free(buffer);
+        shape_release(s);
+    }
+    bench_set_items(b, blocks);
+
+    _bench_serialization_files_free(&files);
+    color_atlas_free(atlas);
+}
+
+void bench_serialization_3zh_load(Bench *b) {
+    _bench_serialization_load(b, false, 0);
+}
+
+void bench_serialization_3zh_load_threaded(Bench *b) {
+    _bench_serialization_load(b, false, 4);
+}
+
+void bench_serialization_3zh_save(Bench *b) {
+    _bench_serialization_save(b, false);
+}
+
+void bench_serialization_3zh_load_bundle(Bench *b) {
+    _bench_serialization_load(b, true, 0);
+}
+
+void bench_serialization_3zh_save_bundle(Bench *b) {
+    _bench_serialization_save(b, true);
+}
+
+// Loads a generated map in a child process, reporting how much its peak RSS grows while loading:
+// either streaming (chunks inflated while parsed) or inflating whole chunks first, as the loader
+// used to. The file buffer is allocated before measuring in both cases.
+static void _bench_serialization_load_peak_rss(Bench *b, bool wholeChunks) {
+    ColorAtlas *atlas = color_atlas_new();
+    _BenchSerializationFiles files;
+    _bench_serialization_map_file(atlas, &files);
+    color_atlas_free(atlas);
+    if (files.count == 0) {
+        return;
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        _bench_serialization_files_free(&files);
+        return;
+    }
+    bench_start(b);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        // resets peak RSS to current RSS
+        FILE *clearRefs = fopen("/proc/self/clear_refs", "w");
+        if (clearRefs != NULL) {
+            fputs("5", clearRefs);
+            fclose(clearRefs);
+        }
+        const uint64_t before = _bench_serialization_proc_status_kb("VmRSS:");
+
+        ColorAtlas *childAtlas = color_atlas_new();
+        const ShapeSettings settings = {.lighting = false, .isMutable = false};
+        void *buffer = files.buffers[0];
+        uint32_t size = files.sizes[0];
+        uint64_t result[2] = {0, 0}; // blocks, peak RSS growth (kB)
+        if (wholeChunks == false ||
+            _bench_serialization_inflate_chunks(files.buffers[0], files.sizes[0], &buffer, &size)) {
+            DoublyLinkedList *assets = NULL;
+            if (serialization_load_assets(stream_new_buffer_read(buffer, size),
+                                          NULL,
+                                          AssetType_Shape,
+                                          childAtlas,
+                                          &settings,
+                                          false,
+                                          0,
+                                          &assets)) {
+                const uint64_t peak = _bench_serialization_proc_status_kb("VmHWM:");
+                result[0] = _bench_serialization_release_assets(assets);
+                result[1] = peak > before ? peak - before : 0;
+            }
+        }
+        if (write(fds[1], result, sizeof(result)) != (ssize_t)sizeof(result)) {
+            _exit(1);
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    uint64_t result[2] = {0, 0};
+    if (pid > 0) {
+        if (read(fds[0], result, sizeof(result)) != (ssize_t)sizeof(result)) {
+            result[0] = 0;
+            result[1] = 0;
+        }
+        waitpid(pid, NULL, 0);
+    }
+    bench_stop(b);
+    close(fds[0]);
+    bench_set_items(b, result[0]);
+    bench_set_metric(b, "peak_rss_growth_kb", result[1]);
+
+    _bench_serialization_files_free(&files);
+}
+
+void bench_serialization_3zh_load_map_peak_rss(Bench *b) {
+    _bench_serialization_load_peak_rss(b, false);
+}
+
+void bench_serialization_3zh_load_map_peak_rss_whole_chunks(Bench *b) {
+    _bench_serialization_load_peak_rss(b, true);
+}
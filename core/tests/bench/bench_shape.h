@@ -0,0 +1,89 @@
+// -------------------------------------------------------------
+//  Cubzh Core Benchmarks
+//  bench_shape.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "box.h"
+#include "chunk.h"
+#include "color_atlas.h"
+#include "float3.h"
+#include "ray.h"
+#include "shape.h"
+#include "vertextbuffer.h"
+
+#define BENCH_SHAPE_NB_CASTS 10000
+
+// uses terrain-like shape from bench_chunk.h
+void bench_shape_compute_baked_lighting(Bench *b) {
+    vertex_buffer_set_lighting_enabled(true);
+    chunk_alloc_default_light();
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *s = _bench_chunk_shape_new(atlas, false);
+
+    bench_start(b);
+    shape_compute_baked_lighting(s);
+    bench_stop(b);
+    bench_set_items(b, shape_get_nb_blocks(s));
+
+    shape_release(s);
+    color_atlas_free(atlas);
+}
+
+// vertical rays cast from above the shape, on a pseudo-random grid
+void bench_shape_ray_cast(Bench *b) {
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *s = _bench_chunk_shape_new(atlas, false);
+    const Transform *t = shape_get_root_transform(s);
+    const float3 dir = {0.0f, -1.0f, 0.0f};
+
+    uint32_t r = 7;
+    uint64_t hits = 0;
+    float distance;
+    bench_start(b);
+    for (int i = 0; i < BENCH_SHAPE_NB_CASTS; ++i) {
+        r = r * 1664525u + 1013904223u;
+        const float3 origin = {(float)((r >> 8) % (BENCH_CHUNK_SHAPE_SIZE * 8)) * 0.125f,
+                               (float)BENCH_CHUNK_SHAPE_SIZE,
+                               (float)((r >> 20) % (BENCH_CHUNK_SHAPE_SIZE * 8)) * 0.125f};
+        Ray *ray = ray_new(&origin, &dir);
+        if (shape_ray_cast(t, s, ray, &distance, NULL, NULL, NULL)) {
+            ++hits;
+        }
+        ray_free(ray);
+    }
+    bench_stop(b);
+    bench_set_items(b, BENCH_SHAPE_NB_CASTS);
+    bench_consume(hits);
+
+    shape_release(s);
+    color_atlas_free(atlas);
+}
+
+// 1-block boxes cast downward from above the shape, on a pseudo-random grid
+void bench_shape_box_cast(Bench *b) {
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *s = _bench_chunk_shape_new(atlas, false);
+    const float3 vector = {0.0f, -(float)BENCH_CHUNK_SHAPE_SIZE, 0.0f};
+    const float3 epsilon = {EPSILON_COLLISION, EPSILON_COLLISION, EPSILON_COLLISION};
+
+    uint32_t r = 7;
+    float sum = 0.0f;
+    float3 normal;
+    bench_start(b);
+    for (int i = 0; i < BENCH_SHAPE_NB_CASTS; ++i) {
+        r = r * 1664525u + 1013904223u;
+        const float x = (float)((r >> 8) % (BENCH_CHUNK_SHAPE_SIZE * 8)) * 0.125f;
+        const float z = (float)((r >> 20) % (BENCH_CHUNK_SHAPE_SIZE * 8)) * 0.125f;
+        const Box box = {{x, (float)BENCH_CHUNK_SHAPE_SIZE, z},
+                         {x + 1.0f, (float)BENCH_CHUNK_SHAPE_SIZE + 1.0f, z + 1.0f}};
+        sum += shape_box_cast(s, &box, &vector, &epsilon, false, &normal, NULL, NULL, NULL);
+    }
+    bench_stop(b);
+    bench_set_items(b, BENCH_SHAPE_NB_CASTS);
+    bench_consume((uint64_t)sum);
+
+    shape_release(s);
+    color_atlas_free(atlas);
+}
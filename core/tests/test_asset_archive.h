@@ -0,0 +1,101 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_asset_archive.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "asset_archive.h"
+
+// writes archive built by `w` in a file, returns its content (to be freed)
+static void *_test_asset_archive_write(AssetArchiveWriter *w, size_t *size) {
+    const char *file_name = "archive.czha";
+    FILE *f = fopen(file_name, "wb");
+    TEST_ASSERT(f != NULL);
+    const bool ok = asset_archive_writer_write(w, f);
+    fclose(f);
+    if (ok == false) {
+        remove(file_name);
+        return NULL;
+    }
+
+    f = fopen(file_name, "rb");
+    fseek(f, 0, SEEK_END);
+    *size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    void *bytes = malloc(*size);
+    TEST_ASSERT(fread(bytes, 1, *size, f) == *size);
+    fclose(f);
+    remove(file_name);
+    return bytes;
+}
+
+// entries are sorted by path hash, with aligned data, compressed only when it's worth it
+// (archives are read by xptools, vx::fs::Archive tests read what this writer writes)
+void test_asset_archive_writer_layout(void) {
+    char text[1000];
+    for (int i = 0; i < 1000; ++i) {
+        text[i] = (char)('a' + i % 4);
+    }
+    const char *small = "hello";
+
+    AssetArchiveWriter *w = asset_archive_writer_new();
+    TEST_CHECK(asset_archive_writer_add(w, "shapes/a.3zh", small, strlen(small), false));
+    TEST_CHECK(asset_archive_writer_add(w, "shaders/text.txt", text, sizeof(text), true));
+    TEST_CHECK(asset_archive_writer_add(w, "empty", NULL, 0, true));
+    TEST_CHECK(asset_archive_writer_get_entry_count(w) == 3);
+
+    size_t size = 0;
+    void *bytes = _test_asset_archive_write(w, &size);
+    asset_archive_writer_free(w);
+    TEST_ASSERT(bytes != NULL);
+
+    // header: magic, version, entry count, paths size, paths offset, total size (32 bytes)
+    const uint8_t *b = (const uint8_t *)bytes;
+    uint32_t version, entryCount;
+    uint64_t totalSize;
+    memcpy(&version, b + 4, sizeof(uint32_t));
+    memcpy(&entryCount, b + 8, sizeof(uint32_t));
+    memcpy(&totalSize, b + 24, sizeof(uint64_t));
+    TEST_CHECK(memcmp(b, "CZHA", 4) == 0);
+    TEST_CHECK(version == ASSET_ARCHIVE_VERSION);
+    TEST_CHECK(entryCount == 3);
+    TEST_CHECK(totalSize == size);
+
+    // entries: path hash, data offset, path offset & length, stored size, size, compression
+    uint64_t previousHash = 0;
+    int compressed = 0;
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        const uint8_t *e = b + 32 + i * 40;
+        uint64_t pathHash, dataOffset;
+        uint32_t entrySize, compression;
+        memcpy(&pathHash, e, sizeof(uint64_t));
+        memcpy(&dataOffset, e + 8, sizeof(uint64_t));
+        memcpy(&entrySize, e + 28, sizeof(uint32_t));
+        memcpy(&compression, e + 32, sizeof(uint32_t));
+        TEST_CHECK(i == 0 || pathHash > previousHash);
+        TEST_CHECK(dataOffset % ASSET_ARCHIVE_DATA_ALIGNMENT == 0);
+        if (compression != 0) {
+            ++compressed;
+            TEST_CHECK(entrySize == sizeof(text));
+        } else if (entrySize == strlen(small)) {
+            TEST_CHECK(memcmp(b + dataOffset, small, strlen(small)) == 0);
+        }
+        previousHash = pathHash;
+    }
+    TEST_CHECK(compressed == 1);
+
+    free(bytes);
+}
+
+// the same path can't be added twice
+void test_asset_archive_writer_duplicate(void) {
+    AssetArchiveWriter *w = asset_archive_writer_new();
+    TEST_CHECK(asset_archive_writer_add(w, "a", "1", 1, false));
+    TEST_CHECK(asset_archive_writer_add(w, "a", "2", 1, false));
+    size_t size = 0;
+    void *bytes = _test_asset_archive_write(w, &size);
+    TEST_CHECK(bytes == NULL);
+    free(bytes);
+    asset_archive_writer_free(w);
+}
@@ -8,7 +8,11 @@
 
 #include "block.h"
 #include "chunk.h"
+#include "color_atlas.h"
+#include "index3d.h"
 #include "int3.h"
+#include "shape.h"
+#include "vertextbuffer.h"
 
 ///// Some function are left untested :
 // --- chunk_get_neighbor()
@@ -16,7 +20,6 @@
 // --- chunk_move_in_neighborhood()
 // --- chunk_get_vbma()
 // --- chunk_set_vbma()
-// --- chunk_write_vertices()
 /////
 
 // Create a chunk and check if the default values are the one used
@@ -144,3 +147,99 @@ void test_chunk_needs_display(void) {
 
     chunk_free(chunk, false);
 }
+
+// hashes vertices written for all chunks of a shape, independently of faces order
+static uint64_t _test_chunk_vertices_hash(const Shape *s, uint32_t *nbFaces) {
+    uint64_t hash = 0;
+    *nbFaces = 0;
+    Index3DIterator *it = index3d_iterator_new(shape_get_chunks(s));
+    while (index3d_iterator_pointer(it) != NULL) {
+        const Chunk *c = (const Chunk *)index3d_iterator_pointer(it);
+        for (int transparent = 0; transparent < 2; ++transparent) {
+            VertexBufferMemArea *vbma = (VertexBufferMemArea *)chunk_get_vbma(c, transparent);
+            while (vbma != NULL) {
+                const VertexAttributes *v = vertex_buffer_get_draw_buffer(
+                                                vertex_buffer_mem_area_get_vb(vbma)) +
+                                            vertex_buffer_mem_area_get_start_idx(vbma);
+                const uint32_t count = vertex_buffer_mem_area_get_count(vbma);
+                for (uint32_t f = 0; f < count; f += DRAWBUFFER_VERTICES_PER_FACE) {
+                    // FNV-1a over face vertices, faces hashes are summed
+                    const uint8_t *bytes = (const uint8_t *)(v + f);
+                    uint64_t h = 14695981039346656037u;
+                    for (size_t i = 0; i < DRAWBUFFER_VERTICES_PER_FACE * sizeof(VertexAttributes);
+                         ++i) {
+                        h = (h ^ bytes[i]) * 1099511628211u;
+                    }
+                    hash += h + (uint64_t)transparent;
+                    ++*nbFaces;
+                }
+                vbma = vertex_buffer_mem_area_get_group_next(vbma);
+            }
+        }
+        index3d_iterator_next(it);
+    }
+    index3d_iterator_free(it);
+    return hash;
+}
+
+// blocks across 3x2x3 chunks, w/ negative coordinates, transparent & emissive colors
+static Shape *_test_chunk_vertices_shape_new(ColorAtlas *atlas, const bool lighting) {
+    Shape *s = shape_make_2(true);
+    ColorPalette *palette = color_palette_new(atlas);
+    shape_set_palette(s, palette, false);
+
+    const RGBAColor colors[5] = {{200, 10, 10, 255},
+                                 {10, 200, 10, 255},
+                                 {10, 10, 200, 100},
+                                 {250, 250, 0, 255},
+                                 {255, 255, 255, 50}};
+    SHAPE_COLOR_INDEX_INT_T idx[5];
+    for (int i = 0; i < 5; ++i) {
+        color_palette_check_and_add_color(palette, colors[i], &idx[i], false);
+    }
+    color_palette_set_emissive(palette, idx[3], true);
+
+    uint32_t r = 7;
+    for (SHAPE_COORDS_INT_T x = -8; x < 24; ++x) {
+        for (SHAPE_COORDS_INT_T y = 0; y < 20; ++y) {
+            for (SHAPE_COORDS_INT_T z = -8; z < 24; ++z) {
+                r = r * 1664525u + 1013904223u;
+                // solid floor, then sparse blocks
+                if (y < 3 || (r >> 24) % 3 == 0) {
+                    shape_add_block(s, idx[(r >> 16) % 5], x, y, z, false);
+                }
+            }
+        }
+    }
+    shape_apply_current_transaction(s, true);
+    if (lighting) {
+        shape_compute_baked_lighting(s);
+    }
+    shape_refresh_all_vertices(s);
+    return s;
+}
+
+// Vertices written for a few chunks (edges, transparency, AO & baked lighting from neighbors) must
+// match reference hashes, obtained w/ chunk_write_vertices before it read blocks from a padded cache
+// --- chunk_write_vertices()
+/////
+void test_chunk_write_vertices_reference(void) {
+    const uint64_t expectedHashes[2] = {0xcb02cf6735bff2f5u, 0xd0ceb028659fc99du};
+    chunk_alloc_default_light();
+    for (int lighting = 0; lighting < 2; ++lighting) {
+        vertex_buffer_set_lighting_enabled(lighting);
+        ColorAtlas *atlas = color_atlas_new();
+        Shape *s = _test_chunk_vertices_shape_new(atlas, lighting);
+
+        uint32_t nbFaces;
+        const uint64_t hash = _test_chunk_vertices_hash(s, &nbFaces);
+        TEST_CHECK(nbFaces == 34531);
+        TEST_MSG("lighting: %d, faces: %u", lighting, nbFaces);
+        TEST_CHECK(hash == expectedHashes[lighting]);
+        TEST_MSG("lighting: %d, hash: 0x%016llx", lighting, (unsigned long long)hash);
+
+        shape_release(s);
+        color_atlas_free(atlas);
+    }
+    vertex_buffer_set_lighting_enabled(true);
+}
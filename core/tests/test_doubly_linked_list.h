@@ -577,5 +577,32 @@ void test_doubly_linked_list_sort_ascending(void) {
     pointerCheck = doubly_linked_list_node_pointer(NodeCheck);
     TEST_CHECK(*pointerCheck == 119);
 
+    // nodes are re-linked, check backward links as well
+    TEST_CHECK(doubly_linked_list_last(list) == NodeCheck);
+    NodeCheck = doubly_linked_list_node_previous(NodeCheck);
+    pointerCheck = doubly_linked_list_node_pointer(NodeCheck);
+    TEST_CHECK(*pointerCheck == 21);
+    TEST_CHECK(doubly_linked_list_node_previous(doubly_linked_list_first(list)) == NULL);
+
+    doubly_linked_list_free(list);
+
+    // larger list w/ duplicates
+    list = doubly_linked_list_new();
+    int values[100];
+    for (int i = 0; i < 100; ++i) {
+        values[i] = (i * 37) % 50;
+        doubly_linked_list_push_last(list, &values[i]);
+    }
+    doubly_linked_list_sort_ascending(list, _node_is_superior);
+    TEST_CHECK(doubly_linked_list_node_count(list) == 100);
+    DoublyLinkedListNode *n = doubly_linked_list_first(list);
+    int previous = -1;
+    while (n != NULL) {
+        pointerCheck = doubly_linked_list_node_pointer(n);
+        TEST_CHECK(*pointerCheck >= previous);
+        previous = *pointerCheck;
+        n = doubly_linked_list_node_next(n);
+    }
+
     doubly_linked_list_free(list);
 }
@@ -50,3 +50,37 @@ void test_hash_uint32_int(void) {
 
     hash_uint32_int_free(h);
 }
+
+// Insert enough keys to trigger several grows, delete every other one, and check that
+// remaining keys are still found w/ their values (exercises probing & backward shift deletion)
+void test_hash_uint32_int_many(void) {
+    int v = 0;
+    const uint32_t n = 10000;
+
+    HashUInt32Int *h = hash_uint32_int_new();
+
+    for (uint32_t i = 0; i < n; ++i) {
+        hash_uint32_int_set(h, i * 2654435761u, (int)i);
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        TEST_CHECK(hash_uint32_int_get(h, i * 2654435761u, &v));
+        TEST_CHECK(v == (int)i);
+    }
+
+    for (uint32_t i = 0; i < n; i += 2) {
+        hash_uint32_int_delete(h, i * 2654435761u);
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        const bool found = hash_uint32_int_get(h, i * 2654435761u, &v);
+        TEST_CHECK(found == (i % 2 == 1));
+        if (found) {
+            TEST_CHECK(v == (int)i);
+        }
+    }
+
+    // deleting a missing key is a no-op
+    hash_uint32_int_delete(h, 0);
+    TEST_CHECK(hash_uint32_int_get(h, 2654435761u, &v));
+
+    hash_uint32_int_free(h);
+}
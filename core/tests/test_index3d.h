@@ -0,0 +1,191 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_index3d.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "index3d.h"
+
+// insert, get & remove pointers, including negative & far apart coordinates
+void test_index3d_insert_get_remove(void) {
+    Index3D *index = index3d_new();
+    int a = 1, b = 2, c = 3;
+
+    TEST_CHECK(index3d_is_empty(index));
+    TEST_CHECK(index3d_get(index, 0, 0, 0) == NULL);
+
+    index3d_insert(index, &a, 0, 0, 0, NULL);
+    index3d_insert(index, &b, -1, 2, -3, NULL);
+    index3d_insert(index, &c, 100000, -100000, 7, NULL);
+    TEST_CHECK(index3d_is_empty(index) == false);
+    TEST_CHECK(index3d_get(index, 0, 0, 0) == &a);
+    TEST_CHECK(index3d_get(index, -1, 2, -3) == &b);
+    TEST_CHECK(index3d_get(index, 100000, -100000, 7) == &c);
+    TEST_CHECK(index3d_get(index, 1, 0, 0) == NULL);
+
+    // replace
+    index3d_insert(index, &c, 0, 0, 0, NULL);
+    TEST_CHECK(index3d_get(index, 0, 0, 0) == &c);
+
+    TEST_CHECK(index3d_remove(index, -1, 2, -3, NULL) == &b);
+    TEST_CHECK(index3d_get(index, -1, 2, -3) == NULL);
+    TEST_CHECK(index3d_remove(index, -1, 2, -3, NULL) == NULL);
+
+    TEST_CHECK(index3d_remove(index, 0, 0, 0, NULL) == &c);
+    TEST_CHECK(index3d_remove(index, 100000, -100000, 7, NULL) == &c);
+    TEST_CHECK(index3d_is_empty(index));
+
+    index3d_free(index);
+}
+
+// fill a volume, remove half of it, then check lookups & iteration order
+void test_index3d_many(void) {
+    Index3D *index = index3d_new();
+    const int32_t size = 16;
+    int32_t *values = (int32_t *)malloc((size_t)(size * size * size) * sizeof(int32_t));
+
+    int32_t i = 0;
+    for (int32_t x = -size / 2; x < size / 2; ++x) {
+        for (int32_t y = -size / 2; y < size / 2; ++y) {
+            for (int32_t z = -size / 2; z < size / 2; ++z) {
+                values[i] = i;
+                index3d_insert(index, &values[i], x, y, z, NULL);
+                ++i;
+            }
+        }
+    }
+    i = 0;
+    for (int32_t x = -size / 2; x < size / 2; ++x) {
+        for (int32_t y = -size / 2; y < size / 2; ++y) {
+            for (int32_t z = -size / 2; z < size / 2; ++z) {
+                TEST_CHECK(index3d_get(index, x, y, z) == &values[i]);
+                if (i % 2 == 0) {
+                    TEST_CHECK(index3d_remove(index, x, y, z, NULL) == &values[i]);
+                }
+                ++i;
+            }
+        }
+    }
+
+    // remaining pointers are iterated in insertion order
+    Index3DIterator *it = index3d_iterator_new(index);
+    int32_t expected = 1, count = 0;
+    while (index3d_iterator_pointer(it) != NULL) {
+        TEST_CHECK(*(int32_t *)index3d_iterator_pointer(it) == expected);
+        expected += 2;
+        ++count;
+        index3d_iterator_next(it);
+    }
+    TEST_CHECK(count == size * size * size / 2);
+    index3d_iterator_free(it);
+
+    index3d_flush(index, NULL);
+    TEST_CHECK(index3d_is_empty(index));
+    TEST_CHECK(index3d_get(index, 1, 1, 1) == NULL);
+    index3d_free(index);
+    free(values);
+}
+
+// an iterator maintained through insertions & removals visits re-inserted pointers again,
+// like transactions do when a block change is amended
+void test_index3d_iterator(void) {
+    Index3D *index = index3d_new();
+    int values[3] = {0, 1, 2};
+
+    for (int i = 0; i < 3; ++i) {
+        index3d_insert(index, &values[i], i, 0, 0, NULL);
+    }
+
+    Index3DIterator *it = index3d_iterator_new(index);
+    TEST_CHECK(index3d_iterator_pointer(it) == &values[0]);
+    TEST_CHECK(index3d_iterator_is_at_end(it) == false);
+
+    // remove current entry, next moves to the following one
+    index3d_remove(index, 0, 0, 0, it);
+    index3d_iterator_next(it);
+    TEST_CHECK(index3d_iterator_pointer(it) == &values[1]);
+
+    index3d_iterator_next(it);
+    index3d_iterator_next(it);
+    TEST_CHECK(index3d_iterator_pointer(it) == NULL);
+
+    // iterator at end picks up new entries
+    index3d_remove(index, 1, 0, 0, it);
+    index3d_insert(index, &values[1], 1, 0, 0, it);
+    TEST_CHECK(index3d_iterator_pointer(it) == &values[1]);
+    TEST_CHECK(index3d_iterator_is_at_end(it));
+
+    // trigger compaction w/ many remove/insert, iterator must remain at end
+    index3d_iterator_next(it);
+    for (int i = 0; i < 100; ++i) {
+        index3d_remove(index, 2, 0, 0, it);
+        index3d_insert(index, &values[2], 2, 0, 0, it);
+        TEST_CHECK(index3d_iterator_pointer(it) == &values[2]);
+        index3d_iterator_next(it);
+    }
+    TEST_CHECK(index3d_iterator_pointer(it) == NULL);
+
+    index3d_iterator_free(it);
+    index3d_flush(index, NULL);
+    index3d_free(index);
+}
+
+// iterators that aren't given to insert & remove keep pointing to the same entries when storage
+// is compacted or trimmed
+void test_index3d_iterators_compaction(void) {
+    Index3D *index = index3d_new();
+    int values[9] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+
+    // fills default capacity (8)
+    for (int i = 0; i < 8; ++i) {
+        index3d_insert(index, &values[i], i, 0, 0, NULL);
+    }
+    Index3DIterator *atFive = index3d_iterator_new(index);
+    Index3DIterator *atEnd = index3d_iterator_new(index);
+    for (int i = 0; i < 8; ++i) {
+        if (i < 5) {
+            index3d_iterator_next(atFive);
+        }
+        index3d_iterator_next(atEnd);
+    }
+    TEST_CHECK(index3d_iterator_pointer(atFive) == &values[5]);
+    TEST_CHECK(index3d_iterator_pointer(atEnd) == NULL);
+
+    // 2 holes out of 8 entries, next insertion compacts
+    TEST_CHECK(index3d_remove(index, 0, 0, 0, NULL) == &values[0]);
+    TEST_CHECK(index3d_remove(index, 1, 0, 0, NULL) == &values[1]);
+    index3d_insert(index, &values[8], 8, 0, 0, NULL);
+    TEST_CHECK(index3d_iterator_pointer(atFive) == &values[5]);
+    TEST_CHECK(index3d_iterator_pointer(atEnd) == &values[8]);
+    TEST_CHECK(index3d_iterator_is_at_end(atFive) == false);
+    TEST_CHECK(index3d_iterator_is_at_end(atEnd));
+    for (int i = 2; i < 9; ++i) {
+        TEST_CHECK(index3d_get(index, i, 0, 0) == &values[i]);
+    }
+
+    // removing last entries brings iterators at end position
+    TEST_CHECK(index3d_remove(index, 8, 0, 0, NULL) == &values[8]);
+    TEST_CHECK(index3d_remove(index, 7, 0, 0, NULL) == &values[7]);
+    TEST_CHECK(index3d_remove(index, 6, 0, 0, NULL) == &values[6]);
+    TEST_CHECK(index3d_iterator_is_at_end(atFive));
+    TEST_CHECK(index3d_iterator_pointer(atEnd) == NULL);
+    index3d_insert(index, &values[6], 6, 0, 0, NULL);
+    TEST_CHECK(index3d_iterator_pointer(atEnd) == &values[6]);
+    TEST_CHECK(index3d_iterator_is_at_end(atFive) == false);
+
+    // removing current entry, then everything after it
+    TEST_CHECK(index3d_remove(index, 5, 0, 0, NULL) == &values[5]);
+    TEST_CHECK(index3d_iterator_pointer(atFive) == NULL);
+    TEST_CHECK(index3d_iterator_is_at_end(atFive) == false);
+    TEST_CHECK(index3d_remove(index, 6, 0, 0, NULL) == &values[6]);
+    TEST_CHECK(index3d_iterator_is_at_end(atFive));
+    index3d_iterator_next(atFive);
+    TEST_CHECK(index3d_iterator_pointer(atFive) == NULL);
+
+    index3d_iterator_free(atFive);
+    index3d_flush(index, NULL);
+    index3d_free(index);
+    // iterator outliving its index
+    index3d_iterator_free(atEnd);
+}
@@ -12,6 +12,7 @@
 #pragma clang diagnostic pop // ignored "-Wsign-conversion"
 #pragma clang diagnostic pop // ignored "-Wconversion"
 
+#include "test_asset_archive.h"
 #include "test_block.h"
 #include "test_blockChange.h"
 #include "test_box.h"
@@ -29,12 +30,15 @@
 #include "test_float4.h"
 #include "test_flood_fill_lighting.h"
 #include "test_hash_uint32_int.h"
+#include "test_index3d.h"
 #include "test_inputs.h"
 #include "test_int3.h"
 #include "test_map_string_float3.h"
 #include "test_matrix4x4.h"
+#include "test_octree.h"
 #include "test_quaternion.h"
 #include "test_rtree.h"
+#include "test_serialization.h"
 #include "test_shape.h"
 #include "test_stream.h"
 #include "test_transaction.h"
@@ -45,6 +49,10 @@
 
 TEST_LIST = {
 
+    // asset archive
+    {"asset_archive_writer_layout", test_asset_archive_writer_layout},
+    {"asset_archive_writer_duplicate", test_asset_archive_writer_duplicate},
+
     // block
     {"test_block_new", test_block_new},
     {"test_block_new_air", test_block_new_air},
@@ -85,6 +93,7 @@ TEST_LIST = {
     {"test_chunk_new", test_chunk_new},
     {"test_chunk_Block", test_chunk_Block},
     {"test_chunk_needs_display", test_chunk_needs_display},
+    {"test_chunk_write_vertices_reference", test_chunk_write_vertices_reference},
 
     // config
     {"test_upper_power_of_two", test_upper_power_of_two},
@@ -175,6 +184,13 @@ TEST_LIST = {
 
     // hash_uint32
     {"hash_uint32_int", test_hash_uint32_int},
+    {"hash_uint32_int_many", test_hash_uint32_int_many},
+
+    // index3d
+    {"index3d_insert_get_remove", test_index3d_insert_get_remove},
+    {"index3d_many", test_index3d_many},
+    {"index3d_iterator", test_index3d_iterator},
+    {"index3d_iterators_compaction", test_index3d_iterators_compaction},
 
     // inputs
     {"isTouchEventID", test_isTouchEventID},
@@ -262,6 +278,10 @@ TEST_LIST = {
     {"matrix4x4_op_invert", test_matrix4x4_op_invert},
     {"matrix4x4_op_unscale", test_matrix4x4_op_unscale},
 
+    // octree
+    {"octree_get_element_fast", test_octree_get_element_fast},
+    {"octree_get_elements_slab", test_octree_get_elements_slab},
+
     // quaternion
     {"quaternion_new", test_quaternion_new},
     {"quaternion_new_identity", test_quaternion_new_identity},
@@ -296,6 +316,16 @@ TEST_LIST = {
     {"rtree_node_get_groups", test_rtree_node_get_groups},
     {"rtree_node_get_collides_with", test_rtree_node_get_collides_with},
     {"rtree_create_and_insert", test_rtree_create_and_insert},
+    {"rtree_cast_results", test_rtree_cast_results},
+    {"rtree_query_cast_all_ray", test_rtree_query_cast_all_ray},
+
+    // serialization
+    {"serialization_shape_save_load", test_serialization_shape_save_load},
+    {"serialization_shape_load_threaded", test_serialization_shape_load_threaded},
+    {"serialization_shape_legacy_name_tail", test_serialization_shape_legacy_name_tail},
+    {"serialization_shape_truncated_blocks", test_serialization_shape_truncated_blocks},
+    {"serialization_vox_save_load", test_serialization_vox_save_load},
+    {"serialization_vox_invalid_nb_voxels", test_serialization_vox_invalid_nb_voxels},
 
     // shape
     {"shape_make", test_shape_make},
@@ -316,6 +346,8 @@ TEST_LIST = {
     // stream
     {"stream_new_buffer_read", test_stream_new_buffer_read},
     {"stream_new_file_read", test_stream_new_file_read},
+    {"stream_new_file_map", test_stream_new_file_map},
+    {"stream_peek_view", test_stream_peek_view},
     {"stream_read", test_stream_read},
     {"stream_read_uint8", test_stream_read_uint8},
     {"stream_read_uint16", test_stream_read_uint16},
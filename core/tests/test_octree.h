@@ -0,0 +1,82 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_octree.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "block.h"
+#include "octree.h"
+
+// function that are NOT tested:
+// octree_new_copy
+// octree_flush
+// octree_get_element_or_empty_value
+// octree_log
+// octree_non_recursive_iteration
+// octree iterator
+
+// fast & checked reads return the same blocks, empty cells holding the default block
+void test_octree_get_element_fast(void) {
+    Block air = {SHAPE_COLOR_INDEX_AIR_BLOCK};
+    Block block = {3};
+    Octree *o = octree_new_with_default_element(octree_8x8x8, &air, sizeof(Block));
+    TEST_CHECK(octree_get_dimension(o) == 8);
+
+    octree_set_element(o, &block, 1, 2, 3);
+    octree_set_element(o, &block, 7, 7, 7);
+    TEST_CHECK(octree_get_element(o, 1, 2, 3) != NULL);
+    TEST_CHECK(octree_get_element(o, 3, 2, 1) == NULL);
+
+    for (size_t x = 0; x < 8; ++x) {
+        for (size_t y = 0; y < 8; ++y) {
+            for (size_t z = 0; z < 8; ++z) {
+                TEST_CHECK(octree_get_element_fast(o, x, y, z) ==
+                           octree_get_element_without_checking(o, x, y, z));
+            }
+        }
+    }
+    TEST_CHECK(((Block *)octree_get_element_fast(o, 1, 2, 3))->colorIndex == 3);
+    TEST_CHECK(((Block *)octree_get_element_fast(o, 7, 7, 7))->colorIndex == 3);
+    TEST_CHECK(((Block *)octree_get_element_fast(o, 3, 2, 1))->colorIndex ==
+               SHAPE_COLOR_INDEX_AIR_BLOCK);
+
+    octree_remove_element(o, 7, 7, 7, &air);
+    TEST_CHECK(((Block *)octree_get_element_fast(o, 7, 7, 7))->colorIndex ==
+               SHAPE_COLOR_INDEX_AIR_BLOCK);
+
+    octree_free(o);
+}
+
+void test_octree_get_elements_slab(void) {
+    Block air = {SHAPE_COLOR_INDEX_AIR_BLOCK};
+    Block block = {0};
+    Octree *o = octree_new_with_default_element(octree_8x8x8, &air, sizeof(Block));
+    for (size_t x = 0; x < 8; ++x) {
+        for (size_t y = 0; y < 8; ++y) {
+            for (size_t z = 0; z < 8; ++z) {
+                block.colorIndex = (SHAPE_COLOR_INDEX_INT_T)(x + 8 * y + 64 * (z % 2));
+                octree_set_element(o, &block, x, y, z);
+            }
+        }
+    }
+
+    // box [2, 5[ * [1, 3[ * [4, 8[, ordered x, then y, then z
+    Block blocks[3 * 2 * 4];
+    TEST_CHECK(octree_get_elements_slab(o, 2, 1, 4, 3, 2, 4, blocks));
+    size_t i = 0;
+    for (size_t z = 4; z < 8; ++z) {
+        for (size_t y = 1; y < 3; ++y) {
+            for (size_t x = 2; x < 5; ++x) {
+                TEST_CHECK(blocks[i].colorIndex == x + 8 * y + 64 * (z % 2));
+                ++i;
+            }
+        }
+    }
+
+    // box going past octree bounds
+    TEST_CHECK(octree_get_elements_slab(o, 6, 0, 0, 3, 1, 1, blocks) == false);
+    TEST_CHECK(octree_get_elements_slab(o, 0, 0, 8, 1, 1, 1, blocks) == false);
+
+    octree_free(o);
+}
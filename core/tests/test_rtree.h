@@ -25,7 +25,6 @@
 // rtree_query_overlap_func
 // rtree_query_overlap_box
 // rtree_query_cast_all_func
-// rtree_query_cast_all_ray
 // rtree_query_cast_all_box_step_func
 // rtree_query_cast_all_box
 // rtree_utils_broadphase_steps
@@ -104,3 +103,71 @@ void test_rtree_create_and_insert(void) {
     rtree_free(r);
     transform_release(t);
 }
+
+void test_rtree_cast_results(void) {
+    RtreeCastResults results;
+    rtree_cast_results_init(&results);
+    const float distances[6] = {5.0f, 1.0f, 3.0f, 0.5f, 4.0f, 2.0f};
+    for (int i = 0; i < 6; ++i) {
+        TEST_CHECK(rtree_cast_results_push(&results, NULL, distances[i]));
+    }
+    TEST_CHECK(rtree_cast_results_count(&results) == 6);
+    TEST_CHECK(rtree_cast_results_get(&results, 6) == NULL);
+
+    RtreeCastResult hit;
+    float last = -1.0f;
+    size_t popped = 0;
+    while (rtree_cast_results_pop_nearest(&results, &hit)) {
+        TEST_CHECK(hit.distance >= last);
+        last = hit.distance;
+        ++popped;
+    }
+    TEST_CHECK(popped == 6);
+    TEST_CHECK(rtree_cast_results_count(&results) == 0);
+
+    // grow past default capacity, then sort
+    for (int i = 0; i < 100; ++i) {
+        TEST_CHECK(rtree_cast_results_push(&results, NULL, (float)((i * 37) % 100)));
+    }
+    rtree_cast_results_sort(&results);
+    for (size_t i = 0; i < 100; ++i) {
+        TEST_CHECK(float_isEqual(rtree_cast_results_get(&results, i)->distance,
+                                 (float)i,
+                                 EPSILON_ZERO));
+    }
+
+    rtree_cast_results_release(&results);
+    TEST_CHECK(rtree_cast_results_count(&results) == 0);
+}
+
+// Insert boxes along the X axis and cast a ray through them, hits must come out nearest first
+void test_rtree_query_cast_all_ray(void) {
+    Rtree *r = rtree_new(RTREE_NODE_MIN_CAPACITY, RTREE_NODE_MAX_CAPACITY);
+    RtreeNode *leaves[8];
+    int ptrs[8];
+    for (int i = 0; i < 8; ++i) {
+        const int x = (i * 5) % 8; // shuffled insertion order
+        Box b = {{(float)(x * 2), 0.0f, 0.0f}, {(float)(x * 2 + 1), 1.0f, 1.0f}};
+        leaves[x] = rtree_create_and_insert(r, &b, 1, 1, &ptrs[x]);
+    }
+
+    const float3 origin = {-1.0f, 0.5f, 0.5f};
+    Ray *ray = ray_new(&origin, &float3_right);
+
+    RtreeCastResults results;
+    rtree_cast_results_init(&results);
+    TEST_CHECK(rtree_query_cast_all_ray(r, ray, 1, 1, NULL, &results) == 8);
+
+    RtreeCastResult hit;
+    int i = 0;
+    while (rtree_cast_results_pop_nearest(&results, &hit)) {
+        TEST_CHECK(hit.rtreeLeaf == leaves[i]);
+        TEST_CHECK(float_isEqual(hit.distance, (float)(i * 2 + 1), EPSILON_COLLISION));
+        ++i;
+    }
+    TEST_CHECK(i == 8);
+
+    rtree_cast_results_release(&results);
+    ray_free(ray);
+    rtree_free(r);
+}
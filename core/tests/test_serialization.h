@@ -0,0 +1,449 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_serialization.h
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "acutest.h"
+
+#include "serialization.h"
+#include "serialization_vox.h"
+#include "shape.h"
+#include "stream.h"
+#include "transform.h"
+
+// check that a shape saved as .3zh is loaded back identically, whether its chunks are inflated
+// from a file stream (windowed reads) or from memory (mapped file)
+void test_serialization_shape_save_load(void) {
+    const char *file_name = "shape.3zh";
+    const int size = 40; // shape blocks chunk larger than inflate windows
+    ColorAtlas *atlas = color_atlas_new();
+    const ShapeSettings settings = {.lighting = false, .isMutable = true};
+
+    Shape *shape = shape_make_2(true);
+    shape_set_palette(shape, color_palette_new(atlas), false);
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            for (int z = 0; z < size; ++z) {
+                if ((x + y * 3 + z * 7) % 5 != 0) {
+                    shape_add_block(shape,
+                                    (SHAPE_COLOR_INDEX_INT_T)((x + y + z) % 8),
+                                    (SHAPE_COORDS_INT_T)x,
+                                    (SHAPE_COORDS_INT_T)y,
+                                    (SHAPE_COORDS_INT_T)z,
+                                    false);
+                }
+            }
+        }
+    }
+    const float3 poi = {1.0f, 2.0f, 3.0f};
+    shape_set_point_of_interest(shape, "hand", &poi);
+    transform_set_name(shape_get_root_transform(shape), "crate");
+    const size_t nbBlocks = shape_get_nb_blocks(shape);
+
+    TEST_ASSERT(serialization_save_shape(shape, NULL, 0, fopen(file_name, "wb")));
+
+    for (int map = 0; map < 2; ++map) {
+        FILE *fd = fopen(file_name, "rb");
+        TEST_ASSERT(fd != NULL);
+        Stream *s = map ? stream_new_file_map(fd) : stream_new_file_read(fd);
+        ShapeSettings loadSettings = settings;
+        Shape *loaded = serialization_load_shape(s, "", atlas, &loadSettings, false);
+        TEST_ASSERT(loaded != NULL);
+
+        TEST_CHECK(shape_get_nb_blocks(loaded) == nbBlocks);
+        bool same = true;
+        for (int x = 0; x < size && same; ++x) {
+            for (int y = 0; y < size && same; ++y) {
+                for (int z = 0; z < size && same; ++z) {
+                    const Block *a = shape_get_block(shape,
+                                                     (SHAPE_COORDS_INT_T)x,
+                                                     (SHAPE_COORDS_INT_T)y,
+                                                     (SHAPE_COORDS_INT_T)z);
+                    const Block *b = shape_get_block(loaded,
+                                                     (SHAPE_COORDS_INT_T)x,
+                                                     (SHAPE_COORDS_INT_T)y,
+                                                     (SHAPE_COORDS_INT_T)z);
+                    if (block_is_solid(a) != block_is_solid(b)) {
+                        same = false;
+                    } else if (block_is_solid(a)) {
+                        const RGBAColor ca = color_palette_get_color(shape_get_palette(shape),
+                                                                     block_get_color_index(a));
+                        const RGBAColor cb = color_palette_get_color(shape_get_palette(loaded),
+                                                                     block_get_color_index(b));
+                        same = memcmp(&ca, &cb, sizeof(RGBAColor)) == 0;
+                    }
+                }
+            }
+        }
+        TEST_CHECK(same);
+
+        const float3 *loadedPoi = shape_get_point_of_interest(loaded, "hand");
+        TEST_ASSERT(loadedPoi != NULL);
+        TEST_CHECK(float3_isEqual(loadedPoi, &poi, EPSILON_ZERO));
+        TEST_CHECK(strcmp(transform_get_name(shape_get_root_transform(loaded)), "crate") == 0);
+
+        shape_release(loaded);
+    }
+
+    shape_release(shape);
+    color_atlas_free(atlas);
+    remove(file_name);
+}
+
+// check that shapes of a multi-shape .3zh built on worker threads are identical to the ones built
+// serially: blocks, colors & atlas indices, names, hierarchy and palette sharing
+void test_serialization_shape_load_threaded(void) {
+    const char *file_name = "shapes.3zh";
+    const int nbChildren = 6;
+    const int size = 12;
+
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *root = shape_make_2(true);
+    shape_set_palette(root, color_palette_new(atlas), false);
+    Shape *parent = root;
+    Shape *shapes[7];
+    for (int i = 0; i <= nbChildren; ++i) {
+        Shape *shape = root;
+        if (i > 0) {
+            shape = shape_make_2(true);
+            // odd children have their own palette, even ones share root palette
+            if (i % 2 == 1) {
+                shape_set_palette(shape, color_palette_new(atlas), false);
+            } else {
+                shape_set_palette(shape, shape_get_palette(root), true);
+            }
+            shape_set_parent(shape, shape_get_root_transform(parent), false);
+            if (i == 3) {
+                parent = shape;
+            }
+            char name[8];
+            snprintf(name, sizeof(name), "part%d", i);
+            transform_set_name(shape_get_root_transform(shape), name);
+        }
+        shapes[i] = shape;
+        ColorPalette *palette = shape_get_palette(shape);
+        for (int c = 0; c < 6; ++c) {
+            SHAPE_COLOR_INDEX_INT_T entry;
+            const RGBAColor color = {(uint8_t)(c * 40), (uint8_t)(i * 30), 128, 255};
+            color_palette_check_and_add_color(palette, color, &entry, false);
+        }
+        for (int x = 0; x < size - i; ++x) {
+            for (int y = 0; y < size; ++y) {
+                for (int z = 0; z < size; ++z) {
+                    if ((x * 7 + y * 3 + z + i) % 4 != 0) {
+                        shape_add_block(shape,
+                                        (SHAPE_COLOR_INDEX_INT_T)((x + y + z + i) % 6),
+                                        (SHAPE_COORDS_INT_T)x,
+                                        (SHAPE_COORDS_INT_T)y,
+                                        (SHAPE_COORDS_INT_T)z,
+                                        false);
+                    }
+                }
+            }
+        }
+    }
+    TEST_ASSERT(serialization_save_shape(root, NULL, 0, fopen(file_name, "wb")));
+
+    const ShapeSettings settings = {.lighting = false, .isMutable = false};
+    const uint8_t threads[3] = {0, 1, 4};
+    Shape *loaded[3][7];
+    ColorAtlas *atlases[3];
+    for (int t = 0; t < 3; ++t) {
+        atlases[t] = color_atlas_new();
+        DoublyLinkedList *assets = NULL;
+        FILE *fd = fopen(file_name, "rb");
+        TEST_ASSERT(fd != NULL);
+        TEST_ASSERT(serialization_load_assets(stream_new_file_map(fd),
+                                              NULL,
+                                              AssetType_Shape,
+                                              atlases[t],
+                                              &settings,
+                                              false,
+                                              threads[t],
+                                              &assets));
+        TEST_ASSERT(doubly_linked_list_node_count(assets) == (size_t)nbChildren + 1);
+        int i = 0;
+        DoublyLinkedListNode *n = doubly_linked_list_first(assets);
+        while (n != NULL) {
+            const Asset *asset = (const Asset *)doubly_linked_list_node_pointer(n);
+            TEST_ASSERT(asset->type == AssetType_Shape);
+            loaded[t][i++] = (Shape *)asset->ptr;
+            n = doubly_linked_list_node_next(n);
+        }
+        doubly_linked_list_flush(assets, free);
+        doubly_linked_list_free(assets);
+    }
+
+    for (int t = 1; t < 3; ++t) {
+        for (int i = 0; i <= nbChildren; ++i) {
+            Shape *a = loaded[0][i];
+            Shape *b = loaded[t][i];
+            TEST_CHECK(shape_get_nb_blocks(a) == shape_get_nb_blocks(b));
+
+            Transform *ta = shape_get_root_transform(a);
+            Transform *tb = shape_get_root_transform(b);
+            if (i > 0) {
+                TEST_CHECK(strcmp(transform_get_name(ta), transform_get_name(tb)) == 0);
+            }
+            int parentIndex = -1;
+            for (int j = 0; j <= nbChildren; ++j) {
+                if (transform_get_parent(tb) == shape_get_root_transform(loaded[t][j])) {
+                    parentIndex = j;
+                }
+            }
+            TEST_CHECK(transform_get_parent(ta) ==
+                       (parentIndex >= 0 ? shape_get_root_transform(loaded[0][parentIndex])
+                                         : NULL));
+            TEST_CHECK((shape_get_palette(a) == shape_get_palette(loaded[0][0])) ==
+                       (shape_get_palette(b) == shape_get_palette(loaded[t][0])));
+
+            const ColorPalette *pa = shape_get_palette(a);
+            const ColorPalette *pb = shape_get_palette(b);
+            TEST_CHECK(color_palette_get_count(pa) == color_palette_get_count(pb));
+            for (SHAPE_COLOR_INDEX_INT_T c = 0; c < color_palette_get_count(pa); ++c) {
+                TEST_CHECK(color_palette_get_atlas_index(pa, c) ==
+                           color_palette_get_atlas_index(pb, c));
+                TEST_CHECK(color_palette_get_color_use_count(pa, c) ==
+                           color_palette_get_color_use_count(pb, c));
+                TEST_CHECK(color_palette_get_color_use_count(pb, c) == 0 ||
+                           color_palette_get_atlas_index(pb, c) != ATLAS_COLOR_INDEX_ERROR);
+            }
+
+            bool same = true;
+            for (int x = 0; x < size && same; ++x) {
+                for (int y = 0; y < size && same; ++y) {
+                    for (int z = 0; z < size && same; ++z) {
+                        const Block *ba = shape_get_block(a,
+                                                          (SHAPE_COORDS_INT_T)x,
+                                                          (SHAPE_COORDS_INT_T)y,
+                                                          (SHAPE_COORDS_INT_T)z);
+                        const Block *bb = shape_get_block(b,
+                                                          (SHAPE_COORDS_INT_T)x,
+                                                          (SHAPE_COORDS_INT_T)y,
+                                                          (SHAPE_COORDS_INT_T)z);
+                        same = block_is_solid(ba) == block_is_solid(bb) &&
+                               (block_is_solid(ba) == false ||
+                                block_get_color_index(ba) == block_get_color_index(bb));
+                    }
+                }
+            }
+            TEST_CHECK_(same, "same blocks (threads: %d, shape: %d)", threads[t], i);
+        }
+    }
+
+    for (int t = 0; t < 3; ++t) {
+        for (int i = nbChildren; i >= 0; --i) {
+            shape_release(loaded[t][i]);
+        }
+        color_atlas_free(atlases[t]);
+    }
+    for (int i = nbChildren; i >= 0; --i) {
+        shape_release(shapes[i]);
+    }
+    color_atlas_free(atlas);
+    remove(file_name);
+}
+
+// loads a hand-built .3zh made of one uncompressed shape chunk w/ given sub-chunks
+static Shape *_test_serialization_load_shape_chunk(const uint8_t *subChunks,
+                                                   const uint32_t subChunksSize,
+                                                   ColorAtlas *atlas,
+                                                   const uint8_t nbThreads) {
+    uint8_t file[128];
+    uint32_t n = 0;
+    const uint32_t version = 6;
+    const uint32_t totalSize = 1 + 2 * sizeof(uint32_t) + sizeof(uint8_t) + subChunksSize;
+    TEST_ASSERT(MAGIC_BYTES_SIZE + sizeof(uint32_t) + 1 + sizeof(uint32_t) + totalSize <=
+                sizeof(file));
+
+    memcpy(file + n, MAGIC_BYTES, MAGIC_BYTES_SIZE);
+    n += MAGIC_BYTES_SIZE;
+    memcpy(file + n, &version, sizeof(uint32_t));
+    n += sizeof(uint32_t);
+    file[n++] = 0; // no compression
+    memcpy(file + n, &totalSize, sizeof(uint32_t));
+    n += sizeof(uint32_t);
+
+    file[n++] = 3; // P3S_CHUNK_ID_SHAPE
+    memcpy(file + n, &subChunksSize, sizeof(uint32_t)); // chunk size
+    n += sizeof(uint32_t);
+    file[n++] = 0; // not compressed
+    memcpy(file + n, &subChunksSize, sizeof(uint32_t)); // uncompressed size
+    n += sizeof(uint32_t);
+    memcpy(file + n, subChunks, subChunksSize);
+    n += subChunksSize;
+
+    const ShapeSettings settings = {.lighting = false, .isMutable = false};
+    DoublyLinkedList *assets = NULL;
+    if (serialization_load_assets(stream_new_buffer_read((const char *)file, n),
+                                  "",
+                                  AssetType_Shape,
+                                  atlas,
+                                  &settings,
+                                  false,
+                                  nbThreads,
+                                  &assets) == false) {
+        return NULL;
+    }
+    Shape *shape = assets_get_root_shape(assets, true);
+    doubly_linked_list_flush(assets, serialization_assets_free_func);
+    doubly_linked_list_free(assets);
+    return shape;
+}
+
+// check that the 4 bytes written after the shape name by older writers are ignored, while a short
+// name ending shape data (current writer) is read
+void test_serialization_shape_legacy_name_tail(void) {
+    const uint8_t subChunks[] = {
+        4, 6, 0, 0, 0, 2, 0, 1, 0, 1, 0, // size: 2x1x1
+        5, 2, 0, 0, 0, 1, SHAPE_COLOR_INDEX_AIR_BLOCK, // blocks
+        18, 2, 'a', 'b', // name
+        18, 2, 'x', 'y' // legacy tail, looks like a name sub-chunk
+    };
+    const uint8_t threads[2] = {0, 2};
+    ColorAtlas *atlas = color_atlas_new();
+    for (int t = 0; t < 2; ++t) {
+        for (int tail = 0; tail < 2; ++tail) {
+            Shape *shape = _test_serialization_load_shape_chunk(subChunks,
+                                                                sizeof(subChunks) - (tail ? 0 : 4),
+                                                                atlas,
+                                                                threads[t]);
+            TEST_ASSERT(shape != NULL);
+            TEST_CHECK(shape_get_nb_blocks(shape) == 1);
+            TEST_CHECK(strcmp(transform_get_name(shape_get_root_transform(shape)), "ab") == 0);
+            shape_release(shape);
+        }
+    }
+    color_atlas_free(atlas);
+}
+
+// check that a blocks sub-chunk going past the end of shape data fails the load
+void test_serialization_shape_truncated_blocks(void) {
+    const uint8_t subChunks[] = {
+        4, 6, 0, 0, 0, 2, 0, 2, 0, 2, 0, // size: 2x2x2
+        5, 8, 0, 0, 0, 1, 1 // blocks, 6 missing
+    };
+    const uint8_t threads[2] = {0, 2};
+    ColorAtlas *atlas = color_atlas_new();
+    for (int t = 0; t < 2; ++t) {
+        Shape *shape = _test_serialization_load_shape_chunk(subChunks,
+                                                              sizeof(subChunks),
+                                                              atlas,
+                                                              threads[t]);
+        TEST_CHECK(shape == NULL);
+        if (shape != NULL) {
+            shape_release(shape);
+        }
+    }
+    color_atlas_free(atlas);
+}
+
+// check that a shape exported as .vox is imported back w/ the same blocks & colors, whether voxels
+// are read in place (mapped file) or copied (file stream)
+void test_serialization_vox_save_load(void) {
+    const char *file_name = "shape.vox";
+    const int size = 40; // several chunks per axis
+    ColorAtlas *atlas = color_atlas_new();
+
+    Shape *shape = shape_make_2(true);
+    shape_set_palette(shape, color_palette_new(atlas), false);
+    ColorPalette *palette = shape_get_palette(shape);
+    for (int c = 0; c < 10; ++c) {
+        SHAPE_COLOR_INDEX_INT_T entry;
+        const RGBAColor color = {(uint8_t)(c * 25), 100, (uint8_t)(255 - c * 25), 255};
+        color_palette_check_and_add_color(palette, color, &entry, false);
+    }
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            for (int z = 0; z < size; ++z) {
+                if ((x * 3 + y + z * 5) % 7 != 0) {
+                    shape_add_block(shape,
+                                    (SHAPE_COLOR_INDEX_INT_T)((x / 4 + y + z / 3) % 10),
+                                    (SHAPE_COORDS_INT_T)x,
+                                    (SHAPE_COORDS_INT_T)y,
+                                    (SHAPE_COORDS_INT_T)z,
+                                    false);
+                }
+            }
+        }
+    }
+    FILE *out = fopen(file_name, "wb");
+    TEST_ASSERT(out != NULL);
+    TEST_ASSERT(serialization_vox_save(shape, out));
+    fclose(out);
+
+    for (int map = 0; map < 2; ++map) {
+        FILE *fd = fopen(file_name, "rb");
+        TEST_ASSERT(fd != NULL);
+        Stream *s = map ? stream_new_file_map(fd) : stream_new_file_read(fd);
+        Shape *loaded = NULL;
+        TEST_CHECK(serialization_vox_load(s, &loaded, false, atlas) == no_error);
+        stream_free(s);
+        TEST_ASSERT(loaded != NULL);
+
+        TEST_CHECK(shape_get_nb_blocks(loaded) == shape_get_nb_blocks(shape));
+        TEST_CHECK(color_palette_get_count(shape_get_palette(loaded)) == 10);
+        bool same = true;
+        for (int x = 0; x < size && same; ++x) {
+            for (int y = 0; y < size && same; ++y) {
+                for (int z = 0; z < size && same; ++z) {
+                    const Block *a = shape_get_block(shape,
+                                                     (SHAPE_COORDS_INT_T)x,
+                                                     (SHAPE_COORDS_INT_T)y,
+                                                     (SHAPE_COORDS_INT_T)z);
+                    const Block *b = shape_get_block(loaded,
+                                                     (SHAPE_COORDS_INT_T)x,
+                                                     (SHAPE_COORDS_INT_T)y,
+                                                     (SHAPE_COORDS_INT_T)z);
+                    if (block_is_solid(a) != block_is_solid(b)) {
+                        same = false;
+                    } else if (block_is_solid(a)) {
+                        const RGBAColor ca = color_palette_get_color(palette,
+                                                                     block_get_color_index(a));
+                        const RGBAColor cb = color_palette_get_color(shape_get_palette(loaded),
+                                                                     block_get_color_index(b));
+                        same = memcmp(&ca, &cb, sizeof(RGBAColor)) == 0;
+                    }
+                }
+            }
+        }
+        TEST_CHECK(same);
+
+        shape_release(loaded);
+    }
+
+    shape_release(shape);
+    color_atlas_free(atlas);
+    remove(file_name);
+}
+
+// check that a .vox whose voxel count doesn't fit in its XYZI chunk is rejected before voxels are
+// allocated, when they can't be read in place (file stream)
+void test_serialization_vox_invalid_nb_voxels(void) {
+    const char *file_name = "invalid.vox";
+    const uint32_t header[] = {
+        150, // version
+        0x4e49414d, 0, 24 + 16, // "MAIN", content, children (SIZE + XYZI)
+        0x455a4953, 12, 0, 2, 2, 2, // "SIZE", content, children, x, y, z
+        0x495a5958, 8, 0, 0x40000000, 0x01000000 // "XYZI", content, children, nbVoxels, 1 voxel
+    };
+    FILE *out = fopen(file_name, "wb");
+    TEST_ASSERT(out != NULL);
+    TEST_CHECK(fwrite("VOX ", 1, 4, out) == 4);
+    TEST_CHECK(fwrite(header, sizeof(header), 1, out) == 1);
+    fclose(out);
+
+    ColorAtlas *atlas = color_atlas_new();
+    FILE *fd = fopen(file_name, "rb");
+    TEST_ASSERT(fd != NULL);
+    Stream *s = stream_new_file_read(fd);
+    Shape *loaded = NULL;
+    TEST_CHECK(serialization_vox_load(s, &loaded, false, atlas) == invalid_format);
+    TEST_CHECK(loaded == NULL);
+    stream_free(s);
+
+    color_atlas_free(atlas);
+    remove(file_name);
+}
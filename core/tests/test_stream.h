@@ -53,6 +53,62 @@ void test_stream_new_file_read(void) {
     remove(file_name);
 }
 
+// check that mapped file is read like a buffer, starting at file position
+void test_stream_new_file_map(void) {
+    const char *file_name = "hi.txt";
+    const char *content = "Hello world";
+    FILE *f = fopen(file_name, "wb");
+    TEST_ASSERT(fputs(content, f) != EOF);
+    fclose(f);
+
+    f = fopen(file_name, "rb");
+    TEST_ASSERT(fseek(f, 6, SEEK_SET) == 0);
+    Stream *s = stream_new_file_map(f);
+    TEST_CHECK(stream_get_cursor_position(s) == 6);
+
+    char buf[6];
+    TEST_CHECK(stream_read_string(s, 5, buf));
+    buf[5] = '\0';
+    TEST_CHECK(strcmp(buf, "world") == 0);
+    TEST_CHECK(stream_reached_the_end(s));
+
+    stream_set_cursor_position(s, 0);
+    TEST_CHECK(stream_read_string(s, 5, buf));
+    TEST_CHECK(strcmp(buf, "Hello") == 0);
+
+    stream_free(s); // closes file
+    remove(file_name);
+}
+
+// check that views point to stream memory, within bounds
+void test_stream_peek_view(void) {
+    const char *content = "Hello";
+    Stream *s = stream_new_buffer_read(content, 5);
+
+    TEST_CHECK(stream_peek(s, 2) == content);
+    TEST_CHECK(stream_get_cursor_position(s) == 0);
+    TEST_CHECK(stream_view(s, 2) == content);
+    TEST_CHECK(stream_get_cursor_position(s) == 2);
+    TEST_CHECK(stream_view(s, 4) == NULL); // only 3 bytes left
+    TEST_CHECK(stream_get_cursor_position(s) == 2);
+    TEST_CHECK(stream_view(s, 3) == content + 2);
+    TEST_CHECK(stream_reached_the_end(s));
+    TEST_CHECK(stream_peek(s, 0) == content + 5);
+    stream_free(s);
+
+    // not memory-backed
+    const char *file_name = "hi.txt";
+    FILE *f = fopen(file_name, "wb");
+    TEST_ASSERT(fputs(content, f) != EOF);
+    fclose(f);
+    f = fopen(file_name, "rb");
+    s = stream_new_file_read(f);
+    TEST_CHECK(stream_peek(s, 1) == NULL);
+    TEST_CHECK(stream_view(s, 1) == NULL);
+    stream_free(s);
+    remove(file_name);
+}
+
 // check that the output matches the content
 void test_stream_read(void) {
     const size_t len = 6; // length of "Hello" (+ NULL terminator)
@@ -11,12 +11,150 @@
 #include <chrono>
 #include <cstring>
 
+#include <zlib.h>
+
 #include "vxlog.h"
 
 #define PAYLOAD_DIFF_NOT_POSSIBLE UINT32_MAX
 
+// initial capacity of receive buffers, most game messages fit in it
+#define RECEIVE_BUFFER_MIN_CAPACITY 4096
+// buffers above that capacity are freed instead of going back to the pool
+#define RECEIVE_BUFFER_POOL_MAX_CAPACITY 65536
+#define RECEIVE_BUFFER_POOL_MAX_BUFFERS 64
+
+// favoring speed, game payloads are very repetitive and compress well anyway
+#define PAYLOAD_COMPRESSION_LEVEL Z_BEST_SPEED
+// protects against corrupted or malicious uncompressed sizes
+#define PAYLOAD_MAX_INFLATED_SIZE 67108864 // 64MB
+
 using namespace vx;
 
+namespace {
+/// deflate state is costly to initialize (larger than compressing a small Payload),
+/// each thread keeps one and resets it between Payloads
+struct PayloadDeflater {
+    z_stream stream;
+    bool ready;
+    PayloadDeflater() : stream(), ready(false) {
+        ready = deflateInit(&stream, PAYLOAD_COMPRESSION_LEVEL) == Z_OK;
+    }
+    ~PayloadDeflater() {
+        if (ready) { deflateEnd(&stream); }
+    }
+};
+}
+
+//
+// Connection
+//
+
+Connection::Connection() :
+_delegate(),
+_compressionEnabled(false),
+_compressionMinSize(0),
+_peerAcceptsCompression(false) {}
+
+void Connection::setCompression(bool enabled, size_t minSize) {
+    _compressionMinSize = minSize;
+    _compressionEnabled = enabled;
+}
+
+bool Connection::isCompressionEnabled() {
+    return _compressionEnabled;
+}
+
+Connection::Payload_SharedPtr Connection::_compressIfNeeded(const Payload_SharedPtr& p) {
+    if (p == nullptr ||
+        _compressionEnabled == false ||
+        _peerAcceptsCompression == false ||
+        p->contentSize() < _compressionMinSize) {
+        return p;
+    }
+    Payload_SharedPtr compressed = p->getCompressed();
+    return compressed != nullptr ? compressed : p;
+}
+
+uint8_t Connection::_advertisedIncludes() {
+    return _compressionEnabled ? Payload::Includes::AcceptsCompression : 0;
+}
+
+void Connection::_didReceivePayload(const Payload_SharedPtr& p) {
+    if (p != nullptr && p->acceptsCompression() && _peerAcceptsCompression == false) {
+        _peerAcceptsCompression = true;
+    }
+}
+
+//
+// ReceiveBuffer
+//
+
+Connection::ReceiveBuffer::Pool Connection::ReceiveBuffer::_pool;
+
+Connection::ReceiveBuffer::Pool::Pool() :
+buffers(RECEIVE_BUFFER_POOL_MAX_BUFFERS),
+destroyed(false) {}
+
+Connection::ReceiveBuffer::Pool::~Pool() {
+    destroyed = true;
+    ReceiveBuffer *buffer = nullptr;
+    while (buffers.pop(buffer)) {
+        delete buffer;
+    }
+}
+
+Connection::ReceiveBuffer *Connection::ReceiveBuffer::get() {
+    ReceiveBuffer *buffer = nullptr;
+    if (_pool.destroyed || _pool.buffers.pop(buffer) == false) {
+        buffer = new ReceiveBuffer();
+    }
+    return buffer;
+}
+
+void Connection::ReceiveBuffer::release() {
+    _size = 0;
+    ReceiveBuffer *self = this;
+    if (_capacity > RECEIVE_BUFFER_POOL_MAX_CAPACITY || _pool.destroyed ||
+        _pool.buffers.tryPush(std::move(self)) == false) {
+        delete this; // too big to be kept, pool is full or destroyed
+    }
+}
+
+bool Connection::ReceiveBuffer::append(const char *bytes, size_t len) {
+    if (_size + len > _capacity) {
+        size_t capacity = _capacity > 0 ? _capacity : RECEIVE_BUFFER_MIN_CAPACITY;
+        while (capacity < _size + len) {
+            capacity *= 2;
+        }
+        char *b = static_cast<char*>(realloc(_bytes, capacity));
+        if (b == nullptr) {
+            return false;
+        }
+        _bytes = b;
+        _capacity = capacity;
+    }
+    memcpy(_bytes + _size, bytes, len);
+    _size += len;
+    return true;
+}
+
+char *Connection::ReceiveBuffer::getBytes() {
+    return _bytes;
+}
+
+size_t Connection::ReceiveBuffer::getSize() {
+    return _size;
+}
+
+Connection::ReceiveBuffer::ReceiveBuffer() :
+_bytes(nullptr),
+_size(0),
+_capacity(0) {}
+
+Connection::ReceiveBuffer::~ReceiveBuffer() {
+    free(_bytes);
+}
+
 //
 // Payload
 //
@@ -98,9 +236,57 @@ Connection::Payload_SharedPtr Connection::Payload::decode(char *bytes, size_t le
     p->_content = cursor;
     p->_len = len - static_cast<size_t>(cursor - bytes);
 
+    p->_acceptsCompression = (p->_includes & Includes::AcceptsCompression) != 0;
+
+    if (p->_includes & Includes::Compressed) {
+        uint32_t inflatedLen = 0;
+        char *inflated = nullptr;
+        uLongf n = 0;
+        if (p->_len >= sizeof(uint32_t)) {
+            memcpy(&inflatedLen, p->_content, sizeof(uint32_t));
+            n = inflatedLen;
+            if (inflatedLen <= PAYLOAD_MAX_INFLATED_SIZE) {
+                inflated = static_cast<char*>(malloc(inflatedLen > 0 ? inflatedLen : 1));
+            }
+        }
+        if (inflated == nullptr ||
+            uncompress(reinterpret_cast<Bytef*>(inflated),
+                       &n,
+                       reinterpret_cast<const Bytef*>(p->_content + sizeof(uint32_t)),
+                       static_cast<uLong>(p->_len - sizeof(uint32_t))) != Z_OK ||
+            n != inflatedLen) {
+            vxlog_error("Connection::Payload::decode - can't inflate content");
+            free(inflated);
+            // bytes remain the caller's responsibility
+            p->_content = nullptr;
+            p->_decoded = nullptr;
+            delete p;
+            return nullptr;
+        }
+        p->_inflated = inflated;
+        p->_content = inflated;
+        p->_len = inflatedLen;
+    }
+
+    // content is not compressed anymore, and acceptance isn't forwarded if copied
+    p->_includes &= ~(Includes::Compressed | Includes::AcceptsCompression);
+
     return Payload_SharedPtr(p);
 }
 
+Connection::Payload_SharedPtr Connection::Payload::decode(ReceiveBuffer *buffer) {
+    if (buffer == nullptr) return nullptr;
+
+    Payload_SharedPtr p = decode(buffer->getBytes(), buffer->getSize());
+    if (p == nullptr) {
+        buffer->release();
+        return nullptr;
+    }
+    // bytes belong to the buffer
+    p->_buffer = buffer;
+    return p;
+}
+
 Connection::Payload_SharedPtr Connection::Payload::copy(const Payload_SharedPtr& p) {
     
     if (p == nullptr) return nullptr;
@@ -133,6 +319,9 @@ Connection::Payload::Payload(char* bytes, size_t len, uint8_t includes) {
     _includes = includes;
     _content = bytes;
     _decoded = nullptr;
+    _buffer = nullptr;
+    _inflated = nullptr;
+    _acceptsCompression = false;
     _len = len;
     _metadataSizeCache = 0;
     _metadata = nullptr;
@@ -206,6 +395,9 @@ Connection::Payload::Payload() {
     _includes = Includes::None;
     _content = nullptr;
     _decoded = nullptr;
+    _buffer = nullptr;
+    _inflated = nullptr;
+    _acceptsCompression = false;
     _len = 0;
     _metadataSizeCache = 0;
     _metadata = nullptr;
@@ -214,7 +406,17 @@ Connection::Payload::Payload() {
 }
 
 Connection::Payload::~Payload() {
-    if (_content != nullptr) {
+    if (_inflated != nullptr) {
+        free(_inflated);
+        _inflated = nullptr;
+        _content = _decoded; // raw bytes, released below
+    }
+    if (_buffer != nullptr) {
+        _buffer->release();
+        _buffer = nullptr;
+        _decoded = nullptr;
+        _content = nullptr;
+    } else if (_content != nullptr) {
         if (_decoded != nullptr) {
             free(_decoded);
             _decoded = nullptr;
@@ -230,6 +432,51 @@ Connection::Payload::~Payload() {
     }
 }
 
+Connection::Payload_SharedPtr Connection::Payload::getCompressed() {
+    std::call_once(_compressedOnce, [this]() {
+        if (_content == nullptr || _len == 0 || _len > UINT32_MAX) {
+            return;
+        }
+        static thread_local PayloadDeflater deflater;
+        if (deflater.ready == false || deflateReset(&deflater.stream) != Z_OK) {
+            return;
+        }
+        const uLong bound = deflateBound(&deflater.stream, static_cast<uLong>(_len));
+        char *bytes = static_cast<char*>(malloc(sizeof(uint32_t) + bound));
+        if (bytes == nullptr) {
+            return;
+        }
+        const uint32_t len = static_cast<uint32_t>(_len);
+        memcpy(bytes, &len, sizeof(uint32_t));
+
+        deflater.stream.next_in = reinterpret_cast<Bytef*>(_content);
+        deflater.stream.avail_in = static_cast<uInt>(_len);
+        deflater.stream.next_out = reinterpret_cast<Bytef*>(bytes + sizeof(uint32_t));
+        deflater.stream.avail_out = static_cast<uInt>(bound);
+        if (deflate(&deflater.stream, Z_FINISH) != Z_STREAM_END ||
+            sizeof(uint32_t) + deflater.stream.total_out >= _len) {
+            free(bytes);
+            return;
+        }
+
+        Payload *p = new Payload();
+        p->_includes = _includes | Includes::Compressed;
+        p->_content = bytes;
+        p->_len = sizeof(uint32_t) + deflater.stream.total_out;
+        p->_createdAt = _createdAt;
+        p->_id = _id;
+        if (_includes & Includes::TravelHistory) {
+            p->_steps = _steps;
+        }
+        _compressed = Payload_SharedPtr(p);
+    });
+    return _compressed;
+}
+
+bool Connection::Payload::acceptsCompression() {
+    return _acceptsCompression;
+}
+
 void Connection::Payload::step(const std::string &name) {
     
     // do not add step if Payload does not support travel history
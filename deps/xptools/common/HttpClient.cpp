@@ -9,6 +9,7 @@
 #include "HttpClient.hpp"
 
 // C++
+#include <algorithm>
 #include <cassert>
 #include <mutex>
 #include <sstream>
@@ -22,6 +23,8 @@
 #include "BZMD5.hpp"
 #include "cJSON.h"
 
+#include <zlib.h>
+
 #if defined(__VX_USE_LIBWEBSOCKETS)
 
 #pragma clang diagnostic push
@@ -38,6 +41,7 @@
 #define VX_HTTP_CACHE_FILE_FORMAT_V1 1 // uint8
 #define VX_HTTP_CACHE_FILE_FORMAT_V2 2 // uint8
 #define VX_HTTP_CACHE_COMPRESSION_NONE 1 // uint8
+#define VX_HTTP_CACHE_COMPRESSION_ZLIB 2 // uint8 (body stored in a VX_HTTP_CACHE_CHUNK_BODY_ZLIB chunk)
 // chunk IDs are uint8s
 #define VX_HTTP_CACHE_CHUNK_CREATIONTIME 1 // value is uint32 (seconds since 2001/01/01)
 #define VX_HTTP_CACHE_CHUNK_MAXAGE 2 // value is uint32 (seconds)
@@ -46,6 +50,28 @@
 #define VX_HTTP_CACHE_CHUNK_HEADERS 5 // value is string (multiple occurences)
 #define VX_HTTP_CACHE_CHUNK_BODY 6 // value is string (raw bytes)
 #define VX_HTTP_CACHE_CHUNK_ETAG 7 // value is string (ETag bytes)
+// value is uint32 (uncompressed size) + string (zlib compressed bytes)
+// (different ID than VX_HTTP_CACHE_CHUNK_BODY, for clients not supporting compression to discard the file)
+#define VX_HTTP_CACHE_CHUNK_BODY_ZLIB 8
+
+// bodies are compressed when large enough, and when it saves at least 1/8 of their size
+// (not the case for already compressed formats: 3zh, png...)
+#define VX_HTTP_CACHE_COMPRESSION_MIN_SIZE 1024
+// favoring speed, responses are cached from the network thread
+#define VX_HTTP_CACHE_COMPRESSION_LEVEL Z_BEST_SPEED
+// larger bodies are only compressed if their first bytes compress well,
+// not to spend time on compressed formats
+#define VX_HTTP_CACHE_COMPRESSION_PROBE_SIZE 4096
+// compressed bodies are read & inflated by blocks of that size
+#define VX_HTTP_CACHE_INFLATE_BLOCK_SIZE 65536
+
+// in-memory cache of hot responses, in front of cache files
+#define VX_HTTP_CACHE_MEMORY_MAX_BYTES 33554432 // 32MB (total, split between shards)
+#define VX_HTTP_CACHE_MEMORY_MAX_ENTRY_BYTES 2097152 // 2MB, larger responses only cached on disk
+// cache files are removed, least recently used first, beyond that size
+#define VX_HTTP_CACHE_DISK_MAX_BYTES 536870912 // 512MB
+// cache file names are hex MD5 hashes of request URLs
+#define VX_HTTP_CACHE_HASH_LEN 32
 
 namespace vx {
 
@@ -322,8 +348,105 @@ void HttpClient::run_unit_tests_get_url() {
 }
 
 HttpClient::HttpClient() :
-_cacheMutex(),
-_callbackMiddleware(nullptr) {}
+_cacheShards(),
+_diskCacheMutex(),
+_diskCacheIndexedOnce(),
+_diskCacheLRU(),
+_diskCacheFiles(),
+_diskCacheBytes(0),
+_callbackMiddleware(nullptr),
+_inFlightGETsMutex(),
+_inFlightGETs(),
+_networkGETsCount(0),
+_coalescedGETsCount(0) {}
+
+bool HttpClient::attachToInFlightGET(const std::string& key, const HttpRequest_SharedPtr& req) {
+    if (req == nullptr) {
+        return false;
+    }
+    const std::lock_guard<std::mutex> lock(_inFlightGETsMutex);
+
+    auto it = _inFlightGETs.find(key);
+    if (it != _inFlightGETs.end()) {
+        HttpRequest_SharedPtr inFlight = it->second.request.lock();
+        if (inFlight != nullptr && inFlight->getStatus() == HttpRequest::Status::PROCESSING) {
+            it->second.waiting.push_back(req);
+            ++_coalescedGETsCount;
+            return true;
+        }
+        // in-flight request is gone or done without notifying, replace it
+        std::vector<HttpRequest_SharedPtr> waiting = std::move(it->second.waiting);
+        it->second.request = req;
+        it->second.waiting = std::move(waiting);
+    } else {
+        InFlightGET inFlightGET;
+        inFlightGET.request = req;
+        _inFlightGETs.emplace(key, std::move(inFlightGET));
+    }
+    ++_networkGETsCount;
+    return false;
+}
+
+std::vector<HttpRequest_SharedPtr> HttpClient::removeInFlightGET(const std::string& key, const HttpRequest_WeakPtr& req) {
+    std::vector<HttpRequest_SharedPtr> waiting;
+    const std::lock_guard<std::mutex> lock(_inFlightGETsMutex);
+
+    auto it = _inFlightGETs.find(key);
+    if (it == _inFlightGETs.end()) {
+        return waiting;
+    }
+    // comparing owners, `req` can be expired when called from HttpRequest's destructor
+    if (it->second.request.owner_before(req) || req.owner_before(it->second.request)) {
+        return waiting;
+    }
+    waiting = std::move(it->second.waiting);
+    _inFlightGETs.erase(it);
+    return waiting;
+}
+
+bool HttpClient::cancelInFlightGET(const std::string& key,
+                                   const HttpRequest_SharedPtr& req,
+                                   HttpRequest_SharedPtr& nextInFlight) {
+    nextInFlight = nullptr;
+    const std::lock_guard<std::mutex> lock(_inFlightGETsMutex);
+
+    auto it = _inFlightGETs.find(key);
+    if (it == _inFlightGETs.end()) {
+        return false;
+    }
+    std::vector<HttpRequest_SharedPtr>& waiting = it->second.waiting;
+    auto w = std::find(waiting.begin(), waiting.end(), req);
+    if (w != waiting.end()) {
+        // was not sent, nothing to cancel
+        waiting.erase(w);
+        return true;
+    }
+    if (it->second.request.lock() != req) {
+        return false;
+    }
+    // response still needed: first waiting request is sent in place of `req`
+    while (waiting.empty() == false) {
+        HttpRequest_SharedPtr r = waiting.front();
+        waiting.erase(waiting.begin());
+        if (r->getStatus() == HttpRequest::Status::PROCESSING) {
+            it->second.request = r;
+            --_coalescedGETsCount;
+            ++_networkGETsCount;
+            nextInFlight = r;
+            return false;
+        }
+    }
+    _inFlightGETs.erase(it);
+    return false;
+}
+
+uint64_t HttpClient::getNetworkGETsCount() {
+    return _networkGETsCount;
+}
+
+uint64_t HttpClient::getCoalescedGETsCount() {
+    return _coalescedGETsCount;
+}
 
 bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
     // For now, there is no caching for streamed HTTP responses
@@ -331,7 +454,6 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
         return false; // was not cached
     }
 
-    const std::lock_guard<std::mutex> lock(this->_cacheMutex);
     bool ok = false;
 
     HttpResponse& response = req->getResponse();
@@ -367,24 +489,53 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
         etag = responseHeaders.at("etag");
     }
 
+    std::shared_ptr<CacheEntry> entry = std::make_shared<CacheEntry>();
+    entry->etag = etag;
+    entry->creationTime = static_cast<uint32_t>(vx::device::timestampApple());
+    entry->maxAge = maxAge;
+    entry->statusCode = statusCode;
+    entry->headers = responseHeaders;
+    if (response.readAllBytes(entry->body) == false) {
+        return false;
+    }
+
     // TODO: used cached URL, do not reconstruct URL here
-    const std::string requestURL = req->constructURLString();
+    entry->url = req->constructURLString();
 
     // generate hash from URL
-    const std::string urlHash = md5(requestURL);
+    const std::string urlHash = md5(entry->url);
 
     // open cache file in storage
     const std::string filepath = std::string(VX_HTTP_CACHE_DIR_NAME) + "/" + urlHash;
 
+    entry->size = sizeof(CacheEntry) + entry->url.size() + entry->etag.size() + entry->body.size();
+    for (const auto& kv : entry->headers) {
+        entry->size += kv.first.size() + kv.second.size();
+    }
+
+    // compressed before locking, not to block accesses to the shard
+    std::string compressedBody;
+    const bool compressBody = _cacheCompress(entry->body, compressedBody);
+
+    // files from previous sessions are indexed before locking the shard
+    _diskCacheIndexIfNeeded();
+    std::vector<std::string> evicted;
+
+    CacheShard& shard = _getCacheShard(urlHash);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+
     // creates file is not present, truncate it otherwise
     FILE* fd = vx::fs::openStorageFile(filepath, "wb");
     if (fd == nullptr) {
+        _memoryCacheRemove(shard, urlHash);
         return false;
     }
 
     // cache file header
     {
-        ok = _cacheWriteFileHeader(VX_HTTP_CACHE_FILE_FORMAT_V2, VX_HTTP_CACHE_COMPRESSION_NONE, fd);
+        ok = _cacheWriteFileHeader(VX_HTTP_CACHE_FILE_FORMAT_V2,
+                                   compressBody ? VX_HTTP_CACHE_COMPRESSION_ZLIB : VX_HTTP_CACHE_COMPRESSION_NONE,
+                                   fd);
         if (ok == false) {
             goto return_false;
         }
@@ -392,7 +543,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // etag
     {
-        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_ETAG, etag, fd);
+        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_ETAG, entry->etag, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -400,8 +551,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // file creation time
     {
-        const uint32_t creationTime = static_cast<uint32_t>(vx::device::timestampApple());
-        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_CREATIONTIME, creationTime, fd);
+        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_CREATIONTIME, entry->creationTime, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -409,7 +559,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // max-age value
     {
-        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_MAXAGE, maxAge, fd);
+        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_MAXAGE, entry->maxAge, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -417,7 +567,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // request URL
     {
-        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_URL, requestURL, fd);
+        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_URL, entry->url, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -425,7 +575,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // HTTP status
     {
-        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_STATUSCODE, response.getStatusCode(), fd);
+        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_STATUSCODE, entry->statusCode, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -433,7 +583,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // HTTP response headers
     {
-        ok = _cacheWriteMapStringStringChunk(VX_HTTP_CACHE_CHUNK_HEADERS, responseHeaders, fd);
+        ok = _cacheWriteMapStringStringChunk(VX_HTTP_CACHE_CHUNK_HEADERS, entry->headers, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -441,33 +591,42 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // HTTP response body
     {
-        std::string allBytes;
-        ok = response.readAllBytes(allBytes);
-        if (ok == false) {
-            goto return_false;
+        if (compressBody) {
+            ok = _cacheWriteCompressedStringChunk(VX_HTTP_CACHE_CHUNK_BODY_ZLIB,
+                                                  compressedBody,
+                                                  static_cast<uint32_t>(entry->body.size()),
+                                                  fd);
+        } else {
+            ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_BODY, entry->body, fd);
         }
-        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_BODY, allBytes, fd);
         if (ok == false) {
             goto return_false;
         }
     }
 
     // Success case - close file and return true
-    fclose(fd);
+    {
+        const long fileSize = ftell(fd);
+        fclose(fd);
+        _memoryCacheSet(shard, urlHash, entry);
+        _diskCacheDidWrite(urlHash, fileSize > 0 ? static_cast<size_t>(fileSize) : 0, evicted);
+    }
+    // evicted files are removed under their own shard lock
+    lock.unlock();
+    _diskCacheRemoveEvicted(evicted);
     return true;
 
 return_false:
     fclose(fd);
     vx::fs::removeStorageFileOrDirectory(filepath);
+    _memoryCacheRemove(shard, urlHash);
+    _diskCacheDidRemove(urlHash);
     return false;
 }
 
 #if !defined(__VX_PLATFORM_WASM)
 
 HttpClient::CacheMatch HttpClient::getCachedResponseForRequest(HttpRequest_SharedPtr req) {
-    const std::lock_guard<std::mutex> lock(this->_cacheMutex);
-
-    bool ok = false;
     CacheMatch result;
 
     if (req == nullptr) {
@@ -484,116 +643,61 @@ HttpClient::CacheMatch HttpClient::getCachedResponseForRequest(HttpRequest_Share
     // generate hash from URL
     const std::string urlHash = md5(requestURL);
 
-    // open cache file in storage
-    const std::string filepath = std::string(VX_HTTP_CACHE_DIR_NAME) + "/" + urlHash;
-
-    // check cache file exists
+    CacheEntry_SharedPtr entry = nullptr;
     {
-        bool isDir = false;
-        const bool exists = vx::fs::storageFileExists(filepath, isDir);
-        if (exists == false || isDir) {
-            return result;
-        }
-    }
+        CacheShard& shard = _getCacheShard(urlHash);
+        const std::lock_guard<std::mutex> lock(shard.mutex);
 
-    // open cache file
-    FILE *fd = vx::fs::openStorageFile(filepath);
-    if (fd == nullptr) {
-        return result;
-    }
+        entry = _memoryCacheGet(shard, urlHash);
 
-    result.didFindCache = true;
-
-    // skip header
-    {
-        fseek(fd, VX_HTTP_CACHE_MAGICBYTES_LEN, SEEK_SET);
-    }
+        if (entry == nullptr) {
+            // open cache file in storage
+            const std::string filepath = std::string(VX_HTTP_CACHE_DIR_NAME) + "/" + urlHash;
 
-    // file format version & file compression method
-    uint8_t fileFormatVersion = 0;
-    {
-        uint8_t fileCompressionMethod = 0;
-        ok = _cacheReadFileHeader(&fileFormatVersion, &fileCompressionMethod, fd);
-        if (ok == false) {
-            goto return_cache_not_found_and_delete_cache;
-        }
-    }
+            // check cache file exists
+            {
+                bool isDir = false;
+                const bool exists = vx::fs::storageFileExists(filepath, isDir);
+                if (exists == false || isDir) {
+                    return result;
+                }
+            }
 
-    if (fileFormatVersion > 1) {
-        std::string etag;
-        ok = _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_ETAG, etag, fd);
-        if (ok == false) {
-            goto return_cache_not_found_and_delete_cache;
-        }
-        if (etag.empty() == false) {
-            req->setOneHeader("If-None-Match", etag);
+            // open cache file
+            FILE *fd = vx::fs::openStorageFile(filepath);
+            if (fd == nullptr) {
+                return result;
+            }
+            entry = _cacheReadFile(fd);
+            fclose(fd);
+
+            if (entry == nullptr || entry->url != requestURL) {
+                // corrupted, outdated format or hash collision
+                vx::fs::removeStorageFileOrDirectory(filepath);
+                _diskCacheDidRemove(urlHash);
+                return result;
+            }
+            _memoryCacheSet(shard, urlHash, entry);
         }
-    } else {
-        // ignore & delete old cache
-        goto return_cache_not_found_and_delete_cache;
     }
+    _diskCacheDidRead(urlHash);
 
-    // check cache is not expired
-    {
-        uint32_t cacheCreationTime = 0;
-        ok = _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_CREATIONTIME, cacheCreationTime, fd);
-        if (ok == false) {
-            goto return_cache_not_found_and_delete_cache;
-        }
-
-        uint32_t maxAge = 0;
-        ok = _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_MAXAGE, maxAge, fd);
-        if (ok == false) {
-            goto return_cache_not_found_and_delete_cache;
-        }
+    result.didFindCache = true;
 
-        const uint32_t currentTime = static_cast<uint32_t>(vx::device::timestampApple());
-        result.isStillFresh = currentTime < (cacheCreationTime + maxAge);
+    if (entry->etag.empty() == false) {
+        req->setOneHeader("If-None-Match", entry->etag);
     }
 
-    // read cache content
-    {
-        std::string url;
-        ok = _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_URL, url, fd);
-        if (ok == false || url != requestURL) {
-            goto return_cache_not_found_and_delete_cache;
-        }
-
-        uint32_t statusCode = 0;
-        ok = _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_STATUSCODE, statusCode, fd);
-        if (ok == false) {
-            goto return_cache_not_found_and_delete_cache;
-        }
-
-        HttpHeaders headers;
-        ok = _cacheReadMapStringStringChunk(VX_HTTP_CACHE_CHUNK_HEADERS, headers, fd);
-        if (ok == false) {
-            goto return_cache_not_found_and_delete_cache;
-        }
-
-        std::string body;
-        ok = _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_BODY, body, fd);
-        if (ok == false) {
-            goto return_cache_not_found_and_delete_cache;
-        }
+    // check cache is not expired
+    const uint32_t currentTime = static_cast<uint32_t>(vx::device::timestampApple());
+    result.isStillFresh = currentTime < (entry->creationTime + entry->maxAge);
 
-        req->setCachedResponse(true, static_cast<uint16_t>(statusCode), std::move(headers), body);
-    }
+    req->setCachedResponse(true, entry->statusCode, entry->headers, entry->body);
 
-    fclose(fd);
-    return result;
-
-return_cache_not_found_and_delete_cache:
-    fclose(fd);
-    vx::fs::removeStorageFileOrDirectory(filepath);
-    result.didFindCache = false;
-    result.isStillFresh = false;
     return result;
 }
 
 bool HttpClient::removeCachedResponseForRequest(HttpRequest_SharedPtr req) {
-    const std::lock_guard<std::mutex> lock(this->_cacheMutex);
-
     if (req == nullptr) {
         return false;
     }
@@ -613,12 +717,208 @@ bool HttpClient::removeCachedResponseForRequest(HttpRequest_SharedPtr req) {
 
     //vxlog_debug("❌ REMOVE HTTP CACHE: %s", filepath.c_str());
 
+    CacheShard& shard = _getCacheShard(urlHash);
+    const std::lock_guard<std::mutex> lock(shard.mutex);
+    _memoryCacheRemove(shard, urlHash);
+    _diskCacheDidRemove(urlHash);
     const bool ok = vx::fs::removeStorageFileOrDirectory(filepath);
     return ok;
 }
 
 #endif // !defined(__VX_PLATFORM_WASM)
 
+HttpClient::CacheShard& HttpClient::_getCacheShard(const std::string& urlHash) {
+    return _cacheShards[std::hash<std::string>()(urlHash) % VX_HTTP_CACHE_SHARDS];
+}
+
+HttpClient::CacheEntry_SharedPtr HttpClient::_memoryCacheGet(CacheShard& shard, const std::string& urlHash) {
+    auto it = shard.entries.find(urlHash);
+    if (it == shard.entries.end()) {
+        return nullptr;
+    }
+    // move to front, most recently used
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second.second);
+    return it->second.first;
+}
+
+void HttpClient::_memoryCacheSet(CacheShard& shard, const std::string& urlHash, const CacheEntry_SharedPtr& entry) {
+    _memoryCacheRemove(shard, urlHash);
+
+    if (entry == nullptr || entry->size > VX_HTTP_CACHE_MEMORY_MAX_ENTRY_BYTES) {
+        return;
+    }
+
+    shard.lru.push_front(urlHash);
+    shard.entries.emplace(urlHash, std::make_pair(entry, shard.lru.begin()));
+    shard.bytes += entry->size;
+
+    // evict least recently used entries
+    while (shard.bytes > VX_HTTP_CACHE_MEMORY_MAX_BYTES / VX_HTTP_CACHE_SHARDS && shard.lru.size() > 1) {
+        _memoryCacheRemove(shard, shard.lru.back());
+    }
+}
+
+void HttpClient::_memoryCacheRemove(CacheShard& shard, const std::string& urlHash) {
+    auto it = shard.entries.find(urlHash);
+    if (it == shard.entries.end()) {
+        return;
+    }
+    shard.bytes -= it->second.first->size;
+    shard.lru.erase(it->second.second);
+    shard.entries.erase(it);
+}
+
+void HttpClient::_diskCacheDidWrite(const std::string& urlHash,
+                                    const size_t size,
+                                    std::vector<std::string>& evicted) {
+    const std::lock_guard<std::mutex> lock(_diskCacheMutex);
+
+    auto it = _diskCacheFiles.find(urlHash);
+    if (it != _diskCacheFiles.end()) {
+        _diskCacheBytes -= it->second.first;
+        it->second.first = size;
+        _diskCacheLRU.splice(_diskCacheLRU.begin(), _diskCacheLRU, it->second.second);
+    } else {
+        _diskCacheLRU.push_front(urlHash);
+        _diskCacheFiles.emplace(urlHash, std::make_pair(size, _diskCacheLRU.begin()));
+    }
+    _diskCacheBytes += size;
+
+    // evict least recently used files
+    while (_diskCacheBytes > VX_HTTP_CACHE_DISK_MAX_BYTES && _diskCacheLRU.size() > 1) {
+        const std::string& hash = _diskCacheLRU.back();
+        auto e = _diskCacheFiles.find(hash);
+        _diskCacheBytes -= e->second.first;
+        evicted.push_back(hash);
+        _diskCacheFiles.erase(e);
+        _diskCacheLRU.pop_back();
+    }
+}
+
+void HttpClient::_diskCacheRemoveEvicted(const std::vector<std::string>& evicted) {
+    // NOTE: evicted responses can remain in memory cache for a while, that's fine
+    for (const std::string& hash : evicted) {
+        CacheShard& shard = _getCacheShard(hash);
+        const std::lock_guard<std::mutex> lock(shard.mutex);
+        {
+            // written again since eviction
+            const std::lock_guard<std::mutex> diskLock(_diskCacheMutex);
+            if (_diskCacheFiles.find(hash) != _diskCacheFiles.end()) {
+                continue;
+            }
+        }
+        vx::fs::removeStorageFileOrDirectory(std::string(VX_HTTP_CACHE_DIR_NAME) + "/" + hash);
+    }
+}
+
+void HttpClient::_diskCacheDidRead(const std::string& urlHash) {
+    const std::lock_guard<std::mutex> lock(_diskCacheMutex);
+    auto it = _diskCacheFiles.find(urlHash);
+    if (it != _diskCacheFiles.end()) {
+        _diskCacheLRU.splice(_diskCacheLRU.begin(), _diskCacheLRU, it->second.second);
+    }
+}
+
+void HttpClient::_diskCacheDidRemove(const std::string& urlHash) {
+    const std::lock_guard<std::mutex> lock(_diskCacheMutex);
+    auto it = _diskCacheFiles.find(urlHash);
+    if (it != _diskCacheFiles.end()) {
+        _diskCacheBytes -= it->second.first;
+        _diskCacheLRU.erase(it->second.second);
+        _diskCacheFiles.erase(it);
+    }
+}
+
+void HttpClient::_diskCacheIndexIfNeeded() {
+    std::call_once(_diskCacheIndexedOnce, [this]() {
+        // files written by previous sessions, no usage information, considered least recently used
+        // (scanned without holding any lock, file sizes are read once)
+        std::vector<std::pair<std::string, size_t>> found;
+        const std::vector<std::string> files = vx::fs::listStorageDirectory(VX_HTTP_CACHE_DIR_NAME);
+        for (const std::string& filepath : files) {
+            // compare file names only, separator depends on the platform
+            const size_t separator = filepath.find_last_of("/\\");
+            const std::string hash = separator == std::string::npos ? filepath : filepath.substr(separator + 1);
+            if (hash.size() != VX_HTTP_CACHE_HASH_LEN) {
+                continue;
+            }
+            FILE *fd = vx::fs::openStorageFile(std::string(VX_HTTP_CACHE_DIR_NAME) + "/" + hash);
+            if (fd == nullptr) {
+                continue;
+            }
+            found.push_back(std::make_pair(hash, vx::fs::getFileSize(fd)));
+            fclose(fd);
+        }
+
+        const std::lock_guard<std::mutex> lock(_diskCacheMutex);
+        for (const std::pair<std::string, size_t>& f : found) {
+            // index is more recent for files written or removed in the meantime
+            if (_diskCacheFiles.find(f.first) != _diskCacheFiles.end()) {
+                continue;
+            }
+            _diskCacheLRU.push_back(f.first);
+            _diskCacheFiles.emplace(f.first, std::make_pair(f.second, std::prev(_diskCacheLRU.end())));
+            _diskCacheBytes += f.second;
+        }
+    });
+}
+
+HttpClient::CacheEntry_SharedPtr HttpClient::_cacheReadFile(FILE * const fd) {
+    if (fd == nullptr) {
+        return nullptr;
+    }
+
+    // skip header
+    if (fseek(fd, VX_HTTP_CACHE_MAGICBYTES_LEN, SEEK_SET) != 0) {
+        return nullptr;
+    }
+
+    // file format version & file compression method
+    uint8_t fileFormatVersion = 0;
+    uint8_t fileCompressionMethod = 0;
+    if (_cacheReadFileHeader(&fileFormatVersion, &fileCompressionMethod, fd) == false) {
+        return nullptr;
+    }
+
+    // ignore old cache
+    if (fileFormatVersion < VX_HTTP_CACHE_FILE_FORMAT_V2) {
+        return nullptr;
+    }
+
+    if (fileCompressionMethod != VX_HTTP_CACHE_COMPRESSION_NONE &&
+        fileCompressionMethod != VX_HTTP_CACHE_COMPRESSION_ZLIB) {
+        return nullptr;
+    }
+
+    std::shared_ptr<CacheEntry> entry = std::make_shared<CacheEntry>();
+    uint32_t statusCode = 0;
+
+    if (_cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_ETAG, entry->etag, fd) == false ||
+        _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_CREATIONTIME, entry->creationTime, fd) == false ||
+        _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_MAXAGE, entry->maxAge, fd) == false ||
+        _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_URL, entry->url, fd) == false ||
+        _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_STATUSCODE, statusCode, fd) == false ||
+        _cacheReadMapStringStringChunk(VX_HTTP_CACHE_CHUNK_HEADERS, entry->headers, fd) == false) {
+        return nullptr;
+    }
+
+    if (fileCompressionMethod == VX_HTTP_CACHE_COMPRESSION_ZLIB) {
+        if (_cacheReadCompressedStringChunk(VX_HTTP_CACHE_CHUNK_BODY_ZLIB, entry->body, fd) == false) {
+            return nullptr;
+        }
+    } else if (_cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_BODY, entry->body, fd) == false) {
+        return nullptr;
+    }
+    entry->statusCode = static_cast<uint16_t>(statusCode);
+
+    entry->size = sizeof(CacheEntry) + entry->url.size() + entry->etag.size() + entry->body.size();
+    for (const auto& kv : entry->headers) {
+        entry->size += kv.first.size() + kv.second.size();
+    }
+
+    return entry;
+}
+
 bool HttpClient::_cacheWriteFileHeader(const uint8_t fileFormatVersion,
                                        const uint8_t compressionMethod,
                                        FILE * const fd) {
@@ -675,7 +975,7 @@ bool HttpClient::_cacheWriteUint32Chunk(const uint8_t chunkID,
 }
 
 bool HttpClient::_cacheWriteStringChunk(const uint8_t chunkID,
-                                        const std::string chunkValue,
+                                        const std::string& chunkValue,
                                         FILE * const fd) {
     if (fd == nullptr) {
         return false;
@@ -706,6 +1006,38 @@ bool HttpClient::_cacheWriteStringChunk(const uint8_t chunkID,
     return true;
 }
 
+bool HttpClient::_cacheWriteCompressedStringChunk(const uint8_t chunkID,
+                                                  const std::string& compressedValue,
+                                                  const uint32_t uncompressedSize,
+                                                  FILE * const fd) {
+    if (fd == nullptr) {
+        return false;
+    }
+
+    // chunk ID
+    if (fwrite(&chunkID, sizeof(uint8_t), 1, fd) != 1) {
+        return false;
+    }
+
+    // uncompressed size
+    if (fwrite(&uncompressedSize, sizeof(uint32_t), 1, fd) != 1) {
+        return false;
+    }
+
+    // compressed value length
+    const uint32_t valueLen = static_cast<uint32_t>(compressedValue.length());
+    if (fwrite(&valueLen, sizeof(uint32_t), 1, fd) != 1) {
+        return false;
+    }
+
+    // compressed value
+    if (fwrite(compressedValue.c_str(), sizeof(char), compressedValue.length(), fd) != compressedValue.length()) {
+        return false;
+    }
+
+    return true;
+}
+
 bool HttpClient::_cacheWriteMapStringStringChunk(const uint8_t chunkID,
                                                  const std::unordered_map<std::string, std::string>& chunkValue,
                                                  FILE * const fd) {
@@ -843,15 +1175,103 @@ bool HttpClient::_cacheReadStringChunk(const uint8_t chunkID, std::string& chunk
     }
 
     // chunk value
+    ok = _readString(chunkValue, fd);
+    if (ok == false) {
+        return false;
+    }
+
+    return true;
+}
+
+bool HttpClient::_cacheReadCompressedStringChunk(const uint8_t chunkID, std::string& chunkValue, FILE * const fd) {
+    if (fd == nullptr) {
+        return false;
+    }
+
+    // chunk ID
     {
-        std::string value;
-        ok = _readString(value, fd);
-        if (ok == false) {
+        uint8_t chunkIDRead = 0;
+        if (fread(&chunkIDRead, sizeof(uint8_t), 1, fd) != 1 || chunkIDRead != chunkID) {
             return false;
         }
-        chunkValue.assign(value);
     }
 
+    uint32_t uncompressedSize = 0;
+    uint32_t compressedSize = 0;
+    if (fread(&uncompressedSize, sizeof(uint32_t), 1, fd) != 1 ||
+        fread(&compressedSize, sizeof(uint32_t), 1, fd) != 1) {
+        return false;
+    }
+    // deflate can't do better than ~1032:1, protects against allocating for corrupted sizes
+    if (static_cast<uint64_t>(uncompressedSize) > static_cast<uint64_t>(compressedSize) * 1032) {
+        return false;
+    }
+
+    z_stream stream = {};
+    if (inflateInit(&stream) != Z_OK) {
+        return false;
+    }
+
+    // inflating blocks as they're read, the whole compressed value is never in memory
+    chunkValue.resize(uncompressedSize);
+    stream.next_out = reinterpret_cast<Bytef*>(&chunkValue[0]);
+    stream.avail_out = uncompressedSize;
+
+    char block[VX_HTTP_CACHE_INFLATE_BLOCK_SIZE];
+    uint32_t remaining = compressedSize;
+    int status = Z_OK;
+    while (remaining > 0 && status == Z_OK) {
+        const size_t toRead = remaining < sizeof(block) ? remaining : sizeof(block);
+        if (fread(block, sizeof(char), toRead, fd) != toRead) {
+            break;
+        }
+        remaining -= static_cast<uint32_t>(toRead);
+        stream.next_in = reinterpret_cast<Bytef*>(block);
+        stream.avail_in = static_cast<uInt>(toRead);
+        status = inflate(&stream, Z_NO_FLUSH);
+    }
+    const bool ok = status == Z_STREAM_END && remaining == 0 && stream.total_out == uncompressedSize;
+    inflateEnd(&stream);
+
+    if (ok == false) {
+        chunkValue.clear();
+    }
+    return ok;
+}
+
+bool HttpClient::_cacheCompress(const std::string& value, std::string& compressed) {
+    if (value.size() < VX_HTTP_CACHE_COMPRESSION_MIN_SIZE || value.size() > UINT32_MAX) {
+        return false;
+    }
+
+    uLongf len = 0;
+
+    if (value.size() > VX_HTTP_CACHE_COMPRESSION_PROBE_SIZE * 4) {
+        len = compressBound(VX_HTTP_CACHE_COMPRESSION_PROBE_SIZE);
+        compressed.resize(len);
+        if (compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+                      &len,
+                      reinterpret_cast<const Bytef*>(value.data()),
+                      VX_HTTP_CACHE_COMPRESSION_PROBE_SIZE,
+                      VX_HTTP_CACHE_COMPRESSION_LEVEL) != Z_OK ||
+            len > VX_HTTP_CACHE_COMPRESSION_PROBE_SIZE - VX_HTTP_CACHE_COMPRESSION_PROBE_SIZE / 8) {
+            compressed.clear();
+            return false;
+        }
+    }
+
+    len = compressBound(static_cast<uLong>(value.size()));
+    compressed.resize(len);
+    if (compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+                  &len,
+                  reinterpret_cast<const Bytef*>(value.data()),
+                  static_cast<uLong>(value.size()),
+                  VX_HTTP_CACHE_COMPRESSION_LEVEL) != Z_OK ||
+        len > value.size() - value.size() / 8) {
+        compressed.clear();
+        return false;
+    }
+    compressed.resize(len);
     return true;
 }
 
@@ -914,17 +1334,16 @@ bool HttpClient::_readString(std::string& out, FILE * const fd) {
         return false;
     }
 
-    char *strBuf = static_cast<char *>(malloc(sizeof(char) * strLen));
-    if (strBuf == nullptr) {
-        return false;
+    // reading directly in the string's buffer
+    out.resize(strLen);
+    if (strLen == 0) {
+        return true;
     }
-    n = fread(strBuf, sizeof(char), strLen, fd);
+    n = fread(&out[0], sizeof(char), strLen, fd);
     if (n != strLen) {
-        free(strBuf);
+        out.clear();
         return false;
     }
-    out.assign(strBuf, strLen);
-    free(strBuf);
     return true;
 }
 
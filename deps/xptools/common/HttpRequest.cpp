@@ -9,7 +9,9 @@
 #include "HttpRequest.hpp"
 
 // C++
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 // xptools
 #include "vxlog.h"
@@ -40,6 +42,16 @@ HttpRequest_SharedPtr HttpRequest::make(const std::string& method,
 }
 
 HttpRequest::~HttpRequest() {
+    if (_coalescingKey.empty() == false) {
+        // released while in flight, without response: send waiting requests again
+        std::vector<HttpRequest_SharedPtr> waiting = HttpClient::shared().removeInFlightGET(_coalescingKey, _weakSelf);
+        for (const HttpRequest_SharedPtr& r : waiting) {
+            if (r->getStatus() == Status::PROCESSING) {
+                r->setStatus(Status::WAITING);
+                r->sendAsync();
+            }
+        }
+    }
     _detachPlatformObject();
 }
 
@@ -94,18 +106,27 @@ bool HttpRequest::callCallback() {
 
 #if !defined(__VX_PLATFORM_WASM)
         // if ETag was valid, we use the cached response
-        if (strongSelf->getResponse().getStatusCode() == HTTP_NOT_MODIFIED) {
+        const bool notModified = strongSelf->getResponse().getStatusCode() == HTTP_NOT_MODIFIED;
+        if (notModified) {
             strongSelf->_useCachedResponse();
         }
 
         // Store response in cache (if conditions are met)
         // optim possible: if it was a 304, we don't need to update the response bytes in the cache
-        const bool ok = vx::HttpClient::shared().cacheHttpResponse(strongSelf);
-        if (ok) {
-            // vxlog_debug("HTTP response cached : %s", strongSelf->constructURLString().c_str());
+        // (already done by the request that received it, for coalesced requests)
+        // Fresh responses served from cache are not written again, they don't carry
+        // response headers and would be stored without their max-age.
+        const bool servedFromCache = strongSelf->getResponse().getUseLocalCache() && notModified == false;
+        if (strongSelf->_coalesced == false && servedFromCache == false) {
+            const bool ok = vx::HttpClient::shared().cacheHttpResponse(strongSelf);
+            if (ok) {
+                // vxlog_debug("HTTP response cached : %s", strongSelf->constructURLString().c_str());
+            }
         }
 #endif
 
+        strongSelf->_callCoalescedCallbacks();
+
         if (strongSelf->_callback != nullptr) {
             strongSelf->_callback(strongSelf);
         }
@@ -191,6 +212,14 @@ void HttpRequest::sendAsync() {
     // update status
     strongSelf->setStatus(HttpRequest::Status::PROCESSING);
 
+    // wait for the response of an identical request if one is in flight
+    if (this->getMethod() == VX_HTTPMETHOD_GET && this->_opts.getStreamResponse() == false) {
+        strongSelf->_coalescingKey = strongSelf->_makeCoalescingKey();
+        if (HttpClient::shared().attachToInFlightGET(strongSelf->_coalescingKey, strongSelf)) {
+            return;
+        }
+    }
+
     strongSelf->_sendAsync();
 }
 
@@ -264,8 +293,22 @@ void HttpRequest::cancel() {
                 return;
         }
 
+        HttpRequest_SharedPtr nextInFlight = nullptr;
+        if (strongSelf->_coalescingKey.empty() == false) {
+            if (HttpClient::shared().cancelInFlightGET(strongSelf->_coalescingKey, strongSelf, nextInFlight)) {
+                // was waiting for an identical request, not sent
+                return;
+            }
+            strongSelf->_coalescingKey.clear();
+        }
+
         strongSelf->_cancel();
 
+        // identical requests were waiting for this one, the first of them is sent instead
+        if (nextInFlight != nullptr) {
+            nextInFlight->_sendAsync();
+        }
+
 #if defined(__VX_PLATFORM_WASM)
     });
 #endif
@@ -403,6 +446,8 @@ _weakSelf(),
 #if defined(__VX_PLATFORM_WASM)
 _fetch(nullptr),
 #endif
+_coalescingKey(),
+_coalesced(false),
 _method(),
 _host(),
 _port(0),
@@ -439,6 +484,54 @@ void HttpRequest::_init(const HttpRequest_SharedPtr& ref,
     this->_secure = secure;
 }
 
+std::string HttpRequest::_makeCoalescingKey() {
+    std::vector<std::pair<std::string, std::string>> headers(_headers.begin(), _headers.end());
+    std::sort(headers.begin(), headers.end());
+
+    std::string key = constructURLString();
+    for (const auto& header : headers) {
+        key += "\n" + header.first + ":" + header.second;
+    }
+    return key;
+}
+
+void HttpRequest::_callCoalescedCallbacks() {
+    if (_coalescingKey.empty()) {
+        return;
+    }
+    const std::vector<HttpRequest_SharedPtr> waiting = HttpClient::shared().removeInFlightGET(_coalescingKey, _weakSelf);
+    _coalescingKey.clear();
+    if (waiting.empty()) {
+        return;
+    }
+
+    std::string bytes;
+    if (_response.getDownloadComplete()) {
+        _response.readAllBytes(bytes);
+    }
+    const Status status = getStatus();
+
+    for (const HttpRequest_SharedPtr& r : waiting) {
+        if (r->getStatus() != Status::PROCESSING) {
+            continue; // cancelled
+        }
+        r->_coalesced = true;
+        r->_coalescingKey.clear();
+        r->_response.setSuccess(_response.getSuccess());
+        r->_response.setStatusCode(_response.getStatusCode());
+        r->_response.setHeaders(_response.getHeaders());
+        r->_response.appendBytes(bytes);
+        r->_response.setUseLocalCache(_response.getUseLocalCache());
+        r->_response.setDownloadComplete(_response.getDownloadComplete());
+        if (status == Status::CANCELLED) {
+            r->setStatus(_response.getSuccess() ? Status::DONE : Status::FAILED);
+        } else {
+            r->setStatus(status);
+        }
+        r->callCallback();
+    }
+}
+
 #if !defined(__VX_PLATFORM_WASM)
 
 void HttpRequest::_useCachedResponse() {
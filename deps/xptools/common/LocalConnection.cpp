@@ -9,6 +9,7 @@
 
 // C++
 #include <cassert>
+#include <vector>
 
 // xptools
 #include "vxlog.h"
@@ -20,7 +21,10 @@ _status(Connection::Status::IDLE),
 _statusMutex(),
 _thread(),
 _threadShouldExit(false),
-_threadShouldExitMutex(),
+_threadShouldWake(false),
+_threadMutex(),
+_threadCondition(),
+_receivedBytes(),
 _peerConnection() {
     _thread = std::thread(&LocalConnection::_threadFunction, this);
 }
@@ -39,6 +43,11 @@ void LocalConnection::pushReceivedBytes(const Payload_SharedPtr& payload) {
         return;
     }
     _receivedBytes.push(payload);
+    {
+        std::lock_guard<std::mutex> lock(_threadMutex);
+        _threadShouldWake = true;
+    }
+    _threadCondition.notify_one();
 }
 
 Connection::Status LocalConnection::getStatus() {
@@ -136,33 +145,42 @@ void LocalConnection::closeOnError() {
 }
     
 void LocalConnection::_threadFunction() {
-    Payload_SharedPtr payload = nullptr;
+    std::vector<Payload_SharedPtr> payloads;
     while (true) {
         {
-            std::lock_guard<std::mutex> lock(_threadShouldExitMutex);
+            std::unique_lock<std::mutex> lock(_threadMutex);
+            _threadCondition.wait(lock, [this]{ return _threadShouldWake || _threadShouldExit; });
             if (this->_threadShouldExit == true) {
                 return;
             }
+            _threadShouldWake = false;
+        }
+
+        // drain everything pushed so far, a push in progress wakes the thread again
+        _receivedBytes.popAll(payloads);
+        if (payloads.empty()) {
+            continue;
         }
-        if (_receivedBytes.pop(payload)) {
-            std::shared_ptr<ConnectionDelegate> delegate = getDelegate().lock();
-            if (delegate != nullptr) {
+
+        std::shared_ptr<ConnectionDelegate> delegate = getDelegate().lock();
+        if (delegate != nullptr) {
+            for (const Payload_SharedPtr& payload : payloads) {
                 delegate->connectionDidReceive(*this, payload);
-                payload = nullptr;
-            } else {
-                vxlog_warning("[LocalConnection::_threadFunction] bytes are dropped");
             }
+        } else {
+            vxlog_warning("[LocalConnection::_threadFunction] bytes are dropped");
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        payloads.clear();
     }
 }
 
 void LocalConnection::_stopThread() {
     if (_thread.joinable()) {
         {
-            std::lock_guard<std::mutex> lock(_threadShouldExitMutex);
+            std::lock_guard<std::mutex> lock(_threadMutex);
             this->_threadShouldExit = true;
         }
+        _threadCondition.notify_one();
         _thread.join();
         vxlog_debug("[LocalConnection::_stopThread] %p", this);
     }
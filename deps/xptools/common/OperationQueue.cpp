@@ -7,6 +7,8 @@
 
 #include "OperationQueue.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <queue>
 
 #ifdef __VX_SINGLE_THREAD
@@ -20,11 +22,20 @@
 #define UNLOCK lock.unlock();
 #endif
 
-#define MAX_OPERATIONS_PER_CYCLE 10
-#define SLEEP_TIME_BETWEEN_CYCLES 16 // in ms
+// default number of workers for the background queue is the number of cores minus one
+// (leaving one for the main thread), within those bounds
+#define BACKGROUND_MIN_THREADS 2
+#define BACKGROUND_MAX_THREADS 8
+#define SLOW_BACKGROUND_THREADS 2
 
 using namespace vx;
 
+#ifndef __VX_SINGLE_THREAD
+// queue & worker index of the current thread, if it's a worker
+static thread_local OperationQueue *currentQueue = nullptr;
+static thread_local size_t currentWorkerIdx = 0;
+#endif
+
 OperationQueue *OperationQueue::getMain() {
     if (_mainQueue == nullptr) {
         _mainQueue = new OperationQueue(Type::sync);
@@ -44,7 +55,14 @@ OperationQueue *OperationQueue::getBackground() {
     return _mainQueue;
 #else
     if (_backgroundQueue == nullptr) {
-        _backgroundQueue = new OperationQueue(Type::async);
+        unsigned int n = _backgroundThreadCount;
+        if (n == 0) {
+            const unsigned int cores = std::thread::hardware_concurrency();
+            n = cores > 1 ? cores - 1 : 1;
+            n = std::min(std::max(n, static_cast<unsigned int>(BACKGROUND_MIN_THREADS)),
+                         static_cast<unsigned int>(BACKGROUND_MAX_THREADS));
+        }
+        _backgroundQueue = new OperationQueue(Type::async, n);
     }
     return _backgroundQueue;
 #endif
@@ -55,106 +73,168 @@ OperationQueue *OperationQueue::getSlowBackground() {
     return _mainQueue;
 #else
     if (_slowBackgroundQueue == nullptr) {
-        _slowBackgroundQueue = new OperationQueue(Type::async);
+        const unsigned int n = _slowBackgroundThreadCount > 0 ? _slowBackgroundThreadCount
+                                                              : SLOW_BACKGROUND_THREADS;
+        _slowBackgroundQueue = new OperationQueue(Type::async, n);
     }
     return _slowBackgroundQueue;
 #endif
 }
 
-OperationQueue::OperationQueue(Type type) :
+OperationQueue *OperationQueue::getSerialBackground() {
+#ifdef __VX_SINGLE_THREAD
+    return _mainQueue;
+#else
+    if (_serialBackgroundQueue == nullptr) {
+        _serialBackgroundQueue = new OperationQueue(Type::async, 1);
+    }
+    return _serialBackgroundQueue;
+#endif
+}
+
+void OperationQueue::setBackgroundThreadCount(unsigned int n) {
+    _backgroundThreadCount = n;
+}
+
+void OperationQueue::setSlowBackgroundThreadCount(unsigned int n) {
+    _slowBackgroundThreadCount = n;
+}
+
+OperationQueue::OperationQueue(Type type, unsigned int nbWorkers) :
 _queue(),
-_queueScheduled() {
+_queueScheduled(),
+_scheduledIndexes() {
     _type = type;
+    _nextTimer = 1;
     _state = State::idle;
 #ifndef __VX_SINGLE_THREAD
-    // create a thread object that doesn't represent an execution thread
-    _thread = std::thread();
+    _nbPending = 0;
+    _nbSleeping = 0;
+    _nextScheduledTime = std::numeric_limits<std::chrono::steady_clock::rep>::max();
+    _stopping = false;
+    if (_type == Type::async) {
+        // worker threads are started with first dispatched operation
+        for (unsigned int i = 0; i < std::max(nbWorkers, 1u); ++i) {
+            _workers.push_back(std::unique_ptr<Worker>(new Worker()));
+        }
+    }
 #endif
 }
 
 OperationQueue::~OperationQueue() {
-    
+#ifndef __VX_SINGLE_THREAD
+    {
+        LOCK_GUARD
+        _stopping = true;
+    }
+    _cv.notify_all();
+    for (std::unique_ptr<Worker>& worker : _workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+#endif
 }
 
 /// dispatch and copy
 void OperationQueue::dispatch(const fp_t& op) {
-    {
-        LOCK_GUARD
-        _queue.push_back(op);
-    }
-    this->startThreadIfNeeded();
+    this->dispatch(fp_t(op));
 }
 
 /// dispatch and move
 void OperationQueue::dispatch(fp_t&& op) {
+#ifndef __VX_SINGLE_THREAD
+    if (this->dispatchFromWorker(std::move(op), false)) {
+        return;
+    }
+#endif
     {
         LOCK_GUARD
         _queue.push_back(std::move(op));
+#ifndef __VX_SINGLE_THREAD
+        ++_nbPending;
+#endif
     }
     this->startThreadIfNeeded();
 }
 
 /// dispatch (in front of queue) and copy
 void OperationQueue::dispatchFirst(const fp_t& op) {
-    {
-        LOCK_GUARD
-        _queue.push_front(op);
-    }
-    this->startThreadIfNeeded();
+    this->dispatchFirst(fp_t(op));
 }
 
 /// dispatch (in front of queue) and move
 void OperationQueue::dispatchFirst(fp_t&& op) {
+#ifndef __VX_SINGLE_THREAD
+    if (this->dispatchFromWorker(std::move(op), true)) {
+        return;
+    }
+#endif
     {
         LOCK_GUARD
         _queue.push_front(std::move(op));
+#ifndef __VX_SINGLE_THREAD
+        ++_nbPending;
+#endif
     }
     this->startThreadIfNeeded();
 }
 
-void OperationQueue::schedule(const fp_t& op, int64_t ms) {
+OperationQueue::TimerID OperationQueue::schedule(const fp_t& op, int64_t ms) {
+    return this->schedule(fp_t(op), ms);
+}
+
+OperationQueue::TimerID OperationQueue::schedule(fp_t&& op, int64_t ms) {
     if (ms < 0) {
         // cannot schedule in the past
-        return;
+        return 0;
     }
+    TimerID timer;
     {
         LOCK_GUARD
-        std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-        std::chrono::system_clock::time_point scheduled_tp = now + std::chrono::milliseconds(ms);
-        _queueScheduled[scheduled_tp] = op;
+        timer = _nextTimer++;
+        const size_t i = _queueScheduled.size();
+        _queueScheduled.push_back({
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(ms),
+            timer,
+            std::move(op)
+        });
+        _scheduledIndexes[timer] = i;
+        this->scheduledSiftUp(i);
+        this->scheduledUpdateNext();
     }
+    // wakes up a worker so it can wait for the new deadline if it's the earliest
     this->startThreadIfNeeded();
+    return timer;
 }
 
-void OperationQueue::schedule(const fp_t&& op, int64_t ms) {
-    if (ms < 0) {
-        // cannot schedule in the past
-        return;
-    }
+bool OperationQueue::cancel(TimerID timer) {
+    fp_t op;
     {
         LOCK_GUARD
-        std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-        std::chrono::system_clock::time_point scheduled_tp = now + std::chrono::milliseconds(ms);
-        _queueScheduled[scheduled_tp] = std::move(op);
+        std::unordered_map<TimerID, size_t>::iterator it = _scheduledIndexes.find(timer);
+        if (it == _scheduledIndexes.end()) {
+            return false;
+        }
+        op = this->scheduledRemove(it->second);
     }
-    this->startThreadIfNeeded();
+    // op (and what it captured) is released outside of the lock
+    return true;
 }
 
 void OperationQueue::callFirstDispatchedBlocks(size_t n) {
     bool skipScheduled = false;
+    fp_t op;
     while (n > 0) {
         LOCK
 
-        if (skipScheduled == false && _queueScheduled.empty() == false) {
-            std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-            std::pair<std::chrono::system_clock::time_point,fp_t> entry = *(_queueScheduled.begin());
-            if (entry.first <= now) {
-                fp_t op = entry.second;
-                _queueScheduled.erase(_queueScheduled.begin());
+        if (skipScheduled == false) {
+            if (this->popDueScheduled(op)) {
                 // unlock before calling op()
                 // because op() could need to add something in the queue
                 UNLOCK
                 op();
+                op = nullptr;
                 
                 --n;
                 continue;
@@ -167,12 +247,13 @@ void OperationQueue::callFirstDispatchedBlocks(size_t n) {
             UNLOCK
             break;
         } else {
-            fp_t op = std::move(_queue.front());
+            op = std::move(_queue.front());
             _queue.pop_front();
             // unlock before calling op()
             // because op() could need to add something in the queue
             UNLOCK
             op();
+            op = nullptr;
         }
         
         --n;
@@ -193,74 +274,237 @@ OperationQueue *OperationQueue::_backgroundQueue = nullptr;
 ///
 OperationQueue *OperationQueue::_slowBackgroundQueue = nullptr;
 
+///
+OperationQueue *OperationQueue::_serialBackgroundQueue = nullptr;
+
+///
+unsigned int OperationQueue::_backgroundThreadCount = 0;
+
+///
+unsigned int OperationQueue::_slowBackgroundThreadCount = 0;
+
 ///
 void OperationQueue::startThreadIfNeeded() {
 #ifdef __VX_SINGLE_THREAD
     return;
 #else
     if (_type != Type::async) {
-        return; // only async operation queues can have a thread
+        return; // only async operation queues can have threads
     }
-    LOCK_GUARD
-    if (_state != State::runningInBackground) {
-        _state = State::runningInBackground;
-        if (_thread.joinable()) {
-            _thread.join();
+    {
+        LOCK_GUARD
+        if (_state != State::runningInBackground) {
+            _state = State::runningInBackground;
+            for (size_t i = 0; i < _workers.size(); ++i) {
+                _workers[i]->thread = std::thread(&OperationQueue::threadFunction, this, i);
+            }
+            return;
+        } // else threads are already running
+    }
+    this->notifyWorker();
+#endif
+}
+
+bool OperationQueue::scheduledBefore(size_t a, size_t b) const {
+    const ScheduledOperation& opA = _queueScheduled[a];
+    const ScheduledOperation& opB = _queueScheduled[b];
+    // timer IDs are increasing, so same time operations keep scheduling order
+    return opA.time < opB.time || (opA.time == opB.time && opA.timer < opB.timer);
+}
+
+void OperationQueue::scheduledSwap(size_t a, size_t b) {
+    std::swap(_queueScheduled[a], _queueScheduled[b]);
+    _scheduledIndexes[_queueScheduled[a].timer] = a;
+    _scheduledIndexes[_queueScheduled[b].timer] = b;
+}
+
+void OperationQueue::scheduledSiftUp(size_t i) {
+    while (i > 0) {
+        const size_t parent = (i - 1) / 2;
+        if (this->scheduledBefore(i, parent) == false) {
+            break;
+        }
+        this->scheduledSwap(i, parent);
+        i = parent;
+    }
+}
+
+void OperationQueue::scheduledSiftDown(size_t i) {
+    const size_t size = _queueScheduled.size();
+    while (true) {
+        const size_t left = 2 * i + 1;
+        if (left >= size) {
+            break;
+        }
+        const size_t right = left + 1;
+        const size_t child = right < size && this->scheduledBefore(right, left) ? right : left;
+        if (this->scheduledBefore(child, i) == false) {
+            break;
         }
-        _thread = std::thread(&OperationQueue::threadFunction, this);
-    } // else thread is already running
+        this->scheduledSwap(i, child);
+        i = child;
+    }
+}
+
+OperationQueue::fp_t OperationQueue::scheduledRemove(size_t i) {
+    const size_t last = _queueScheduled.size() - 1;
+    if (i != last) {
+        this->scheduledSwap(i, last);
+    }
+    fp_t op = std::move(_queueScheduled.back().op);
+    _scheduledIndexes.erase(_queueScheduled.back().timer);
+    _queueScheduled.pop_back();
+    if (i < _queueScheduled.size()) {
+        // element moved from the back may need to go either way
+        this->scheduledSiftUp(i);
+        this->scheduledSiftDown(i);
+    }
+    this->scheduledUpdateNext();
+    return op;
+}
+
+bool OperationQueue::popDueScheduled(fp_t& op) {
+    if (_queueScheduled.empty() ||
+        _queueScheduled.front().time > std::chrono::steady_clock::now()) {
+        return false;
+    }
+    op = this->scheduledRemove(0);
+    return true;
+}
+
+void OperationQueue::scheduledUpdateNext() {
+#ifndef __VX_SINGLE_THREAD
+    _nextScheduledTime = _queueScheduled.empty() ?
+                         std::numeric_limits<std::chrono::steady_clock::rep>::max() :
+                         _queueScheduled.front().time.time_since_epoch().count();
 #endif
 }
 
 #ifndef __VX_SINGLE_THREAD
-void OperationQueue::threadFunction() {
+bool OperationQueue::dispatchFromWorker(fp_t&& op, bool first) {
+    // a single worker goes through the shared queue only, to run operations in dispatch order
+    if (currentQueue != this || _workers.size() == 1) {
+        return false;
+    }
+    Worker *worker = _workers[currentWorkerIdx].get();
+    {
+        const std::lock_guard<std::mutex> locker(worker->lock);
+        if (first) {
+            worker->queue.push_front(std::move(op));
+        } else {
+            worker->queue.push_back(std::move(op));
+        }
+    }
+    ++_nbPending;
+    this->notifyWorker();
+    return true;
+}
+
+void OperationQueue::notifyWorker() {
+    // _nbPending is always increased before checking for sleeping workers, and workers check
+    // _nbPending after declaring themselves as sleeping, so no wake up can be missed
+    if (_nbSleeping > 0) {
+        {
+            LOCK_GUARD
+        }
+        _cv.notify_one();
+    }
+}
+
+bool OperationQueue::popOperation(size_t workerIdx, fp_t& op) {
+    // own queue first
+    Worker *worker = _workers[workerIdx].get();
+    {
+        const std::lock_guard<std::mutex> locker(worker->lock);
+        if (worker->queue.empty() == false) {
+            op = std::move(worker->queue.front());
+            worker->queue.pop_front();
+            --_nbPending;
+            return true;
+        }
+    }
+
+    // then shared queue
+    {
+        LOCK_GUARD
+        if (_queue.empty() == false) {
+            op = std::move(_queue.front());
+            _queue.pop_front();
+            --_nbPending;
+            return true;
+        }
+    }
+
+    // then steal from other workers, from the back of their queue
+    const size_t nbWorkers = _workers.size();
+    for (size_t i = 1; i < nbWorkers; ++i) {
+        worker = _workers[(workerIdx + i) % nbWorkers].get();
+        const std::lock_guard<std::mutex> locker(worker->lock);
+        if (worker->queue.empty() == false) {
+            op = std::move(worker->queue.back());
+            worker->queue.pop_back();
+            --_nbPending;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void OperationQueue::threadFunction(size_t workerIdx) {
+    currentQueue = this;
+    currentWorkerIdx = workerIdx;
+
     std::unique_lock<std::mutex> locker(_lock, std::defer_lock);
-    std::chrono::system_clock::time_point now;
-    std::queue<fp_t> operations;
-    std::map<std::chrono::system_clock::time_point,fp_t>::iterator itScheduled;
-    std::pair<std::chrono::system_clock::time_point,fp_t> opScheduled;
     fp_t op;
-    int n;
 
     while (true) {
-        n = 0;
+        // due scheduled operations first, so that a busy queue doesn't delay them
+        if (_nextScheduledTime <= std::chrono::steady_clock::now().time_since_epoch().count()) {
+            locker.lock();
+            const bool due = this->popDueScheduled(op);
+            locker.unlock();
+            if (due) {
+                op();
+                op = nullptr;
+                continue;
+            }
+        }
+
+        if (this->popOperation(workerIdx, op)) {
+            op();
+            op = nullptr;
+            continue;
+        }
+
         locker.lock();
 
-        if (_queue.empty() && _queueScheduled.empty()) {
-            _state = State::idle;
+        if (_stopping) {
             locker.unlock();
             break;
         }
 
-        if (_queueScheduled.empty() == false) {
-            // TODO: _queueScheduled -> std::list<std::pair<uint64_t,fp_t>>
-            now = std::chrono::system_clock::now();
-            itScheduled = _queueScheduled.begin();
-
-            opScheduled = *(itScheduled);
+        if (this->popDueScheduled(op)) {
+            locker.unlock();
+            op();
+            op = nullptr;
+            continue;
+        }
 
-            if (opScheduled.first <= now) {
-                operations.push(opScheduled.second);
-                ++n;
-                _queueScheduled.erase(itScheduled);
+        // sleep until an operation is dispatched or the next scheduled one is due
+        ++_nbSleeping;
+        if (_nbPending == 0) {
+            if (_queueScheduled.empty()) {
+                _cv.wait(locker);
+            } else {
+                _cv.wait_until(locker, _queueScheduled.front().time);
             }
         }
-        
-        while (_queue.empty() == false && n < MAX_OPERATIONS_PER_CYCLE) {
-            operations.push(_queue.front());
-            ++n;
-            _queue.pop_front();
-        }
+        --_nbSleeping;
 
         locker.unlock();
-
-        while (operations.empty() == false) {
-            op = operations.front();
-            operations.pop();
-            op();
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_TIME_BETWEEN_CYCLES));
     }
+
+    currentQueue = nullptr;
 }
 #endif
@@ -52,7 +52,8 @@ _wsi(nullptr),
 #if defined(__VX_USE_LIBWEBSOCKETS) || defined(__VX_PLATFORM_WASM)
 _wsiMutex(),
 #endif
-_receivedBytesBuffer(),
+_receivedBytesBuffer(nullptr),
+_receivedBytesDropped(false),
 _isWriting(false),
 _isWritingMutex(),
 _payloadsToWrite(),
@@ -64,6 +65,10 @@ _platformObject(nullptr) {
 
 WSConnection::~WSConnection() {
     _destroy();
+    if (_receivedBytesBuffer != nullptr) {
+        _receivedBytesBuffer->release();
+        _receivedBytesBuffer = nullptr;
+    }
 }
 
 Connection::Status WSConnection::getStatus() {
@@ -158,7 +163,11 @@ void WSConnection::reset() {
     _payloadBeingWritten = nullptr;
     _written = 0;
 
-    _receivedBytesBuffer.clear();
+    if (_receivedBytesBuffer != nullptr) {
+        _receivedBytesBuffer->release();
+        _receivedBytesBuffer = nullptr;
+    }
+    _receivedBytesDropped = false;
 
 #if defined(__VX_USE_LIBWEBSOCKETS)
     setWsi(nullptr);
@@ -362,6 +371,7 @@ Connection::Payload_SharedPtr WSConnection::_getPayloadToWrite() {
         // _payloadBeingWritten remains NULL if nothing was popped
 
         if (_payloadBeingWritten != nullptr) {
+            _payloadBeingWritten = _compressIfNeeded(_payloadBeingWritten);
             _written = 0;
             _payloadBeingWritten->step("start writing out (client)");
         }
@@ -373,29 +383,32 @@ Connection::Payload_SharedPtr WSConnection::_getPayloadToWrite() {
 void WSConnection::receivedBytes(char *bytes,
                                  const size_t len,
                                  const bool isFinalFragment) {
-    // append received bytes
-    if (len > 0) {
-        _receivedBytesBuffer.append(bytes, len);
+    // append received bytes, directly in the buffer the Payload will adopt
+    if (_receivedBytesBuffer == nullptr) {
+        _receivedBytesBuffer = Connection::ReceiveBuffer::get();
+    }
+    if (len > 0 && _receivedBytesBuffer->append(bytes, len) == false) {
+        vxlog_error("[WSConnection::receivedBytes] dropped bytes");
+        _receivedBytesDropped = true;
     }
 
     if (isFinalFragment) {
+        Connection::ReceiveBuffer *buffer = _receivedBytesBuffer;
+        _receivedBytesBuffer = nullptr;
+
         // notify delegate
         std::shared_ptr<ConnectionDelegate> delegate = getDelegate().lock();
-        if (delegate != nullptr) {
-            char *bytesBuf = reinterpret_cast<char*>(malloc(_receivedBytesBuffer.size()));
-            if (bytesBuf != nullptr) {
-                memcpy(bytesBuf, _receivedBytesBuffer.c_str(), _receivedBytesBuffer.size());
-
-                Payload_SharedPtr pld = Payload::decode(bytesBuf, _receivedBytesBuffer.size());
-
+        if (delegate != nullptr && _receivedBytesDropped == false) {
+            Payload_SharedPtr pld = Payload::decode(buffer); // buffer adopted by Payload
+            if (pld != nullptr) {
+                _didReceivePayload(pld);
                 pld->step("WSConnection::receivedBytes");
-
                 delegate->connectionDidReceive(*this, pld);
-            } else {
-                vxlog_error("[WSConnection::receivedBytes] dropped bytes");
             }
+        } else {
+            buffer->release();
         }
-        _receivedBytesBuffer.clear();
+        _receivedBytesDropped = false;
     }
 }
 
@@ -450,6 +463,10 @@ size_t WSConnection::write(char *buf, size_t len, bool& isFirstFragment, bool& p
         }
 
         memcpy(cursor, payload->getMetadata() + _written, toWrite);
+        if (isFirstFragment && toWrite > 0) {
+            // includes byte, metadata is shared with other connections writing the Payload
+            cursor[0] |= _advertisedIncludes();
+        }
 
         cursor += toWrite;
         n += toWrite;
@@ -465,8 +482,6 @@ size_t WSConnection::write(char *buf, size_t len, bool& isFirstFragment, bool& p
     toWrite = payload->contentSize() - contentWritten;
     if (toWrite > (len-n)) { toWrite = (len-n); } // (len-n) is the current "write capacity"
 
-    // NOTE: we could compress (using zlib deflate) when size is big enough (>~42 bytes?)
-    // https://stackoverflow.com/a/63699295
     memcpy(cursor, payload->getContent() + contentWritten, toWrite);
     n += toWrite;
     _written += toWrite;
@@ -18,7 +18,12 @@
 
 #define PROTOCOL_NAME "join"
 #define WS_SERVER_RX_BUFFER_SIZE 1024
-#define WS_WRITE_BUF_SIZE 512 // arbitrary size
+// frames are sized to the payload being written, larger payloads are fragmented
+// around 2 x MTU, which the OS almost always accepts directly (see lws-write.h)
+#define WS_WRITE_MAX_FRAME_SIZE 4096
+// bytes written per writable callback, until lws_send_pipe_choked reports the
+// socket is full, before giving other connections a chance to write
+#define WS_WRITE_MAX_BYTES_PER_CALLBACK 65536
 
 using namespace vx;
 
@@ -82,9 +87,11 @@ _secure(secure),
 _tlsCertificate(tlsCertificate),
 _tlsPrivateKey(tlsPrivateKey),
 _delegate(nullptr),
-_activeConnections(),
-_lws_context(nullptr),
-_contextMutex(),
+_compressionEnabled(false),
+_compressionMinSize(512),
+_serviceThreadsCount(0),
+_services(),
+_servicesShouldExit(false),
 _lws_pvo_wsserver(),
 _lws_pvo_options(),
 _lws_pvo_interrupted(),
@@ -124,8 +131,17 @@ _lws_process_n(0) {
 }
 
 WSServer::~WSServer() {
-    if (_lws_context != nullptr) {
-        lws_context_destroy(_lws_context);
+    _servicesShouldExit = true;
+    for (std::unique_ptr<Service>& service : _services) {
+        if (service->thread.joinable()) {
+            lws_cancel_service(service->context); // wakes service thread up
+            service->thread.join();
+        }
+    }
+    for (std::unique_ptr<Service>& service : _services) {
+        if (service->context != nullptr) {
+            lws_context_destroy(service->context);
+        }
     }
 }
 
@@ -171,6 +187,10 @@ void WSServer::listen() {
     info.pt_serv_buf_size = 32 * 1024;
     info.options = (LWS_SERVER_OPTION_VALIDATE_UTF8 |
                     LWS_SERVER_OPTION_HTTP_HEADERS_SECURITY_BEST_PRACTICES_ENFORCE);
+    if (_serviceThreadsCount > 0) {
+        // each service binds its own listening socket on the same port
+        info.options |= LWS_SERVER_OPTION_ALLOW_LISTEN_SHARE;
+    }
     if (_secure) {
         info.options |= LWS_SERVER_OPTION_DO_SSL_GLOBAL_INIT;
 #if defined(ONLINE_GAMESERVER)
@@ -193,9 +213,23 @@ void WSServer::listen() {
     // info.ka_probes = 20; // nb of retries
     // info.ka_interval = 5; // interval between retries
 
-    _lws_context = lws_create_context(&info);
-    if (_lws_context == nullptr) {
-        vxlog_error("[WSServer::listen] lws init failed");
+    const size_t servicesCount = _serviceThreadsCount > 0 ? _serviceThreadsCount : 1;
+    for (size_t i = 0; i < servicesCount; ++i) {
+        std::unique_ptr<Service> service(new Service());
+        service->context = nullptr;
+        info.user = service.get(); // lws_context_user
+        service->context = lws_create_context(&info);
+        if (service->context == nullptr) {
+            vxlog_error("[WSServer::listen] lws init failed");
+            break;
+        }
+        _services.push_back(std::move(service));
+    }
+
+    if (_serviceThreadsCount > 0) {
+        for (std::unique_ptr<Service>& service : _services) {
+            service->thread = std::thread(&WSServer::_serviceThreadFunction, this, service.get());
+        }
     }
 //    else {
 //        while (n >= 0 && !_lws_interrupted) {
@@ -209,9 +243,25 @@ void WSServer::listen() {
 }
 
 void WSServer::process() {
+    if (_serviceThreadsCount > 0 || _services.empty()) {
+        return; // serviced by their own threads
+    }
     if (_lws_process_n >= 0 && _lws_interrupted == false) {
-        _lws_process_n = lws_service(_lws_context, 0);
+        _lws_process_n = lws_service(_services[0]->context, 0);
+    }
+}
+
+void WSServer::setCompression(bool enabled, size_t minSize) {
+    _compressionEnabled = enabled;
+    _compressionMinSize = minSize;
+}
+
+void WSServer::setServiceThreads(const size_t count) {
+    if (_services.empty() == false) {
+        vxlog_error("[WSServer::setServiceThreads] must be called before listen()");
+        return;
     }
+    _serviceThreadsCount = count;
 }
 
 // Allocates new connection and notify delegates
@@ -225,6 +275,7 @@ WSServerConnection_SharedPtr* WSServer::createNewConnection(WSBackend wsi) {
     if (newConnPtr == nullptr) {
         return nullptr;
     }
+    newConnPtr->setCompression(_compressionEnabled, _compressionMinSize);
 
     WSServerConnection_SharedPtr *conn = new WSServerConnection_SharedPtr(newConnPtr);
     if (conn == nullptr) {
@@ -232,8 +283,11 @@ WSServerConnection_SharedPtr* WSServer::createNewConnection(WSBackend wsi) {
         return nullptr;
     }
 
-    // add new connection to the collection of active connections
-    _activeConnections.push_back(WSServerConnection_WeakPtr(*conn));
+    // add new connection to the collection of active connections of its service
+    {
+        std::lock_guard<std::mutex> lock(getContextMutex(wsi));
+        getActiveConnections(wsi).push_back(WSServerConnection_WeakPtr(*conn));
+    }
 
     return conn;
 }
@@ -257,17 +311,39 @@ void WSServer::scheduleWrite(WSServerConnection* conn) {
         return;
     }
     {
-        std::lock_guard<std::mutex> lock(_contextMutex);
+        std::lock_guard<std::mutex> lock(getContextMutex(wsi));
         lws_cancel_service_pt(wsi);
     }
 }
 
-std::mutex& WSServer::getContextMutex() {
-    return _contextMutex;
+void WSServer::broadcast(const Connection::Payload_SharedPtr& p) {
+    _broadcast(p, _getActiveConnections(nullptr));
+}
+
+void WSServer::broadcast(const Connection::Payload_SharedPtr& p, const Connection_SharedPtr& except) {
+    _broadcast(p, _getActiveConnections(except.get()));
 }
 
-std::vector<WSServerConnection_WeakPtr>& WSServer::getActiveConnections() {
-    return _activeConnections;
+void WSServer::broadcast(const Connection::Payload_SharedPtr& p, const std::vector<Connection_SharedPtr>& conns) {
+    std::vector<WSServerConnection_SharedPtr> wsConns;
+    wsConns.reserve(conns.size());
+    for (const Connection_SharedPtr& conn : conns) {
+        WSServerConnection_SharedPtr wsConn = std::dynamic_pointer_cast<WSServerConnection>(conn);
+        if (wsConn != nullptr) {
+            wsConns.push_back(wsConn);
+        } else if (conn != nullptr) {
+            conn->pushPayloadToWrite(p); // not a connection of this server
+        }
+    }
+    _broadcast(p, wsConns);
+}
+
+std::mutex& WSServer::getContextMutex(WSBackend wsi) {
+    return _getService(wsi)->contextMutex;
+}
+
+std::vector<WSServerConnection_WeakPtr>& WSServer::getActiveConnections(WSBackend wsi) {
+    return _getService(wsi)->activeConnections;
 }
 
 // --------------------------------------------------
@@ -276,6 +352,72 @@ std::vector<WSServerConnection_WeakPtr>& WSServer::getActiveConnections() {
 //
 // --------------------------------------------------
 
+WSServer::Service *WSServer::_getService(WSBackend wsi) {
+    return reinterpret_cast<Service*>(lws_context_user(lws_get_context(wsi)));
+}
+
+std::vector<WSServerConnection_SharedPtr> WSServer::_getActiveConnections(const Connection* except) {
+    std::vector<WSServerConnection_SharedPtr> conns;
+    for (std::unique_ptr<Service>& service : _services) {
+        std::lock_guard<std::mutex> lock(service->contextMutex);
+        conns.reserve(conns.size() + service->activeConnections.size());
+        for (const WSServerConnection_WeakPtr& weak : service->activeConnections) {
+            WSServerConnection_SharedPtr conn = weak.lock();
+            if (conn != nullptr && conn.get() != except) {
+                conns.push_back(conn);
+            }
+        }
+    }
+    return conns;
+}
+
+void WSServer::_broadcast(const Connection::Payload_SharedPtr& p, const std::vector<WSServerConnection_SharedPtr>& conns) {
+    if (p == nullptr || conns.empty()) {
+        return;
+    }
+
+    // serialize once, connections only read it from now on
+    p->step("WSServer::broadcast");
+    if (p->createMetadataIfNull() == false) {
+        return;
+    }
+    if (_compressionEnabled && p->contentSize() >= _compressionMinSize) {
+        Connection::Payload_SharedPtr compressed = p->getCompressed();
+        if (compressed != nullptr) {
+            compressed->createMetadataIfNull();
+        }
+    }
+
+    std::vector<Service*> servicesToWake;
+    for (const WSServerConnection_SharedPtr& conn : conns) {
+        if (conn->isClosed()) {
+            continue;
+        }
+        if (conn->pushSerializedPayloadToWrite(p)) {
+            lws* wsi = conn->getWsi();
+            if (wsi == nullptr) {
+                continue;
+            }
+            Service *service = _getService(wsi);
+            if (std::find(servicesToWake.begin(), servicesToWake.end(), service) == servicesToWake.end()) {
+                servicesToWake.push_back(service);
+            }
+        }
+    }
+
+    // connections with pending payloads are looked for when the service is woken up
+    for (Service *service : servicesToWake) {
+        std::lock_guard<std::mutex> lock(service->contextMutex);
+        lws_cancel_service(service->context);
+    }
+}
+
+void WSServer::_serviceThreadFunction(Service *service) {
+    int n = 0;
+    while (n >= 0 && _servicesShouldExit == false) {
+        n = lws_service(service->context, 0);
+    }
+}
 
 
 // --------------------------------------------------
@@ -404,7 +546,8 @@ static int lws_callback(struct lws *wsi,
         case LWS_CALLBACK_EVENT_WAIT_CANCELLED: {
 
             if (vhd != nullptr && vhd->wsserver != nullptr) {
-                std::vector<WSServerConnection_WeakPtr>& conns = vhd->wsserver->getActiveConnections();
+                std::lock_guard<std::mutex> lock(vhd->wsserver->getContextMutex(wsi));
+                std::vector<WSServerConnection_WeakPtr>& conns = vhd->wsserver->getActiveConnections(wsi);
                 std::vector<WSServerConnection_WeakPtr>::iterator it;
 
                 // remove expired weak pointers
@@ -416,10 +559,13 @@ static int lws_callback(struct lws *wsi,
                 for (it = conns.begin(); it != conns.end(); it++) {
                     WSServerConnection_SharedPtr strong = (*it).lock();
                     if (strong == nullptr) { continue; }
+                    // closed connections can still be referenced elsewhere, w/ pending payloads
+                    lws* connWsi = strong->getWsi();
+                    if (connWsi == nullptr) { continue; }
                     if (strong->doneWriting() == false) {
                         strong->setIsWriting(true);
                         // request additional write callback
-                        lws_callback_on_writable(strong->getWsi());
+                        lws_callback_on_writable(connWsi);
                     }
                 }
             }
@@ -492,47 +638,61 @@ static int lws_callback(struct lws *wsi,
             if (conn != nullptr) {
                 if (conn->doneWriting() == false) {
 
-                    static char buf[LWS_PRE + WS_WRITE_BUF_SIZE];
+                    // buffer per service thread
+                    static thread_local char buf[LWS_PRE + WS_WRITE_MAX_FRAME_SIZE];
                     char *start = &(buf[LWS_PRE]); // buf + LWS_PRE
 
-                    bool firstFragment;
-                    bool partial;
-                    const size_t len_to_write = conn->write(start, WS_WRITE_BUF_SIZE, firstFragment, partial);
-
-                    int writeMode = 0;
-                    // vxlog_debug("WS write: --- %d/%d - writing %d", alreadyWritten, totalPayloadLen, len_to_write);
-                    if (firstFragment) {
-                        // first write for this payload
-                        if (partial == false) {
-                            // vxlog_debug("WS write: single frame, no fragmentation");
-                            writeMode = LWS_WRITE_BINARY; // single frame, no fragmentation
-                        } else {
-                            // vxlog_debug("WS write: first fragment");
-                            writeMode = LWS_WRITE_BINARY | LWS_WRITE_NO_FIN; // first fragment
+                    // write queued payloads one after the other (each one being a websocket
+                    // message), until the socket stops accepting bytes without blocking
+                    size_t written = 0;
+                    do {
+                        bool firstFragment;
+                        bool partial;
+                        const size_t len_to_write = conn->write(start, WS_WRITE_MAX_FRAME_SIZE, firstFragment, partial);
+                        if (len_to_write == 0) {
+                            break;
                         }
-                    } else {
-                        if (partial == true) {
-                            // vxlog_debug("WS write: middle fragment");
-                            writeMode = LWS_WRITE_CONTINUATION | LWS_WRITE_NO_FIN; // all middle fragments
+
+                        int writeMode = 0;
+                        // vxlog_debug("WS write: --- %d/%d - writing %d", alreadyWritten, totalPayloadLen, len_to_write);
+                        if (firstFragment) {
+                            // first write for this payload
+                            if (partial == false) {
+                                // vxlog_debug("WS write: single frame, no fragmentation");
+                                writeMode = LWS_WRITE_BINARY; // single frame, no fragmentation
+                            } else {
+                                // vxlog_debug("WS write: first fragment");
+                                writeMode = LWS_WRITE_BINARY | LWS_WRITE_NO_FIN; // first fragment
+                            }
                         } else {
-                            // vxlog_debug("WS write: last fragment");
-                            writeMode = LWS_WRITE_CONTINUATION; // last fragment
+                            if (partial == true) {
+                                // vxlog_debug("WS write: middle fragment");
+                                writeMode = LWS_WRITE_CONTINUATION | LWS_WRITE_NO_FIN; // all middle fragments
+                            } else {
+                                // vxlog_debug("WS write: last fragment");
+                                writeMode = LWS_WRITE_CONTINUATION; // last fragment
+                            }
                         }
-                    }
-                    lws_write_protocol wp = static_cast<lws_write_protocol>(writeMode);
+                        lws_write_protocol wp = static_cast<lws_write_protocol>(writeMode);
 
-                    const int bytesJustWritten = lws_write(wsi,
-                                                           reinterpret_cast<uint8_t *>(start),
-                                                           len_to_write,
-                                                           wp);
+                        const int bytesJustWritten = lws_write(wsi,
+                                                               reinterpret_cast<uint8_t *>(start),
+                                                               len_to_write,
+                                                               wp);
 
-                    if (bytesJustWritten < static_cast<int>(len_to_write)) {
-                        // Error, connection is dead.
-                        return 1;
-                    }
+                        if (bytesJustWritten < static_cast<int>(len_to_write)) {
+                            // Error, connection is dead.
+                            return 1;
+                        }
+                        written += len_to_write;
+
+                        if (lws_send_pipe_choked(wsi)) {
+                            break; // wait for next writable callback
+                        }
+                    } while (written < WS_WRITE_MAX_BYTES_PER_CALLBACK && conn->doneWriting() == false);
 
                     if (conn->doneWriting() == false) {
-                        std::lock_guard<std::mutex> lock(vhd->wsserver->getContextMutex());
+                        std::lock_guard<std::mutex> lock(vhd->wsserver->getContextMutex(wsi));
                         lws_callback_on_writable(wsi); // request additional write
                         assert(conn->isWriting() == true);
                     } else {
@@ -28,12 +28,18 @@ _server(parentServer),
 _payloadsToWrite(),
 _status(Connection::Status::IDLE),
 _statusMutex(),
-_receivedBytesBuffer(),
+_receivedBytesBuffer(nullptr),
+_receivedBytesDropped(false),
 _isWriting(false),
 _isWritingMutex(),
 _written(0) {}
 
-WSServerConnection::~WSServerConnection() {}
+WSServerConnection::~WSServerConnection() {
+    if (_receivedBytesBuffer != nullptr) {
+        _receivedBytesBuffer->release();
+        _receivedBytesBuffer = nullptr;
+    }
+}
 
 // --------------------------------------------------
 // "Connection" interface implementation
@@ -117,28 +123,32 @@ void WSServerConnection::_setWsi(lws *wsi) {
 void WSServerConnection::receivedBytes(char *bytes,
                                        const size_t len,
                                        const bool isFinalFragment) {
-    // append received bytes
-    if (len > 0) {
-        _receivedBytesBuffer.append(bytes, len);
+    // append received bytes, directly in the buffer the Payload will adopt
+    if (_receivedBytesBuffer == nullptr) {
+        _receivedBytesBuffer = Connection::ReceiveBuffer::get();
+    }
+    if (len > 0 && _receivedBytesBuffer->append(bytes, len) == false) {
+        vxlog_error("[WSServerConnection::receivedBytes] dropped bytes");
+        _receivedBytesDropped = true;
     }
 
     if (isFinalFragment) {
+        Connection::ReceiveBuffer *buffer = _receivedBytesBuffer;
+        _receivedBytesBuffer = nullptr;
+
         // notify delegate
         std::shared_ptr<ConnectionDelegate> delegate = getDelegate().lock();
-        if (delegate != nullptr) {
-            char *bytes = reinterpret_cast<char*>(malloc(_receivedBytesBuffer.size()));
-            if (bytes != nullptr) {
-                memcpy(bytes, _receivedBytesBuffer.c_str(), _receivedBytesBuffer.size());
-                Payload_SharedPtr pld = Payload::decode(bytes, _receivedBytesBuffer.size());
-
+        if (delegate != nullptr && _receivedBytesDropped == false) {
+            Payload_SharedPtr pld = Payload::decode(buffer); // buffer adopted by Payload
+            if (pld != nullptr) {
+                _didReceivePayload(pld);
                 pld->step("WSServerConnection::receivedBytes");
-
                 delegate->connectionDidReceive(*this, pld);
-            } else {
-                vxlog_error("[WSConnection::receivedBytes] dropped bytes");
             }
+        } else {
+            buffer->release();
         }
-        _receivedBytesBuffer.clear();
+        _receivedBytesDropped = false;
     }
 }
 
@@ -171,8 +181,13 @@ Connection::Payload_SharedPtr WSServerConnection::_getPayloadToWrite() {
         // _payloadBeingWritten remains NULL if nothing was popped
 
         if (_payloadBeingWritten != nullptr) {
+            _payloadBeingWritten = _compressIfNeeded(_payloadBeingWritten);
             _written = 0;
-            _payloadBeingWritten->step("start writing out (server)");
+            // payloads pushed serialized (broadcast) are shared w/ connections of other
+            // service threads, their travel history is already part of their metadata
+            if (_payloadBeingWritten->getMetadata() == nullptr) {
+                _payloadBeingWritten->step("start writing out (server)");
+            }
         }
     }
 
@@ -191,6 +206,11 @@ void WSServerConnection::pushPayloadToWrite(const Payload_SharedPtr& p) {
     _server->scheduleWrite(this);
 }
 
+bool WSServerConnection::pushSerializedPayloadToWrite(const Payload_SharedPtr& p) {
+    _payloadsToWrite.push(p);
+    return isWriting() == false;
+}
+
 size_t WSServerConnection::write(char *buf, size_t len, bool& isFirstFragment, bool& partial) {
     isFirstFragment = false;
     partial = true;
@@ -224,6 +244,10 @@ size_t WSServerConnection::write(char *buf, size_t len, bool& isFirstFragment, b
         }
 
         memcpy(cursor, payload->getMetadata() + _written, toWrite);
+        if (isFirstFragment && toWrite > 0) {
+            // includes byte, metadata is shared with other connections writing the Payload
+            cursor[0] |= _advertisedIncludes();
+        }
 
         cursor += toWrite;
         n += toWrite;
@@ -239,8 +263,6 @@ size_t WSServerConnection::write(char *buf, size_t len, bool& isFirstFragment, b
     toWrite = payload->contentSize() - contentWritten;
     if (toWrite > (len-n)) { toWrite = (len-n); } // (len-n) is the current "write capacity"
 
-    // NOTE: we could compress (using zlib deflate) when size is big enough (>~42 bytes?)
-    // https://stackoverflow.com/a/63699295
     memcpy(cursor, payload->getContent() + contentWritten, toWrite);
     n += toWrite;
     _written += toWrite;
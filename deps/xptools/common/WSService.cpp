@@ -10,6 +10,7 @@
 // C++
 #include <algorithm>
 #include <cassert>
+#include <vector>
 
 #if defined(__VX_SINGLE_THREAD) || !defined(__VX_USE_LIBWEBSOCKETS)
 #define LOCK_GUARD_CONTEXT
@@ -25,7 +26,12 @@
 #include "HttpRequest.hpp"
 
 #define BODY_BUF_SIZE 2048
-#define WS_WRITE_BUF_SIZE 512 // arbitrary size
+// frames are sized to the payload being written, larger payloads are fragmented
+// around 2 x MTU, which the OS almost always accepts directly (see lws-write.h)
+#define WS_WRITE_MAX_FRAME_SIZE 4096
+// bytes written per writable callback, until lws_send_pipe_choked reports the
+// socket is full, before giving other connections a chance to write
+#define WS_WRITE_MAX_BYTES_PER_CALLBACK 65536
 
 // #define WSSERVICE_DEBUG_LOG(...) vxlog_debug(__VA_ARGS__)
 #define WSSERVICE_DEBUG_LOG(...)
@@ -188,18 +194,28 @@ void WSService::scheduleWSConnectionWrite(WSConnection_SharedPtr wsConn) {
 #endif
 
 #if defined(__VX_PLATFORM_WASM)
-#define WASM_WEBSOCKET_WRITE_BUFFER_SIZE 512
-    static char* buffer[WASM_WEBSOCKET_WRITE_BUFFER_SIZE];
+    // browser websockets can't send fragments, each payload is accumulated
+    // and sent as a single message (buffer is shrunk back after big payloads)
+    static std::vector<char> buffer;
     WSBackend wsi = wsConn->getWsi();
     bool isFirstFragment = true;
     bool partial = true;
     size_t n = 0;
+    size_t size = 0;
     do {
-        n = wsConn->write(reinterpret_cast<char*>(buffer), WASM_WEBSOCKET_WRITE_BUFFER_SIZE, isFirstFragment, partial);
-        if (n > 0) {
-            EMSCRIPTEN_RESULT r = emscripten_websocket_send_binary(wsi, buffer, n);
+        if (buffer.size() < size + WS_WRITE_MAX_FRAME_SIZE) {
+            buffer.resize(size + WS_WRITE_MAX_FRAME_SIZE);
+        }
+        n = wsConn->write(buffer.data() + size, WS_WRITE_MAX_FRAME_SIZE, isFirstFragment, partial);
+        size += n;
+        if (n > 0 && partial == false) {
+            EMSCRIPTEN_RESULT r = emscripten_websocket_send_binary(wsi, buffer.data(), static_cast<uint32_t>(size));
+            size = 0;
         }
     } while (n > 0);
+    if (buffer.size() > WS_WRITE_MAX_FRAME_SIZE) {
+        std::vector<char>(WS_WRITE_MAX_FRAME_SIZE).swap(buffer);
+    }
 
 #endif
 }
@@ -704,45 +720,59 @@ int lws_callback_ws_join(struct lws *wsi,
             if (wsConn != nullptr) {
                 if (wsConn->doneWriting() == false) {
 
-                    static char buf[LWS_PRE + WS_WRITE_BUF_SIZE];
+                    // buffer per service thread
+                    static thread_local char buf[LWS_PRE + WS_WRITE_MAX_FRAME_SIZE];
                     char *start = &(buf[LWS_PRE]); // buf + LWS_PRE
 
-                    bool firstFragment;
-                    bool partial;
-                    const size_t len_to_write = wsConn->write(start, WS_WRITE_BUF_SIZE, firstFragment, partial);
-
-                    int writeMode = 0;
-                    // WSSERVICE_DEBUG_LOG("WS write: -----");
-                    if (firstFragment) {
-                        // first write for this payload
-                        if (partial == false) {
-                            WSSERVICE_DEBUG_LOG("WS write: single frame, no fragmentation");
-                            writeMode = LWS_WRITE_BINARY; // single frame, no fragmentation
-                        } else {
-                            WSSERVICE_DEBUG_LOG("WS write: first fragment");
-                            writeMode = LWS_WRITE_BINARY | LWS_WRITE_NO_FIN; // first fragment
+                    // write queued payloads one after the other (each one being a websocket
+                    // message), until the socket stops accepting bytes without blocking
+                    size_t written = 0;
+                    do {
+                        bool firstFragment;
+                        bool partial;
+                        const size_t len_to_write = wsConn->write(start, WS_WRITE_MAX_FRAME_SIZE, firstFragment, partial);
+                        if (len_to_write == 0) {
+                            break;
                         }
-                    } else {
-                        if (partial == true) {
-                            WSSERVICE_DEBUG_LOG("WS write: middle fragment");
-                            writeMode = LWS_WRITE_CONTINUATION | LWS_WRITE_NO_FIN; // all middle fragments
+
+                        int writeMode = 0;
+                        // WSSERVICE_DEBUG_LOG("WS write: -----");
+                        if (firstFragment) {
+                            // first write for this payload
+                            if (partial == false) {
+                                WSSERVICE_DEBUG_LOG("WS write: single frame, no fragmentation");
+                                writeMode = LWS_WRITE_BINARY; // single frame, no fragmentation
+                            } else {
+                                WSSERVICE_DEBUG_LOG("WS write: first fragment");
+                                writeMode = LWS_WRITE_BINARY | LWS_WRITE_NO_FIN; // first fragment
+                            }
                         } else {
-                            WSSERVICE_DEBUG_LOG("WS write: last fragment");
-                            writeMode = LWS_WRITE_CONTINUATION; // last fragment
+                            if (partial == true) {
+                                WSSERVICE_DEBUG_LOG("WS write: middle fragment");
+                                writeMode = LWS_WRITE_CONTINUATION | LWS_WRITE_NO_FIN; // all middle fragments
+                            } else {
+                                WSSERVICE_DEBUG_LOG("WS write: last fragment");
+                                writeMode = LWS_WRITE_CONTINUATION; // last fragment
+                            }
                         }
-                    }
 
-                    lws_write_protocol wp = static_cast<lws_write_protocol>(writeMode);
+                        lws_write_protocol wp = static_cast<lws_write_protocol>(writeMode);
 
-                    const int bytesJustWritten = lws_write(wsi,
-                                                           reinterpret_cast<uint8_t *>(start),
-                                                           len_to_write,
-                                                           wp);
+                        const int bytesJustWritten = lws_write(wsi,
+                                                               reinterpret_cast<uint8_t *>(start),
+                                                               len_to_write,
+                                                               wp);
 
-                    if (bytesJustWritten < static_cast<int>(len_to_write)) {
-                        // Error, connection is dead.
-                        return 1;
-                    }
+                        if (bytesJustWritten < static_cast<int>(len_to_write)) {
+                            // Error, connection is dead.
+                            return 1;
+                        }
+                        written += len_to_write;
+
+                        if (lws_send_pipe_choked(wsi)) {
+                            break; // wait for next writable callback
+                        }
+                    } while (written < WS_WRITE_MAX_BYTES_PER_CALLBACK && wsConn->doneWriting() == false);
 
                     if (wsConn->doneWriting() == false) {
                         lws_callback_on_writable(wsi); // request additional write
@@ -13,6 +13,7 @@
 // C++
 #include <thread>
 #include <cassert>
+#include <cmath>
 
 // xptools
 #include "vxlog.h"
@@ -26,6 +27,12 @@
 
 #define OGG_PAGE_HEADER "OggS"
 
+// files up to that size are decoded once and shared by Sounds with the same name,
+// larger ones (music) keep being decoded while playing
+#define DECODED_CACHE_MAX_FILE_SIZE 262144 // 256KB
+#define DECODED_CACHE_MAX_SIZE 33554432 // 32MB of decoded PCM
+#define DEFAULT_MAX_VOICES 32
+
 using namespace vx::audio;
 
 typedef struct {
@@ -198,6 +205,13 @@ AudioEngine *AudioEngine::shared() {
 }
 
 AudioEngine::~AudioEngine() {
+    ma_resource_manager *resourceManager = ma_engine_get_resource_manager(&_engine);
+    {
+        const std::lock_guard<std::mutex> lock(_decodedSoundsMutex);
+        for (const std::string& name : _decodedSoundsLRU) {
+            ma_resource_manager_unregister_file(resourceManager, name.c_str());
+        }
+    }
     ma_engine_uninit(&_engine);
     free(_vfs);
     _vfs = nullptr;
@@ -225,9 +239,26 @@ bool AudioEngine::setVolume(float volumePercentage) {
     return true;
 }
 
+void AudioEngine::setMaxVoices(const size_t maxVoices) {
+    _maxVoices = maxVoices > 0 ? maxVoices : 1;
+}
+
+size_t AudioEngine::getPlayingVoicesCount() {
+    const std::lock_guard<std::mutex> lock(_voicesMutex);
+    _pruneVoices();
+    return _voices.size();
+}
+
 // MARK: - private -
 
-AudioEngine::AudioEngine() {
+AudioEngine::AudioEngine() :
+_decodedSoundsMutex(),
+_decodedSounds(),
+_decodedSoundsLRU(),
+_decodedCacheBytes(0),
+_voicesMutex(),
+_voices(),
+_maxVoices(DEFAULT_MAX_VOICES) {
     
     ma_result result;
     
@@ -246,11 +277,147 @@ AudioEngine::AudioEngine() {
     }
 }
 
+ma_uint32 AudioEngine::_getSoundFlags(const std::string& soundName) {
+    const std::lock_guard<std::mutex> lock(_decodedSoundsMutex);
+    std::unordered_map<std::string, DecodedSound>::iterator it = _decodedSounds.find(soundName);
+    if (it != _decodedSounds.end()) {
+        if (it->second.decoded == false) {
+            return 0;
+        }
+        _decodedSoundsLRU.splice(_decodedSoundsLRU.begin(), _decodedSoundsLRU, it->second.lruIt);
+        return MA_SOUND_FLAG_DECODE;
+    }
+
+    DecodedSound entry;
+    entry.size = 0;
+    entry.decoded = false;
+    entry.lruIt = _decodedSoundsLRU.end();
+
+    // only look at the encoded size, decoding it is what we try to avoid
+    ma_file_info info;
+    info.sizeInBytes = 0;
+    ma_vfs_file file = nullptr;
+    if (ma_vfs_open(_vfs, soundName.c_str(), MA_OPEN_MODE_READ, &file) == MA_SUCCESS) {
+        ma_vfs_info(_vfs, file, &info);
+        ma_vfs_close(_vfs, file);
+    }
+
+    if (info.sizeInBytes > 0 && info.sizeInBytes <= DECODED_CACHE_MAX_FILE_SIZE) {
+        ma_result result = ma_resource_manager_register_file(ma_engine_get_resource_manager(&_engine),
+                                                             soundName.c_str(),
+                                                             MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_DECODE);
+        if (result == MA_SUCCESS) {
+            entry.decoded = true;
+            _decodedSoundsLRU.push_front(soundName);
+            entry.lruIt = _decodedSoundsLRU.begin();
+        } else {
+            vxlog_error("[AudioEngine] failed to decode %s", soundName.c_str());
+        }
+    }
+
+    _decodedSounds.emplace(soundName, entry);
+    return entry.decoded ? MA_SOUND_FLAG_DECODE : 0;
+}
+
+void AudioEngine::_decodedSoundDidLoad(const std::string& soundName, const size_t size) {
+    const std::lock_guard<std::mutex> lock(_decodedSoundsMutex);
+    std::unordered_map<std::string, DecodedSound>::iterator it = _decodedSounds.find(soundName);
+    if (it == _decodedSounds.end() || it->second.decoded == false || it->second.size > 0) {
+        return;
+    }
+    it->second.size = size;
+    _decodedCacheBytes += size;
+
+    // evict least recently used sounds, data remains alive while Sounds still use it
+    ma_resource_manager *resourceManager = ma_engine_get_resource_manager(&_engine);
+    while (_decodedCacheBytes > DECODED_CACHE_MAX_SIZE && _decodedSoundsLRU.size() > 1) {
+        const std::string name = _decodedSoundsLRU.back();
+        _decodedSoundsLRU.pop_back();
+        ma_resource_manager_unregister_file(resourceManager, name.c_str());
+        std::unordered_map<std::string, DecodedSound>::iterator evicted = _decodedSounds.find(name);
+        if (evicted != _decodedSounds.end()) {
+            _decodedCacheBytes -= evicted->second.size;
+            _decodedSounds.erase(evicted);
+        }
+    }
+}
+
+bool AudioEngine::_acquireVoice(Sound *sound) {
+    if (sound->_weakSelf.expired()) {
+        return true; // not created with Sound::make, can't be tracked
+    }
+
+    Sound_SharedPtr victim = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(_voicesMutex);
+
+        _pruneVoices();
+
+        for (const Sound_WeakPtr& voice : _voices) {
+            if (voice.lock().get() == sound) {
+                return true; // already counted
+            }
+        }
+
+        if (_voices.size() >= _maxVoices) {
+            // steal the least important voice: lowest priority, then least audible
+            const float audibility = sound->_getAudibility();
+            size_t victimIndex = _voices.size();
+            float victimAudibility = 0.0f;
+
+            for (size_t i = 0; i < _voices.size(); ++i) {
+                Sound_SharedPtr voice = _voices[i].lock();
+                if (voice == nullptr) {
+                    continue; // released since pruned
+                }
+                const float a = voice->_getAudibility();
+                if (victim == nullptr ||
+                    voice->_priority < victim->_priority ||
+                    (voice->_priority == victim->_priority && a < victimAudibility)) {
+                    victimIndex = i;
+                    victim = voice;
+                    victimAudibility = a;
+                }
+            }
+
+            if (victim == nullptr ||
+                sound->_priority < victim->_priority ||
+                (sound->_priority == victim->_priority && audibility < victimAudibility)) {
+                return false; // new sound is the least important one
+            }
+
+            _voices.erase(_voices.begin() + static_cast<std::ptrdiff_t>(victimIndex));
+        }
+
+        _voices.push_back(sound->_weakSelf);
+    }
+
+    // stolen voice is stopped once unlocked
+    if (victim != nullptr) {
+        victim->_playScheduled = false;
+        victim->stop();
+    }
+    return true;
+}
+
+void AudioEngine::_pruneVoices() {
+    Sound_SharedPtr sptr;
+    for (std::vector<Sound_WeakPtr>::iterator it = _voices.begin(); it != _voices.end();) {
+        sptr = (*it).lock();
+        if (sptr != nullptr && sptr->_usesVoice()) {
+            it++;
+        } else {
+            it = _voices.erase(it);
+        }
+    }
+}
+
 // --------------------------------------------------
 // MARK: - SoundsTicks type -
 // --------------------------------------------------
 
 SoundsTicks::SoundsTicks():
+_soundsMutex(),
 _sounds() {}
 
 SoundsTicks::~SoundsTicks() {
@@ -266,6 +433,7 @@ SoundsTicks *SoundsTicks::shared() {
 }
 
 void SoundsTicks::tick(const double dt) {
+    const std::lock_guard<std::mutex> lock(_soundsMutex);
     if (_sounds.size() == 0) {
         return;
     }
@@ -285,6 +453,7 @@ void SoundsTicks::tick(const double dt) {
 
 void SoundsTicks::addSound(const Sound_SharedPtr sound) {
     Sound_WeakPtr soundWeakRef = sound;
+    const std::lock_guard<std::mutex> lock(_soundsMutex);
     _sounds.push_back(soundWeakRef);
 }
 
@@ -306,6 +475,8 @@ _hasDefaultRadiusRatio(true),
 _pitch(1.0f),
 _looping(looping),
 _playScheduled(false),
+_priority(0),
+_engine(engine),
 _timeSinceStartOfPlay(-1.0),
 _timeSinceStartOfFade(-1.0),
 _startFrame(0),
@@ -330,9 +501,10 @@ Sound_SharedPtr Sound::make(AudioEngine * const engine, const std::string& sound
 bool Sound::init(AudioEngine * const engine, const std::string& soundName) {
     ma_result result;
     
-    // maybe we should use "ma_sound_init_from_data_source"
+    // short sounds share decoded data, instead of each Sound decoding the file
     // - Spatialization is enabled by default
-    result = ma_sound_init_from_file(&(engine->_engine), soundName.c_str(), 0, nullptr, nullptr, &_ma_sound);
+    const ma_uint32 flags = engine->_getSoundFlags(soundName);
+    result = ma_sound_init_from_file(&(engine->_engine), soundName.c_str(), flags, nullptr, nullptr, &_ma_sound);
     if (result != MA_SUCCESS) {
         // error
         vxlog_error("[vx::audio::Sound] failed to init Sound object (1)");
@@ -346,20 +518,26 @@ bool Sound::init(AudioEngine * const engine, const std::string& soundName) {
     ma_sound_set_volume(&_ma_sound, _volume);
 
     // retreive information about the sound
-    result = ma_sound_get_data_format(&_ma_sound, nullptr, nullptr, &_sampleRate, nullptr, 0);
+    ma_uint32 channels = 0;
+    result = ma_sound_get_data_format(&_ma_sound, nullptr, &channels, &_sampleRate, nullptr, 0);
     if (result != MA_SUCCESS || _sampleRate == 0) {
         vxlog_error("[vx::audio::Sound] failed to retreive format.");
         return false;
     }
 
     ma_uint64 nbFrames;
-    result = ma_data_source_get_length_in_pcm_frames(&_ma_sound, &nbFrames);
+    result = ma_sound_get_length_in_pcm_frames(&_ma_sound, &nbFrames);
     if (result != MA_SUCCESS) {
         nbFrames = static_cast<ma_uint64>(this->getNbSamplesFromOggFile());
     }
 
     _originalDuration = static_cast<float>(nbFrames) / static_cast<float>(_sampleRate);
 
+    if (flags & MA_SOUND_FLAG_DECODE) {
+        // engine's resource manager decodes to f32
+        engine->_decodedSoundDidLoad(soundName, static_cast<size_t>(nbFrames) * channels * sizeof(float));
+    }
+
     // reset
     result = ma_sound_seek_to_pcm_frame(&_ma_sound, 0);
     if (result != MA_SUCCESS) {
@@ -443,6 +621,10 @@ void Sound::play() {
 
     ma_sound_set_looping(&_ma_sound, _looping);
 
+    if (_engine->_acquireVoice(this) == false) {
+        return; // voice budget used by more important sounds
+    }
+
     _timeSinceStartOfPlay = 0.0;
     _timeSinceStartOfFade = -1.0;
 
@@ -660,6 +842,32 @@ void Sound::setPosition(const float x, const float y, const float z) {
     ma_sound_set_position(&_ma_sound, x, y, z);
 }
 
+bool Sound::_usesVoice() {
+    // fading out sounds are about to stop, they don't count
+    return _playScheduled || (_timeSinceStartOfFade < 0.0 && ma_sound_is_playing(&_ma_sound) == MA_TRUE);
+}
+
+float Sound::_getAudibility() {
+    if (ma_sound_is_spatialization_enabled(&_ma_sound) == MA_FALSE) {
+        return _volume;
+    }
+    const ma_vec3f p = ma_sound_get_position(&_ma_sound);
+    const ma_vec3f l = ma_engine_listener_get_position(&_engine->_engine, 0);
+    const float dx = p.x - l.x;
+    const float dy = p.y - l.y;
+    const float dz = p.z - l.z;
+    const float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+    const float minDistance = ma_sound_get_min_distance(&_ma_sound);
+    const float maxDistance = ma_sound_get_max_distance(&_ma_sound);
+    if (distance <= minDistance) {
+        return _volume;
+    }
+    if (distance >= maxDistance) {
+        return 0.0f;
+    }
+    return _volume * (1.0f - (distance - minDistance) / (maxDistance - minDistance));
+}
+
 ma_uint32 Sound::getNbSamplesFromOggFile() {
     bool inCache = false;
 
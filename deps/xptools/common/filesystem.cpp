@@ -13,11 +13,52 @@
 #include <cstdio>
 #include <fstream>
 
+// C
+#if defined(__VX_PLATFORM_WINDOWS)
+#include <windows.h>
+#elif !defined(__VX_PLATFORM_WASM)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 // xptools
 #include "vxlog.h"
 
+// zlib
+#include <zlib.h>
+
 using namespace vx::fs;
 
+// Asset archive layout (little-endian), as written by core's asset_archive.c (`cubzh_cli pack`).
+// Read here, xptools doesn't depend on core.
+#define ARCHIVE_MAGIC "CZHA"
+#define ARCHIVE_MAGIC_SIZE 4
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_COMPRESSION_NONE 0
+#define ARCHIVE_COMPRESSION_ZLIB 1
+
+typedef struct {
+    char magic[ARCHIVE_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t pathsSize;
+    uint64_t pathsOffset;
+    uint64_t totalSize;
+} ArchiveHeader; // 32 bytes
+
+struct vx::fs::Archive::Entry {
+    uint64_t pathHash; // FNV-1a 64, entries are sorted by hash
+    uint64_t dataOffset;
+    uint32_t pathOffset; // within paths
+    uint32_t pathLength;
+    uint32_t storedSize;
+    uint32_t size;
+    uint32_t compression;
+    uint32_t pad;
+}; // 40 bytes
+
 size_t vx::fs::getFileSize(FILE *fp) {
     long off = 0;
     long sz = 0;
@@ -197,6 +238,224 @@ InMemoryFile::~InMemoryFile() {
     free(this->bytes);
 }
 
+// ------------------------------
+// Archive
+// ------------------------------
+
+vx::fs::Archive::Archive() :
+_entries(nullptr),
+_entryCount(0),
+_paths(nullptr),
+_bytes(nullptr),
+_size(0),
+_mappingHandle(nullptr) {}
+
+vx::fs::Archive::~Archive() {
+#if defined(__VX_PLATFORM_WINDOWS)
+    if (_bytes != nullptr) {
+        UnmapViewOfFile(_bytes);
+    }
+    if (_mappingHandle != nullptr) {
+        CloseHandle(static_cast<HANDLE>(_mappingHandle));
+        _mappingHandle = nullptr;
+    }
+#elif defined(__VX_PLATFORM_WASM)
+    free(_bytes);
+#else
+    if (_bytes != nullptr) {
+        munmap(_bytes, _size);
+    }
+#endif
+    _bytes = nullptr;
+}
+
+std::shared_ptr<Archive> vx::fs::Archive::open(const std::string& absPath) {
+    std::shared_ptr<Archive> archive(new Archive());
+
+#if defined(__VX_PLATFORM_WINDOWS)
+    HANDLE file = CreateFileA(absPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file); // mapping keeps file open
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+    archive->_mappingHandle = mapping;
+    archive->_bytes = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (archive->_bytes == nullptr) {
+        return nullptr;
+    }
+    archive->_size = static_cast<size_t>(fileSize.QuadPart);
+#elif defined(__VX_PLATFORM_WASM)
+    // no mapping, file system is in memory anyway
+    FILE *fd = openFile(absPath);
+    archive->_bytes = getFileContent(fd, &archive->_size);
+    if (archive->_bytes == nullptr) {
+        return nullptr;
+    }
+#else
+    const int fd = ::open(absPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat stat_buf;
+    if (fstat(fd, &stat_buf) != 0 || stat_buf.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    void *bytes = mmap(nullptr, static_cast<size_t>(stat_buf.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // mapping keeps file open
+    if (bytes == MAP_FAILED) {
+        return nullptr;
+    }
+    archive->_bytes = bytes;
+    archive->_size = static_cast<size_t>(stat_buf.st_size);
+#endif
+
+    if (archive->_index() == false) {
+        vxlog_error("[Archive::open] invalid archive: %s", absPath.c_str());
+        return nullptr;
+    }
+    return archive;
+}
+
+bool vx::fs::Archive::contains(const std::string& path) const {
+    uint32_t index;
+    return _find(path, index);
+}
+
+bool vx::fs::Archive::getView(const std::string& path, const void*& data, size_t& size) const {
+    uint32_t index;
+    if (_find(path, index) == false || _entries[index].compression != ARCHIVE_COMPRESSION_NONE) {
+        return false; // not found or compressed
+    }
+    data = static_cast<const uint8_t*>(_bytes) + _entries[index].dataOffset;
+    size = _entries[index].size;
+    return true;
+}
+
+void *vx::fs::Archive::getContent(const std::string& path, size_t *outDataSize) const {
+    uint32_t index;
+    if (_find(path, index) == false) {
+        return nullptr;
+    }
+    const Entry& e = _entries[index];
+    const uint8_t *stored = static_cast<const uint8_t*>(_bytes) + e.dataOffset;
+
+    // malloc(0) may return nullptr
+    void *content = malloc(e.size > 0 ? e.size : 1);
+    if (content == nullptr) {
+        return nullptr;
+    }
+    if (e.compression == ARCHIVE_COMPRESSION_ZLIB) {
+        uLongf resultSize = e.size;
+        if (uncompress(static_cast<Bytef*>(content), &resultSize, stored, e.storedSize) != Z_OK ||
+            resultSize != e.size) {
+            free(content);
+            return nullptr;
+        }
+    } else {
+        memcpy(content, stored, e.size);
+    }
+    if (outDataSize != nullptr) {
+        *outDataSize = e.size;
+    }
+    return content;
+}
+
+std::vector<std::string> vx::fs::Archive::getPaths() const {
+    std::vector<std::string> paths;
+    paths.reserve(_entryCount);
+    for (uint32_t i = 0; i < _entryCount; ++i) {
+        paths.push_back(std::string(_paths + _entries[i].pathOffset, _entries[i].pathLength));
+    }
+    return paths;
+}
+
+bool vx::fs::Archive::_index() {
+    if (_bytes == nullptr || _size < sizeof(ArchiveHeader)) {
+        return false;
+    }
+    ArchiveHeader header;
+    memcpy(&header, _bytes, sizeof(ArchiveHeader));
+    if (memcmp(header.magic, ARCHIVE_MAGIC, ARCHIVE_MAGIC_SIZE) != 0 ||
+        header.version != ARCHIVE_VERSION || header.totalSize != _size) {
+        return false;
+    }
+
+    // written not to overflow with crafted offsets
+    const uint64_t entriesEnd = sizeof(ArchiveHeader) +
+                                static_cast<uint64_t>(header.entryCount) * sizeof(Entry);
+    if (entriesEnd > header.pathsOffset || header.pathsOffset > _size ||
+        header.pathsSize > _size - header.pathsOffset) {
+        return false;
+    }
+
+    const uint8_t *bytes = static_cast<const uint8_t*>(_bytes);
+    const Entry *entries = reinterpret_cast<const Entry*>(bytes + sizeof(ArchiveHeader));
+    const char *paths = reinterpret_cast<const char*>(bytes + header.pathsOffset);
+
+    // validate entries once, so that lookups don't have to
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        const Entry& e = entries[i];
+        if (static_cast<uint64_t>(e.pathOffset) + e.pathLength >= header.pathsSize ||
+            paths[e.pathOffset + e.pathLength] != '\0' || e.dataOffset > _size ||
+            e.storedSize > _size - e.dataOffset ||
+            (i > 0 && entries[i - 1].pathHash > e.pathHash)) {
+            return false;
+        }
+        if (e.compression == ARCHIVE_COMPRESSION_NONE) {
+            if (e.storedSize != e.size) {
+                return false;
+            }
+        } else if (e.compression != ARCHIVE_COMPRESSION_ZLIB) {
+            return false;
+        }
+    }
+
+    _entries = entries;
+    _entryCount = header.entryCount;
+    _paths = paths;
+    return true;
+}
+
+bool vx::fs::Archive::_find(const std::string& path, uint32_t& index) const {
+    uint64_t h = 14695981039346656037ULL; // FNV-1a 64
+    for (const char c : path) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ULL;
+    }
+
+    // lower bound
+    uint32_t lo = 0;
+    uint32_t hi = _entryCount;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (_entries[mid].pathHash < h) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // collisions are next to each other
+    for (uint32_t i = lo; i < _entryCount && _entries[i].pathHash == h; ++i) {
+        const Entry& e = _entries[i];
+        if (e.pathLength == path.size() && memcmp(_paths + e.pathOffset, path.data(), path.size()) == 0) {
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
 // ------------------------------
 // Helper
 // ------------------------------
@@ -214,6 +473,11 @@ vx::fs::Helper::Helper() {
     this->_thumbnailCallback = nullptr;
     this->_inMemoryStorage = false;
     this->_inMemoryFiles = std::map<std::string, InMemoryFile*>();
+    this->_bundleOverlay = false;
+    this->_bundleOverlays = std::vector<std::pair<std::string, std::string>>();
+    this->_bundleOverlayRemovedPaths = std::set<std::string>();
+    this->_bundleArchive = nullptr;
+    this->_bundleArchiveMounted = false;
     this->_storageRelPathPrefix = "";
 }
 
@@ -265,6 +529,106 @@ InMemoryFile* vx::fs::Helper::createInMemoryFile(std::string path, size_t size)
     return inMemFile;
 }
 
+bool vx::fs::Helper::bundleOverlay() {
+    return this->_bundleOverlay;
+}
+
+/// Returns true if `path` is `dir` or a path within it (whole path components),
+/// any path is within an empty `dir`.
+static bool isPathWithinDir(const std::string& path, const std::string& dir) {
+    if (dir.empty()) {
+        return true;
+    }
+    if (path.compare(0, dir.length(), dir) != 0) {
+        return false;
+    }
+    return path.length() == dir.length() || path[dir.length()] == '/';
+}
+
+void vx::fs::Helper::addBundleOverlay(const std::string& storageDir, const std::string& bundleDir) {
+    std::string storagePrefix = storageDir;
+    while (storagePrefix.empty() == false && storagePrefix.back() == '/') {
+        storagePrefix.pop_back();
+    }
+    std::string bundlePrefix = bundleDir;
+    while (bundlePrefix.empty() == false && bundlePrefix.back() == '/') {
+        bundlePrefix.pop_back();
+    }
+    // merging again brings back removed bundle files, as a copy would
+    for (auto it = this->_bundleOverlayRemovedPaths.begin(); it != this->_bundleOverlayRemovedPaths.end();) {
+        if (isPathWithinDir(*it, storagePrefix)) {
+            it = this->_bundleOverlayRemovedPaths.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (std::pair<std::string, std::string>& overlay : this->_bundleOverlays) {
+        if (overlay.first == storagePrefix) {
+            overlay.second = bundlePrefix;
+            return;
+        }
+    }
+    this->_bundleOverlays.push_back(std::make_pair(storagePrefix, bundlePrefix));
+}
+
+bool vx::fs::Helper::getBundleOverlayPath(const std::string& relStoragePath, std::string& relBundlePath) {
+    for (const std::string& removedPath : this->_bundleOverlayRemovedPaths) {
+        if (isPathWithinDir(relStoragePath, removedPath)) {
+            return false;
+        }
+    }
+    for (const std::pair<std::string, std::string>& overlay : this->_bundleOverlays) {
+        const std::string& storagePrefix = overlay.first;
+        if (isPathWithinDir(relStoragePath, storagePrefix) == false) {
+            continue;
+        }
+        std::string rest = relStoragePath.substr(storagePrefix.length());
+        if (rest.empty() == false && rest.front() == '/') {
+            rest.erase(0, 1);
+        }
+        if (overlay.second.empty()) {
+            relBundlePath = rest;
+        } else {
+            relBundlePath = rest.empty() ? overlay.second : overlay.second + "/" + rest;
+        }
+        return true;
+    }
+    return false;
+}
+
+void vx::fs::Helper::removeBundleOverlayPath(const std::string& relStoragePath) {
+    std::string path = relStoragePath;
+    while (path.empty() == false && path.back() == '/') {
+        path.pop_back();
+    }
+    this->_bundleOverlayRemovedPaths.insert(path);
+}
+
+void vx::fs::Helper::setBundleArchive(const std::shared_ptr<Archive>& archive) {
+    const std::lock_guard<std::mutex> lock(this->_bundleArchiveMutex);
+    this->_bundleArchive = archive;
+    this->_bundleArchiveMounted = true;
+}
+
+bool vx::fs::Helper::mountBundleArchive() {
+    std::shared_ptr<Archive> archive = Archive::open(getBundleFilePath(VX_BUNDLE_ARCHIVE_FILENAME));
+    setBundleArchive(archive);
+    return archive != nullptr;
+}
+
+std::shared_ptr<Archive> vx::fs::Helper::getBundleArchive() {
+    {
+        const std::lock_guard<std::mutex> lock(this->_bundleArchiveMutex);
+        if (this->_bundleArchiveMounted) {
+            return this->_bundleArchive;
+        }
+    }
+    // first bundle lookup
+    mountBundleArchive();
+    const std::lock_guard<std::mutex> lock(this->_bundleArchiveMutex);
+    return this->_bundleArchive;
+}
+
 #if !defined(__VX_PLATFORM_WASM)
 void vx::fs::syncFSToDisk() {
     // nothing on non-web platforms
@@ -451,6 +815,9 @@ bool c_mergeBundleDirInStorage(const char *bundleDir, const char *storageDir) {
     std::string bundleDirStr(bundleDir);
     std::string storageDirStr(storageDir);
 
+    // bundle files are read in place where supported, instead of being copied
+    vx::fs::Helper::shared()->setBundleOverlay(true);
+
     return vx::fs::mergeBundleDirInStorage(bundleDirStr, storageDirStr);
 }
 
@@ -249,9 +249,9 @@ TrackingClient::TrackingClient(const std::string& host,
     _session_used_at = 0;
     _keep_alive_activated = false;
 
-    // default queue used by tracking client
+    // default queue used by tracking client, serial as events & keep alive share session state
     // this could become configurable.
-    _operationQueue = OperationQueue::getBackground();
+    _operationQueue = OperationQueue::getSerialBackground();
     _operationQueue->schedule([](){
         TrackingClient::shared()._sendKeepAliveEventIfNeeded();
     }, KEEP_ALIVE_DELAY);
@@ -8,75 +8,237 @@
 #pragma once
 
 // C++
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <vector>
 
 namespace vx {
 
-/// simple-duplex channel
+/// Simple-duplex channel, any number of threads can push and pop.
+///
+/// Messages go through a lock-free bounded ring (each cell carries a sequence number telling
+/// whether it can be written or read, both ends are claimed w/ a CAS). When the ring is full,
+/// producers fall back to a mutex-guarded overflow queue, so a push never fails nor blocks on
+/// consumers.
+/// Once a message is in the overflow queue, following pushes go there too until it has been
+/// drained, so messages from a given producer are popped in push order. With several consumers
+/// (e.g. Connection's ReceiveBuffer pool), pops from different threads may complete in any order.
 template <typename T>
 class Channel final {
 
 public:
-    
-    Channel();
+
+    /// `capacity` of the lock-free ring, rounded up to a power of 2
+    Channel(size_t capacity = 256);
     ~Channel();
-    
+
     ///
     void push(T msg);
-    
+
     ///
     void pushMove(T&& msg);
 
+    /// Pushes only if the lock-free ring has room (not using overflow queue),
+    /// returns false otherwise. Makes the channel usable as a bounded pool.
+    bool tryPush(T&& msg);
+
     /// Returns true when a message has been popped
     bool pop(T& msgRef);
-    
+
+    /// Pops all available messages, appending them to `msgs`. Returns number of messages popped.
+    size_t popAll(std::vector<T>& msgs);
+
     void clear();
-    
+
 private:
-    
-    std::mutex _mutex;
-    std::queue<T> _queue;
-    
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    bool _tryPushRing(T& msg);
+    bool _tryPopRing(T& msgRef);
+
+    /// Messages in the overflow queue have been pushed after the ones in the ring,
+    /// they can only be popped once it is drained. To be called with _overflowMutex locked,
+    /// which guarantees ring pushes preceding overflow pushes are visible.
+    bool _ringDrained() const;
+
+    std::unique_ptr<Cell[]> _cells;
+    size_t _mask;
+
+    // producer & consumer positions padded on their own cache lines, not to share them
+    // when contended (padding rather than alignas, not to require aligned allocations)
+    char _pad0[64];
+    std::atomic<size_t> _enqueuePos;
+    char _pad1[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> _dequeuePos;
+    char _pad2[64 - sizeof(std::atomic<size_t>)];
+
+    std::atomic<size_t> _overflowSize;
+    std::mutex _overflowMutex;
+    std::deque<T> _overflow;
+
 };
 
 // Full definition must be available here for template classes
 
 template <typename T>
-Channel<T>::Channel() :
-_mutex(),
-_queue() {}
+Channel<T>::Channel(size_t capacity) :
+_cells(),
+_mask(0),
+_pad0(),
+_enqueuePos(0),
+_pad1(),
+_dequeuePos(0),
+_pad2(),
+_overflowSize(0),
+_overflowMutex(),
+_overflow() {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    _cells.reset(new Cell[size]);
+    _mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
 
 template <typename T>
 Channel<T>::~Channel() {}
 
 template <typename T>
 void Channel<T>::push(T msg) {
-    const std::lock_guard<std::mutex> locker(_mutex);
-    _queue.push(msg);
+    this->pushMove(std::move(msg));
 }
 
 template <typename T>
 void Channel<T>::pushMove(T&& msg) {
-    const std::lock_guard<std::mutex> locker(_mutex);
-    _queue.push(std::move(msg));
+    if (_overflowSize.load(std::memory_order_acquire) == 0 && this->_tryPushRing(msg)) {
+        return;
+    }
+    const std::lock_guard<std::mutex> locker(_overflowMutex);
+    _overflow.push_back(std::move(msg));
+    _overflowSize.fetch_add(1, std::memory_order_release);
+}
+
+template <typename T>
+bool Channel<T>::tryPush(T&& msg) {
+    return _overflowSize.load(std::memory_order_acquire) == 0 && this->_tryPushRing(msg);
 }
 
 template <typename T>
 bool Channel<T>::pop(T& msgRef) {
-    const std::lock_guard<std::mutex> locker(_mutex);
-    if (_queue.empty()) { return false; }
-    msgRef = _queue.front();
-    _queue.pop();
+    if (this->_tryPopRing(msgRef)) {
+        return true;
+    }
+    if (_overflowSize.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    const std::lock_guard<std::mutex> locker(_overflowMutex);
+    if (this->_ringDrained() == false) {
+        // ring looked empty but has been filled since, or a push is in progress
+        return this->_tryPopRing(msgRef);
+    }
+    if (_overflow.empty()) { return false; }
+    msgRef = std::move(_overflow.front());
+    _overflow.pop_front();
+    _overflowSize.fetch_sub(1, std::memory_order_release);
     return true;
 }
 
+template <typename T>
+size_t Channel<T>::popAll(std::vector<T>& msgs) {
+    const size_t n = msgs.size();
+    T msg;
+    while (this->_tryPopRing(msg)) {
+        msgs.push_back(std::move(msg));
+    }
+    if (_overflowSize.load(std::memory_order_acquire) > 0) {
+        const std::lock_guard<std::mutex> locker(_overflowMutex);
+        while (this->_tryPopRing(msg)) {
+            msgs.push_back(std::move(msg));
+        }
+        if (this->_ringDrained() == false) {
+            return msgs.size() - n; // push in progress, overflow has to wait for it
+        }
+        for (T& m : _overflow) {
+            msgs.push_back(std::move(m));
+        }
+        _overflow.clear();
+        _overflowSize.store(0, std::memory_order_release);
+    }
+    return msgs.size() - n;
+}
+
 template <typename T>
 void Channel<T>::clear() {
-    const std::lock_guard<std::mutex> locker(_mutex);
-    std::queue<T> empty;
-    std::swap( _queue, empty );
+    T msg;
+    while (this->_tryPopRing(msg)) {}
+    std::deque<T> empty;
+    {
+        const std::lock_guard<std::mutex> locker(_overflowMutex);
+        std::swap(_overflow, empty);
+        _overflowSize.store(0, std::memory_order_release);
+    }
+}
+
+template <typename T>
+bool Channel<T>::_tryPushRing(T& msg) {
+    size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = _cells[pos & _mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            // cell is free, claim it
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.data = std::move(msg);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // full
+        } else {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
 }
 
+template <typename T>
+bool Channel<T>::_tryPopRing(T& msgRef) {
+    size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = _cells[pos & _mask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            // cell has been written, claim it (CAS keeps clear() safe from another thread)
+            if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                msgRef = std::move(cell.data);
+                cell.data = T();
+                cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // empty
+        } else {
+            pos = _dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool Channel<T>::_ringDrained() const {
+    return _enqueuePos.load(std::memory_order_acquire) ==
+           _dequeuePos.load(std::memory_order_acquire);
+}
 
 } // namespace vx
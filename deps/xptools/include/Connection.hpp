@@ -13,8 +13,10 @@
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <atomic>
 
 #include "Channel.hpp"
+#include "Macros.h"
 
 namespace vx {
 
@@ -35,6 +37,51 @@ public:
     
     class Payload;
     typedef std::shared_ptr<Payload> Payload_SharedPtr;
+
+    /// Growable byte buffer with a single owner, recycled through a pool once released.
+    /// Received message fragments are appended into it and the decoded Payload adopts it,
+    /// so bytes are never copied again after leaving the network layer's buffer.
+    class ReceiveBuffer final {
+    public:
+
+        /// Returns a buffer from the pool (or a new one)
+        static ReceiveBuffer *get();
+
+        /// Buffer goes back to the pool, or is freed if too big or if the pool is full
+        void release();
+
+        /// Appends bytes, growing capacity if needed. Returns false on allocation failure.
+        bool append(const char *bytes, size_t len);
+
+        ///
+        char *getBytes();
+
+        ///
+        size_t getSize();
+
+    private:
+        ReceiveBuffer();
+        ~ReceiveBuffer();
+
+        VX_DISALLOW_COPY_AND_ASSIGN(ReceiveBuffer)
+
+        /// Pooled buffers are freed when the pool is destroyed (at exit),
+        /// buffers released after that are freed directly.
+        class Pool final {
+        public:
+            Pool();
+            ~Pool();
+            // buffers are released on game threads and taken back on the network thread
+            Channel<ReceiveBuffer*> buffers;
+            std::atomic<bool> destroyed;
+        };
+
+        static Pool _pool;
+
+        char *_bytes;
+        size_t _size;
+        size_t _capacity;
+    };
     
     ///
     class Payload final {
@@ -47,6 +94,12 @@ public:
             PayloadID = 1,
             CreatedAt = 2,
             TravelHistory = 4,
+            // content is deflated, prefixed with its uncompressed size (uint32)
+            // only sent to peers accepting compression
+            Compressed = 8,
+            // set by senders able to decode compressed payloads, on the wire only
+            // (ignored by peers that don't know about it)
+            AcceptsCompression = 16,
         } Includes;
         
         typedef struct Step {
@@ -65,9 +118,19 @@ public:
         // used to trigger a meant to fail write operation, in order to close the connection.
         static Payload_SharedPtr createDummy();
         static Payload_SharedPtr decode(char *bytes, size_t len);
+        // decodes bytes in place, adopting caller's reference on `buffer` (released even
+        // when returning nullptr)
+        static Payload_SharedPtr decode(ReceiveBuffer *buffer);
         static Payload_SharedPtr copy(const Payload_SharedPtr& p);
         
         ~Payload();
+
+        // Returns compressed version of this Payload, computed once and shared by all
+        // connections writing it. Returns nullptr if compression doesn't make it smaller.
+        Payload_SharedPtr getCompressed();
+
+        // Returns true if decoded Payload's sender can decode compressed Payloads
+        bool acceptsCompression();
         
         // Returns start of _content
         char* getContent();
@@ -131,6 +194,22 @@ public:
         char *_decoded;
         size_t _decodedLen;
 
+        // When decoded from a ReceiveBuffer, _decoded
+        // points to its bytes, and the buffer is
+        // released instead of freeing _decoded.
+        ReceiveBuffer *_buffer;
+
+        // Content inflated from a compressed Payload,
+        // _content points to it when not NULL.
+        char *_inflated;
+
+        // See getCompressed
+        std::once_flag _compressedOnce;
+        Payload_SharedPtr _compressed;
+
+        // Set when decoding, if sender included AcceptsCompression
+        bool _acceptsCompression;
+
         // Only used when including CreatedAt
         uint64_t _createdAt; // ms timestamp
         
@@ -197,11 +276,43 @@ public:
     virtual size_t write(char *buf, size_t len, bool& isFirstFragment, bool& partial) = 0;
     
     virtual bool doneWriting() = 0;
+
+    // ------------------
+    // COMPRESSION
+    // ------------------
+
+    /// Opt-in per-message compression. When enabled, the connection advertises it can decode
+    /// compressed Payloads, and deflates Payloads of at least `minSize` bytes if the peer
+    /// advertised it too. Smaller Payloads are not worth the CPU time.
+    void setCompression(bool enabled, size_t minSize = 512);
+
+    ///
+    bool isCompressionEnabled();
+
+protected:
+
+    Connection();
+
+    /// Returns Payload to write in place of `p`: its compressed version if compression is
+    /// enabled, accepted by the peer and worth it.
+    Payload_SharedPtr _compressIfNeeded(const Payload_SharedPtr& p);
+
+    /// Flags to add to the includes byte of written Payloads
+    uint8_t _advertisedIncludes();
+
+    /// To be called with each received Payload
+    void _didReceivePayload(const Payload_SharedPtr& p);
     
 private:
     
     ///
     std::weak_ptr<ConnectionDelegate> _delegate;
+
+    std::atomic<bool> _compressionEnabled;
+    std::atomic<size_t> _compressionMinSize;
+
+    /// set once peer advertised it can decode compressed Payloads
+    std::atomic<bool> _peerAcceptsCompression;
 };
 
 ///  Interface
@@ -9,9 +9,12 @@
 #pragma once
 
 // C++
+#include <atomic>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <unordered_map>
 #include <unordered_set>
 
 // xptools
@@ -19,6 +22,8 @@
 #include "URL.hpp"
 
 #define VX_HTTP_CACHE_DIR_NAME "http_cache"
+// cache accesses are sharded by URL hash, each shard with its own lock
+#define VX_HTTP_CACHE_SHARDS 16
 
 // HTTP status codes
 #define HTTP_OK 200
@@ -151,6 +156,27 @@ public:
 
 #endif
 
+    // Request coalescing: identical GET requests (same URL & headers) sent while one is
+    // in flight don't go through the network, they receive the in-flight request's response.
+
+    /// Attaches `req` to the in-flight request with the same key and returns true.
+    /// Returns false if there's none, `req` then becomes the in-flight request for that key.
+    bool attachToInFlightGET(const std::string& key, const HttpRequest_SharedPtr& req);
+
+    /// Called when in-flight request is done, returns requests waiting for its response.
+    std::vector<HttpRequest_SharedPtr> removeInFlightGET(const std::string& key, const HttpRequest_WeakPtr& req);
+
+    /// Called when cancelling `req`, returns true if it was itself waiting (not sent), nothing
+    /// else to do. Otherwise `req` has to be cancelled: if it was the in-flight request, the first
+    /// waiting request takes its place and is returned in `nextInFlight`, to be sent.
+    bool cancelInFlightGET(const std::string& key,
+                           const HttpRequest_SharedPtr& req,
+                           HttpRequest_SharedPtr& nextInFlight);
+
+    /// GET requests sent through the network / attached to an in-flight request
+    uint64_t getNetworkGETsCount();
+    uint64_t getCoalescedGETsCount();
+
     static void run_unit_tests();
 
     // --------------------------------------------------
@@ -174,20 +200,94 @@ private:
 
     // HTTP Caching
 
-    std::mutex _cacheMutex;
+    /// Cached response, as stored in cache files
+    typedef struct CacheEntry {
+        std::string url;
+        std::string etag;
+        uint32_t creationTime; // seconds since 2001/01/01
+        uint32_t maxAge; // seconds
+        uint16_t statusCode;
+        HttpHeaders headers;
+        std::string body;
+        size_t size; // approximate memory footprint
+    } CacheEntry;
+    typedef std::shared_ptr<const CacheEntry> CacheEntry_SharedPtr;
+
+    /// Lock & in-memory LRU for URLs hashing to the same shard.
+    /// Requests for URLs in different shards don't wait for each other.
+    typedef struct CacheShard {
+        std::mutex mutex;
+        // URL hashes, most recently used first
+        std::list<std::string> lru;
+        std::unordered_map<std::string, std::pair<CacheEntry_SharedPtr, std::list<std::string>::iterator>> entries;
+        size_t bytes = 0;
+    } CacheShard;
+
+    CacheShard _cacheShards[VX_HTTP_CACHE_SHARDS];
+
+    /// Index of cache files, to cap the size of the disk cache.
+    /// Built before first write, w/o holding any lock. Lock can be acquired while holding
+    /// a shard lock (never the opposite).
+    std::mutex _diskCacheMutex;
+    std::once_flag _diskCacheIndexedOnce;
+    // URL hashes, most recently used first
+    std::list<std::string> _diskCacheLRU;
+    std::unordered_map<std::string, std::pair<size_t, std::list<std::string>::iterator>> _diskCacheFiles;
+    size_t _diskCacheBytes;
 
     CallbackMiddleware _callbackMiddleware;
 
+    // Request coalescing
+
+    typedef struct InFlightGET {
+        // request sent through the network
+        HttpRequest_WeakPtr request;
+        // identical requests waiting for its response
+        std::vector<HttpRequest_SharedPtr> waiting;
+    } InFlightGET;
+
+    std::mutex _inFlightGETsMutex;
+    std::unordered_map<std::string, InFlightGET> _inFlightGETs;
+    std::atomic<uint64_t> _networkGETsCount;
+    std::atomic<uint64_t> _coalescedGETsCount;
+
+    CacheShard& _getCacheShard(const std::string& urlHash);
+
+    // in-memory cache, to be called with shard locked
+    static CacheEntry_SharedPtr _memoryCacheGet(CacheShard& shard, const std::string& urlHash);
+    static void _memoryCacheSet(CacheShard& shard, const std::string& urlHash, const CacheEntry_SharedPtr& entry);
+    static void _memoryCacheRemove(CacheShard& shard, const std::string& urlHash);
+
+    // disk cache index
+    // to be called with shard locked, least recently used files are moved to `evicted`
+    void _diskCacheDidWrite(const std::string& urlHash, const size_t size, std::vector<std::string>& evicted);
+    // to be called w/o any lock, removes files of evicted entries under their shard lock
+    void _diskCacheRemoveEvicted(const std::vector<std::string>& evicted);
+    void _diskCacheDidRead(const std::string& urlHash);
+    void _diskCacheDidRemove(const std::string& urlHash);
+    void _diskCacheIndexIfNeeded();
+
+    /// Reads & parses cache file, returns nullptr if it can't be used
+    static CacheEntry_SharedPtr _cacheReadFile(FILE * const fd);
+
     // file utils
     static bool _cacheWriteFileHeader(const uint8_t fileFormatVersion, const uint8_t compressionMethod, FILE * const fd);
     static bool _cacheWriteUint32Chunk(const uint8_t chunkID, const uint32_t chunkValue, FILE * const fd);
-    static bool _cacheWriteStringChunk(const uint8_t chunkID, const std::string chunkValue, FILE * const fd);
+    static bool _cacheWriteStringChunk(const uint8_t chunkID, const std::string& chunkValue, FILE * const fd);
+    static bool _cacheWriteCompressedStringChunk(const uint8_t chunkID,
+                                                 const std::string& compressedValue,
+                                                 const uint32_t uncompressedSize,
+                                                 FILE * const fd);
     static bool _cacheWriteMapStringStringChunk(const uint8_t chunkID,
                                                 const std::unordered_map<std::string, std::string>& chunkValue,
                                                 FILE * const fd);
     static bool _cacheReadFileHeader(uint8_t *fileFormatVersion, uint8_t *compressionMethod, FILE * const fd);
     static bool _cacheReadUint32Chunk(const uint8_t chunkID, uint32_t& chunkValue, FILE * const fd);
     static bool _cacheReadStringChunk(const uint8_t chunkID, std::string& chunkValue, FILE * const fd);
+    static bool _cacheReadCompressedStringChunk(const uint8_t chunkID, std::string& chunkValue, FILE * const fd);
+
+    /// Returns true if compressing `value` is worth it, `compressed` then contains compressed bytes
+    static bool _cacheCompress(const std::string& value, std::string& compressed);
     static bool _cacheReadMapStringStringChunk(const uint8_t chunkID,
                                                std::unordered_map<std::string, std::string>& chunkValue,
                                                FILE * const fd);
@@ -189,6 +189,18 @@ private:
     void _useCachedResponse();
 #endif
 
+    /// Key identifying identical GET requests, empty if not in flight through HttpClient
+    std::string _coalescingKey;
+
+    /// true if response has been received by an identical in-flight request
+    bool _coalesced;
+
+    ///
+    std::string _makeCoalescingKey();
+
+    /// Gives response to identical requests waiting for it
+    void _callCoalescedCallbacks();
+
     /// Request fields
     std::string _method;
     std::string _host;
@@ -8,6 +8,7 @@
 #pragma once
 
 // C++
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 
@@ -76,10 +77,12 @@ private:
     Status _status;
     std::mutex _statusMutex;
     
-    /// thread processing the received bytes
+    /// thread processing the received bytes, sleeping until woken by a push or exit request
     std::thread _thread;
     bool _threadShouldExit;
-    std::mutex _threadShouldExitMutex;
+    bool _threadShouldWake;
+    std::mutex _threadMutex;
+    std::condition_variable _threadCondition;
     
     /// Bytes received from the other side.
     Channel<Payload_SharedPtr> _receivedBytes;
@@ -10,8 +10,17 @@
 // C++
 #include <future>
 #include <queue>
-#include <map>
 #include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#ifndef __VX_SINGLE_THREAD
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#endif
 
 // xptools
 #include "Macros.h"
@@ -37,6 +46,9 @@ public:
 
     ///
     typedef std::function<void(void)> fp_t;
+
+    /// Identifies a scheduled operation, to cancel it. 0 is never a valid timer.
+    typedef uint64_t TimerID;
     
     ///
     static OperationQueue *getMain();
@@ -44,11 +56,20 @@ public:
     ///
     static OperationQueue *getServerMain();
     
-    ///
+    /// Pool of worker threads, operations may run concurrently and complete in any order
     static OperationQueue *getBackground();
 
-    ///
+    /// Pool of worker threads meant for long operations, so they don't delay the ones
+    /// dispatched on the background queue
     static OperationQueue *getSlowBackground();
+
+    /// Single worker thread, operations run one at a time, in dispatch order
+    static OperationQueue *getSerialBackground();
+
+    /// Number of worker threads for background queues, only considered if called
+    /// before the queue is first accessed. (0: default)
+    static void setBackgroundThreadCount(unsigned int n);
+    static void setSlowBackgroundThreadCount(unsigned int n);
     
     /// Destructor
     virtual ~OperationQueue();
@@ -59,11 +80,16 @@ public:
     /// dispatch and move
     void dispatch(fp_t&& op);
     
-    /// dispatch and copy, to be triggered in `ms` milliseconds
-    void schedule(const fp_t& op, int64_t ms);
+    /// dispatch and copy, to be triggered in `ms` milliseconds (monotonic clock)
+    /// Operations scheduled for the same time are triggered in scheduling order.
+    /// Returns 0 if `ms` is negative (not scheduled).
+    TimerID schedule(const fp_t& op, int64_t ms);
     
-    /// dispatch and move, to be triggered in `ms` milliseconds
-    void schedule(const fp_t&& op, int64_t ms);
+    /// dispatch and move, to be triggered in `ms` milliseconds (monotonic clock)
+    TimerID schedule(fp_t&& op, int64_t ms);
+
+    /// Cancels a scheduled operation, returns false if it was already triggered or cancelled
+    bool cancel(TimerID timer);
     
     /// dispatch (in front of queue) and copy
     void dispatchFirst(const fp_t& op);
@@ -94,14 +120,36 @@ private:
     ///
     static OperationQueue *_slowBackgroundQueue;
 
+    ///
+    static OperationQueue *_serialBackgroundQueue;
+
+    ///
+    static unsigned int _backgroundThreadCount;
+
+    ///
+    static unsigned int _slowBackgroundThreadCount;
+
     /// Constructor
-    OperationQueue(Type type);
+    OperationQueue(Type type, unsigned int nbWorkers = 1);
     
     /// tasks queue
     std::deque<fp_t> _queue;
     
-    /// scheduled tasks queue
-    std::map<std::chrono::system_clock::time_point,fp_t> _queueScheduled;
+    ///
+    struct ScheduledOperation {
+        std::chrono::steady_clock::time_point time;
+        TimerID timer;
+        fp_t op;
+    };
+
+    /// scheduled tasks, binary min-heap ordered by time then timer ID
+    std::vector<ScheduledOperation> _queueScheduled;
+
+    /// position of each pending timer in _queueScheduled, for cancellation
+    std::unordered_map<TimerID, size_t> _scheduledIndexes;
+
+    ///
+    TimerID _nextTimer;
     
     /// queue type
     Type _type;
@@ -112,11 +160,57 @@ private:
     State _state;
 
     void startThreadIfNeeded();
+
+    /// scheduled tasks heap maintenance, to be called with _lock held
+    bool scheduledBefore(size_t a, size_t b) const;
+    void scheduledSwap(size_t a, size_t b);
+    void scheduledSiftUp(size_t i);
+    void scheduledSiftDown(size_t i);
+    fp_t scheduledRemove(size_t i);
+
+    /// pops first scheduled operation if it is due, to be called with _lock held
+    bool popDueScheduled(fp_t& op);
+
+    /// to be called with _lock held, after _queueScheduled changed
+    void scheduledUpdateNext();
 #ifndef __VX_SINGLE_THREAD
+    /// Each worker runs operations from its own queue first, then from the shared queue,
+    /// and steals from other workers when both are empty.
+    struct Worker {
+        std::mutex lock;
+        std::deque<fp_t> queue;
+        std::thread thread;
+    };
+
+    /// protects _queue, _queueScheduled, _scheduledIndexes & _state, used for workers to wait for operations
     std::mutex _lock;
-    std::thread _thread;
+    std::condition_variable _cv;
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    /// operations in _queue & worker queues, not yet popped
+    std::atomic<size_t> _nbPending;
+
+    /// workers waiting on _cv
+    std::atomic<unsigned int> _nbSleeping;
+
+    /// time of first scheduled operation (steady_clock ticks), max if none,
+    /// for workers to check for due operations without locking
+    std::atomic<std::chrono::steady_clock::rep> _nextScheduledTime;
+
+    /// set when destroying the queue, for workers to exit
+    bool _stopping;
+
+    /// pushes op in current worker queue if called from one of this queue's workers,
+    /// unless the queue has a single worker (serial)
+    bool dispatchFromWorker(fp_t&& op, bool first);
+
+    /// wakes up a sleeping worker, if any, after an operation has been added
+    void notifyWorker();
+
+    /// pops next operation for given worker, returns false if none is available
+    bool popOperation(size_t workerIdx, fp_t& op);
 
-    void threadFunction();
+    void threadFunction(size_t workerIdx);
 #endif
 };
 
@@ -152,8 +152,11 @@ private:
     std::mutex _wsiMutex;
 #endif
 
-    /// buffer for received bytes
-    std::string _receivedBytesBuffer;
+    /// buffer for received bytes of message being received, adopted by its Payload
+    Connection::ReceiveBuffer *_receivedBytesBuffer;
+
+    /// set when bytes of message being received could not be buffered
+    bool _receivedBytesDropped;
 
     /// `true` means "not currently writing
     bool _isWriting;
@@ -9,9 +9,14 @@
 #pragma once
 
 // C++
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #if defined(__VX_USE_LIBWEBSOCKETS)
 #pragma clang diagnostic push
@@ -59,10 +64,21 @@ public:
     ///
     inline WSServerDelegate* getDelegate() {return _delegate;}
 
+    /// Compression settings for connections established from now on
+    /// (see Connection::setCompression)
+    void setCompression(bool enabled, size_t minSize = 512);
+
+    /// Number of threads servicing sockets, to be set before listen().
+    /// 0 (default): sockets are serviced by the thread calling process().
+    /// N > 0: N services listen on the same port (SO_REUSEPORT), each one with its own
+    /// thread and connections, the kernel spreading incoming connections between them.
+    /// Delegates are then called from these threads.
+    void setServiceThreads(const size_t count);
+
     ///
     void listen();
     
-    ///
+    /// services sockets, when not using service threads
     void process();
     
     /// should be used only by LWS callback function
@@ -70,18 +86,50 @@ public:
     
     ///
     void scheduleWrite(WSServerConnection* conn);
+
+    /// Writes the same Payload to all active connections.
+    /// Its wire form (metadata, compressed version) is serialized once, shared by all
+    /// connections, and each service is woken up once. Payload must not be modified afterwards.
+    void broadcast(const Connection::Payload_SharedPtr& p);
+
+    /// Writes the same Payload to all active connections but one
+    void broadcast(const Connection::Payload_SharedPtr& p, const Connection_SharedPtr& except);
+
+    /// Writes the same Payload to given connections
+    void broadcast(const Connection::Payload_SharedPtr& p, const std::vector<Connection_SharedPtr>& conns);
     
-    ///
-    std::mutex& getContextMutex();
+    /// mutex of the service the connection belongs to
+    std::mutex& getContextMutex(WSBackend wsi);
     
-    ///
-    std::vector<WSServerConnection_WeakPtr>& getActiveConnections();
+    /// active connections of the service the connection belongs to,
+    /// to be accessed with its context mutex locked
+    std::vector<WSServerConnection_WeakPtr>& getActiveConnections(WSBackend wsi);
     
 private:
+
+    /// lws context and the connections it services
+    struct Service {
+        struct lws_context* context;
+        std::mutex contextMutex;
+        std::vector<WSServerConnection_WeakPtr> activeConnections;
+        std::thread thread;
+    };
     
     // --------------------------------------------------
     // Methods
     // --------------------------------------------------
+
+    ///
+    static Service *_getService(WSBackend wsi);
+
+    ///
+    void _serviceThreadFunction(Service *service);
+
+    /// all active connections, but `except`
+    std::vector<WSServerConnection_SharedPtr> _getActiveConnections(const Connection* except);
+
+    ///
+    void _broadcast(const Connection::Payload_SharedPtr& p, const std::vector<WSServerConnection_SharedPtr>& conns);
     
     // --------------------------------------------------
     // Fields
@@ -101,16 +149,21 @@ private:
 
     ///
     WSServerDelegate* _delegate;
-    
-    /// active connections
-    std::vector<WSServerConnection_WeakPtr> _activeConnections;
-    
-    // LWS
-    struct lws_context* _lws_context;
+
+    /// applied to new connections
+    bool _compressionEnabled;
+    size_t _compressionMinSize;
     
     ///
-    std::mutex _contextMutex;
-    
+    size_t _serviceThreadsCount;
+
+    /// one per service thread, or a single one serviced by process()
+    std::vector<std::unique_ptr<Service>> _services;
+
+    ///
+    std::atomic<bool> _servicesShouldExit;
+
+    // LWS
     struct lws_protocol_vhost_options _lws_pvo_wsserver;
     struct lws_protocol_vhost_options _lws_pvo_options;
     struct lws_protocol_vhost_options _lws_pvo_interrupted;
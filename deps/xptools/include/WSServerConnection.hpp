@@ -67,6 +67,10 @@ public:
     
     /// Pushes Payload to be written
     void pushPayloadToWrite(const Payload_SharedPtr& p) override;
+
+    /// Pushes Payload already serialized for several connections (see WSServer::broadcast),
+    /// without waking the server up. Returns true if it has to be woken up for it to be written.
+    bool pushSerializedPayloadToWrite(const Payload_SharedPtr& p);
     
     // Writes as much as possible in given buffer
     // Returns size written
@@ -104,8 +108,11 @@ private:
     Status _status;
     std::mutex _statusMutex;
     
-    /// buffer for received bytes
-    std::string _receivedBytesBuffer;
+    /// buffer for received bytes of message being received, adopted by its Payload
+    Connection::ReceiveBuffer *_receivedBytesBuffer;
+
+    /// set when bytes of message being received could not be buffered
+    bool _receivedBytesDropped;
     
     /// `true` means currently writing
     bool _isWriting;
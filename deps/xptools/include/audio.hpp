@@ -11,8 +11,12 @@
 #ifndef P3S_CLIENT_HEADLESS
 
 // C++
+#include <atomic>
+#include <list>
+#include <mutex>
 #include <string>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 // miniaudio
@@ -61,17 +65,68 @@ public:
     Listener *createListener();
 
     bool setVolume(float volumePercentage);
-    
+
+    /// Maximum number of voices playing at the same time. When a Sound starts playing
+    /// while the budget is used, the least important voice is stolen (see Sound::setPriority).
+    void setMaxVoices(const size_t maxVoices);
+
+    ///
+    inline size_t getMaxVoices() { return _maxVoices; }
+
+    /// Number of voices currently counted in the budget
+    size_t getPlayingVoicesCount();
+
+    /// Size in bytes of decoded PCM data kept in cache
+    inline size_t getDecodedCacheSize() { return _decodedCacheBytes; }
+
     // MARK: - Private -
 private:
-    
+
+    /// Short sounds are decoded once and shared by all Sounds with the same name.
+    /// The resource manager keeps decoded data while a Sound or the cache references it.
+    struct DecodedSound {
+        size_t size; // decoded size in bytes, 0 until known
+        bool decoded; // false for files too large to be decoded in memory
+        std::list<std::string>::iterator lruIt;
+    };
+
     ///
     AudioEngine();
-    
+
+    /// Registers sound's decoded data in cache if it should be,
+    /// returns flags to use when initializing a ma_sound with it.
+    ma_uint32 _getSoundFlags(const std::string& soundName);
+
+    /// Records decoded size of a cached sound, evicting least recently used ones if needed.
+    void _decodedSoundDidLoad(const std::string& soundName, const size_t size);
+
+    /// Returns false if the Sound should not play, the budget being used by more important voices.
+    bool _acquireVoice(Sound *sound);
+
+    /// Removes stopped and released Sounds from voices (_voicesMutex must be locked)
+    void _pruneVoices();
+
     // miniaudio stuff
     ma_engine _engine;
     
     vx_tools_vfs *_vfs;
+
+    /// Sounds can be created from any thread, guards _decodedSounds & _decodedSoundsLRU
+    std::mutex _decodedSoundsMutex;
+
+    std::unordered_map<std::string, DecodedSound> _decodedSounds;
+
+    /// names of decoded sounds, most recently used first
+    std::list<std::string> _decodedSoundsLRU;
+
+    std::atomic<size_t> _decodedCacheBytes;
+
+    /// Sounds can be played from any thread, guards _voices
+    std::mutex _voicesMutex;
+
+    std::vector<Sound_WeakPtr> _voices;
+
+    std::atomic<size_t> _maxVoices;
     
     // Now class Sound can access private members of Engine
     friend class Sound;
@@ -102,6 +157,9 @@ private:
     /// private constructor
     SoundsTicks();
 
+    /// Sounds can be made from any thread, guards _sounds
+    std::mutex _soundsMutex;
+
     /// sounds currently allocated
     std::vector<Sound_WeakPtr> _sounds;
 };
@@ -218,8 +276,20 @@ public:
     
     ///
     void setPosition(const float x, const float y, const float z);
+
+    /// Voices with higher priority are stolen last when the voice budget is used
+    inline int getPriority() { return _priority; }
+
+    ///
+    inline void setPriority(const int priority) { _priority = priority; }
     
 private:
+    /// true while the Sound plays (or is about to) and counts in the voice budget
+    bool _usesVoice();
+
+    /// volume once attenuated by distance to listener, in [0, 1]
+    float _getAudibility();
+
     /// reads the file and returns the number of samples
     /// /!\ only works with ogg files
     ma_uint32 getNbSamplesFromOggFile();
@@ -261,6 +331,10 @@ private:
 
     bool _playScheduled;
 
+    int _priority;
+
+    AudioEngine *_engine;
+
     // if it is -1.0, the Sound has been stopped / paused and fade has started
     double _timeSinceStartOfPlay;
 
@@ -14,6 +14,10 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include <png.h>
@@ -40,6 +44,59 @@ public:
     
 };
 
+/// Bundle archive, mounted when found at the root of the bundle directory
+#define VX_BUNDLE_ARCHIVE_FILENAME "bundle.czha"
+
+/// Memory-mapped asset archive, packing many small files in one file mapped once.
+/// Archives are written by core's asset_archive.h (`cubzh_cli pack`).
+class Archive {
+public:
+    /// Maps file at given absolute path.
+    /// Returns nullptr if it can't be mapped or isn't a valid archive.
+    static std::shared_ptr<Archive> open(const std::string& absPath);
+
+    ~Archive();
+
+    ///
+    bool contains(const std::string& path) const;
+
+    /// Sets a view of the entry's bytes within the mapping (no copy), valid while the Archive lives.
+    /// Returns false if there's no such entry or if it is compressed (see getContent).
+    bool getView(const std::string& path, const void*& data, size_t& size) const;
+
+    /// Returns a copy of the entry's bytes (inflated if compressed), to be freed by the caller.
+    /// Returns nullptr if there's no such entry.
+    void *getContent(const std::string& path, size_t *outDataSize) const;
+
+    ///
+    std::vector<std::string> getPaths() const;
+
+private:
+    Archive();
+
+    struct Entry;
+
+    /// Validates header & entries once, so that lookups don't have to.
+    bool _index();
+
+    /// Returns false if there's no entry for given path
+    bool _find(const std::string& path, uint32_t& index) const;
+
+    /// entries sorted by path hash, within mapped bytes
+    const Entry *_entries;
+    uint32_t _entryCount;
+
+    /// '\0'-terminated entry paths, within mapped bytes
+    const char *_paths;
+
+    /// mapped bytes (read in memory where mapping isn't available)
+    void *_bytes;
+    size_t _size;
+
+    /// file mapping handle (Windows only)
+    void *_mappingHandle;
+};
+
 enum class FileType {
     NONE = -1,
     PNG = 0,
@@ -81,6 +138,36 @@ public:
     
     ///
     InMemoryFile* createInMemoryFile(std::string path, size_t size);
+
+    /// When set to true, mergeBundleDirInStorage doesn't copy anything,
+    /// storage lookups in merged directories fall back to the read-only bundle instead.
+    /// Returns true if the change has been accepted, all platforms may not support it.
+    bool setBundleOverlay(bool b);
+
+    /// Returns true if merged bundle directories are served in place.
+    bool bundleOverlay();
+
+    /// Storage files in `storageDir` fall back to files in bundle's `bundleDir`.
+    void addBundleOverlay(const std::string& storageDir, const std::string& bundleDir);
+
+    /// Returns true if storage path is in an overlaid directory,
+    /// setting the bundle path to fall back to.
+    bool getBundleOverlayPath(const std::string& relStoragePath, std::string& relBundlePath);
+
+    /// Storage path has been removed, it doesn't fall back to the bundle anymore
+    /// (nor files within it, for a directory).
+    void removeBundleOverlayPath(const std::string& relStoragePath);
+
+    /// Bundle files are looked up in this archive first, see openBundleFile.
+    /// nullptr unmounts it. Files opened from an archive have to be closed before it is replaced.
+    void setBundleArchive(const std::shared_ptr<Archive>& archive);
+
+    /// Mounts VX_BUNDLE_ARCHIVE_FILENAME if found in the bundle, returns true if mounted.
+    /// Done on first bundle lookup, no need to call it otherwise.
+    bool mountBundleArchive();
+
+    /// Returns mounted bundle archive, nullptr if there's none.
+    std::shared_ptr<Archive> getBundleArchive();
     
 private:
     ///
@@ -98,6 +185,24 @@ private:
     /// A map to store in memory files and index them by path
     std::map<std::string, InMemoryFile*> _inMemoryFiles;
 
+    /// When set to true, merged bundle directories are not copied in storage
+    bool _bundleOverlay;
+
+    /// overlaid storage directories (without trailing '/'), with their bundle directories
+    std::vector<std::pair<std::string, std::string>> _bundleOverlays;
+
+    /// removed storage paths, hiding their overlaid bundle files
+    std::set<std::string> _bundleOverlayRemovedPaths;
+
+    /// mounted bundle archive, can be nullptr
+    std::shared_ptr<Archive> _bundleArchive;
+
+    /// false until bundle archive is mounted or set
+    bool _bundleArchiveMounted;
+
+    /// bundle files are opened from any thread
+    std::mutex _bundleArchiveMutex;
+
     ///
     std::string _storageRelPathPrefix;
 
@@ -205,6 +310,8 @@ bool storageFileExists(const std::string& relFilePath, bool& isDir);
 
 /// Merges content of bundle directory into cache directory.
 /// Overriding existing cache files if found.
+/// With Helper::bundleOverlay(), files are not copied but read from the bundle
+/// until written in storage.
 bool mergeBundleDirInStorage(const std::string& bundleDir, const std::string& storageDir);
 
 /// Shows a file picker, prepares the thumbnails and puts in the storage
@@ -142,12 +142,8 @@
                             NSUInteger length = [data length];
 
                             if (bytes != nullptr && length > 0) {
-                                char *buffer = static_cast<char *>(malloc(length));
-                                memcpy(buffer, bytes, length);
-
-                                vx::WSConnection::Payload_SharedPtr pld = vx::WSConnection::Payload::decode(buffer, length);
-                                pld->step("WSConnection::receivedBytes");
-                                delegate->connectionDidReceive(*self.conn, pld);
+                                // decodes (and inflates) Payload, notifying delegate
+                                self.conn->receivedBytes(const_cast<char *>(bytes), length, true);
                             } else {
                                 vxlog_error("[WSConnection::receivedBytes] dropped bytes");
                             }
@@ -159,12 +155,7 @@
 
                             if (utf8String != nullptr) {
                                 size_t length = strlen(utf8String);
-                                char *buffer = static_cast<char *>(malloc(length));
-                                memcpy(buffer, utf8String, length);
-
-                                vx::WSConnection::Payload_SharedPtr pld = vx::WSConnection::Payload::decode(buffer, length);
-                                pld->step("WSConnection::receivedBytes");
-                                delegate->connectionDidReceive(*self.conn, pld);
+                                self.conn->receivedBytes(const_cast<char *>(utf8String), length, true);
                             } else {
                                 vxlog_error("[WSConnection::receivedBytes] dropped bytes");
                             }
@@ -197,11 +188,16 @@ void WSConnection::_writePayload(const Payload_SharedPtr& p) {
         return;
     }
 
-    p->createMetadataIfNull();
-    char *metadata = p->getMetadata();
-    size_t metaDataSize = p->metadataSize();
+    Payload_SharedPtr toWrite = _compressIfNeeded(p);
+    toWrite->createMetadataIfNull();
+    char *metadata = toWrite->getMetadata();
+    size_t metaDataSize = toWrite->metadataSize();
     NSMutableData *data = [NSMutableData dataWithBytes:metadata length:metaDataSize];
-    [data appendBytes:p->getContent() length:p->contentSize()];
+    [data appendBytes:toWrite->getContent() length:toWrite->contentSize()];
+    if (metaDataSize > 0) {
+        // includes byte
+        static_cast<uint8_t *>([data mutableBytes])[0] |= _advertisedIncludes();
+    }
 
     NSURLSessionWebSocketMessage *webSocketMessage = [[NSURLSessionWebSocketMessage alloc] initWithData:data];
     [(__bridge WebSocketConnection*)_platformObject send:webSocketMessage];
@@ -59,6 +59,11 @@ bool vx::fs::Helper::setInMemoryStorage(bool b) {
     return true;
 }
 
+bool vx::fs::Helper::setBundleOverlay(bool b) {
+    // bundle overlay not supported on iOS & macOS for now
+    return false;
+}
+
 /// --------------------------------------------------
 ///
 /// MARK: - static functions -
@@ -9,16 +9,23 @@
 #include "filesystem.hpp"
 
 // C++
+#include <cerrno>
 #include <cstdio>
 #include <string.h>
 #include <list>
+#include <set>
 #include <fstream>
+#include <vector>
 
 // C
 #include <libgen.h> // for basename
 #include <dirent.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 
+#define FILE_COPY_BUFFER_SIZE 262144 // 256KB
+
 // --------------------------------------------------
 // MARK: - Path separator -
 // --------------------------------------------------
@@ -123,9 +130,54 @@ std::string vx::fs::getBundleFilePath(const std::string& relFilePath) {
     return bundlePath + relFilePath;
 }
 
+/// Opens a file from the mounted bundle archive, for reading.
+/// Stored entries are read in place, compressed ones are inflated in a temporary file.
+static FILE *openBundleArchiveFile(const std::string& relFilePath) {
+    std::shared_ptr<vx::fs::Archive> archive = vx::fs::Helper::shared()->getBundleArchive();
+    if (archive == nullptr || archive->contains(relFilePath) == false) {
+        return nullptr;
+    }
+
+    const void *data = nullptr;
+    size_t size = 0;
+    if (archive->getView(relFilePath, data, size) && size > 0) {
+        // archive remains mapped while mounted
+        return fmemopen(const_cast<void *>(data), size, "rb");
+    }
+
+    void *content = archive->getContent(relFilePath, &size);
+    if (content == nullptr) {
+        return nullptr;
+    }
+    FILE *f = tmpfile();
+    if (f != nullptr && (fwrite(content, 1, size, f) != size || fseek(f, 0, SEEK_SET) != 0)) {
+        fclose(f);
+        f = nullptr;
+    }
+    free(content);
+    return f;
+}
+
+/// Opens bundle file a storage file falls back to, from the archive or the bundle directory.
+static FILE *openOverlaidBundleFile(const std::string& relBundlePath, const std::string& mode) {
+    FILE *f = openBundleArchiveFile(relBundlePath);
+    if (f == nullptr) {
+        f = fopen(vx::fs::getBundleFilePath(relBundlePath).c_str(), mode.c_str());
+    }
+    return f;
+}
+
 /// Opens a file located in the bundle "assets" directory.
 /// @param filename name of the file to open. It should not start with a '/'.
 FILE *vx::fs::openBundleFile(std::string relFilePath, std::string mode) {
+    // mounted bundle archive first, it can only be read
+    if (mode == "rb" || mode == "r") {
+        FILE *f = openBundleArchiveFile(relFilePath);
+        if (f != nullptr) {
+            return f;
+        }
+    }
+
     // TODO: create intermediary parent directories when writing
     std::string absPath = getBundleFilePath(relFilePath);
     FILE *result = fopen(absPath.c_str(), mode.c_str());
@@ -136,6 +188,49 @@ FILE *vx::fs::openBundleFile(std::string relFilePath, std::string mode) {
     return result;
 }
 
+/// Copies `size` bytes from `src` to `dst`, both freshly opened (nothing buffered yet).
+/// The kernel copies between file descriptors when possible (without going through user space),
+/// falling back to a buffered copy for in-memory files.
+static bool copyFileContent(FILE *src, FILE *dst, const size_t size) {
+    size_t copied = 0;
+    const int srcFd = fileno(src);
+    const int dstFd = fileno(dst);
+
+    if (srcFd >= 0 && dstFd >= 0) {
+        while (copied < size) {
+            const ssize_t n = copy_file_range(srcFd, nullptr, dstFd, nullptr, size - copied, 0);
+            if (n <= 0) {
+                break; // not supported (kernel, file systems), try sendfile
+            }
+            copied += static_cast<size_t>(n);
+        }
+        while (copied < size) {
+            const ssize_t n = sendfile(dstFd, srcFd, nullptr, size - copied);
+            if (n <= 0) {
+                break;
+            }
+            copied += static_cast<size_t>(n);
+        }
+        if (copied == size) {
+            return true;
+        }
+    }
+
+    // continues where file descriptors' offsets are
+    std::vector<char> buffer(size - copied < FILE_COPY_BUFFER_SIZE ? size - copied : FILE_COPY_BUFFER_SIZE);
+    while (copied < size) {
+        const size_t n = fread(buffer.data(), 1, buffer.size(), src);
+        if (n == 0) {
+            break;
+        }
+        if (fwrite(buffer.data(), 1, n, dst) != n) {
+            return false;
+        }
+        copied += n;
+    }
+    return copied == size;
+}
+
 bool ensureParentDirs(const std::string& path) {
     mode_t mode = 0755;
     struct stat sb;
@@ -195,6 +290,11 @@ FILE *vx::fs::openStorageFile(std::string relFilePath, std::string mode, size_t
             InMemoryFile *inMemFile = Helper::shared()->getInMemoryFile("storage/" + relFilePath);
             if (inMemFile != nullptr) {
                 f = fmemopen(inMemFile->bytes, inMemFile->size - 1, mode.c_str());
+            } else if (Helper::shared()->bundleOverlay()) {
+                std::string relBundlePath;
+                if (Helper::shared()->getBundleOverlayPath(relFilePath, relBundlePath)) {
+                    f = openOverlaidBundleFile(relBundlePath, mode);
+                }
             }
             
         } else if (mode == "wb" && writeSize != 0) {
@@ -209,6 +309,15 @@ FILE *vx::fs::openStorageFile(std::string relFilePath, std::string mode, size_t
     } else {
         std::string fullPath = getStoragePath(relFilePath);
 
+        // overlaid bundle file, not written in storage yet
+        std::string relBundlePath;
+        const bool overlaid = Helper::shared()->bundleOverlay() &&
+                              Helper::shared()->getBundleOverlayPath(relFilePath, relBundlePath) &&
+                              access(fullPath.c_str(), F_OK) != 0;
+        if (overlaid && mode[0] == 'r' && mode.find('+') == std::string::npos) {
+            return openOverlaidBundleFile(relBundlePath, mode); // read in place
+        }
+
         // Create directories if they do not exist
         size_t lastSlashPos = fullPath.rfind('/');
         if (lastSlashPos != std::string::npos) {
@@ -219,6 +328,20 @@ FILE *vx::fs::openStorageFile(std::string relFilePath, std::string mode, size_t
             }
         }
 
+        if (overlaid && mode[0] != 'w') {
+            // updating or appending: bring bundle file in storage first
+            FILE *src = openOverlaidBundleFile(relBundlePath, "rb");
+            if (src != nullptr) {
+                const size_t size = getFileSize(src);
+                FILE *dst = fopen(fullPath.c_str(), "wb");
+                if (dst != nullptr) {
+                    copyFileContent(src, dst, size);
+                    fclose(dst);
+                }
+                fclose(src);
+            }
+        }
+
         return fopen(fullPath.c_str(), mode.c_str());
     }
 }
@@ -227,28 +350,49 @@ std::vector<std::string> vx::fs::listStorageDirectory(const std::string& relStor
     const std::string absPath = getStoragePath(relStoragePath);
     std::vector<std::string> files;
 
-    DIR *dir = opendir(absPath.c_str());
-    if (dir == nullptr) {
-        // __android_log_print(ANDROID_LOG_ERROR, "Particubes", "opendir failed in storage. (%s)", absPath.c_str());
-        return files;
+    // storage directory, then overlaid bundle directory if any
+    std::vector<std::string> absDirPaths;
+    absDirPaths.push_back(absPath);
+    std::string relBundlePath;
+    if (Helper::shared()->bundleOverlay() &&
+        Helper::shared()->getBundleOverlayPath(relStoragePath, relBundlePath)) {
+        absDirPaths.push_back(getBundleFilePath(relBundlePath));
     }
 
-    struct dirent *ent;
-    while((ent = readdir(dir)) != nullptr) {
-        // filter out "." and ".."
-        if (strcmp(ent->d_name, ".") == 0 ||
-            strcmp(ent->d_name, "..") == 0) {
+    std::set<std::string> names;
+    for (const std::string& absDirPath : absDirPaths) {
+        DIR *dir = opendir(absDirPath.c_str());
+        if (dir == nullptr) {
+            // __android_log_print(ANDROID_LOG_ERROR, "Particubes", "opendir failed in storage. (%s)", absPath.c_str());
             continue;
         }
 
-        std::string fullName(relStoragePath + "/" + ent->d_name);
+        struct dirent *ent;
+        while((ent = readdir(dir)) != nullptr) {
+            // filter out "." and ".."
+            if (strcmp(ent->d_name, ".") == 0 ||
+                strcmp(ent->d_name, "..") == 0) {
+                continue;
+            }
+
+            if (names.insert(ent->d_name).second == false) {
+                continue; // storage file shadowing bundle file
+            }
+
+            std::string fullName(relStoragePath + "/" + ent->d_name);
+
+            if (absDirPath != absPath &&
+                Helper::shared()->getBundleOverlayPath(fullName, relBundlePath) == false) {
+                continue; // bundle file removed from storage
+            }
 
-        if (ent->d_type == DT_REG || ent->d_type == DT_DIR) {
-            // regular file or directory
-            files.push_back(fullName);
+            if (ent->d_type == DT_REG || ent->d_type == DT_DIR) {
+                // regular file or directory
+                files.push_back(fullName);
+            }
         }
+        closedir(dir);
     }
-    closedir(dir);
 
     return files;
 }
@@ -260,11 +404,31 @@ void vx::fs::importFile(ImportFileCallback callback) {
 
 ///
 bool vx::fs::removeStorageFileOrDirectory(std::string relFilePath) {
-    return remove(getStoragePath(relFilePath).c_str()) == 0;
+    const bool removed = remove(getStoragePath(relFilePath).c_str()) == 0;
+    if (removed == false && errno != ENOENT) {
+        return false; // e.g. directory not empty
+    }
+
+    // overlaid bundle file or directory, not served anymore
+    std::string relBundlePath;
+    bool isDir = false;
+    if (Helper::shared()->bundleOverlay() &&
+        Helper::shared()->getBundleOverlayPath(relFilePath, relBundlePath) &&
+        bundleFileExists(relBundlePath, isDir)) {
+        Helper::shared()->removeBundleOverlayPath(relFilePath);
+        return true;
+    }
+    return removed;
 }
 
 ///
 bool vx::fs::bundleFileExists(const std::string& relFilePath, bool& isDir) {
+    std::shared_ptr<Archive> archive = Helper::shared()->getBundleArchive();
+    if (archive != nullptr && archive->contains(relFilePath)) {
+        isDir = false; // archives only index files
+        return true;
+    }
+
     struct stat stat_buf;
 
     if(stat(getBundleFilePath(relFilePath).c_str(),&stat_buf) != 0 ) {
@@ -282,6 +446,12 @@ bool vx::fs::storageFileExists(const std::string& relFilePath, bool& isDir) {
     if (Helper::shared()->inMemoryStorage()) {
         
         InMemoryFile *inMemFile = Helper::shared()->getInMemoryFile("storage/" + relFilePath);
+        if (inMemFile == nullptr && Helper::shared()->bundleOverlay()) {
+            std::string relBundlePath;
+            if (Helper::shared()->getBundleOverlayPath(relFilePath, relBundlePath)) {
+                return bundleFileExists(relBundlePath, isDir);
+            }
+        }
         return inMemFile != nullptr;
         
     } else {
@@ -290,6 +460,11 @@ bool vx::fs::storageFileExists(const std::string& relFilePath, bool& isDir) {
 
         if(stat(getStoragePath(relFilePath).c_str(),&stat_buf) != 0 )
         {
+            std::string relBundlePath;
+            if (Helper::shared()->bundleOverlay() &&
+                Helper::shared()->getBundleOverlayPath(relFilePath, relBundlePath)) {
+                return bundleFileExists(relBundlePath, isDir);
+            }
             isDir = false;
             return false;
         }
@@ -300,16 +475,10 @@ bool vx::fs::storageFileExists(const std::string& relFilePath, bool& isDir) {
     }
 }
 
-#define FILE_COPY_BUFFER_SIZE 255
-
 bool vx::fs::mergeBundleDirInStorage(const std::string& bundleDir, const std::string& storageDir) {
     
     const std::string bundlePrefix = getBundleFilePath("");
     const std::string absBundleDir = getBundleFilePath(bundleDir);
-    const std::string absStorageDir = getStoragePath(storageDir);
-    
-    char buffer[FILE_COPY_BUFFER_SIZE];
-    size_t n;
     
     bool isDirectory = false;
     bool fileExists = false;
@@ -319,6 +488,13 @@ bool vx::fs::mergeBundleDirInStorage(const std::string& bundleDir, const std::st
         return false;
     }
 
+    if (Helper::shared()->bundleOverlay()) {
+        // nothing to copy, storage lookups fall back to bundle files,
+        // at the same relative paths files would have been copied to
+        Helper::shared()->addBundleOverlay(bundleDir, bundleDir);
+        return false;
+    }
+
     // no need to check for storage dir presence when
     // using in-memory storage.
     if (Helper::shared()->inMemoryStorage() == false) {
@@ -383,16 +559,15 @@ bool vx::fs::mergeBundleDirInStorage(const std::string& bundleDir, const std::st
                         return false;
                     }
                     
-                    n = fread(buffer, 1, FILE_COPY_BUFFER_SIZE, src);
-                    fwrite(buffer, 1, n, dst);
-
-                    while (n == FILE_COPY_BUFFER_SIZE) {
-                        n = fread(buffer, 1, FILE_COPY_BUFFER_SIZE, src);
-                        fwrite(buffer, 1, n, dst);
-                    }
+                    const bool copied = copyFileContent(src, dst, fileSize);
                     
                     fclose(src);
                     fclose(dst);
+
+                    if (copied == false) {
+                        printf("CAN'T COPY BUNDLE FILE: %s\n", relPath.c_str());
+                        return false;
+                    }
                 }
             }
             
@@ -456,3 +631,8 @@ bool vx::fs::Helper::setInMemoryStorage(bool b) {
     this->_inMemoryStorage = b;
     return true;
 }
+
+bool vx::fs::Helper::setBundleOverlay(bool b) {
+    this->_bundleOverlay = b;
+    return true;
+}
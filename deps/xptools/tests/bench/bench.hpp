@@ -0,0 +1,182 @@
+//
+//  bench.hpp
+//  xptools
+//
+
+// Minimal benchmark harness, provides main(), same output as core_bench.
+//
+// Benchmarks are listed in bench_list.cpp w/ BENCH_LIST, similar to acutest's TEST_LIST.
+// Each benchmark function is called once per run, it must measure its hot section between
+// bench_start & bench_stop, and report how many items it processed w/ bench_set_items.
+// Setup & teardown done outside of bench_start/bench_stop are not measured.
+// An extra counter (e.g. frames when items are bytes) can be reported w/ bench_set_counter.
+// An extra value that isn't a throughput (e.g. CPU time) can be reported w/ bench_set_metric.
+// A benchmark that can't complete (e.g. waiting past a deadline) reports it w/ bench_fail,
+// xptools_bench then exits w/ 1.
+//
+// Results are printed to stdout as JSON (logs go to stderr).
+//
+// Usage: xptools_bench [--runs N] [filter...]
+// Only benchmarks whose name contains one of the filters are run.
+
+#pragma once
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define BENCH_DEFAULT_RUNS 5
+#define BENCH_MAX_RUNS 100
+
+struct Bench {
+    std::chrono::steady_clock::time_point start;
+    uint64_t elapsedNs;
+    uint64_t items;
+    const char *counterName;
+    uint64_t counter;
+    const char *metricName;
+    uint64_t metric;
+    const char *failure;
+};
+
+typedef void (*pointer_bench_func)(Bench *b);
+
+struct BenchEntry {
+    const char *name;
+    pointer_bench_func func;
+};
+
+#define BENCH_LIST const BenchEntry bench_list_[]
+
+extern const BenchEntry bench_list_[];
+
+/// Starts (or resumes) measuring
+static inline void bench_start(Bench *b) {
+    b->start = std::chrono::steady_clock::now();
+}
+
+/// Stops measuring, can be called several times in a run to exclude setup between sections
+static inline void bench_stop(Bench *b) {
+    b->elapsedNs += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                             b->start).count());
+}
+
+/// Number of items processed per run (operations, messages, bytes...), used to report throughput
+static inline void bench_set_items(Bench *b, uint64_t items) {
+    b->items = items;
+}
+
+/// Extra counter per run, reported w/ its own throughput (`<name>_per_sec`)
+static inline void bench_set_counter(Bench *b, const char *name, uint64_t value) {
+    b->counterName = name;
+    b->counter = value;
+}
+
+/// Extra value per run, reported as is (last run's value)
+static inline void bench_set_metric(Bench *b, const char *name, uint64_t value) {
+    b->metricName = name;
+    b->metric = value;
+}
+
+/// Marks the run as failed, remaining runs of the benchmark are skipped
+static inline void bench_fail(Bench *b, const char *reason) {
+    b->failure = reason;
+}
+
+#ifndef BENCH_NO_MAIN
+
+static bool bench_is_selected_(const char *name, int argc, char **argv, int firstFilter) {
+    if (firstFilter >= argc) {
+        return true;
+    }
+    for (int i = firstFilter; i < argc; ++i) {
+        if (strstr(name, argv[i]) != nullptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    int runs = BENCH_DEFAULT_RUNS;
+    int firstFilter = 1;
+    if (argc > 2 && strcmp(argv[1], "--runs") == 0) {
+        runs = std::min(std::max(atoi(argv[2]), 1), BENCH_MAX_RUNS);
+        firstFilter = 3;
+    }
+
+    uint64_t samples[BENCH_MAX_RUNS];
+    bool first = true;
+    bool failed = false;
+
+    printf("{\n  \"suite\": \"xptools_bench\",\n  \"runs\": %d,\n  \"results\": [", runs);
+    for (const BenchEntry *e = bench_list_; e->name != nullptr; ++e) {
+        if (bench_is_selected_(e->name, argc, argv, firstFilter) == false) {
+            continue;
+        }
+
+        Bench b;
+        b.elapsedNs = 0;
+        b.items = 0;
+        b.counterName = nullptr;
+        b.counter = 0;
+        b.metricName = nullptr;
+        b.metric = 0;
+        b.failure = nullptr;
+        uint64_t total = 0;
+        int done = 0;
+        while (done < runs && b.failure == nullptr) {
+            b.elapsedNs = 0;
+            e->func(&b);
+            samples[done++] = b.elapsedNs;
+            total += b.elapsedNs;
+        }
+        if (b.failure != nullptr) {
+            fprintf(stderr, "%s: %s\n", e->name, b.failure);
+            printf("%s\n    {\"name\": \"%s\", \"failed\": true}", first ? "" : ",", e->name);
+            fflush(stdout);
+            first = false;
+            failed = true;
+            continue;
+        }
+        std::sort(samples, samples + runs);
+
+        const uint64_t median = samples[runs / 2];
+        const double perSec = median > 0 ? 1e9 / static_cast<double>(median) : 0.0;
+
+        printf("%s\n    {\"name\": \"%s\", \"items\": %llu, \"min_ns\": %llu, "
+               "\"median_ns\": %llu, \"mean_ns\": %llu, \"max_ns\": %llu, "
+               "\"items_per_sec\": %.1f",
+               first ? "" : ",",
+               e->name,
+               static_cast<unsigned long long>(b.items),
+               static_cast<unsigned long long>(samples[0]),
+               static_cast<unsigned long long>(median),
+               static_cast<unsigned long long>(total / static_cast<uint64_t>(runs)),
+               static_cast<unsigned long long>(samples[runs - 1]),
+               static_cast<double>(b.items) * perSec);
+        if (b.counterName != nullptr) {
+            printf(", \"%s\": %llu, \"%s_per_sec\": %.1f",
+                   b.counterName,
+                   static_cast<unsigned long long>(b.counter),
+                   b.counterName,
+                   static_cast<double>(b.counter) * perSec);
+        }
+        if (b.metricName != nullptr) {
+            printf(", \"%s\": %llu", b.metricName, static_cast<unsigned long long>(b.metric));
+        }
+        printf("}");
+        fflush(stdout);
+        first = false;
+    }
+    printf("\n  ]\n}\n");
+
+    return failed ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,119 @@
+//
+//  bench_channel.hpp
+//  xptools
+//
+
+#pragma once
+
+// C++
+#include <memory>
+#include <thread>
+#include <vector>
+
+// xptools
+#include "Channel.hpp"
+
+#define BENCH_CHANNEL_NB_MESSAGES 200000
+#define BENCH_CHANNEL_POOL_NB_OPS 100000
+
+struct BenchChannelMessage {
+    int producer;
+    int seq;
+};
+
+typedef std::shared_ptr<BenchChannelMessage> BenchChannelMessage_SharedPtr;
+
+// producers push shared pointers (like connection payloads) to a single consumer,
+// the consumer checks messages of each producer arrive in push order
+static void _bench_channel_producers(Bench *b, int nbProducers) {
+    vx::Channel<BenchChannelMessage_SharedPtr> channel;
+    const int perProducer = BENCH_CHANNEL_NB_MESSAGES / nbProducers;
+    const int total = perProducer * nbProducers;
+
+    std::vector<std::vector<BenchChannelMessage_SharedPtr>> msgs(nbProducers);
+    for (int p = 0; p < nbProducers; ++p) {
+        for (int i = 0; i < perProducer; ++i) {
+            msgs[p].push_back(std::make_shared<BenchChannelMessage>(BenchChannelMessage{p, i}));
+        }
+    }
+    std::vector<int> last(nbProducers, -1);
+    bool ordered = true;
+
+    bench_start(b);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < nbProducers; ++p) {
+        producers.emplace_back([&channel, &msgs, p]() {
+            for (BenchChannelMessage_SharedPtr& m : msgs[p]) {
+                channel.pushMove(std::move(m));
+            }
+        });
+    }
+    int received = 0;
+    BenchChannelMessage_SharedPtr m;
+    while (received < total) {
+        if (channel.pop(m)) {
+            if (m->seq != last[m->producer] + 1) {
+                ordered = false;
+            }
+            last[m->producer] = m->seq;
+            ++received;
+            m = nullptr;
+        }
+    }
+    for (std::thread& t : producers) {
+        t.join();
+    }
+    bench_stop(b);
+    bench_set_items(b, static_cast<uint64_t>(total));
+
+    if (ordered == false) {
+        fprintf(stderr, "bench_channel: messages popped out of order\n");
+    }
+}
+
+void bench_channel_producers_1(Bench *b) {
+    _bench_channel_producers(b, 1);
+}
+
+void bench_channel_producers_2(Bench *b) {
+    _bench_channel_producers(b, 2);
+}
+
+void bench_channel_producers_4(Bench *b) {
+    _bench_channel_producers(b, 4);
+}
+
+void bench_channel_producers_8(Bench *b) {
+    _bench_channel_producers(b, 8);
+}
+
+// bounded pool usage (like Connection::ReceiveBuffer): threads take an object & give it back
+void bench_channel_pool_4_threads(Bench *b) {
+    const int nbThreads = 4;
+    const int capacity = 64;
+    vx::Channel<int *> pool(capacity);
+    std::vector<int> objects(capacity, 0);
+    for (int i = 0; i < capacity; ++i) {
+        int *o = &objects[i];
+        pool.tryPush(std::move(o));
+    }
+
+    bench_start(b);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nbThreads; ++t) {
+        threads.emplace_back([&pool]() {
+            int *o = nullptr;
+            for (int i = 0; i < BENCH_CHANNEL_POOL_NB_OPS; ++i) {
+                if (pool.pop(o)) {
+                    ++(*o);
+                    pool.tryPush(std::move(o));
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    bench_stop(b);
+    bench_set_items(b, static_cast<uint64_t>(nbThreads) * BENCH_CHANNEL_POOL_NB_OPS);
+}
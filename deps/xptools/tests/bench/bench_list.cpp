@@ -0,0 +1,46 @@
+//
+//  bench_list.cpp
+//  xptools
+//
+
+#include "bench.hpp"
+
+#include "bench_channel.hpp"
+#include "bench_local_connection.hpp"
+#include "bench_operation_queue.hpp"
+#include "bench_ws_server.hpp"
+
+BENCH_LIST = {
+
+    // Channel
+    {"channel_producers_1", bench_channel_producers_1},
+    {"channel_producers_2", bench_channel_producers_2},
+    {"channel_producers_4", bench_channel_producers_4},
+    {"channel_producers_8", bench_channel_producers_8},
+    {"channel_pool_4_threads", bench_channel_pool_4_threads},
+
+    // LocalConnection
+    {"local_connection_100k_both_ways", bench_local_connection_100k_both_ways},
+    {"local_connection_idle_latency", bench_local_connection_idle_latency},
+
+    // OperationQueue
+    {"operation_queue_background_throughput", bench_operation_queue_background_throughput},
+    {"operation_queue_serial_throughput", bench_operation_queue_serial_throughput},
+    {"operation_queue_background_latency", bench_operation_queue_background_latency},
+
+    // WSServer
+    {"ws_server_write_64B", bench_ws_server_write_64B},
+    {"ws_server_write_1KB", bench_ws_server_write_1KB},
+    {"ws_server_write_64KB", bench_ws_server_write_64KB},
+    {"ws_server_write_1MB", bench_ws_server_write_1MB},
+    {"ws_server_echo_2000_conns_main_thread", bench_ws_server_echo_2000_conns_main_thread},
+    {"ws_server_echo_2000_conns_2_service_threads", bench_ws_server_echo_2000_conns_2_service_threads},
+    {"ws_server_broadcast_100_conns", bench_ws_server_broadcast_100_conns},
+    {"ws_server_broadcast_1000_conns", bench_ws_server_broadcast_1000_conns},
+    {"ws_server_compression_1KB_off", bench_ws_server_compression_1KB_off},
+    {"ws_server_compression_1KB_on", bench_ws_server_compression_1KB_on},
+    {"ws_server_compression_64KB_off", bench_ws_server_compression_64KB_off},
+    {"ws_server_compression_64KB_on", bench_ws_server_compression_64KB_on},
+    {"ws_server_compression_64KB_random_on", bench_ws_server_compression_64KB_random_on},
+
+    {nullptr, nullptr}};
@@ -0,0 +1,127 @@
+//
+//  bench_local_connection.hpp
+//  xptools
+//
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+// xptools
+#include "LocalConnection.hpp"
+
+#define BENCH_LOCAL_CONNECTION_NB_PAYLOADS 100000
+#define BENCH_LOCAL_CONNECTION_PAYLOAD_SIZE 64
+#define BENCH_LOCAL_CONNECTION_NB_LATENCY_SAMPLES 20
+// waiting longer means payloads are lost or receiving threads aren't woken up
+#define BENCH_LOCAL_CONNECTION_TIMEOUT_SEC 10
+
+// counts received Payloads, checking they arrive in the order they were pushed
+class BenchLocalConnectionDelegate final : public vx::ConnectionDelegate {
+public:
+    BenchLocalConnectionDelegate() : received(0), outOfOrder(0) {}
+
+    void connectionDidEstablish(vx::Connection& conn) override {}
+
+    void connectionDidReceive(vx::Connection& conn, const vx::Connection::Payload_SharedPtr& payload) override {
+        uint32_t index;
+        memcpy(&index, payload->getContent(), sizeof(uint32_t));
+        if (index != received) {
+            ++outOfOrder;
+        }
+        ++received;
+    }
+
+    void connectionDidClose(vx::Connection& conn) override {}
+
+    std::atomic<uint32_t> received;
+    std::atomic<uint32_t> outOfOrder;
+};
+
+static void _bench_local_connection_push(vx::LocalConnection *conn, uint32_t index, size_t size) {
+    char *content = static_cast<char *>(malloc(size));
+    memset(content, 0, size);
+    memcpy(content, &index, sizeof(uint32_t));
+    conn->pushPayloadToWrite(vx::Connection::Payload::create(content, size));
+}
+
+// 2 connected peers, each pushing 100k payloads from its own thread
+void bench_local_connection_100k_both_ways(Bench *b) {
+    vx::LocalConnection_SharedPtr a = std::make_shared<vx::LocalConnection>();
+    vx::LocalConnection_SharedPtr c = std::make_shared<vx::LocalConnection>();
+    a->setPeerConnection(c);
+    c->setPeerConnection(a);
+    std::shared_ptr<BenchLocalConnectionDelegate> aDelegate = std::make_shared<BenchLocalConnectionDelegate>();
+    std::shared_ptr<BenchLocalConnectionDelegate> cDelegate = std::make_shared<BenchLocalConnectionDelegate>();
+    a->setDelegate(aDelegate);
+    c->setDelegate(cDelegate);
+    a->connect();
+
+    bench_start(b);
+    std::thread producer([&c]() {
+        for (uint32_t i = 0; i < BENCH_LOCAL_CONNECTION_NB_PAYLOADS; ++i) {
+            _bench_local_connection_push(c.get(), i, BENCH_LOCAL_CONNECTION_PAYLOAD_SIZE);
+        }
+    });
+    for (uint32_t i = 0; i < BENCH_LOCAL_CONNECTION_NB_PAYLOADS; ++i) {
+        _bench_local_connection_push(a.get(), i, BENCH_LOCAL_CONNECTION_PAYLOAD_SIZE);
+    }
+    producer.join();
+    const std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(BENCH_LOCAL_CONNECTION_TIMEOUT_SEC);
+    while (aDelegate->received < BENCH_LOCAL_CONNECTION_NB_PAYLOADS ||
+           cDelegate->received < BENCH_LOCAL_CONNECTION_NB_PAYLOADS) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            bench_fail(b, "timed out waiting for payloads");
+            a->close();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    bench_stop(b);
+    bench_set_items(b, 2 * BENCH_LOCAL_CONNECTION_NB_PAYLOADS);
+
+    if (aDelegate->outOfOrder > 0 || cDelegate->outOfOrder > 0) {
+        fprintf(stderr, "bench_local_connection: %u payloads received out of order\n",
+                static_cast<uint32_t>(aDelegate->outOfOrder + cDelegate->outOfOrder));
+    }
+    a->close();
+}
+
+// time between push & reception of a single payload on an idle connection,
+// median_ns / items is the average latency
+void bench_local_connection_idle_latency(Bench *b) {
+    vx::LocalConnection_SharedPtr a = std::make_shared<vx::LocalConnection>();
+    vx::LocalConnection_SharedPtr c = std::make_shared<vx::LocalConnection>();
+    a->setPeerConnection(c);
+    c->setPeerConnection(a);
+    std::shared_ptr<BenchLocalConnectionDelegate> cDelegate = std::make_shared<BenchLocalConnectionDelegate>();
+    c->setDelegate(cDelegate);
+    a->connect();
+
+    for (uint32_t i = 0; i < BENCH_LOCAL_CONNECTION_NB_LATENCY_SAMPLES; ++i) {
+        // let the receiving thread go back to sleep
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+
+        bench_start(b);
+        _bench_local_connection_push(a.get(), i, sizeof(uint32_t));
+        const std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(BENCH_LOCAL_CONNECTION_TIMEOUT_SEC);
+        while (cDelegate->received == i) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                bench_fail(b, "timed out waiting for payload");
+                a->close();
+                return;
+            }
+            std::this_thread::yield();
+        }
+        bench_stop(b);
+    }
+    bench_set_items(b, BENCH_LOCAL_CONNECTION_NB_LATENCY_SAMPLES);
+    a->close();
+}
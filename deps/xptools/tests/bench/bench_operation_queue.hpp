@@ -0,0 +1,69 @@
+//
+//  bench_operation_queue.hpp
+//  xptools
+//
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <thread>
+
+// xptools
+#include "OperationQueue.hpp"
+
+#define BENCH_OPERATION_QUEUE_NB_OPS 2000
+#define BENCH_OPERATION_QUEUE_NB_LATENCY_SAMPLES 50
+
+// small operations (~20us of work each), like file reads & decodes dispatched by the engine
+static void _bench_operation_queue_throughput(Bench *b, vx::OperationQueue *queue) {
+    std::atomic<int> done(0);
+
+    bench_start(b);
+    for (int i = 0; i < BENCH_OPERATION_QUEUE_NB_OPS; ++i) {
+        queue->dispatch([&done]() {
+            volatile double x = 0.0;
+            for (int k = 0; k < 20000; ++k) {
+                x = x + k * 0.5;
+            }
+            ++done;
+        });
+    }
+    while (done < BENCH_OPERATION_QUEUE_NB_OPS) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    bench_stop(b);
+    bench_set_items(b, BENCH_OPERATION_QUEUE_NB_OPS);
+}
+
+void bench_operation_queue_background_throughput(Bench *b) {
+    _bench_operation_queue_throughput(b, vx::OperationQueue::getBackground());
+}
+
+void bench_operation_queue_serial_throughput(Bench *b) {
+    _bench_operation_queue_throughput(b, vx::OperationQueue::getSerialBackground());
+}
+
+// time between dispatch & execution of a single operation on an idle queue,
+// median_ns / items is the average latency
+void bench_operation_queue_background_latency(Bench *b) {
+    vx::OperationQueue *queue = vx::OperationQueue::getBackground();
+    for (int i = 0; i < BENCH_OPERATION_QUEUE_NB_LATENCY_SAMPLES; ++i) {
+        // let workers go back to sleep
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+
+        std::atomic<bool> ran(false);
+        std::chrono::steady_clock::time_point ranAt;
+        const std::chrono::steady_clock::time_point dispatchedAt = std::chrono::steady_clock::now();
+        queue->dispatch([&ran, &ranAt]() {
+            ranAt = std::chrono::steady_clock::now();
+            ran = true;
+        });
+        while (ran == false) {
+            std::this_thread::yield();
+        }
+        b->elapsedNs += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(ranAt - dispatchedAt).count());
+    }
+    bench_set_items(b, BENCH_OPERATION_QUEUE_NB_LATENCY_SAMPLES);
+}
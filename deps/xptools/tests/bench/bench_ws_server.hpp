@@ -0,0 +1,515 @@
+//
+//  bench_ws_server.hpp
+//  xptools
+//
+
+#pragma once
+
+// C
+#include <time.h>
+#include <unistd.h>
+
+// C++
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// xptools
+#include "WSServer.hpp"
+
+// libwebsockets
+#include "libwebsockets.h"
+
+#define BENCH_WS_SERVER_BASE_PORT 9000
+#define BENCH_WS_SERVER_CONNECT_TIMEOUT_SEC 30
+// messages each echo client keeps in flight
+#define BENCH_WS_SERVER_ECHO_WINDOW 4
+
+// MARK: - Fixture -
+
+// received by loopback clients, all connections included
+static std::atomic<uint64_t> _benchWSRxBytes(0);
+static std::atomic<uint64_t> _benchWSRxFrames(0);
+static std::atomic<uint64_t> _benchWSRxMessages(0);
+static std::atomic<uint64_t> _benchWSEstablished(0);
+
+// serialized Payload sent by echo clients, empty when clients only receive
+static std::vector<char> _benchWSEchoMessage;
+
+// serialized Payload sent once by each client when established, empty if none
+static std::vector<char> _benchWSHelloMessage;
+
+typedef struct {
+    int toSend;
+    bool sendHello;
+} BenchWSClientSession;
+
+static bool _bench_ws_client_write(lws *wsi, const std::vector<char>& message) {
+    static thread_local std::vector<unsigned char> buffer;
+    buffer.resize(LWS_PRE + message.size());
+    memcpy(buffer.data() + LWS_PRE, message.data(), message.size());
+    return lws_write(wsi, buffer.data() + LWS_PRE, message.size(), LWS_WRITE_BINARY) >=
+           static_cast<int>(message.size());
+}
+
+static int _bench_ws_client_callback(lws *wsi,
+                                     lws_callback_reasons reason,
+                                     void *user,
+                                     void *in,
+                                     size_t len) {
+    BenchWSClientSession *session = static_cast<BenchWSClientSession *>(user);
+    switch (reason) {
+        case LWS_CALLBACK_CLIENT_ESTABLISHED:
+            ++_benchWSEstablished;
+            session->toSend = 0;
+            session->sendHello = _benchWSHelloMessage.empty() == false;
+            if (_benchWSEchoMessage.empty() == false) {
+                session->toSend = BENCH_WS_SERVER_ECHO_WINDOW;
+            }
+            if (session->sendHello || session->toSend > 0) {
+                lws_callback_on_writable(wsi);
+            }
+            break;
+        case LWS_CALLBACK_CLIENT_RECEIVE:
+            _benchWSRxBytes += len;
+            ++_benchWSRxFrames;
+            if (lws_is_final_fragment(wsi)) {
+                ++_benchWSRxMessages;
+                if (_benchWSEchoMessage.empty() == false) {
+                    ++session->toSend;
+                    lws_callback_on_writable(wsi);
+                }
+            }
+            break;
+        case LWS_CALLBACK_CLIENT_WRITEABLE: {
+            if (session->sendHello) {
+                if (_bench_ws_client_write(wsi, _benchWSHelloMessage) == false) {
+                    return -1;
+                }
+                session->sendHello = false;
+            }
+            while (session->toSend > 0) {
+                if (_bench_ws_client_write(wsi, _benchWSEchoMessage) == false) {
+                    return -1;
+                }
+                --session->toSend;
+                if (lws_send_pipe_choked(wsi)) {
+                    lws_callback_on_writable(wsi);
+                    break;
+                }
+            }
+            break;
+        }
+        case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
+            fprintf(stderr, "bench_ws_server: client connection error\n");
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+static lws_protocols _benchWSClientProtocols[] = {
+    {"join", _bench_ws_client_callback, sizeof(BenchWSClientSession), 65536, 0, nullptr, 0},
+    LWS_PROTOCOL_LIST_TERM};
+
+// server side, sends received Payloads back
+class BenchWSEchoDelegate final : public vx::ConnectionDelegate {
+public:
+    void connectionDidEstablish(vx::Connection& conn) override {}
+
+    void connectionDidReceive(vx::Connection& conn, const vx::Connection::Payload_SharedPtr& payload) override {
+        conn.pushPayloadToWrite(payload);
+    }
+
+    void connectionDidClose(vx::Connection& conn) override {}
+};
+
+// server side, counts received Payloads
+class BenchWSReceiveDelegate final : public vx::ConnectionDelegate {
+public:
+    BenchWSReceiveDelegate() : received(0) {}
+
+    void connectionDidEstablish(vx::Connection& conn) override {}
+
+    void connectionDidReceive(vx::Connection& conn, const vx::Connection::Payload_SharedPtr& payload) override {
+        ++received;
+    }
+
+    void connectionDidClose(vx::Connection& conn) override {}
+
+    std::atomic<int> received;
+};
+
+class BenchWSServerDelegate final : public vx::WSServerDelegate {
+public:
+    bool didEstablishNewConnection(vx::Connection_SharedPtr newIncomingConn) override {
+        if (connectionDelegate != nullptr) {
+            newIncomingConn->setDelegate(connectionDelegate);
+        }
+        const std::lock_guard<std::mutex> locker(mutex);
+        connections.push_back(newIncomingConn);
+        return true;
+    }
+
+    std::shared_ptr<vx::ConnectionDelegate> connectionDelegate;
+    std::mutex mutex;
+    std::vector<vx::Connection_SharedPtr> connections;
+};
+
+// WSServer on a loopback port, w/ `nbConnections` lws clients serviced by their own threads.
+// When `echoSize` > 0, each client keeps BENCH_WS_SERVER_ECHO_WINDOW payloads of that size
+// in flight, echoed by the server.
+// When `compression` is true, server compresses payloads once clients advertised they accept it
+// (w/ a first payload sent when established, the fixture is ready once the server received it).
+class BenchWSFixture final {
+public:
+    BenchWSFixture(int nbConnections,
+                   size_t serviceThreads,
+                   int nbClientThreads = 1,
+                   size_t echoSize = 0,
+                   bool compression = false) :
+    ready(false),
+    _stopServer(false),
+    _stopClients(false) {
+        static int nextPort = 0;
+        const int port = BENCH_WS_SERVER_BASE_PORT + getpid() % 500 + nextPort++ % 500;
+
+        _benchWSRxBytes = 0;
+        _benchWSRxFrames = 0;
+        _benchWSRxMessages = 0;
+        _benchWSEstablished = 0;
+
+        _benchWSEchoMessage.clear();
+        if (echoSize > 0) {
+            char *content = static_cast<char *>(malloc(echoSize));
+            memset(content, 7, echoSize);
+            vx::Connection::Payload_SharedPtr p = vx::Connection::Payload::create(content, echoSize);
+            p->createMetadataIfNull();
+            _benchWSEchoMessage.assign(p->getMetadata(), p->getMetadata() + p->metadataSize());
+            _benchWSEchoMessage.insert(_benchWSEchoMessage.end(), p->getContent(), p->getContent() + p->contentSize());
+            delegate.connectionDelegate = std::make_shared<BenchWSEchoDelegate>();
+        }
+
+        std::shared_ptr<BenchWSReceiveDelegate> helloDelegate;
+        _benchWSHelloMessage.clear();
+        if (compression) {
+            char *content = static_cast<char *>(malloc(1));
+            content[0] = 0;
+            vx::Connection::Payload_SharedPtr p = vx::Connection::Payload::create(
+                content,
+                1,
+                vx::Connection::Payload::Includes::AcceptsCompression);
+            p->createMetadataIfNull();
+            _benchWSHelloMessage.assign(p->getMetadata(), p->getMetadata() + p->metadataSize());
+            _benchWSHelloMessage.insert(_benchWSHelloMessage.end(), p->getContent(), p->getContent() + p->contentSize());
+            helloDelegate = std::make_shared<BenchWSReceiveDelegate>();
+            delegate.connectionDelegate = helloDelegate;
+        }
+
+        server.reset(new vx::WSServer(static_cast<uint16_t>(port), false, "", ""));
+        server->setCompression(compression);
+        server->setDelegate(&delegate);
+        server->setServiceThreads(serviceThreads);
+        server->listen();
+        if (serviceThreads == 0) {
+            _serverThread = std::thread([this]() {
+                while (_stopServer == false) {
+                    server->process();
+                }
+            });
+        }
+
+        for (int t = 0; t < nbClientThreads; ++t) {
+            lws_context_creation_info info;
+            memset(&info, 0, sizeof(info));
+            info.port = CONTEXT_PORT_NO_LISTEN;
+            info.protocols = _benchWSClientProtocols;
+            info.fd_limit_per_thread = static_cast<unsigned int>(nbConnections + 64);
+            _clients.push_back(lws_create_context(&info));
+        }
+        for (int i = 0; i < nbConnections; ++i) {
+            lws_client_connect_info ci;
+            memset(&ci, 0, sizeof(ci));
+            ci.context = _clients[static_cast<size_t>(i % nbClientThreads)];
+            ci.address = "127.0.0.1";
+            ci.port = port;
+            ci.path = "/";
+            ci.host = "127.0.0.1";
+            ci.origin = "127.0.0.1";
+            ci.protocol = "join";
+            lws_client_connect_via_info(&ci);
+        }
+        for (lws_context *client : _clients) {
+            _clientThreads.emplace_back([this, client]() {
+                while (_stopClients == false) {
+                    lws_service(client, 0);
+                }
+            });
+        }
+
+        const std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() +
+            std::chrono::seconds(BENCH_WS_SERVER_CONNECT_TIMEOUT_SEC);
+        while (std::chrono::steady_clock::now() < deadline) {
+            {
+                const std::lock_guard<std::mutex> locker(delegate.mutex);
+                if (static_cast<int>(delegate.connections.size()) == nbConnections &&
+                    _benchWSEstablished == static_cast<uint64_t>(nbConnections) &&
+                    (helloDelegate == nullptr || helloDelegate->received == nbConnections)) {
+                    ready = true;
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        if (ready == false) {
+            fprintf(stderr, "bench_ws_server: %d/%d connections established\n",
+                    static_cast<int>(_benchWSEstablished.load()), nbConnections);
+        }
+    }
+
+    ~BenchWSFixture() {
+        _stopClients = true;
+        for (lws_context *client : _clients) {
+            lws_cancel_service(client);
+        }
+        for (std::thread& t : _clientThreads) {
+            t.join();
+        }
+        for (lws_context *client : _clients) {
+            lws_context_destroy(client);
+        }
+        {
+            const std::lock_guard<std::mutex> locker(delegate.mutex);
+            delegate.connections.clear();
+        }
+        _stopServer = true;
+        if (_serverThread.joinable()) {
+            _serverThread.join();
+        }
+        server.reset();
+        _benchWSEchoMessage.clear();
+        _benchWSHelloMessage.clear();
+    }
+
+    /// waits until clients received `nbMessages` messages in total
+    void waitForMessages(uint64_t nbMessages) {
+        while (_benchWSRxMessages < nbMessages) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    bool ready;
+    BenchWSServerDelegate delegate;
+    std::unique_ptr<vx::WSServer> server;
+
+private:
+    std::atomic<bool> _stopServer;
+    std::atomic<bool> _stopClients;
+    std::thread _serverThread;
+    std::vector<lws_context *> _clients;
+    std::vector<std::thread> _clientThreads;
+};
+
+// MARK: - Write path -
+
+// server pushes `count` payloads of `size` bytes to a single client,
+// items are received bytes, frames are lws receive callbacks
+static void _bench_ws_server_write(Bench *b, size_t size, int count) {
+    BenchWSFixture fixture(1, 0);
+    if (fixture.ready == false) {
+        return;
+    }
+    vx::Connection_SharedPtr conn = fixture.delegate.connections[0];
+
+    std::vector<char *> contents;
+    for (int i = 0; i < count; ++i) {
+        char *content = static_cast<char *>(malloc(size));
+        memset(content, i & 0xff, size);
+        contents.push_back(content);
+    }
+
+    bench_start(b);
+    for (char *content : contents) {
+        // payload owns content
+        conn->pushPayloadToWrite(vx::Connection::Payload::create(content, size));
+    }
+    fixture.waitForMessages(static_cast<uint64_t>(count));
+    bench_stop(b);
+    bench_set_items(b, _benchWSRxBytes);
+    bench_set_counter(b, "frames", _benchWSRxFrames);
+}
+
+void bench_ws_server_write_64B(Bench *b) {
+    _bench_ws_server_write(b, 64, 20000);
+}
+
+void bench_ws_server_write_1KB(Bench *b) {
+    _bench_ws_server_write(b, 1024, 10000);
+}
+
+void bench_ws_server_write_64KB(Bench *b) {
+    _bench_ws_server_write(b, 65536, 200);
+}
+
+void bench_ws_server_write_1MB(Bench *b) {
+    _bench_ws_server_write(b, 1 << 20, 20);
+}
+
+// MARK: - Load -
+
+// echo clients w/ BENCH_WS_SERVER_ECHO_WINDOW messages of 64 bytes in flight each,
+// items are messages echoed back to clients within a 1 second window
+static void _bench_ws_server_echo(Bench *b, int nbConnections, size_t serviceThreads) {
+    BenchWSFixture fixture(nbConnections, serviceThreads, 2, 64);
+    if (fixture.ready == false) {
+        return;
+    }
+    // warm up
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    const uint64_t before = _benchWSRxMessages;
+    bench_start(b);
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    bench_stop(b);
+    bench_set_items(b, _benchWSRxMessages - before);
+}
+
+void bench_ws_server_echo_2000_conns_main_thread(Bench *b) {
+    _bench_ws_server_echo(b, 2000, 0);
+}
+
+void bench_ws_server_echo_2000_conns_2_service_threads(Bench *b) {
+    _bench_ws_server_echo(b, 2000, 2);
+}
+
+// MARK: - Broadcast -
+
+// server broadcasts `count` payloads of 64 bytes to `nbConnections` clients,
+// w/ 2 service threads, items are messages received by clients
+static void _bench_ws_server_broadcast(Bench *b, int nbConnections, int count) {
+    BenchWSFixture fixture(nbConnections, 2, 2);
+    if (fixture.ready == false) {
+        return;
+    }
+
+    std::vector<vx::Connection::Payload_SharedPtr> payloads;
+    for (int i = 0; i < count; ++i) {
+        char *content = static_cast<char *>(malloc(64));
+        memset(content, i & 0xff, 64);
+        payloads.push_back(vx::Connection::Payload::create(content, 64));
+    }
+
+    bench_start(b);
+    for (const vx::Connection::Payload_SharedPtr& p : payloads) {
+        fixture.server->broadcast(p);
+    }
+    fixture.waitForMessages(static_cast<uint64_t>(nbConnections) * static_cast<uint64_t>(count));
+    bench_stop(b);
+    bench_set_items(b, _benchWSRxMessages);
+}
+
+void bench_ws_server_broadcast_100_conns(Bench *b) {
+    _bench_ws_server_broadcast(b, 100, 1000);
+}
+
+void bench_ws_server_broadcast_1000_conns(Bench *b) {
+    _bench_ws_server_broadcast(b, 1000, 100);
+}
+
+// MARK: - Compression -
+
+static uint64_t _bench_ws_server_cpu_ns() {
+    timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return static_cast<uint64_t>(t.tv_sec) * 1000000000ull + static_cast<uint64_t>(t.tv_nsec);
+}
+
+// game-like snapshot: entity records w/ increasing IDs & positions drifting from the previous one
+static void _bench_ws_server_snapshot(char *content, size_t size, uint32_t seed) {
+    uint32_t r = seed;
+    uint16_t id = 0;
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    size_t i = 0;
+    while (i < size) {
+        char record[16];
+        memcpy(record, &id, sizeof(uint16_t));
+        record[2] = static_cast<char>(id % 4); // entity type
+        r = r * 1664525u + 1013904223u;
+        record[3] = static_cast<char>((r >> 24) & 0x3); // flags
+        for (int c = 0; c < 3; ++c) {
+            r = r * 1664525u + 1013904223u;
+            position[c] += static_cast<float>(static_cast<int>(r >> 28) - 8) * 0.25f;
+        }
+        memcpy(record + 4, position, sizeof(position));
+        const size_t n = std::min(sizeof(record), size - i);
+        memcpy(content + i, record, n);
+        i += n;
+        ++id;
+    }
+}
+
+// server pushes `count` payloads of `size` bytes to a single client, w/ or w/o compression,
+// items are payload bytes, wire_bytes are received by the client (ratio is items / wire_bytes),
+// cpu_ns is process CPU time (server & client) for the last run
+static void _bench_ws_server_compression(Bench *b, size_t size, int count, bool compression, bool random) {
+    BenchWSFixture fixture(1, 0, 1, 0, compression);
+    if (fixture.ready == false) {
+        bench_fail(b, "connection not established");
+        return;
+    }
+    vx::Connection_SharedPtr conn = fixture.delegate.connections[0];
+
+    std::vector<char *> contents;
+    uint32_t r = 1;
+    for (int i = 0; i < count; ++i) {
+        char *content = static_cast<char *>(malloc(size));
+        if (random) {
+            for (size_t j = 0; j < size; ++j) {
+                r = r * 1664525u + 1013904223u;
+                content[j] = static_cast<char>(r >> 24);
+            }
+        } else {
+            _bench_ws_server_snapshot(content, size, static_cast<uint32_t>(i));
+        }
+        contents.push_back(content);
+    }
+
+    const uint64_t rxBefore = _benchWSRxBytes;
+    const uint64_t messagesBefore = _benchWSRxMessages;
+    const uint64_t cpuBefore = _bench_ws_server_cpu_ns();
+    bench_start(b);
+    for (char *content : contents) {
+        // payload owns content
+        conn->pushPayloadToWrite(vx::Connection::Payload::create(content, size));
+    }
+    fixture.waitForMessages(messagesBefore + static_cast<uint64_t>(count));
+    bench_stop(b);
+    bench_set_items(b, static_cast<uint64_t>(size) * static_cast<uint64_t>(count));
+    bench_set_counter(b, "wire_bytes", _benchWSRxBytes - rxBefore);
+    bench_set_metric(b, "cpu_ns", _bench_ws_server_cpu_ns() - cpuBefore);
+}
+
+void bench_ws_server_compression_1KB_off(Bench *b) {
+    _bench_ws_server_compression(b, 1024, 10000, false, false);
+}
+
+void bench_ws_server_compression_1KB_on(Bench *b) {
+    _bench_ws_server_compression(b, 1024, 10000, true, false);
+}
+
+void bench_ws_server_compression_64KB_off(Bench *b) {
+    _bench_ws_server_compression(b, 65536, 200, false, false);
+}
+
+void bench_ws_server_compression_64KB_on(Bench *b) {
+    _bench_ws_server_compression(b, 65536, 200, true, false);
+}
+
+// incompressible content, cost of trying to compress
+void bench_ws_server_compression_64KB_random_on(Bench *b) {
+    _bench_ws_server_compression(b, 65536, 200, true, true);
+}
@@ -0,0 +1,18 @@
+//
+//  miniaudio_null.cpp
+//  xptools
+//
+
+// miniaudio lib, only w/ the null backend (no audio device needed to run tests)
+#define MA_ENABLE_ONLY_SPECIFIC_BACKENDS
+#define MA_ENABLE_NULL
+
+#define STB_VORBIS_HEADER_ONLY
+#include "extras/stb_vorbis.c"    /* Enables Vorbis decoding. */
+
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+
+/* stb_vorbis implementation must come after the implementation of miniaudio. */
+#undef STB_VORBIS_HEADER_ONLY
+#include "extras/stb_vorbis.c"
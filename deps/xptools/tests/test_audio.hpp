@@ -0,0 +1,149 @@
+//
+//  test_audio.hpp
+//  xptools
+//
+
+#pragma once
+
+// C++
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// xptools
+#include "audio.hpp"
+#include "filesystem.hpp"
+
+using vx::audio::AudioEngine;
+using vx::audio::Sound;
+using vx::audio::Sound_SharedPtr;
+
+#define TEST_AUDIO_SAMPLE_RATE 48000
+
+// Writes a mono 16-bit PCM WAV file in (in-memory) storage, where bundle sounds are looked up
+static void _test_audio_write_wav(const std::string& name, const uint32_t nbFrames) {
+    vx::fs::Helper::shared()->setInMemoryStorage(true);
+
+    const uint32_t dataSize = nbFrames * sizeof(int16_t);
+    std::vector<uint8_t> wav(44 + dataSize);
+    uint8_t *cursor = wav.data();
+    const auto write32 = [&cursor](uint32_t v) { memcpy(cursor, &v, 4); cursor += 4; };
+    const auto write16 = [&cursor](uint16_t v) { memcpy(cursor, &v, 2); cursor += 2; };
+    memcpy(cursor, "RIFF", 4); cursor += 4;
+    write32(36 + dataSize);
+    memcpy(cursor, "WAVEfmt ", 8); cursor += 8;
+    write32(16); // fmt chunk size
+    write16(1); // PCM
+    write16(1); // channels
+    write32(TEST_AUDIO_SAMPLE_RATE);
+    write32(TEST_AUDIO_SAMPLE_RATE * sizeof(int16_t)); // byte rate
+    write16(sizeof(int16_t)); // block align
+    write16(16); // bits per sample
+    memcpy(cursor, "data", 4); cursor += 4;
+    write32(dataSize);
+    for (uint32_t i = 0; i < nbFrames; ++i) {
+        write16(static_cast<uint16_t>(i % 2 == 0 ? 8000 : -8000));
+    }
+
+    FILE *fd = vx::fs::openStorageFile("bundle/audio/" + name, "wb", wav.size());
+    TEST_ASSERT(fd != nullptr);
+    TEST_CHECK(fwrite(wav.data(), 1, wav.size(), fd) == wav.size());
+    fclose(fd);
+}
+
+// Sounds with the same name share decoded data, counted once in cache
+void test_audio_decoded_cache(void) {
+    const uint32_t nbFrames = 4800;
+    _test_audio_write_wav("test_cache.wav", nbFrames);
+
+    AudioEngine *engine = AudioEngine::shared();
+    const size_t cacheSize = engine->getDecodedCacheSize();
+
+    Sound_SharedPtr s1 = Sound::make(engine, "test_cache.wav");
+    TEST_ASSERT(s1 != nullptr);
+    TEST_CHECK(ma_engine_get_device(s1->getEngine())->pContext->backend == ma_backend_null);
+    TEST_CHECK(engine->getDecodedCacheSize() == cacheSize + nbFrames * sizeof(float));
+
+    Sound_SharedPtr s2 = Sound::make(engine, "test_cache.wav");
+    TEST_ASSERT(s2 != nullptr);
+    TEST_CHECK(engine->getDecodedCacheSize() == cacheSize + nbFrames * sizeof(float));
+    TEST_CHECK(s2->getOriginalDuration() == s1->getOriginalDuration());
+}
+
+// Voices beyond the budget steal less important ones, or don't play
+void test_audio_voice_budget(void) {
+    _test_audio_write_wav("test_voice.wav", TEST_AUDIO_SAMPLE_RATE * 2);
+
+    AudioEngine *engine = AudioEngine::shared();
+    const size_t maxVoices = engine->getMaxVoices();
+    engine->setMaxVoices(2);
+
+    std::vector<Sound_SharedPtr> sounds;
+    for (int priority : {0, 0, 1, -1}) {
+        Sound_SharedPtr s = Sound::make(engine, "test_voice.wav");
+        TEST_ASSERT(s != nullptr);
+        s->setPriority(priority);
+        sounds.push_back(s);
+    }
+
+    sounds[0]->play();
+    sounds[1]->play();
+    TEST_CHECK(engine->getPlayingVoicesCount() == 2);
+
+    // steals one of the first two voices
+    sounds[2]->play();
+    TEST_CHECK(sounds[2]->isPlaying());
+    TEST_CHECK(engine->getPlayingVoicesCount() == 2);
+
+    // least important, doesn't play
+    sounds[3]->play();
+    TEST_CHECK(sounds[3]->isPlaying() == false);
+    TEST_CHECK(engine->getPlayingVoicesCount() == 2);
+
+    for (const Sound_SharedPtr& s : sounds) {
+        s->stopWithoutFadeOut();
+    }
+    TEST_CHECK(engine->getPlayingVoicesCount() == 0);
+    engine->setMaxVoices(maxVoices);
+}
+
+// Sounds made & played from several threads while the engine is queried
+void test_audio_concurrent_sounds(void) {
+    const uint32_t nbFrames = 2400;
+    _test_audio_write_wav("test_concurrent_a.wav", nbFrames);
+    _test_audio_write_wav("test_concurrent_b.wav", nbFrames);
+
+    AudioEngine *engine = AudioEngine::shared();
+    const size_t maxVoices = engine->getMaxVoices();
+    engine->setMaxVoices(4);
+    const size_t cacheSize = engine->getDecodedCacheSize();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([engine, t]() {
+            for (int i = 0; i < 50; ++i) {
+                Sound_SharedPtr s = Sound::make(engine, (i + t) % 2 == 0 ? "test_concurrent_a.wav"
+                                                                         : "test_concurrent_b.wav");
+                if (s != nullptr) {
+                    s->setPriority(i % 3);
+                    s->play();
+                }
+            }
+        });
+    }
+    bool withinBudget = true;
+    for (int i = 0; i < 100; ++i) {
+        withinBudget = withinBudget && engine->getPlayingVoicesCount() <= 4;
+        vx::audio::SoundsTicks::shared()->tick(0.001);
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    TEST_CHECK(withinBudget);
+    TEST_CHECK(engine->getPlayingVoicesCount() <= 4);
+    // each sound decoded once
+    TEST_CHECK(engine->getDecodedCacheSize() == cacheSize + 2 * nbFrames * sizeof(float));
+    engine->setMaxVoices(maxVoices);
+}
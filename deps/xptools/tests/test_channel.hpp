@@ -0,0 +1,62 @@
+//
+//  test_channel.hpp
+//  xptools
+//
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// xptools
+#include "Channel.hpp"
+
+// Several producers & consumers on a small ring (using overflow queue),
+// each message is popped exactly once
+void test_channel_multiple_consumers(void) {
+    const int nbThreads = 4;
+    const int perProducer = 20000;
+    const int total = nbThreads * perProducer;
+    vx::Channel<int> channel(8);
+    std::vector<std::atomic<int>> popped(total);
+    for (std::atomic<int>& p : popped) {
+        p = 0;
+    }
+    std::atomic<int> nbPopped(0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nbThreads; ++t) {
+        threads.emplace_back([&channel, t]() {
+            for (int i = 0; i < perProducer; ++i) {
+                channel.push(t * perProducer + i);
+            }
+        });
+        threads.emplace_back([&channel, &popped, &nbPopped, total]() {
+            int msg;
+            std::vector<int> msgs;
+            while (nbPopped < total) {
+                if (channel.pop(msg)) {
+                    ++popped[msg];
+                    ++nbPopped;
+                }
+                msgs.clear();
+                nbPopped += static_cast<int>(channel.popAll(msgs));
+                for (int m : msgs) {
+                    ++popped[m];
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    TEST_CHECK(nbPopped == total);
+    bool once = true;
+    for (const std::atomic<int>& p : popped) {
+        once = once && p == 1;
+    }
+    TEST_CHECK(once);
+}
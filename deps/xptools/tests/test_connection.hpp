@@ -0,0 +1,108 @@
+//
+//  test_connection.hpp
+//  xptools
+//
+
+#pragma once
+
+// C++
+#include <cstring>
+#include <string>
+
+// xptools
+#include "Connection.hpp"
+
+using vx::Connection;
+
+// Released buffers are recycled, keeping their capacity but not their content
+void test_connection_receive_buffer_pool(void) {
+    Connection::ReceiveBuffer *buffer = Connection::ReceiveBuffer::get();
+    TEST_CHECK(buffer->getSize() == 0);
+    TEST_CHECK(buffer->append("hello", 5));
+    TEST_CHECK(buffer->append(" world", 6));
+    TEST_CHECK(buffer->getSize() == 11);
+    TEST_CHECK(memcmp(buffer->getBytes(), "hello world", 11) == 0);
+    char *bytes = buffer->getBytes();
+    buffer->release();
+
+    Connection::ReceiveBuffer *recycled = Connection::ReceiveBuffer::get();
+    TEST_CHECK(recycled == buffer);
+    TEST_CHECK(recycled->getSize() == 0);
+    TEST_CHECK(recycled->append("abc", 3));
+    TEST_CHECK(recycled->getBytes() == bytes);
+
+    // decoded Payload adopts the buffer & releases it back to the pool
+    Connection::Payload_SharedPtr p = Connection::Payload::decode(recycled);
+    p = nullptr;
+    recycled = Connection::ReceiveBuffer::get();
+    TEST_CHECK(recycled == buffer);
+    recycled->release();
+}
+
+// Serializes `p` as written on the wire (metadata + content), then decodes it
+static Connection::Payload_SharedPtr _test_connection_loopback(const Connection::Payload_SharedPtr& p) {
+    if (p->createMetadataIfNull() == false) {
+        return nullptr;
+    }
+    Connection::ReceiveBuffer *buffer = Connection::ReceiveBuffer::get();
+    if (buffer->append(p->getMetadata(), p->metadataSize()) == false ||
+        buffer->append(p->getContent(), p->contentSize()) == false) {
+        buffer->release();
+        return nullptr;
+    }
+    return Connection::Payload::decode(buffer);
+}
+
+// Compressed & uncompressed Payloads go through create, write & decode unchanged
+void test_connection_payload_compression_round_trip(void) {
+    const std::string text = "compressible content, compressible content, compressible content, "
+                             "compressible content, compressible content, compressible content";
+
+    // uncompressed
+    char *content = static_cast<char *>(malloc(text.size()));
+    memcpy(content, text.data(), text.size());
+    Connection::Payload_SharedPtr p = Connection::Payload::create(content, text.size(),
+                                                                  Connection::Payload::Includes::PayloadID);
+    Connection::Payload_SharedPtr decoded = _test_connection_loopback(p);
+    TEST_ASSERT(decoded != nullptr);
+    TEST_CHECK(decoded->acceptsCompression() == false);
+    TEST_CHECK(decoded->contentSize() == text.size());
+    TEST_CHECK(memcmp(decoded->getContent(), text.data(), text.size()) == 0);
+
+    // compressed, computed once & smaller than original
+    Connection::Payload_SharedPtr compressed = p->getCompressed();
+    TEST_ASSERT(compressed != nullptr);
+    TEST_CHECK(p->getCompressed() == compressed);
+    TEST_CHECK(compressed->contentSize() < p->contentSize());
+    decoded = _test_connection_loopback(compressed);
+    TEST_ASSERT(decoded != nullptr);
+    TEST_CHECK(decoded->contentSize() == text.size());
+    TEST_CHECK(memcmp(decoded->getContent(), text.data(), text.size()) == 0);
+
+    // sender accepting compression
+    content = static_cast<char *>(malloc(text.size()));
+    memcpy(content, text.data(), text.size());
+    p = Connection::Payload::create(content, text.size(),
+                                    Connection::Payload::Includes::AcceptsCompression);
+    decoded = _test_connection_loopback(p->getCompressed());
+    TEST_ASSERT(decoded != nullptr);
+    TEST_CHECK(decoded->acceptsCompression());
+    TEST_CHECK(decoded->contentSize() == text.size());
+    TEST_CHECK(memcmp(decoded->getContent(), text.data(), text.size()) == 0);
+
+    // not compressed when it doesn't make it smaller
+    content = static_cast<char *>(malloc(4));
+    memcpy(content, "abcd", 4);
+    p = Connection::Payload::create(content, 4);
+    TEST_CHECK(p->getCompressed() == nullptr);
+    decoded = _test_connection_loopback(p);
+    TEST_ASSERT(decoded != nullptr);
+    TEST_CHECK(decoded->contentSize() == 4);
+    TEST_CHECK(memcmp(decoded->getContent(), "abcd", 4) == 0);
+
+    // corrupted compressed content fails to decode
+    Connection::ReceiveBuffer *buffer = Connection::ReceiveBuffer::get();
+    const char corrupted[] = {Connection::Payload::Includes::Compressed, 16, 0, 0, 0, 'x', 'y', 'z'};
+    TEST_CHECK(buffer->append(corrupted, sizeof(corrupted)));
+    TEST_CHECK(Connection::Payload::decode(buffer) == nullptr);
+}
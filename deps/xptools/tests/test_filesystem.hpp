@@ -0,0 +1,314 @@
+//
+//  test_filesystem.hpp
+//  xptools
+//
+
+#pragma once
+
+// C++
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// C
+#include <sys/stat.h>
+#include <unistd.h>
+
+// xptools
+#include "filesystem.hpp"
+
+// core (archive writer)
+#include "asset_archive.h"
+
+// fixture directory, created in the bundle & removed by each test
+#define TEST_FILESYSTEM_BUNDLE_DIR "xptools_tests_fs"
+#define TEST_FILESYSTEM_STORAGE_PREFIX "xptools_tests"
+// archives are written in the current directory
+#define TEST_FILESYSTEM_ARCHIVE_NAME "xptools_tests.czha"
+
+static bool _test_filesystem_write(FILE *fd, const std::string& content) {
+    if (fd == nullptr) {
+        return false;
+    }
+    const bool ok = fwrite(content.c_str(), 1, content.size(), fd) == content.size();
+    fclose(fd);
+    return ok;
+}
+
+// returns "<none>" if file can't be opened
+static std::string _test_filesystem_read(FILE *fd) {
+    if (fd == nullptr) {
+        return "<none>";
+    }
+    std::string content;
+    vx::fs::getFileTextContentAsStringAndClose(fd, content);
+    return content;
+}
+
+static bool _test_filesystem_bundle_fixture_create(void) {
+    const std::string dir = vx::fs::getBundleFilePath(TEST_FILESYSTEM_BUNDLE_DIR);
+    mkdir(dir.c_str(), 0755);
+    mkdir((dir + "/sub").c_str(), 0755);
+    return _test_filesystem_write(fopen((dir + "/a.txt").c_str(), "wb"), "bundle a") &&
+           _test_filesystem_write(fopen((dir + "/c.txt").c_str(), "wb"), "bundle c") &&
+           _test_filesystem_write(fopen((dir + "/sub/b.txt").c_str(), "wb"), "bundle b");
+}
+
+static void _test_filesystem_fixtures_remove(void) {
+    const std::string dir = vx::fs::getBundleFilePath(TEST_FILESYSTEM_BUNDLE_DIR);
+    unlink((dir + "/a.txt").c_str());
+    unlink((dir + "/c.txt").c_str());
+    unlink((dir + "/sub/b.txt").c_str());
+    rmdir((dir + "/sub").c_str());
+    rmdir(dir.c_str());
+
+    vx::fs::Helper::shared()->setBundleOverlay(false);
+    vx::fs::removeStorageFileOrDirectory(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt");
+    vx::fs::removeStorageFileOrDirectory(TEST_FILESYSTEM_BUNDLE_DIR "/c.txt");
+    vx::fs::removeStorageFileOrDirectory(TEST_FILESYSTEM_BUNDLE_DIR "/sub/b.txt");
+    vx::fs::removeStorageFileOrDirectory(TEST_FILESYSTEM_BUNDLE_DIR "/sub");
+    vx::fs::removeStorageFileOrDirectory(TEST_FILESYSTEM_BUNDLE_DIR);
+}
+
+// storage directory has to exist for merged files to be copied
+static bool _test_filesystem_storage_dir_create(const std::string& relDir) {
+    FILE *fd = vx::fs::openStorageFile(relDir + "/tmp", "wb");
+    if (fd == nullptr) {
+        return false;
+    }
+    fclose(fd);
+    return vx::fs::removeStorageFileOrDirectory(relDir + "/tmp");
+}
+
+// Merged bundle files are copied in storage at the path they have in the bundle,
+// whatever the storage directory is
+void test_filesystem_merge_bundle_dir_copy(void) {
+    vx::fs::Helper::shared()->setStorageRelPathPrefix(TEST_FILESYSTEM_STORAGE_PREFIX);
+    _test_filesystem_fixtures_remove();
+    TEST_ASSERT(_test_filesystem_bundle_fixture_create());
+    TEST_ASSERT(_test_filesystem_storage_dir_create(TEST_FILESYSTEM_BUNDLE_DIR "/sub"));
+
+    vx::fs::mergeBundleDirInStorage(TEST_FILESYSTEM_BUNDLE_DIR, TEST_FILESYSTEM_BUNDLE_DIR "/sub");
+
+    TEST_CHECK(_test_filesystem_read(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt")) == "bundle a");
+    TEST_CHECK(_test_filesystem_read(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/sub/b.txt")) == "bundle b");
+    bool isDir = false;
+    TEST_CHECK(vx::fs::storageFileExists(TEST_FILESYSTEM_BUNDLE_DIR "/sub/a.txt", isDir) == false);
+
+    _test_filesystem_fixtures_remove();
+    vx::fs::Helper::shared()->setStorageRelPathPrefix("");
+}
+
+// With bundle overlay, merged bundle files are read in place until written or removed in storage
+void test_filesystem_bundle_overlay(void) {
+    vx::fs::Helper::shared()->setStorageRelPathPrefix(TEST_FILESYSTEM_STORAGE_PREFIX);
+    _test_filesystem_fixtures_remove();
+    TEST_ASSERT(_test_filesystem_bundle_fixture_create());
+
+    TEST_ASSERT(vx::fs::Helper::shared()->setBundleOverlay(true));
+    vx::fs::mergeBundleDirInStorage(TEST_FILESYSTEM_BUNDLE_DIR, TEST_FILESYSTEM_BUNDLE_DIR);
+
+    // nothing copied
+    struct stat stat_buf;
+    const std::string absStorageDir = "/storage/" TEST_FILESYSTEM_STORAGE_PREFIX "/" TEST_FILESYSTEM_BUNDLE_DIR;
+    TEST_CHECK(stat(absStorageDir.c_str(), &stat_buf) != 0);
+
+    bool isDir = false;
+    TEST_CHECK(vx::fs::storageFileExists(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt", isDir) && isDir == false);
+    TEST_CHECK(vx::fs::storageFileExists(TEST_FILESYSTEM_BUNDLE_DIR "/sub", isDir) && isDir);
+    TEST_CHECK(_test_filesystem_read(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt")) == "bundle a");
+    TEST_CHECK(vx::fs::listStorageDirectory(TEST_FILESYSTEM_BUNDLE_DIR).size() == 3);
+
+    // written in storage, bundle file left untouched
+    TEST_CHECK(_test_filesystem_write(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt", "wb"), "storage a"));
+    TEST_CHECK(_test_filesystem_read(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt")) == "storage a");
+    TEST_CHECK(_test_filesystem_read(vx::fs::openBundleFile(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt")) == "bundle a");
+
+    // appending starts from the bundle file
+    TEST_CHECK(_test_filesystem_write(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/sub/b.txt", "ab"), "+"));
+    TEST_CHECK(_test_filesystem_read(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/sub/b.txt")) == "bundle b+");
+
+    // removed files don't fall back to the bundle
+    TEST_CHECK(vx::fs::removeStorageFileOrDirectory(TEST_FILESYSTEM_BUNDLE_DIR "/c.txt"));
+    TEST_CHECK(vx::fs::storageFileExists(TEST_FILESYSTEM_BUNDLE_DIR "/c.txt", isDir) == false);
+    TEST_CHECK(_test_filesystem_read(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/c.txt")) == "<none>");
+    TEST_CHECK(vx::fs::removeStorageFileOrDirectory(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt"));
+    TEST_CHECK(vx::fs::storageFileExists(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt", isDir) == false);
+    const std::vector<std::string> files = vx::fs::listStorageDirectory(TEST_FILESYSTEM_BUNDLE_DIR);
+    TEST_CHECK(files.size() == 1);
+    TEST_CHECK(std::find(files.begin(), files.end(), TEST_FILESYSTEM_BUNDLE_DIR "/sub") != files.end());
+
+    // merging again brings them back
+    vx::fs::mergeBundleDirInStorage(TEST_FILESYSTEM_BUNDLE_DIR, TEST_FILESYSTEM_BUNDLE_DIR);
+    TEST_CHECK(_test_filesystem_read(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/c.txt")) == "bundle c");
+
+    _test_filesystem_fixtures_remove();
+    vx::fs::Helper::shared()->setStorageRelPathPrefix("");
+}
+
+// writes archive built by `w` at given path, returns false on failure
+static bool _test_filesystem_archive_write(AssetArchiveWriter *w, const std::string& path) {
+    FILE *fd = fopen(path.c_str(), "wb");
+    if (fd == nullptr) {
+        return false;
+    }
+    const bool ok = asset_archive_writer_write(w, fd);
+    fclose(fd);
+    return ok;
+}
+
+static std::string _test_filesystem_archive_path(void) {
+    char cwd[1024];
+    if (getcwd(cwd, sizeof(cwd)) == nullptr) {
+        return TEST_FILESYSTEM_ARCHIVE_NAME;
+    }
+    return std::string(cwd) + "/" + TEST_FILESYSTEM_ARCHIVE_NAME;
+}
+
+// Stored entries are viewed in place, compressed ones are inflated
+void test_filesystem_archive_read(void) {
+    char text[1000];
+    for (int i = 0; i < 1000; ++i) {
+        text[i] = static_cast<char>('a' + i % 4);
+    }
+    const std::string small = "hello";
+
+    AssetArchiveWriter *w = asset_archive_writer_new();
+    TEST_CHECK(asset_archive_writer_add(w, "shapes/a.3zh", small.c_str(), small.size(), false));
+    TEST_CHECK(asset_archive_writer_add(w, "shaders/text.txt", text, sizeof(text), true));
+    TEST_CHECK(asset_archive_writer_add(w, "empty", nullptr, 0, true));
+    const std::string path = _test_filesystem_archive_path();
+    TEST_ASSERT(_test_filesystem_archive_write(w, path));
+    asset_archive_writer_free(w);
+
+    std::shared_ptr<vx::fs::Archive> archive = vx::fs::Archive::open(path);
+    TEST_ASSERT(archive != nullptr);
+    TEST_CHECK(archive->getPaths().size() == 3);
+    TEST_CHECK(archive->contains("shapes/a.3z") == false);
+    TEST_CHECK(archive->contains("shapes/b.3zh") == false);
+    TEST_CHECK(archive->getContent("shapes/b.3zh", nullptr) == nullptr);
+
+    const void *data = nullptr;
+    size_t size = 0;
+    TEST_CHECK(archive->contains("shapes/a.3zh"));
+    TEST_ASSERT(archive->getView("shapes/a.3zh", data, size));
+    TEST_CHECK(size == small.size() && memcmp(data, small.c_str(), size) == 0);
+    TEST_CHECK(reinterpret_cast<uintptr_t>(data) % ASSET_ARCHIVE_DATA_ALIGNMENT == 0);
+
+    TEST_CHECK(archive->getView("shaders/text.txt", data, size) == false);
+    void *content = archive->getContent("shaders/text.txt", &size);
+    TEST_ASSERT(content != nullptr);
+    TEST_CHECK(size == sizeof(text) && memcmp(content, text, size) == 0);
+    free(content);
+
+    content = archive->getContent("empty", &size);
+    TEST_CHECK(content != nullptr && size == 0);
+    free(content);
+    archive = nullptr;
+
+    // truncated archive is rejected
+    FILE *fd = fopen(path.c_str(), "rb");
+    TEST_ASSERT(fd != nullptr);
+    size_t fileSize = 0;
+    void *bytes = vx::fs::getFileContent(fd, &fileSize);
+    TEST_ASSERT(bytes != nullptr);
+    fd = fopen(path.c_str(), "wb");
+    TEST_ASSERT(fd != nullptr);
+    fwrite(bytes, 1, fileSize - 1, fd);
+    fclose(fd);
+    free(bytes);
+    TEST_CHECK(vx::fs::Archive::open(path) == nullptr);
+
+    remove(path.c_str());
+}
+
+// Corrupted headers are rejected, offsets can't wrap around
+void test_filesystem_archive_corrupted_header(void) {
+    AssetArchiveWriter *w = asset_archive_writer_new();
+    TEST_CHECK(asset_archive_writer_add(w, "a", "1", 1, false));
+    const std::string path = _test_filesystem_archive_path();
+    TEST_ASSERT(_test_filesystem_archive_write(w, path));
+    asset_archive_writer_free(w);
+    TEST_CHECK(vx::fs::Archive::open(path) != nullptr);
+
+    FILE *fd = fopen(path.c_str(), "rb");
+    TEST_ASSERT(fd != nullptr);
+    size_t size = 0;
+    uint8_t *bytes = static_cast<uint8_t *>(vx::fs::getFileContent(fd, &size));
+    TEST_ASSERT(bytes != nullptr);
+
+    // header: magic, version, entry count, paths size (uint32), paths offset (uint64 at 16)
+    uint32_t pathsSize;
+    memcpy(&pathsSize, bytes + 12, sizeof(uint32_t));
+    uint64_t pathsOffset;
+    memcpy(&pathsOffset, bytes + 16, sizeof(uint64_t));
+
+    // paths offset + paths size wraps around to a valid size, paths would be 2GB before bytes
+    const uint32_t hugePathsSize = 0x80000000;
+    const uint64_t wrapping = UINT64_MAX - hugePathsSize + 1 + pathsOffset;
+    memcpy(bytes + 12, &hugePathsSize, sizeof(uint32_t));
+    memcpy(bytes + 16, &wrapping, sizeof(uint64_t));
+    fd = fopen(path.c_str(), "wb");
+    TEST_ASSERT(fd != nullptr && fwrite(bytes, 1, size, fd) == size);
+    fclose(fd);
+    TEST_CHECK(vx::fs::Archive::open(path) == nullptr);
+
+    // paths beyond the end
+    memcpy(bytes + 16, &pathsOffset, sizeof(uint64_t));
+    const uint32_t bigPathsSize = static_cast<uint32_t>(size);
+    memcpy(bytes + 12, &bigPathsSize, sizeof(uint32_t));
+    fd = fopen(path.c_str(), "wb");
+    TEST_ASSERT(fd != nullptr && fwrite(bytes, 1, size, fd) == size);
+    fclose(fd);
+    TEST_CHECK(vx::fs::Archive::open(path) == nullptr);
+
+    // restored
+    memcpy(bytes + 12, &pathsSize, sizeof(uint32_t));
+    fd = fopen(path.c_str(), "wb");
+    TEST_ASSERT(fd != nullptr && fwrite(bytes, 1, size, fd) == size);
+    fclose(fd);
+    TEST_CHECK(vx::fs::Archive::open(path) != nullptr);
+
+    free(bytes);
+    remove(path.c_str());
+}
+
+// Bundle archive found in the bundle is mounted, bundle files are read from it first,
+// including storage files falling back to the bundle
+void test_filesystem_bundle_archive(void) {
+    const std::string path = vx::fs::getBundleFilePath(VX_BUNDLE_ARCHIVE_FILENAME);
+    const std::string compressible(1000, 'a');
+
+    AssetArchiveWriter *w = asset_archive_writer_new();
+    TEST_CHECK(asset_archive_writer_add(w, TEST_FILESYSTEM_BUNDLE_DIR "/stored.txt", "stored", 6, false));
+    TEST_CHECK(asset_archive_writer_add(w, TEST_FILESYSTEM_BUNDLE_DIR "/compressed.txt",
+                                        compressible.c_str(), compressible.size(), true));
+    TEST_ASSERT(_test_filesystem_archive_write(w, path));
+    asset_archive_writer_free(w);
+
+    TEST_CHECK(vx::fs::Helper::shared()->mountBundleArchive());
+
+    bool isDir = true;
+    TEST_CHECK(vx::fs::bundleFileExists(TEST_FILESYSTEM_BUNDLE_DIR "/stored.txt", isDir) && isDir == false);
+    TEST_CHECK(_test_filesystem_read(vx::fs::openBundleFile(TEST_FILESYSTEM_BUNDLE_DIR "/stored.txt")) == "stored");
+    TEST_CHECK(_test_filesystem_read(vx::fs::openBundleFile(TEST_FILESYSTEM_BUNDLE_DIR "/compressed.txt")) == compressible);
+    TEST_CHECK(vx::fs::openBundleFile(TEST_FILESYSTEM_BUNDLE_DIR "/missing.txt") == nullptr);
+
+    // overlaid storage directory
+    vx::fs::Helper::shared()->setStorageRelPathPrefix(TEST_FILESYSTEM_STORAGE_PREFIX);
+    _test_filesystem_fixtures_remove();
+    TEST_ASSERT(_test_filesystem_bundle_fixture_create());
+    TEST_ASSERT(vx::fs::Helper::shared()->setBundleOverlay(true));
+    vx::fs::mergeBundleDirInStorage(TEST_FILESYSTEM_BUNDLE_DIR, TEST_FILESYSTEM_BUNDLE_DIR);
+    TEST_CHECK(_test_filesystem_read(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/stored.txt")) == "stored");
+    TEST_CHECK(_test_filesystem_read(vx::fs::openStorageFile(TEST_FILESYSTEM_BUNDLE_DIR "/a.txt")) == "bundle a");
+    _test_filesystem_fixtures_remove();
+    vx::fs::Helper::shared()->setStorageRelPathPrefix("");
+
+    // unmounted
+    vx::fs::Helper::shared()->setBundleArchive(nullptr);
+    TEST_CHECK(vx::fs::openBundleFile(TEST_FILESYSTEM_BUNDLE_DIR "/stored.txt") == nullptr);
+    remove(path.c_str());
+}
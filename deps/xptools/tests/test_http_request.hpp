@@ -0,0 +1,161 @@
+//
+//  test_http_request.hpp
+//  xptools
+//
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// POSIX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// xptools
+#include "filesystem.hpp"
+#include "HttpClient.hpp"
+#include "HttpRequest.hpp"
+
+#define TEST_HTTP_REQUEST_TIMEOUT_SEC 10
+// server waits before responding, for identical requests to be coalesced
+#define TEST_HTTP_REQUEST_RESPONSE_DELAY_MS 300
+
+// minimal HTTP server on 127.0.0.1, answering "hello" to each request it receives
+class TestHttpServer final {
+public:
+    TestHttpServer() : port(0), requests(0), _fd(-1), _stop(false) {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0; // any available port
+        socklen_t len = sizeof(addr);
+        if (bind(_fd, reinterpret_cast<struct sockaddr *>(&addr), len) != 0 ||
+            listen(_fd, 8) != 0 ||
+            getsockname(_fd, reinterpret_cast<struct sockaddr *>(&addr), &len) != 0) {
+            close(_fd);
+            _fd = -1;
+            return;
+        }
+        port = ntohs(addr.sin_port);
+        _thread = std::thread(&TestHttpServer::_serve, this);
+    }
+
+    ~TestHttpServer() {
+        _stop = true;
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+        if (_fd >= 0) {
+            close(_fd);
+        }
+    }
+
+    uint16_t port;
+    std::atomic<int> requests;
+
+private:
+    void _serve() {
+        while (_stop == false) {
+            struct pollfd pfd = {_fd, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0) {
+                continue;
+            }
+            const int conn = accept(_fd, nullptr, nullptr);
+            if (conn < 0) {
+                continue;
+            }
+            // read request headers
+            std::string request;
+            char buf[512];
+            while (request.find("\r\n\r\n") == std::string::npos) {
+                const ssize_t n = recv(conn, buf, sizeof(buf), 0);
+                if (n <= 0) {
+                    break;
+                }
+                request.append(buf, static_cast<size_t>(n));
+            }
+            if (request.find("\r\n\r\n") != std::string::npos) {
+                ++requests;
+                std::this_thread::sleep_for(std::chrono::milliseconds(TEST_HTTP_REQUEST_RESPONSE_DELAY_MS));
+                const std::string response = "HTTP/1.1 200 OK\r\n"
+                                             "Content-Length: 5\r\n"
+                                             "Connection: close\r\n"
+                                             "\r\n"
+                                             "hello";
+                // client may be gone if its request has been cancelled
+                send(conn, response.c_str(), response.size(), MSG_NOSIGNAL);
+            }
+            close(conn);
+        }
+    }
+
+    int _fd;
+    std::atomic<bool> _stop;
+    std::thread _thread;
+};
+
+// Cancelling the in-flight request of coalesced GETs sends one of the requests that were
+// waiting for it instead, all of them still get the response
+void test_http_request_coalesced_leader_cancelled(void) {
+    TestHttpServer server;
+    TEST_ASSERT(server.port != 0);
+
+    // HTTP cache files are not written on disk
+    const bool inMemoryStorage = vx::fs::Helper::shared()->inMemoryStorage();
+    vx::fs::Helper::shared()->setInMemoryStorage(true);
+
+    const uint64_t networkGETs = vx::HttpClient::shared().getNetworkGETsCount();
+
+    std::atomic<int> leaderCallbacks(0);
+    std::atomic<int> done(0);
+    std::atomic<int> failed(0);
+
+    const size_t nbRequests = 3;
+    vx::HttpRequest_SharedPtr reqs[nbRequests];
+    for (size_t i = 0; i < nbRequests; ++i) {
+        reqs[i] = vx::HttpRequest::make("GET", "127.0.0.1", server.port, "/coalesced", vx::QueryParams(), false);
+        reqs[i]->setCallback([i, &leaderCallbacks, &done, &failed](vx::HttpRequest_SharedPtr req) {
+            if (i == 0) {
+                ++leaderCallbacks;
+                return;
+            }
+            std::string bytes;
+            req->getResponse().readAllBytes(bytes);
+            if (req->getStatus() == vx::HttpRequest::Status::DONE && bytes == "hello") {
+                ++done;
+            } else {
+                ++failed;
+            }
+        });
+    }
+    for (size_t i = 0; i < nbRequests; ++i) {
+        reqs[i]->sendAsync();
+    }
+    // leader is cancelled while the server is still holding its response
+    reqs[0]->cancel();
+
+    const std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(TEST_HTTP_REQUEST_TIMEOUT_SEC);
+    while (done + failed < static_cast<int>(nbRequests - 1) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    TEST_CHECK(done == static_cast<int>(nbRequests - 1));
+    TEST_MSG("%d of %d waiting requests completed", static_cast<int>(done), static_cast<int>(nbRequests - 1));
+    TEST_CHECK(failed == 0);
+    TEST_CHECK(leaderCallbacks == 0);
+    // the leader, then the waiting request sent in its place
+    TEST_CHECK(vx::HttpClient::shared().getNetworkGETsCount() - networkGETs == 2);
+
+    vx::fs::Helper::shared()->setInMemoryStorage(inMemoryStorage);
+}
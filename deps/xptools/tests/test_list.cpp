@@ -0,0 +1,45 @@
+//
+//  test_list.cpp
+//  xptools
+//
+
+// acutest is shared w/ core unit tests
+#include "acutest.h"
+
+#include "test_audio.hpp"
+#include "test_channel.hpp"
+#include "test_connection.hpp"
+#include "test_filesystem.hpp"
+#include "test_http_request.hpp"
+#include "test_operation_queue.hpp"
+
+TEST_LIST = {
+
+    // Audio
+    {"audio_decoded_cache", test_audio_decoded_cache},
+    {"audio_voice_budget", test_audio_voice_budget},
+    {"audio_concurrent_sounds", test_audio_concurrent_sounds},
+
+    // Channel
+    {"channel_multiple_consumers", test_channel_multiple_consumers},
+
+    // Connection
+    {"connection_receive_buffer_pool", test_connection_receive_buffer_pool},
+    {"connection_payload_compression_round_trip", test_connection_payload_compression_round_trip},
+
+    // Filesystem
+    {"filesystem_merge_bundle_dir_copy", test_filesystem_merge_bundle_dir_copy},
+    {"filesystem_bundle_overlay", test_filesystem_bundle_overlay},
+    {"filesystem_archive_read", test_filesystem_archive_read},
+    {"filesystem_archive_corrupted_header", test_filesystem_archive_corrupted_header},
+    {"filesystem_bundle_archive", test_filesystem_bundle_archive},
+
+    // HttpRequest
+    {"http_request_coalesced_leader_cancelled", test_http_request_coalesced_leader_cancelled},
+
+    // OperationQueue
+    {"operation_queue_serial_order", test_operation_queue_serial_order},
+    {"operation_queue_background_nested", test_operation_queue_background_nested},
+    {"operation_queue_scheduled_while_busy", test_operation_queue_scheduled_while_busy},
+
+    {NULL, NULL}};
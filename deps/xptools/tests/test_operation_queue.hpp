@@ -0,0 +1,110 @@
+//
+//  test_operation_queue.hpp
+//  xptools
+//
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+// xptools
+#include "OperationQueue.hpp"
+
+// Operations dispatched on the serial queue, from outside & from the queue's own worker,
+// run in dispatch order
+void test_operation_queue_serial_order(void) {
+    vx::OperationQueue *queue = vx::OperationQueue::getSerialBackground();
+    const int n = 1000;
+    std::atomic<int> last(-1);
+    std::atomic<int> done(0);
+    std::atomic<bool> ordered(true);
+    std::atomic<bool> released(false);
+
+    // holds the worker until all operations are dispatched
+    queue->dispatch([&released]() {
+        while (released == false) {
+            std::this_thread::yield();
+        }
+    });
+    for (int i = 0; i < n; ++i) {
+        queue->dispatch([i, n, queue, &last, &done, &ordered]() {
+            if (last + 1 != i) {
+                ordered = false;
+            }
+            last = i;
+            if (i == 0) {
+                // dispatched while operations 1...n-1 are already queued, must run after them
+                queue->dispatch([n, &last, &done, &ordered]() {
+                    if (last != n - 1) {
+                        ordered = false;
+                    }
+                    last = n;
+                    ++done;
+                });
+            }
+            ++done;
+        });
+    }
+    released = true;
+    for (int i = 0; i < 1000 && done < n + 1; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TEST_CHECK(done == n + 1);
+    TEST_CHECK(ordered);
+}
+
+// Operations dispatched from background workers (landing in their own queues) are all run
+void test_operation_queue_background_nested(void) {
+    vx::OperationQueue *queue = vx::OperationQueue::getBackground();
+    const int n = 1000;
+    std::atomic<int> done(0);
+
+    for (int i = 0; i < n; ++i) {
+        queue->dispatch([queue, &done]() {
+            queue->dispatch([&done]() { ++done; });
+            queue->dispatchFirst([&done]() { ++done; });
+            ++done;
+        });
+    }
+    for (int i = 0; i < 1000 && done < 3 * n; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TEST_CHECK(done == 3 * n);
+}
+
+// Scheduled operations are triggered on time even if the queue never runs out of operations
+void test_operation_queue_scheduled_while_busy(void) {
+    vx::OperationQueue *queue = vx::OperationQueue::getSerialBackground();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::chrono::steady_clock::time_point deadline = start + std::chrono::seconds(5);
+    std::atomic<bool> fired(false);
+    std::atomic<bool> busyDone(false);
+    std::atomic<int64_t> firedAfterMs(-1);
+
+    // keeps the queue busy by dispatching itself again, until the timer fires (or deadline)
+    std::function<void()> busy;
+    busy = [queue, deadline, &busy, &fired, &busyDone]() {
+        if (fired || std::chrono::steady_clock::now() > deadline) {
+            busyDone = true;
+            return;
+        }
+        queue->dispatch(busy);
+    };
+    queue->dispatch(busy);
+    queue->schedule([start, &fired, &firedAfterMs]() {
+        firedAfterMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        fired = true;
+    }, 10);
+
+    while (busyDone == false) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TEST_CHECK(fired);
+    TEST_CHECK(firedAfterMs >= 10 && firedAfterMs < 1000);
+    TEST_MSG("fired after %lld ms", static_cast<long long>(firedAfterMs));
+}
@@ -522,3 +522,8 @@ bool vx::fs::Helper::setInMemoryStorage(bool b) {
     // in memory storage not allowed on Android for now
     return false;
 }
+
+bool vx::fs::Helper::setBundleOverlay(bool b) {
+    // bundle overlay not supported on the web for now
+    return false;
+}
@@ -946,6 +946,11 @@ bool vx::fs::Helper::setInMemoryStorage(bool b) {
     return false;
 }
 
+bool vx::fs::Helper::setBundleOverlay(bool b) {
+    // bundle overlay not supported on Windows for now
+    return false;
+}
+
 
 
 // --------------------------------------------------